@@ -41,6 +41,9 @@ def token_type(i):
                   '\\': 'reverseSolidus',
                   ':': 'colon',
                   ';': 'semiColon',
+                  '#': 'hash',
+                  '@': 'commercialAt',
+                  '<': 'lessThan',
                   }
     whitespace = '\n\r\t\f '
     quotes = '"\''
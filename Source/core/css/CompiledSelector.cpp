@@ -0,0 +1,151 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "config.h"
+#include "core/css/CompiledSelector.h"
+
+#include "core/css/CSSSelector.h"
+#include "core/css/SelectorChecker.h"
+#include "core/dom/Element.h"
+
+namespace blink {
+
+bool CompiledSelector::canCompile(const CSSSelector& selector)
+{
+    for (const CSSSelector* current = &selector; current; current = current->tagHistory()) {
+        switch (current->match()) {
+        case CSSSelector::Tag:
+        case CSSSelector::Id:
+        case CSSSelector::Class:
+            break;
+        default:
+            if (!current->isAttributeSelector())
+                return false;
+            break;
+        }
+
+        if (current->isLastInTagHistory())
+            break;
+        if (current->relationIsAffectedByPseudoContent())
+            return false;
+        switch (current->relation()) {
+        case CSSSelector::SubSelector:
+        case CSSSelector::Descendant:
+        case CSSSelector::Child:
+            break;
+        default:
+            return false;
+        }
+    }
+    return true;
+}
+
+PassOwnPtr<CompiledSelector> CompiledSelector::compile(const CSSSelector& selector)
+{
+    if (!canCompile(selector))
+        return nullptr;
+
+    OwnPtr<CompiledSelector> compiledSelector = adoptPtr(new CompiledSelector);
+    Vector<Instruction>& instructions = compiledSelector->m_instructions;
+    for (const CSSSelector* current = &selector; current; current = current->tagHistory()) {
+        switch (current->match()) {
+        case CSSSelector::Tag: {
+            const QualifiedName& tagQName = current->tagQName();
+            if (tagQName.namespaceURI() != starAtom)
+                instructions.append(Instruction(MatchTag, current));
+            else if (tagQName.localName() != starAtom)
+                instructions.append(Instruction(MatchLocalName, current));
+            break;
+        }
+        case CSSSelector::Id:
+            instructions.append(Instruction(MatchId, current));
+            break;
+        case CSSSelector::Class:
+            instructions.append(Instruction(MatchClass, current));
+            break;
+        default:
+            ASSERT(current->isAttributeSelector());
+            instructions.append(Instruction(MatchAttribute, current));
+            compiledSelector->m_hasAttributeSelectors = true;
+            break;
+        }
+
+        if (current->isLastInTagHistory())
+            break;
+        if (current->relation() == CSSSelector::Child)
+            instructions.append(Instruction(ToParent, 0));
+        else if (current->relation() == CSSSelector::Descendant)
+            instructions.append(Instruction(ToAncestor, 0));
+    }
+    instructions.append(Instruction(Matched, 0));
+    instructions.shrinkToFit();
+    return compiledSelector.release();
+}
+
+// The compound selectors between two descendant combinators only ever need
+// to be tried again at the next ancestor of the element the first of them was
+// tried on: anchoring them at the closest possible element leaves the most
+// ancestors for the rest of the selector, so nothing further to the right has
+// to be revisited. This is what lets the loop below do without the recursion
+// SelectorChecker::match() uses.
+bool CompiledSelector::matches(Element& element) const
+{
+    Element* current = &element;
+    Element* retryElement = 0;
+    const Instruction* retryInstruction = 0;
+    const Instruction* instruction = m_instructions.data();
+    while (true) {
+        const CSSSelector* selector = instruction->selector;
+        bool matched;
+        switch (instruction->opcode) {
+        case MatchLocalName:
+            matched = current->localName() == selector->tagQName().localName();
+            break;
+        case MatchTag:
+            matched = SelectorChecker::tagMatches(*current, selector->tagQName());
+            break;
+        case MatchId:
+            matched = current->hasID() && current->idForStyleResolution() == selector->value();
+            break;
+        case MatchClass:
+            matched = current->hasClass() && current->classNames().contains(selector->value());
+            break;
+        case MatchAttribute:
+            matched = SelectorChecker::attributeSelectorMatches(*current, *selector);
+            break;
+        case ToParent:
+            current = current->parentElement();
+            if (!current)
+                return false;
+            ++instruction;
+            continue;
+        case ToAncestor:
+            current = current->parentElement();
+            if (!current)
+                return false;
+            retryElement = current;
+            retryInstruction = ++instruction;
+            continue;
+        case Matched:
+            return true;
+        default:
+            ASSERT_NOT_REACHED();
+            return false;
+        }
+
+        if (matched) {
+            ++instruction;
+            continue;
+        }
+        if (!retryInstruction)
+            return false;
+        retryElement = retryElement->parentElement();
+        if (!retryElement)
+            return false;
+        current = retryElement;
+        instruction = retryInstruction;
+    }
+}
+
+} // namespace blink
@@ -0,0 +1,79 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CompiledSelector_h
+#define CompiledSelector_h
+
+#include "wtf/FastAllocBase.h"
+#include "wtf/Noncopyable.h"
+#include "wtf/PassOwnPtr.h"
+#include "wtf/Vector.h"
+
+namespace blink {
+
+class CSSSelector;
+class Element;
+
+// A CompiledSelector is a flattened form of a complex selector that is made
+// only of tag, id, class and attribute simple selectors joined by descendant
+// and child combinators, which covers the bulk of author style sheets. It is
+// matched by a single loop instead of the recursive SelectorChecker, and it
+// gives the same answer as SelectorChecker does for an unscoped match that
+// does not request a pseudo element.
+//
+// The instructions refer back into the CSSSelector they were compiled from,
+// so a CompiledSelector must not outlive the StyleRule owning that selector.
+class CompiledSelector {
+    WTF_MAKE_NONCOPYABLE(CompiledSelector);
+    WTF_MAKE_FAST_ALLOCATED;
+public:
+    // Returns nullptr when the selector has a shape that only SelectorChecker handles.
+    static PassOwnPtr<CompiledSelector> compile(const CSSSelector&);
+
+    bool matches(Element&) const;
+
+    // Matching reads nothing but the element tree unless the selector has
+    // attribute selectors, which may synchronize lazy attributes.
+    bool canMatchOnWorkerThread() const { return !m_hasAttributeSelectors; }
+
+private:
+    enum Opcode {
+        MatchLocalName,
+        MatchTag,
+        MatchId,
+        MatchClass,
+        MatchAttribute,
+        // Move to the parent element.
+        ToParent,
+        // Move to the parent element and remember it as the place to retry
+        // the instructions that follow if they fail.
+        ToAncestor,
+        Matched
+    };
+
+    struct Instruction {
+        Instruction(Opcode opcode, const CSSSelector* selector)
+            : opcode(opcode)
+            , selector(selector)
+        {
+        }
+
+        Opcode opcode;
+        const CSSSelector* selector;
+    };
+
+    CompiledSelector()
+        : m_hasAttributeSelectors(false)
+    {
+    }
+
+    static bool canCompile(const CSSSelector&);
+
+    Vector<Instruction> m_instructions;
+    bool m_hasAttributeSelectors;
+};
+
+} // namespace blink
+
+#endif // CompiledSelector_h
@@ -0,0 +1,112 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "config.h"
+#include "core/css/CompiledSelector.h"
+
+#include "bindings/core/v8/ExceptionStatePlaceholder.h"
+#include "core/css/CSSSelectorList.h"
+#include "core/css/SelectorChecker.h"
+#include "core/css/SiblingTraversalStrategies.h"
+#include "core/css/parser/CSSParser.h"
+#include "core/dom/Element.h"
+#include "core/dom/ElementTraversal.h"
+#include "core/html/HTMLDocument.h"
+#include "core/testing/DummyPageHolder.h"
+#include <gtest/gtest.h>
+
+using namespace blink;
+
+namespace {
+
+class CompiledSelectorTest : public ::testing::Test {
+protected:
+    virtual void SetUp() OVERRIDE
+    {
+        m_dummyPageHolder = DummyPageHolder::create(IntSize(800, 600));
+    }
+
+    Document& document() const { return m_dummyPageHolder->document(); }
+
+    void parseSelector(const char* selectorText, CSSSelectorList& selectorList)
+    {
+        CSSParser parser(CSSParserContext(document(), 0));
+        parser.parseSelector(selectorText, selectorList);
+        ASSERT_TRUE(selectorList.first());
+    }
+
+    bool canCompile(const char* selectorText)
+    {
+        CSSSelectorList selectorList;
+        parseSelector(selectorText, selectorList);
+        return !!CompiledSelector::compile(*selectorList.first());
+    }
+
+    // Checks that the compiled form of the selector agrees with
+    // SelectorChecker on every element of the document.
+    void expectSameMatchesAsSelectorChecker(const char* selectorText)
+    {
+        CSSSelectorList selectorList;
+        parseSelector(selectorText, selectorList);
+        OwnPtr<CompiledSelector> compiledSelector = CompiledSelector::compile(*selectorList.first());
+        ASSERT_TRUE(compiledSelector);
+
+        SelectorChecker selectorChecker(document(), SelectorChecker::QueryingRules);
+        unsigned matchCount = 0;
+        for (Element* element = ElementTraversal::firstWithin(document()); element; element = ElementTraversal::next(*element)) {
+            SelectorChecker::SelectorCheckingContext context(*selectorList.first(), element, SelectorChecker::VisitedMatchDisabled);
+            bool expected = selectorChecker.match(context, DOMSiblingTraversalStrategy()) == SelectorChecker::SelectorMatches;
+            EXPECT_EQ(expected, compiledSelector->matches(*element)) << selectorText << " on <" << element->localName().utf8().data() << " id=" << element->getIdAttribute().utf8().data() << ">";
+            if (expected)
+                ++matchCount;
+        }
+        EXPECT_LT(0u, matchCount) << selectorText;
+    }
+
+private:
+    OwnPtr<DummyPageHolder> m_dummyPageHolder;
+};
+
+TEST_F(CompiledSelectorTest, CompilesOnlySimpleChains)
+{
+    EXPECT_TRUE(canCompile("div"));
+    EXPECT_TRUE(canCompile("*"));
+    EXPECT_TRUE(canCompile(".a .b"));
+    EXPECT_TRUE(canCompile("div#id > p.a[title] span[lang|=en]"));
+
+    EXPECT_FALSE(canCompile("a:hover"));
+    EXPECT_FALSE(canCompile("div::before"));
+    EXPECT_FALSE(canCompile(".a + .b"));
+    EXPECT_FALSE(canCompile(".a ~ .b"));
+    EXPECT_FALSE(canCompile(".a :not(.b)"));
+}
+
+TEST_F(CompiledSelectorTest, MatchesLikeSelectorChecker)
+{
+    document().documentElement()->setInnerHTML(
+        "<body class='root'>"
+        "  <div id='outer' class='a'>"
+        "    <div class='b' title='x'>"
+        "      <p class='a c'><span id='s1' lang='en-US'>text</span></p>"
+        "      <section class='b'><p><span id='s2' class='c'>text</span></p></section>"
+        "    </div>"
+        "    <p class='b'><span id='s3' class='c' lang='fr'>text</span></p>"
+        "  </div>"
+        "</body>", ASSERT_NO_EXCEPTION);
+
+    expectSameMatchesAsSelectorChecker("span");
+    expectSameMatchesAsSelectorChecker("*");
+    expectSameMatchesAsSelectorChecker("#outer");
+    expectSameMatchesAsSelectorChecker(".a .c");
+    expectSameMatchesAsSelectorChecker(".b > .c");
+    expectSameMatchesAsSelectorChecker("div > p span");
+    expectSameMatchesAsSelectorChecker(".b > p > span.c");
+    // Needs a retry further up after the child combinator fails at the closest ".b".
+    expectSameMatchesAsSelectorChecker(".a > .b p span");
+    expectSameMatchesAsSelectorChecker("#outer .b .c");
+    expectSameMatchesAsSelectorChecker("[title=x] span[lang|=en]");
+    expectSameMatchesAsSelectorChecker("body.root div > [class~=b] > *");
+}
+
+} // namespace
@@ -37,6 +37,7 @@
 #include "core/css/CSSStyleRule.h"
 #include "core/css/CSSStyleSheet.h"
 #include "core/css/CSSSupportsRule.h"
+#include "core/css/CompiledSelector.h"
 #include "core/css/SiblingTraversalStrategies.h"
 #include "core/css/StylePropertySet.h"
 #include "core/css/resolver/StyleResolver.h"
@@ -55,6 +56,7 @@ ElementRuleCollector::ElementRuleCollector(const ElementResolveContext& context,
     , m_canUseFastReject(m_selectorFilter.parentStackIsConsistent(context.parentNode()))
     , m_sameOriginOnly(false)
     , m_matchingUARules(false)
+    , m_useParallelRuleMatches(false)
 { }
 
 ElementRuleCollector::~ElementRuleCollector()
@@ -139,6 +141,8 @@ void ElementRuleCollector::collectMatchingRules(const MatchRequest& matchRequest
     ASSERT(m_context.element());
 
     Element& element = *m_context.element();
+    m_useParallelRuleMatches = m_parallelRuleMatches.coversRuleSet(*matchRequest.ruleSet);
+
     const AtomicString& pseudoId = element.shadowPseudoId();
     if (!pseudoId.isEmpty()) {
         ASSERT(element.isStyledElement());
@@ -254,8 +258,28 @@ void ElementRuleCollector::sortAndTransferMatchedRules()
     }
 }
 
+static inline bool canUseCompiledSelector(const Element& element, const ContainerNode* scope, SelectorChecker::ContextFlags contextFlags)
+{
+    if (!scope)
+        return contextFlags == SelectorChecker::DefaultBehavior;
+    // The document contains every ancestor of an element in the document
+    // tree, so a document scope neither changes how SelectorChecker walks up
+    // nor where it may stop, whatever the context flags.
+    return scope->isDocumentNode() && scope->treeScope() == element.treeScope();
+}
+
 inline bool ElementRuleCollector::ruleMatches(const RuleData& ruleData, const ContainerNode* scope, SelectorChecker::ContextFlags contextFlags, SelectorChecker::MatchResult* result)
 {
+    // A compiled selector has no pseudo elements and never crosses a scope,
+    // so it matches with specificity and dynamic pseudo left untouched.
+    if (const CompiledSelector* compiledSelector = ruleData.compiledSelector()) {
+        if (canUseCompiledSelector(*m_context.element(), scope, contextFlags) && m_pseudoStyleRequest.pseudoId == NOPSEUDO) {
+            if (m_useParallelRuleMatches && compiledSelector->canMatchOnWorkerThread())
+                return m_parallelRuleMatches.contains(ruleData);
+            return compiledSelector->matches(*m_context.element());
+        }
+    }
+
     SelectorChecker selectorChecker(m_context.element()->document(), m_mode);
     SelectorChecker::SelectorCheckingContext context(ruleData.selector(), m_context.element(), SelectorChecker::VisitedMatchEnabled);
     context.elementStyle = m_style.get();
@@ -275,7 +299,7 @@ inline bool ElementRuleCollector::ruleMatches(const RuleData& ruleData, const Co
 
 void ElementRuleCollector::collectRuleIfMatches(const RuleData& ruleData, SelectorChecker::ContextFlags contextFlags, CascadeScope cascadeScope, CascadeOrder cascadeOrder, const MatchRequest& matchRequest, RuleRange& ruleRange)
 {
-    if (m_canUseFastReject && m_selectorFilter.fastRejectSelector<RuleData::maximumIdentifierCount>(ruleData.descendantSelectorIdentifierHashes()))
+    if (m_canUseFastReject && m_selectorFilter.fastRejectSelector<RuleData::maximumIdentifierCount>(ruleData.descendantSelectorIdentifierHashes(), *m_context.element()))
         return;
 
     StyleRule* rule = ruleData.rule();
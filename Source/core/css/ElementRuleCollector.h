@@ -27,6 +27,7 @@
 #include "core/css/resolver/ElementResolveContext.h"
 #include "core/css/resolver/MatchRequest.h"
 #include "core/css/resolver/MatchResult.h"
+#include "core/css/resolver/ParallelRuleMatcher.h"
 #include "wtf/RefPtr.h"
 #include "wtf/Vector.h"
 
@@ -116,6 +117,7 @@ public:
 
     void setMode(SelectorChecker::Mode mode) { m_mode = mode; }
     void setPseudoStyleRequest(const PseudoStyleRequest& request) { m_pseudoStyleRequest = request; }
+    void setParallelRuleMatches(const ParallelRuleMatcher::ElementMatches& matches) { m_parallelRuleMatches = matches; }
     void setSameOriginOnly(bool f) { m_sameOriginOnly = f; }
 
     void setMatchingUARules(bool matchingUARules) { m_matchingUARules = matchingUARules; }
@@ -166,6 +168,8 @@ private:
     bool m_canUseFastReject;
     bool m_sameOriginOnly;
     bool m_matchingUARules;
+    ParallelRuleMatcher::ElementMatches m_parallelRuleMatches;
+    bool m_useParallelRuleMatches;
 
     OwnPtrWillBeMember<WillBeHeapVector<MatchedRule, 32> > m_matchedRules;
 
@@ -77,6 +77,7 @@ static bool isSkippableComponentForInvalidation(const CSSSelector& selector)
     case CSSSelector::PseudoLink:
     case CSSSelector::PseudoVisited:
     case CSSSelector::PseudoAnyLink:
+    case CSSSelector::PseudoAutofill:
     case CSSSelector::PseudoHover:
     case CSSSelector::PseudoDrag:
     case CSSSelector::PseudoFocus:
@@ -223,6 +224,14 @@ DescendantInvalidationSet* RuleFeatureSet::invalidationSetForSelector(const CSSS
         case CSSSelector::PseudoLink:
         case CSSSelector::PseudoTarget:
         case CSSSelector::PseudoVisited:
+        case CSSSelector::PseudoAutofill:
+        case CSSSelector::PseudoOptional:
+        case CSSSelector::PseudoRequired:
+        case CSSSelector::PseudoValid:
+        case CSSSelector::PseudoInvalid:
+        case CSSSelector::PseudoInRange:
+        case CSSSelector::PseudoOutOfRange:
+        case CSSSelector::PseudoUnresolved:
             return &ensurePseudoInvalidationSet(selector.pseudoType());
         default:
             break;
@@ -473,6 +482,7 @@ void RuleFeatureSet::clear()
     m_classInvalidationSets.clear();
     m_attributeInvalidationSets.clear();
     m_idInvalidationSets.clear();
+    m_pseudoInvalidationSets.clear();
     // We cannot clear m_styleInvalidator here, because the style invalidator might not
     // have been evaluated yet. If not yet, in StyleInvalidator, there exists some element
     // who has needsStyleInvlidation but does not have any invalidation list.
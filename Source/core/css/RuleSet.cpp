@@ -135,6 +135,7 @@ RuleData::RuleData(StyleRule* rule, unsigned selectorIndex, unsigned position, A
     , m_linkMatchType(SelectorChecker::determineLinkMatchType(selector()))
     , m_hasDocumentSecurityOrigin(addRuleFlags & RuleHasDocumentSecurityOrigin)
     , m_propertyWhitelistType(determinePropertyWhitelistType(addRuleFlags, selector()))
+    , m_compiledSelector(0)
 {
     ASSERT(m_position == position);
     ASSERT(m_selectorIndex == selectorIndex);
@@ -238,6 +239,10 @@ bool RuleSet::findBestRuleSetAndAdd(const CSSSelector& component, RuleData& rule
 void RuleSet::addRule(StyleRule* rule, unsigned selectorIndex, AddRuleFlags addRuleFlags)
 {
     RuleData ruleData(rule, selectorIndex, m_ruleCount++, addRuleFlags);
+    if (OwnPtr<CompiledSelector> compiledSelector = CompiledSelector::compile(ruleData.selector())) {
+        ruleData.setCompiledSelector(compiledSelector.get());
+        m_compiledSelectors.append(compiledSelector.release());
+    }
     m_features.collectFeaturesFromRuleData(ruleData);
 
     if (!findBestRuleSetAndAdd(ruleData.selector(), ruleData)) {
@@ -365,6 +370,7 @@ void RuleSet::compactRules()
     m_keyframesRules.shrinkToFit();
     m_treeBoundaryCrossingRules.shrinkToFit();
     m_shadowDistributedRules.shrinkToFit();
+    m_compiledSelectors.shrinkToFit();
 }
 
 void MinimalRuleData::trace(Visitor* visitor)
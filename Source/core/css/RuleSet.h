@@ -23,6 +23,7 @@
 #define RuleSet_h
 
 #include "core/css/CSSKeyframesRule.h"
+#include "core/css/CompiledSelector.h"
 #include "core/css/MediaQueryEvaluator.h"
 #include "core/css/RuleFeature.h"
 #include "core/css/StyleRule.h"
@@ -33,6 +34,7 @@
 #include "wtf/HashMap.h"
 #include "wtf/LinkedStack.h"
 #include "wtf/TerminatedArray.h"
+#include "wtf/text/AtomicStringHash.h"
 
 namespace blink {
 
@@ -93,6 +95,11 @@ public:
     static const unsigned maximumIdentifierCount = 4;
     const unsigned* descendantSelectorIdentifierHashes() const { return m_descendantSelectorIdentifierHashes; }
 
+    // Owned by the RuleSet this RuleData was added to. Null if the selector
+    // has to be matched with SelectorChecker.
+    const CompiledSelector* compiledSelector() const { return m_compiledSelector; }
+    void setCompiledSelector(const CompiledSelector* compiledSelector) { m_compiledSelector = compiledSelector; }
+
     void trace(Visitor*);
 
 private:
@@ -111,6 +118,7 @@ private:
     unsigned m_propertyWhitelistType : 2;
     // Use plain array instead of a Vector to minimize memory overhead.
     unsigned m_descendantSelectorIdentifierHashes[maximumIdentifierCount];
+    const CompiledSelector* m_compiledSelector;
 };
 
 struct SameSizeAsRuleData {
@@ -118,6 +126,7 @@ struct SameSizeAsRuleData {
     unsigned b;
     unsigned c;
     unsigned d[4];
+    void* e;
 };
 
 COMPILE_ASSERT(sizeof(RuleData) == sizeof(SameSizeAsRuleData), RuleData_should_stay_small);
@@ -167,7 +176,9 @@ public:
 
 private:
     typedef WillBeHeapHashMap<AtomicString, OwnPtrWillBeMember<WillBeHeapLinkedStack<RuleData> > > PendingRuleMap;
-    typedef WillBeHeapHashMap<AtomicString, OwnPtrWillBeMember<WillBeHeapTerminatedArray<RuleData> > > CompactRuleMap;
+    // The compact maps are looked up for every element during style
+    // resolution.
+    typedef WillBeHeapHashMap<AtomicString, OwnPtrWillBeMember<WillBeHeapTerminatedArray<RuleData> >, DefaultHash<AtomicString>::Hash, GroupedProbingHashTraits<AtomicString> > CompactRuleMap;
 
     RuleSet()
         : m_ruleCount(0)
@@ -226,6 +237,8 @@ private:
 
     MediaQueryResultList m_viewportDependentMediaQueryResults;
 
+    Vector<OwnPtr<CompiledSelector> > m_compiledSelectors;
+
     unsigned m_ruleCount;
     OwnPtrWillBeMember<PendingRuleMaps> m_pendingRules;
 
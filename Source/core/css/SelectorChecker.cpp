@@ -496,6 +496,12 @@ static bool anyAttributeMatches(Element& element, CSSSelector::Match match, cons
     return false;
 }
 
+bool SelectorChecker::attributeSelectorMatches(Element& element, const CSSSelector& selector)
+{
+    ASSERT(selector.isAttributeSelector());
+    return anyAttributeMatches(element, selector.match(), selector);
+}
+
 template<typename SiblingTraversalStrategy>
 bool SelectorChecker::checkOne(const SelectorCheckingContext& context, const SiblingTraversalStrategy& siblingTraversalStrategy, unsigned* specificity) const
 {
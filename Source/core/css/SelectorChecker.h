@@ -117,6 +117,7 @@ public:
     static bool matchesSpatialNavigationFocusPseudoClass(const Element&);
     static bool matchesListBoxPseudoClass(const Element&);
     static bool checkExactAttribute(const Element&, const QualifiedName& selectorAttributeName, const StringImpl* value);
+    static bool attributeSelectorMatches(Element&, const CSSSelector&);
 
     enum LinkMatchMask { MatchLink = 1, MatchVisited = 2, MatchAll = MatchLink | MatchVisited };
     static unsigned determineLinkMatchType(const CSSSelector&);
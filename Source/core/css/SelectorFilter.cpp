@@ -29,14 +29,17 @@
 #include "config.h"
 #include "core/css/SelectorFilter.h"
 
+#include "core/HTMLNames.h"
 #include "core/css/CSSSelector.h"
+#include "core/dom/ElementTraversal.h"
+#include "wtf/MainThread.h"
 
 namespace blink {
 
 // Salt to separate otherwise identical string hashes so a class-selector like .article won't match <article> elements.
-enum { TagNameSalt = 13, IdAttributeSalt = 17, ClassAttributeSalt = 19 };
+enum { TagNameSalt = 13, IdAttributeSalt = 17, ClassAttributeSalt = 19, AttributeSalt = 23 };
 
-static inline void collectElementIdentifierHashes(const Element& element, Vector<unsigned, 4>& identifierHashes)
+void SelectorFilter::collectElementIdentifierHashes(const Element& element, Vector<unsigned, 4>& identifierHashes)
 {
     identifierHashes.append(element.localName().impl()->existingHash() * TagNameSalt);
     if (element.hasID())
@@ -47,6 +50,17 @@ static inline void collectElementIdentifierHashes(const Element& element, Vector
         for (size_t i = 0; i < count; ++i)
             identifierHashes.append(classNames[i].impl()->existingHash() * ClassAttributeSalt);
     }
+
+    // HTML elements only have a lazy style attribute, which is there if the
+    // element has an inline style. Reading it keeps this safe on the worker
+    // threads of ParallelRuleMatcher, which never see other elements.
+    ASSERT(element.isHTMLElement() || isMainThread());
+    if (element.isHTMLElement() && element.inlineStyle())
+        identifierHashes.append(HTMLNames::styleAttr.localName().impl()->existingHash() * AttributeSalt);
+    AttributeCollection attributes = element.isHTMLElement() ? element.attributesWithoutUpdate() : element.attributes();
+    AttributeCollection::iterator end = attributes.end();
+    for (AttributeCollection::iterator it = attributes.begin(); it != end; ++it)
+        identifierHashes.append(it->localName().impl()->existingHash() * AttributeSalt);
 }
 
 void SelectorFilter::pushParentStackFrame(Element& parent)
@@ -73,6 +87,8 @@ void SelectorFilter::popParentStackFrame()
     for (size_t i = 0; i < count; ++i)
         m_ancestorIdentifierFilter->remove(parentFrame.identifierHashes[i]);
     m_parentStack.removeLast();
+    if (m_siblingFilters.size() > m_parentStack.size())
+        m_siblingFilters.shrink(m_parentStack.size());
     if (m_parentStack.isEmpty()) {
         ASSERT(m_ancestorIdentifierFilter->likelyEmpty());
         m_ancestorIdentifierFilter.clear();
@@ -84,6 +100,7 @@ void SelectorFilter::setupParentStack(Element& parent)
     ASSERT(m_parentStack.isEmpty() == !m_ancestorIdentifierFilter);
     // Kill whatever we stored before.
     m_parentStack.shrink(0);
+    m_siblingFilters.clear();
     m_ancestorIdentifierFilter = adoptPtr(new BloomFilter<bloomFilterKeyBits>);
     // Fast version if parent is a root element:
     if (!parent.parentOrShadowHostNode()) {
@@ -108,24 +125,91 @@ void SelectorFilter::pushParent(Element& parent)
     pushParentStackFrame(parent);
 }
 
-static inline void collectDescendantSelectorIdentifierHashes(const CSSSelector& selector, unsigned*& hash)
+const SelectorFilter::SiblingFilter* SelectorFilter::siblingFilterFor(const Element& element) const
+{
+    ASSERT(!m_parentStack.isEmpty());
+    Element* parent = m_parentStack.last().element;
+    // The composed tree parent of a distributed or shadow root child is not
+    // the parent its sibling combinators look at.
+    if (element.parentNode() != parent)
+        return 0;
+
+    size_t depth = m_parentStack.size() - 1;
+    if (m_siblingFilters.size() <= depth)
+        m_siblingFilters.grow(depth + 1);
+    if (!m_siblingFilters[depth]) {
+        OwnPtr<SiblingFilter> siblingFilter = adoptPtr(new SiblingFilter);
+        Vector<unsigned, 4> identifierHashes;
+        for (Element* child = ElementTraversal::firstChild(*parent); child; child = ElementTraversal::nextSibling(*child)) {
+            if (!child->isHTMLElement()) {
+                siblingFilter->isComplete = false;
+                break;
+            }
+            identifierHashes.shrink(0);
+            collectElementIdentifierHashes(*child, identifierHashes);
+            for (size_t i = 0; i < identifierHashes.size(); ++i)
+                siblingFilter->identifierFilter.add(identifierHashes[i]);
+        }
+        m_siblingFilters[depth] = siblingFilter.release();
+    }
+    return m_siblingFilters[depth].get();
+}
+
+void SelectorFilter::countFastRejection(unsigned hash) const
+{
+    if (hash & siblingHashFlag) {
+        ++m_stats->selectorFilterRejectedBySiblings;
+        ++m_statsTotals->selectorFilterRejectedBySiblings;
+    } else if (hash & attributeHashFlag) {
+        ++m_stats->selectorFilterRejectedByAttributes;
+        ++m_statsTotals->selectorFilterRejectedByAttributes;
+    } else {
+        ++m_stats->selectorFilterRejectedByAncestors;
+        ++m_statsTotals->selectorFilterRejectedByAncestors;
+    }
+}
+
+static inline unsigned selectorIdentifierHash(const CSSSelector& selector, bool& isAttribute)
 {
     switch (selector.match()) {
     case CSSSelector::Id:
         if (!selector.value().isEmpty())
-            (*hash++) = selector.value().impl()->existingHash() * IdAttributeSalt;
+            return selector.value().impl()->existingHash() * IdAttributeSalt;
         break;
     case CSSSelector::Class:
         if (!selector.value().isEmpty())
-            (*hash++) = selector.value().impl()->existingHash() * ClassAttributeSalt;
+            return selector.value().impl()->existingHash() * ClassAttributeSalt;
         break;
     case CSSSelector::Tag:
         if (selector.tagQName().localName() != starAtom)
-            (*hash++) = selector.tagQName().localName().impl()->existingHash() * TagNameSalt;
+            return selector.tagQName().localName().impl()->existingHash() * TagNameSalt;
         break;
+    case CSSSelector::Exact:
+    case CSSSelector::Set:
+    case CSSSelector::List:
+    case CSSSelector::Hyphen:
+    case CSSSelector::Contain:
+    case CSSSelector::Begin:
+    case CSSSelector::End:
+        isAttribute = true;
+        return selector.attribute().localName().impl()->existingHash() * AttributeSalt;
     default:
         break;
     }
+    return 0;
+}
+
+inline void SelectorFilter::collectSelectorIdentifierHash(const CSSSelector& selector, bool matchesSibling, unsigned*& hash)
+{
+    bool isAttribute = false;
+    unsigned identifierHash = selectorIdentifierHash(selector, isAttribute) & ~hashFlagsMask;
+    if (!identifierHash)
+        return;
+    if (isAttribute)
+        identifierHash |= attributeHashFlag;
+    if (matchesSibling)
+        identifierHash |= siblingHashFlag;
+    *hash++ = identifierHash;
 }
 
 void SelectorFilter::collectIdentifierHashes(const CSSSelector& selector, unsigned* identifierHashes, unsigned maximumIdentifierCount)
@@ -137,16 +221,25 @@ void SelectorFilter::collectIdentifierHashes(const CSSSelector& selector, unsign
 
     // Skip the topmost selector. It is handled quickly by the rule hashes.
     bool skipOverSubselectors = true;
+    // Only the compound selector a sibling combinator attaches to the
+    // topmost one is known to match a child of the parent on the stack.
+    bool passedCombinator = false;
+    bool inSiblingCompound = false;
     for (const CSSSelector* current = selector.tagHistory(); current; current = current->tagHistory()) {
-        // Only collect identifiers that match ancestors.
+        // Only collect identifiers that match ancestors, or siblings of the
+        // element.
         switch (relation) {
         case CSSSelector::SubSelector:
-            if (!skipOverSubselectors)
-                collectDescendantSelectorIdentifierHashes(*current, hash);
+            if (inSiblingCompound || !skipOverSubselectors)
+                collectSelectorIdentifierHash(*current, inSiblingCompound, hash);
             break;
         case CSSSelector::DirectAdjacent:
         case CSSSelector::IndirectAdjacent:
             skipOverSubselectors = true;
+            inSiblingCompound = !passedCombinator;
+            passedCombinator = true;
+            if (inSiblingCompound)
+                collectSelectorIdentifierHash(*current, true, hash);
             break;
         case CSSSelector::Descendant:
         case CSSSelector::Child:
@@ -159,7 +252,9 @@ void SelectorFilter::collectIdentifierHashes(const CSSSelector& selector, unsign
         case CSSSelector::ShadowPseudo:
         case CSSSelector::ShadowDeep:
             skipOverSubselectors = false;
-            collectDescendantSelectorIdentifierHashes(*current, hash);
+            inSiblingCompound = false;
+            passedCombinator = true;
+            collectSelectorIdentifierHash(*current, false, hash);
             break;
         }
         if (hash == end)
@@ -29,6 +29,7 @@
 #ifndef SelectorFilter_h
 #define SelectorFilter_h
 
+#include "core/css/resolver/StyleResolverStats.h"
 #include "core/dom/Element.h"
 #include "wtf/BloomFilter.h"
 #include "wtf/Vector.h"
@@ -52,6 +53,8 @@ public:
         Vector<unsigned, 4> identifierHashes;
     };
 
+    SelectorFilter() : m_stats(0), m_statsTotals(0) { }
+
     void pushParentStackFrame(Element& parent);
     void popParentStackFrame();
 
@@ -61,27 +64,82 @@ public:
     bool parentStackIsEmpty() const { return m_parentStack.isEmpty(); }
     bool parentStackIsConsistent(const ContainerNode* parentNode) const { return !m_parentStack.isEmpty() && m_parentStack.last().element == parentNode; }
 
+    // |element| must be a child of the element on top of the parent stack in
+    // the composed tree.
     template <unsigned maximumIdentifierCount>
-    inline bool fastRejectSelector(const unsigned* identifierHashes) const;
+    inline bool fastRejectSelector(const unsigned* identifierHashes, const Element&) const;
     static void collectIdentifierHashes(const CSSSelector&, unsigned* identifierHashes, unsigned maximumIdentifierCount);
 
+    // Counts fast rejections when set. The worker thread filters of
+    // ParallelRuleMatcher never count.
+    void setStats(StyleResolverStats* stats, StyleResolverStats* statsTotals)
+    {
+        m_stats = stats;
+        m_statsTotals = statsTotals;
+    }
+
     void trace(Visitor*);
 
 private:
-    WillBeHeapVector<ParentStackFrame> m_parentStack;
+    // The bloom filters only look at the low 28 bits of a hash. The top bits
+    // of the hashes collected from selectors say what they must be found in.
+    static const unsigned siblingHashFlag = 1u << 31;
+    static const unsigned attributeHashFlag = 1u << 30;
+    static const unsigned hashFlagsMask = siblingHashFlag | attributeHashFlag;
 
     // With 100 unique strings in the filter, 2^12 slot table has false positive rate of ~0.2%.
     static const unsigned bloomFilterKeyBits = 12;
+    // Holds the identifiers of all the children of a parent, which are
+    // rarely more than a few dozen.
+    static const unsigned siblingBloomFilterKeyBits = 8;
+
+    struct SiblingFilter {
+        WTF_MAKE_FAST_ALLOCATED;
+    public:
+        SiblingFilter() : isComplete(true) { }
+
+        // False if the children include elements whose attributes may be
+        // out of date, which only the main thread can synchronize.
+        bool isComplete;
+        BloomFilter<siblingBloomFilterKeyBits> identifierFilter;
+    };
+
+    static void collectElementIdentifierHashes(const Element&, Vector<unsigned, 4>& identifierHashes);
+    static void collectSelectorIdentifierHash(const CSSSelector&, bool matchesSibling, unsigned*& hash);
+    const SiblingFilter* siblingFilterFor(const Element&) const;
+    void countFastRejection(unsigned hash) const;
+
+    WillBeHeapVector<ParentStackFrame> m_parentStack;
+
     OwnPtr<BloomFilter<bloomFilterKeyBits> > m_ancestorIdentifierFilter;
+    // Built on demand for the children of the elements on the parent stack,
+    // indexed like it.
+    mutable Vector<OwnPtr<SiblingFilter> > m_siblingFilters;
+
+    StyleResolverStats* m_stats;
+    StyleResolverStats* m_statsTotals;
 };
 
 template <unsigned maximumIdentifierCount>
-inline bool SelectorFilter::fastRejectSelector(const unsigned* identifierHashes) const
+inline bool SelectorFilter::fastRejectSelector(const unsigned* identifierHashes, const Element& element) const
 {
     ASSERT(m_ancestorIdentifierFilter);
+    if (m_stats) {
+        ++m_stats->selectorFilterChecks;
+        ++m_statsTotals->selectorFilterChecks;
+    }
     for (unsigned n = 0; n < maximumIdentifierCount && identifierHashes[n]; ++n) {
-        if (!m_ancestorIdentifierFilter->mayContain(identifierHashes[n]))
-            return true;
+        unsigned hash = identifierHashes[n];
+        if (hash & siblingHashFlag) {
+            const SiblingFilter* siblingFilter = siblingFilterFor(element);
+            if (!siblingFilter || !siblingFilter->isComplete || siblingFilter->identifierFilter.mayContain(hash))
+                continue;
+        } else if (m_ancestorIdentifierFilter->mayContain(hash)) {
+            continue;
+        }
+        if (m_stats)
+            countFastRejection(hash);
+        return true;
     }
     return false;
 }
@@ -0,0 +1,98 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "config.h"
+#include "core/css/SelectorFilter.h"
+
+#include "bindings/core/v8/ExceptionStatePlaceholder.h"
+#include "core/css/CSSSelectorList.h"
+#include "core/css/RuleSet.h"
+#include "core/css/parser/CSSParser.h"
+#include "core/dom/Element.h"
+#include "core/html/HTMLDocument.h"
+#include "core/testing/DummyPageHolder.h"
+#include <gtest/gtest.h>
+
+using namespace blink;
+
+namespace {
+
+class SelectorFilterTest : public ::testing::Test {
+protected:
+    virtual void SetUp() OVERRIDE
+    {
+        m_dummyPageHolder = DummyPageHolder::create(IntSize(800, 600));
+        document().documentElement()->setInnerHTML(
+            "<body><div id=grandparent data-theme=dark>"
+            "<div id=parent class=list>"
+            "<span class='a first'></span><svg></svg><p id=target class=item></p>"
+            "</div>"
+            "<div id=other><span class=b></span><p id=otherTarget></p></div>"
+            "</div></body>", ASSERT_NO_EXCEPTION);
+    }
+
+    Document& document() const { return m_dummyPageHolder->document(); }
+    Element& element(const char* id) const { return *document().getElementById(id); }
+
+    bool fastRejects(const SelectorFilter& filter, const char* selectorText, const Element& element)
+    {
+        CSSSelectorList selectorList;
+        CSSParser parser(CSSParserContext(document(), 0));
+        parser.parseSelector(selectorText, selectorList);
+        EXPECT_TRUE(selectorList.first()) << selectorText;
+        unsigned identifierHashes[RuleData::maximumIdentifierCount];
+        SelectorFilter::collectIdentifierHashes(*selectorList.first(), identifierHashes, RuleData::maximumIdentifierCount);
+        return filter.fastRejectSelector<RuleData::maximumIdentifierCount>(identifierHashes, element);
+    }
+
+private:
+    OwnPtr<DummyPageHolder> m_dummyPageHolder;
+};
+
+TEST_F(SelectorFilterTest, RejectsAncestorAttributes)
+{
+    SelectorFilter filter;
+    filter.setupParentStack(element("parent"));
+    Element& target = element("target");
+
+    EXPECT_FALSE(fastRejects(filter, "[data-theme] .item", target));
+    EXPECT_FALSE(fastRejects(filter, "[data-theme=light] .item", target));
+    EXPECT_FALSE(fastRejects(filter, "#grandparent[data-theme] > .list > .item", target));
+    EXPECT_TRUE(fastRejects(filter, "[data-mode] .item", target));
+    EXPECT_TRUE(fastRejects(filter, "div[title] .item", target));
+}
+
+TEST_F(SelectorFilterTest, SiblingsOfElementsWithLazyAttributes)
+{
+    SelectorFilter filter;
+    filter.setupParentStack(element("parent"));
+    Element& target = element("target");
+
+    // The <svg> sibling may have attributes only the main thread can
+    // synchronize, so siblings do not reject anything here.
+    EXPECT_FALSE(fastRejects(filter, ".missing ~ .item", target));
+    EXPECT_FALSE(fastRejects(filter, ".a + .item", target));
+}
+
+TEST_F(SelectorFilterTest, RejectsSiblings)
+{
+    SelectorFilter filter;
+    filter.setupParentStack(element("other"));
+    Element& target = element("otherTarget");
+
+    EXPECT_FALSE(fastRejects(filter, ".b + p", target));
+    EXPECT_FALSE(fastRejects(filter, "span.b ~ p", target));
+    EXPECT_FALSE(fastRejects(filter, "[data-theme] .b ~ p", target));
+    EXPECT_TRUE(fastRejects(filter, ".a ~ p", target));
+    EXPECT_TRUE(fastRejects(filter, "div + p", target));
+    EXPECT_TRUE(fastRejects(filter, "[data-theme] .a + p", target));
+
+    // Only the compound next to the subject is known to be a sibling of it.
+    EXPECT_FALSE(fastRejects(filter, ".a ~ span + p", target));
+
+    // Siblings are only known for children of the element on the stack.
+    EXPECT_FALSE(fastRejects(filter, ".b + p", element("target")));
+}
+
+} // namespace
@@ -33,6 +33,8 @@
 #include "core/css/CSSViewportRule.h"
 #include "core/css/StylePropertySet.h"
 #include "core/css/StyleRuleImport.h"
+#include "core/css/parser/CSSLazyParsingState.h"
+#include "wtf/MainThread.h"
 
 namespace blink {
 
@@ -252,13 +254,17 @@ unsigned StyleRule::averageSizeInBytes()
 
 StyleRule::StyleRule()
     : StyleRuleBase(Style)
+    , m_lazyBlockStart(0)
+    , m_lazyBlockEnd(0)
 {
 }
 
 StyleRule::StyleRule(const StyleRule& o)
     : StyleRuleBase(o)
-    , m_properties(o.m_properties->mutableCopy())
+    , m_properties(o.properties().mutableCopy())
     , m_selectorList(o.m_selectorList)
+    , m_lazyBlockStart(0)
+    , m_lazyBlockEnd(0)
 {
 }
 
@@ -268,7 +274,7 @@ StyleRule::~StyleRule()
 
 MutableStylePropertySet& StyleRule::mutableProperties()
 {
-    if (!m_properties->isMutable())
+    if (!properties().isMutable())
         m_properties = m_properties->mutableCopy();
     return *toMutableStylePropertySet(m_properties.get());
 }
@@ -276,11 +282,29 @@ MutableStylePropertySet& StyleRule::mutableProperties()
 void StyleRule::setProperties(PassRefPtrWillBeRawPtr<StylePropertySet> properties)
 {
     m_properties = properties;
+    m_lazyParsingState = nullptr;
+}
+
+void StyleRule::setLazyProperties(PassRefPtrWillBeRawPtr<CSSLazyParsingState> lazyParsingState, unsigned start, unsigned end)
+{
+    m_properties = nullptr;
+    m_lazyParsingState = lazyParsingState;
+    m_lazyBlockStart = start;
+    m_lazyBlockEnd = end;
+}
+
+void StyleRule::parseLazyProperties() const
+{
+    ASSERT(isMainThread());
+    ASSERT(m_lazyParsingState);
+    m_properties = m_lazyParsingState->parseDeclarationBlock(m_lazyBlockStart, m_lazyBlockEnd);
+    m_lazyParsingState = nullptr;
 }
 
 void StyleRule::traceAfterDispatch(Visitor* visitor)
 {
     visitor->trace(m_properties);
+    visitor->trace(m_lazyParsingState);
     StyleRuleBase::traceAfterDispatch(visitor);
 }
 
@@ -29,6 +29,7 @@
 
 namespace blink {
 
+class CSSLazyParsingState;
 class CSSRule;
 class CSSStyleSheet;
 class MutableStylePropertySet;
@@ -105,12 +106,23 @@ public:
     ~StyleRule();
 
     const CSSSelectorList& selectorList() const { return m_selectorList; }
-    const StylePropertySet& properties() const { return *m_properties; }
+    const StylePropertySet& properties() const
+    {
+        if (!m_properties)
+            parseLazyProperties();
+        return *m_properties;
+    }
     MutableStylePropertySet& mutableProperties();
 
     void parserAdoptSelectorVector(Vector<OwnPtr<CSSParserSelector> >& selectors) { m_selectorList.adoptSelectorVector(selectors); }
     void wrapperAdoptSelectorList(CSSSelectorList& selectors) { m_selectorList.adopt(selectors); }
     void setProperties(PassRefPtrWillBeRawPtr<StylePropertySet>);
+    // The declaration block is parsed from [start, end) of the sheet text
+    // the first time properties() is called.
+    void setLazyProperties(PassRefPtrWillBeRawPtr<CSSLazyParsingState>, unsigned start, unsigned end);
+
+    bool hasParsedProperties() const { return m_properties; }
+    unsigned unparsedDeclarationBlockLength() const { return m_properties ? 0 : m_lazyBlockEnd - m_lazyBlockStart; }
 
     PassRefPtrWillBeRawPtr<StyleRule> copy() const { return adoptRefWillBeNoop(new StyleRule(*this)); }
 
@@ -122,8 +134,13 @@ private:
     StyleRule();
     StyleRule(const StyleRule&);
 
-    RefPtrWillBeMember<StylePropertySet> m_properties; // Cannot be null.
+    void parseLazyProperties() const;
+
+    mutable RefPtrWillBeMember<StylePropertySet> m_properties; // Only null until a lazy declaration block is parsed.
     CSSSelectorList m_selectorList;
+    mutable RefPtrWillBeMember<CSSLazyParsingState> m_lazyParsingState;
+    unsigned m_lazyBlockStart;
+    unsigned m_lazyBlockEnd;
 };
 
 class StyleRuleFontFace : public StyleRuleBase {
@@ -483,7 +483,8 @@ static bool childRulesHaveFailedOrCanceledSubresources(const WillBeHeapVector<Re
         const StyleRuleBase* rule = rules[i].get();
         switch (rule->type()) {
         case StyleRuleBase::Style:
-            if (toStyleRule(rule)->properties().hasFailedOrCanceledSubresources())
+            // A declaration block that is not parsed yet has loaded nothing.
+            if (toStyleRule(rule)->hasParsedProperties() && toStyleRule(rule)->properties().hasFailedOrCanceledSubresources())
                 return true;
             break;
         case StyleRuleBase::FontFace:
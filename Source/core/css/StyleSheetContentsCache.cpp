@@ -0,0 +1,118 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "config.h"
+#include "core/css/StyleSheetContentsCache.h"
+
+#include "core/css/StyleSheetContents.h"
+#include "wtf/MainThread.h"
+
+namespace blink {
+
+static const size_t maximumEntryCount = 32;
+static const size_t maximumSizeInBytes = 4 * 1024 * 1024;
+
+static size_t entrySizeInBytes(const AtomicString& text, const StyleSheetContents& contents)
+{
+    return contents.estimatedSizeInBytes() + text.length() * (text.is8Bit() ? sizeof(LChar) : sizeof(UChar));
+}
+
+StyleSheetContentsCache& StyleSheetContentsCache::instance()
+{
+    DEFINE_STATIC_LOCAL(OwnPtrWillBePersistent<StyleSheetContentsCache>, cache, (adoptPtrWillBeNoop(new StyleSheetContentsCache())));
+    return *cache;
+}
+
+StyleSheetContentsCache::StyleSheetContentsCache()
+{
+}
+
+PassRefPtrWillBeRawPtr<StyleSheetContents> StyleSheetContentsCache::find(const AtomicString& text, const CSSParserContext& context)
+{
+    ASSERT(isMainThread());
+    size_t index = m_texts.find(text);
+    if (index == kNotFound)
+        return nullptr;
+
+    RefPtrWillBeRawPtr<StyleSheetContents> contents = m_contents[index];
+    // The CSSOM changes contents with media queries in place once their only
+    // client wants to mutate them.
+    if (contents->isMutable()) {
+        remove(index);
+        return nullptr;
+    }
+    // Contexts must be identical so we know we would get the same exact result if we parsed again.
+    if (contents->parserContext() != context)
+        return nullptr;
+    if (contents->isCacheable()) {
+        if (!contents->isInMemoryCache())
+            contents->addedToMemoryCache();
+    } else {
+        if (contents->clientSize())
+            return nullptr;
+        // The RuleSet was built against the media of the last document.
+        contents->clearRuleSet();
+    }
+
+    moveToEnd(index);
+    return contents.release();
+}
+
+void StyleSheetContentsCache::add(const AtomicString& text, StyleSheetContents* contents)
+{
+    ASSERT(isMainThread());
+    ASSERT(!contents->isMutable());
+    size_t index = m_texts.find(text);
+    if (index != kNotFound)
+        remove(index);
+    if (entrySizeInBytes(text, *contents) > maximumSizeInBytes)
+        return;
+
+    m_texts.append(text);
+    m_contents.append(contents);
+    evictIfNeeded();
+}
+
+void StyleSheetContentsCache::clear()
+{
+    while (!m_texts.isEmpty())
+        remove(0);
+}
+
+void StyleSheetContentsCache::remove(size_t index)
+{
+    if (m_contents[index]->isInMemoryCache())
+        m_contents[index]->removedFromMemoryCache();
+    m_texts.remove(index);
+    m_contents.remove(index);
+}
+
+void StyleSheetContentsCache::moveToEnd(size_t index)
+{
+    AtomicString text = m_texts[index];
+    RefPtrWillBeRawPtr<StyleSheetContents> contents = m_contents[index];
+    m_texts.remove(index);
+    m_contents.remove(index);
+    m_texts.append(text);
+    m_contents.append(contents);
+}
+
+void StyleSheetContentsCache::evictIfNeeded()
+{
+    size_t sizeInBytes = 0;
+    for (size_t i = 0; i < m_texts.size(); ++i)
+        sizeInBytes += entrySizeInBytes(m_texts[i], *m_contents[i]);
+
+    while (m_texts.size() > maximumEntryCount || sizeInBytes > maximumSizeInBytes) {
+        sizeInBytes -= entrySizeInBytes(m_texts[0], *m_contents[0]);
+        remove(0);
+    }
+}
+
+void StyleSheetContentsCache::trace(Visitor* visitor)
+{
+    visitor->trace(m_contents);
+}
+
+} // namespace blink
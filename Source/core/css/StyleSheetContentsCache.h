@@ -0,0 +1,58 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef StyleSheetContentsCache_h
+#define StyleSheetContentsCache_h
+
+#include "platform/heap/Handle.h"
+#include "wtf/Noncopyable.h"
+#include "wtf/PassRefPtr.h"
+#include "wtf/Vector.h"
+#include "wtf/text/AtomicString.h"
+
+namespace blink {
+
+class CSSParserContext;
+class StyleSheetContents;
+
+// StyleSheetContentsCache keeps the parsed contents of recently used inline
+// style sheets alive across documents, so that a page, or its frames, inserting
+// a style sheet it has seen before gets the rules and the RuleSet compiled
+// from them without parsing the text again.
+//
+// Contents that isCacheable() are shared read-only by any number of documents,
+// like the parsed style sheets of the memory cache: CSSOM mutations copy them
+// first. Contents with media queries build a RuleSet that depends on the
+// document they are evaluated in, so they are only handed to a new document
+// once no other one uses them.
+class StyleSheetContentsCache : public NoBaseWillBeGarbageCollected<StyleSheetContentsCache> {
+    WTF_MAKE_NONCOPYABLE(StyleSheetContentsCache);
+public:
+    static StyleSheetContentsCache& instance();
+
+    // Returns contents parsed from |text| with an equal parser context, or
+    // nullptr if there are none that can be used right now.
+    PassRefPtrWillBeRawPtr<StyleSheetContents> find(const AtomicString& text, const CSSParserContext&);
+    void add(const AtomicString& text, StyleSheetContents*);
+    void clear();
+
+    size_t size() const { return m_texts.size(); }
+
+    void trace(Visitor*);
+
+private:
+    StyleSheetContentsCache();
+
+    void remove(size_t index);
+    void moveToEnd(size_t index);
+    void evictIfNeeded();
+
+    // Least recently used first.
+    Vector<AtomicString> m_texts;
+    WillBeHeapVector<RefPtrWillBeMember<StyleSheetContents> > m_contents;
+};
+
+} // namespace blink
+
+#endif // StyleSheetContentsCache_h
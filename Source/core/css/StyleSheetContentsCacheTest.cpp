@@ -0,0 +1,102 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "config.h"
+#include "core/css/StyleSheetContentsCache.h"
+
+#include "bindings/core/v8/ExceptionStatePlaceholder.h"
+#include "core/css/CSSStyleSheet.h"
+#include "core/css/StyleSheetContents.h"
+#include "core/dom/Document.h"
+#include "core/html/HTMLElement.h"
+#include "core/html/HTMLStyleElement.h"
+#include "core/testing/DummyPageHolder.h"
+#include "platform/weborigin/KURL.h"
+#include "platform/weborigin/SecurityOrigin.h"
+#include <gtest/gtest.h>
+
+namespace blink {
+
+class StyleSheetContentsCacheTest : public ::testing::Test {
+protected:
+    virtual void SetUp() OVERRIDE
+    {
+        StyleSheetContentsCache::instance().clear();
+        m_firstPageHolder = createPageHolder();
+        m_secondPageHolder = createPageHolder();
+    }
+
+    virtual void TearDown() OVERRIDE
+    {
+        StyleSheetContentsCache::instance().clear();
+    }
+
+    Document& firstDocument() const { return m_firstPageHolder->document(); }
+    Document& secondDocument() const { return m_secondPageHolder->document(); }
+
+    static CSSStyleSheet* insertStyleSheet(Document& document, const String& text)
+    {
+        RefPtrWillBeRawPtr<HTMLStyleElement> style = HTMLStyleElement::create(document, false);
+        style->setTextContent(text);
+        document.body()->appendChild(style, ASSERT_NO_EXCEPTION);
+        return style->sheet();
+    }
+
+private:
+    static PassOwnPtr<DummyPageHolder> createPageHolder()
+    {
+        OwnPtr<DummyPageHolder> pageHolder = DummyPageHolder::create(IntSize(800, 600));
+        pageHolder->document().setURL(KURL(ParsedURLString, "http://example.com/"));
+        pageHolder->document().setSecurityOrigin(SecurityOrigin::createFromString("http://example.com"));
+        return pageHolder.release();
+    }
+
+    OwnPtr<DummyPageHolder> m_firstPageHolder;
+    OwnPtr<DummyPageHolder> m_secondPageHolder;
+};
+
+TEST_F(StyleSheetContentsCacheTest, SharesContentsAcrossDocuments)
+{
+    CSSStyleSheet* firstSheet = insertStyleSheet(firstDocument(), ".a .b { color: red }");
+    CSSStyleSheet* secondSheet = insertStyleSheet(secondDocument(), ".a .b { color: red }");
+    ASSERT_TRUE(firstSheet);
+    ASSERT_TRUE(secondSheet);
+    EXPECT_EQ(firstSheet->contents(), secondSheet->contents());
+    EXPECT_TRUE(firstSheet->contents()->isInMemoryCache());
+    EXPECT_EQ(1u, StyleSheetContentsCache::instance().size());
+}
+
+TEST_F(StyleSheetContentsCacheTest, CopiesSharedContentsOnMutation)
+{
+    CSSStyleSheet* firstSheet = insertStyleSheet(firstDocument(), ".a .b { color: red }");
+    CSSStyleSheet* secondSheet = insertStyleSheet(secondDocument(), ".a .b { color: red }");
+    RefPtrWillBeRawPtr<StyleSheetContents> sharedContents = firstSheet->contents();
+
+    secondSheet->insertRule(".c { color: green }", 0, ASSERT_NO_EXCEPTION);
+    EXPECT_NE(sharedContents.get(), secondSheet->contents());
+    EXPECT_EQ(sharedContents.get(), firstSheet->contents());
+    EXPECT_EQ(1u, sharedContents->ruleCount());
+
+    CSSStyleSheet* thirdSheet = insertStyleSheet(secondDocument(), ".a .b { color: red }");
+    EXPECT_EQ(sharedContents.get(), thirdSheet->contents());
+}
+
+TEST_F(StyleSheetContentsCacheTest, DoesNotShareContentsWithMediaQueriesInUse)
+{
+    const char* text = "@media (min-width: 100px) { .a { color: red } }";
+    CSSStyleSheet* firstSheet = insertStyleSheet(firstDocument(), text);
+    CSSStyleSheet* secondSheet = insertStyleSheet(secondDocument(), text);
+    EXPECT_NE(firstSheet->contents(), secondSheet->contents());
+    EXPECT_FALSE(firstSheet->contents()->isInMemoryCache());
+}
+
+TEST_F(StyleSheetContentsCacheTest, DoesNotShareContentsParsedWithAnotherBaseURL)
+{
+    secondDocument().setURL(KURL(ParsedURLString, "http://example.com/other/"));
+    CSSStyleSheet* firstSheet = insertStyleSheet(firstDocument(), ".a { background-image: url(a.png) }");
+    CSSStyleSheet* secondSheet = insertStyleSheet(secondDocument(), ".a { background-image: url(a.png) }");
+    EXPECT_NE(firstSheet->contents(), secondSheet->contents());
+}
+
+} // namespace blink
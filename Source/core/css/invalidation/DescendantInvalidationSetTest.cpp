@@ -5,6 +5,12 @@
 #include "config.h"
 #include "core/css/invalidation/DescendantInvalidationSet.h"
 
+#include "bindings/core/v8/ExceptionStatePlaceholder.h"
+#include "core/HTMLNames.h"
+#include "core/dom/Document.h"
+#include "core/dom/Element.h"
+#include "core/rendering/style/RenderStyle.h"
+#include "core/testing/DummyPageHolder.h"
 #include <gtest/gtest.h>
 
 using namespace blink;
@@ -61,4 +67,38 @@ TEST(DescendantInvalidationSetTest, SubtreeInvalid_Combine_2)
     ASSERT_TRUE(set1->isEmpty());
 }
 
+TEST(DescendantInvalidationSetTest, InvalidatesElementsWithAttribute)
+{
+    OwnPtr<DummyPageHolder> dummyPageHolder = DummyPageHolder::create(IntSize(800, 600));
+    Document& document = dummyPageHolder->document();
+    document.documentElement()->setInnerHTML("<div id=withAttribute data-state=open></div><div id=withoutAttribute></div>", ASSERT_NO_EXCEPTION);
+
+    RefPtrWillBeRawPtr<DescendantInvalidationSet> set = DescendantInvalidationSet::create();
+    set->addAttribute("data-state");
+
+    EXPECT_TRUE(set->invalidatesElement(*document.getElementById("withAttribute")));
+    EXPECT_FALSE(set->invalidatesElement(*document.getElementById("withoutAttribute")));
+}
+
+// Form control state changes go through the pseudo class invalidation sets
+// instead of recalculating the style of the whole subtree.
+TEST(DescendantInvalidationSetTest, FormControlStateChangeSchedulesInvalidation)
+{
+    OwnPtr<DummyPageHolder> dummyPageHolder = DummyPageHolder::create(IntSize(800, 600));
+    Document& document = dummyPageHolder->document();
+    document.documentElement()->setInnerHTML("<style>input:invalid { background-color: red } input:optional { background-color: green }</style>"
+        "<input id=input required><span></span>", ASSERT_NO_EXCEPTION);
+    document.updateLayout();
+
+    Element* input = document.getElementById("input");
+    EXPECT_EQ(Color(255, 0, 0), input->renderStyle()->visitedDependentColor(CSSPropertyBackgroundColor));
+
+    input->removeAttribute(HTMLNames::requiredAttr);
+    EXPECT_TRUE(input->needsStyleInvalidation());
+    EXPECT_LT(input->styleChangeType(), SubtreeStyleChange);
+
+    document.updateLayout();
+    EXPECT_EQ(Color(0, 128, 0), input->renderStyle()->visitedDependentColor(CSSPropertyBackgroundColor));
+}
+
 } // namespace
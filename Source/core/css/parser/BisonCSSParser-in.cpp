@@ -225,12 +225,12 @@ static inline bool isColorPropertyID(CSSPropertyID propertyId)
     }
 }
 
-static bool parseColorValue(MutableStylePropertySet* declaration, CSSPropertyID propertyId, const String& string, bool important, CSSParserMode cssParserMode)
+static PassRefPtrWillBeRawPtr<CSSValue> parseColorValue(CSSPropertyID propertyId, const String& string, CSSParserMode cssParserMode)
 {
     ASSERT(!string.isEmpty());
     bool quirksMode = isQuirksModeBehavior(cssParserMode);
     if (!isColorPropertyID(propertyId))
-        return false;
+        return nullptr;
     CSSParserString cssString;
     cssString.init(string);
     CSSValueID valueID = cssValueKeywordID(cssString);
@@ -244,17 +244,12 @@ static bool parseColorValue(MutableStylePropertySet* declaration, CSSPropertyID
         validPrimitive = true;
     }
 
-    if (validPrimitive) {
-        RefPtrWillBeRawPtr<CSSValue> value = cssValuePool().createIdentifierValue(valueID);
-        declaration->addParsedProperty(CSSProperty(propertyId, value.release(), important));
-        return true;
-    }
+    if (validPrimitive)
+        return cssValuePool().createIdentifierValue(valueID);
     RGBA32 color;
     if (!CSSPropertyParser::fastParseColor(color, string, !quirksMode && string[0] != '#'))
-        return false;
-    RefPtrWillBeRawPtr<CSSValue> value = cssValuePool().createColorValue(color);
-    declaration->addParsedProperty(CSSProperty(propertyId, value.release(), important));
-    return true;
+        return nullptr;
+    return cssValuePool().createColorValue(color);
 }
 
 static inline bool isSimpleLengthPropertyID(CSSPropertyID propertyId, bool& acceptsNegativeNumbers)
@@ -320,14 +315,14 @@ static inline bool parseSimpleLength(const CharacterType* characters, unsigned l
     return ok;
 }
 
-static bool parseSimpleLengthValue(MutableStylePropertySet* declaration, CSSPropertyID propertyId, const String& string, bool important, CSSParserMode cssParserMode)
+static PassRefPtrWillBeRawPtr<CSSValue> parseSimpleLengthValue(CSSPropertyID propertyId, const String& string, CSSParserMode cssParserMode)
 {
     ASSERT(!string.isEmpty());
     bool acceptsNegativeNumbers = false;
 
     // In @viewport, width and height are shorthands, not simple length values.
     if (isCSSViewportParsingEnabledForMode(cssParserMode) || !isSimpleLengthPropertyID(propertyId, acceptsNegativeNumbers))
-        return false;
+        return nullptr;
 
     unsigned length = string.length();
     double number;
@@ -335,29 +330,27 @@ static bool parseSimpleLengthValue(MutableStylePropertySet* declaration, CSSProp
 
     if (string.is8Bit()) {
         if (!parseSimpleLength(string.characters8(), length, unit, number))
-            return false;
+            return nullptr;
     } else {
         if (!parseSimpleLength(string.characters16(), length, unit, number))
-            return false;
+            return nullptr;
     }
 
     if (unit == CSSPrimitiveValue::CSS_NUMBER) {
         bool quirksMode = isQuirksModeBehavior(cssParserMode);
         if (number && !quirksMode)
-            return false;
+            return nullptr;
         unit = CSSPrimitiveValue::CSS_PX;
     }
     if (number < 0 && !acceptsNegativeNumbers)
-        return false;
+        return nullptr;
 
-    RefPtrWillBeRawPtr<CSSValue> value = cssValuePool().createValue(number, unit);
-    declaration->addParsedProperty(CSSProperty(propertyId, value.release(), important));
-    return true;
+    return cssValuePool().createValue(number, unit);
 }
 
 bool isValidKeywordPropertyAndValue(CSSPropertyID propertyId, CSSValueID valueID, const CSSParserContext& parserContext)
 {
-    if (valueID == CSSValueInvalid)
+    if (valueID == CSSValueInvalid || !isValueAllowedInMode(valueID, parserContext.mode()))
         return false;
 
     switch (propertyId) {
@@ -671,7 +664,7 @@ bool isKeywordPropertyID(CSSPropertyID propertyId)
     }
 }
 
-static bool parseKeywordValue(MutableStylePropertySet* declaration, CSSPropertyID propertyId, const String& string, bool important, const CSSParserContext& parserContext)
+static PassRefPtrWillBeRawPtr<CSSValue> parseKeywordValue(CSSPropertyID propertyId, const String& string, const CSSParserContext& parserContext)
 {
     ASSERT(!string.isEmpty());
 
@@ -679,11 +672,11 @@ static bool parseKeywordValue(MutableStylePropertySet* declaration, CSSPropertyI
         // All properties accept the values of "initial" and "inherit".
         String lowerCaseString = string.lower();
         if (lowerCaseString != "initial" && lowerCaseString != "inherit")
-            return false;
+            return nullptr;
 
         // Parse initial/inherit shorthands using the BisonCSSParser.
         if (shorthandForProperty(propertyId).length())
-            return false;
+            return nullptr;
     }
 
     CSSParserString cssString;
@@ -691,20 +684,15 @@ static bool parseKeywordValue(MutableStylePropertySet* declaration, CSSPropertyI
     CSSValueID valueID = cssValueKeywordID(cssString);
 
     if (!valueID)
-        return false;
+        return nullptr;
 
-    RefPtrWillBeRawPtr<CSSValue> value = nullptr;
     if (valueID == CSSValueInherit)
-        value = cssValuePool().createInheritedValue();
-    else if (valueID == CSSValueInitial)
-        value = cssValuePool().createExplicitInitialValue();
-    else if (isValidKeywordPropertyAndValue(propertyId, valueID, parserContext))
-        value = cssValuePool().createIdentifierValue(valueID);
-    else
-        return false;
-
-    declaration->addParsedProperty(CSSProperty(propertyId, value.release(), important));
-    return true;
+        return cssValuePool().createInheritedValue();
+    if (valueID == CSSValueInitial)
+        return cssValuePool().createExplicitInitialValue();
+    if (isValidKeywordPropertyAndValue(propertyId, valueID, parserContext))
+        return cssValuePool().createIdentifierValue(valueID);
+    return nullptr;
 }
 
 template <typename CharType>
@@ -853,27 +841,27 @@ static PassRefPtrWillBeRawPtr<CSSValueList> parseSimpleTransformList(CharType*&
     return transformList.release();
 }
 
-static bool parseSimpleTransform(MutableStylePropertySet* properties, CSSPropertyID propertyID, const String& string, bool important)
+static PassRefPtrWillBeRawPtr<CSSValue> parseSimpleTransform(CSSPropertyID propertyID, const String& string)
 {
     if (propertyID != CSSPropertyTransform && propertyID != CSSPropertyWebkitTransform)
-        return false;
+        return nullptr;
     if (string.isEmpty())
-        return false;
-    RefPtrWillBeRawPtr<CSSValueList> transformList = nullptr;
+        return nullptr;
     if (string.is8Bit()) {
         const LChar* pos = string.characters8();
         const LChar* end = pos + string.length();
-        transformList = parseSimpleTransformList(pos, end);
-        if (!transformList)
-            return false;
-    } else {
-        const UChar* pos = string.characters16();
-        const UChar* end = pos + string.length();
-        transformList = parseSimpleTransformList(pos, end);
-        if (!transformList)
-            return false;
+        return parseSimpleTransformList(pos, end);
     }
-    properties->addParsedProperty(CSSProperty(propertyID, transformList.release(), important));
+    const UChar* pos = string.characters16();
+    const UChar* end = pos + string.length();
+    return parseSimpleTransformList(pos, end);
+}
+
+static bool addParsedProperty(MutableStylePropertySet* declaration, CSSPropertyID propertyID, PassRefPtrWillBeRawPtr<CSSValue> value, bool important)
+{
+    if (!value)
+        return false;
+    declaration->addParsedProperty(CSSProperty(propertyID, value, important));
     return true;
 }
 
@@ -881,11 +869,11 @@ bool BisonCSSParser::parseValue(MutableStylePropertySet* declaration, CSSPropert
 {
     ASSERT(!string.isEmpty());
 
-    if (parseSimpleLengthValue(declaration, propertyID, string, important, context.mode()))
+    if (addParsedProperty(declaration, propertyID, parseSimpleLengthValue(propertyID, string, context.mode()), important))
         return true;
-    if (parseColorValue(declaration, propertyID, string, important, context.mode()))
+    if (addParsedProperty(declaration, propertyID, parseColorValue(propertyID, string, context.mode()), important))
         return true;
-    if (parseKeywordValue(declaration, propertyID, string, important, context))
+    if (addParsedProperty(declaration, propertyID, parseKeywordValue(propertyID, string, context), important))
         return true;
 
     BisonCSSParser parser(context);
@@ -895,9 +883,9 @@ bool BisonCSSParser::parseValue(MutableStylePropertySet* declaration, CSSPropert
 bool BisonCSSParser::parseValue(MutableStylePropertySet* declaration, CSSPropertyID propertyID, const String& string, bool important, CSSParserMode cssParserMode, StyleSheetContents* contextStyleSheet)
 {
     ASSERT(!string.isEmpty());
-    if (parseSimpleLengthValue(declaration, propertyID, string, important, cssParserMode))
+    if (addParsedProperty(declaration, propertyID, parseSimpleLengthValue(propertyID, string, cssParserMode), important))
         return true;
-    if (parseColorValue(declaration, propertyID, string, important, cssParserMode))
+    if (addParsedProperty(declaration, propertyID, parseColorValue(propertyID, string, cssParserMode), important))
         return true;
 
     CSSParserContext context(cssParserMode, 0);
@@ -906,15 +894,47 @@ bool BisonCSSParser::parseValue(MutableStylePropertySet* declaration, CSSPropert
         context.setMode(cssParserMode);
     }
 
-    if (parseKeywordValue(declaration, propertyID, string, important, context))
+    if (addParsedProperty(declaration, propertyID, parseKeywordValue(propertyID, string, context), important))
         return true;
-    if (parseSimpleTransform(declaration, propertyID, string, important))
+    if (addParsedProperty(declaration, propertyID, parseSimpleTransform(propertyID, string), important))
         return true;
 
     BisonCSSParser parser(context);
     return parser.parseValue(declaration, propertyID, string, important, contextStyleSheet);
 }
 
+PassRefPtrWillBeRawPtr<CSSValue> BisonCSSParser::parseValueOnFastPath(CSSPropertyID propertyID, const String& string, const CSSParserContext& context)
+{
+    ASSERT(!string.isEmpty());
+    RefPtrWillBeRawPtr<CSSValue> value = parseSimpleLengthValue(propertyID, string, context.mode());
+    if (!value)
+        value = parseColorValue(propertyID, string, context.mode());
+    if (!value)
+        value = parseKeywordValue(propertyID, string, context);
+    if (!value)
+        value = parseSimpleTransform(propertyID, string);
+    if (value && context.useCounter())
+        context.useCounter()->count(context, propertyID);
+    return value.release();
+}
+
+bool BisonCSSParser::parseValue(CSSPropertyID propertyID, const String& string, bool important, StyleSheetContents* contextStyleSheet, WillBeHeapVector<CSSProperty, 256>& properties)
+{
+    setStyleSheet(contextStyleSheet);
+    setupParser("@-internal-value ", string, "");
+    m_id = propertyID;
+    m_important = important;
+    cssyyparse(this);
+    m_rule = nullptr;
+    m_id = CSSPropertyInvalid;
+
+    if (m_parsedProperties.isEmpty())
+        return false;
+    properties.appendVector(m_parsedProperties);
+    clearProperties();
+    return true;
+}
+
 bool BisonCSSParser::parseValue(MutableStylePropertySet* declaration, CSSPropertyID propertyID, const String& string, bool important, StyleSheetContents* contextStyleSheet)
 {
     if (m_context.useCounter())
@@ -1096,19 +1116,23 @@ static inline void filterProperties(bool important, const WillBeHeapVector<CSSPr
 }
 
 PassRefPtrWillBeRawPtr<ImmutableStylePropertySet> BisonCSSParser::createStylePropertySet()
+{
+    CSSParserMode mode = inViewport() ? CSSViewportRuleMode : m_context.mode();
+    return createStylePropertySet(m_parsedProperties, mode);
+}
+
+PassRefPtrWillBeRawPtr<ImmutableStylePropertySet> BisonCSSParser::createStylePropertySet(const WillBeHeapVector<CSSProperty, 256>& parsedProperties, CSSParserMode mode)
 {
     BitArray<numCSSProperties> seenProperties;
-    size_t unusedEntries = m_parsedProperties.size();
+    size_t unusedEntries = parsedProperties.size();
     WillBeHeapVector<CSSProperty, 256> results(unusedEntries);
 
     // Important properties have higher priority, so add them first. Duplicate definitions can then be ignored when found.
-    filterProperties(true, m_parsedProperties, results, unusedEntries, seenProperties);
-    filterProperties(false, m_parsedProperties, results, unusedEntries, seenProperties);
+    filterProperties(true, parsedProperties, results, unusedEntries, seenProperties);
+    filterProperties(false, parsedProperties, results, unusedEntries, seenProperties);
     if (unusedEntries)
         results.remove(0, unusedEntries);
 
-    CSSParserMode mode = inViewport() ? CSSViewportRuleMode : m_context.mode();
-
     return ImmutableStylePropertySet::create(results.data(), results.size(), mode);
 }
 
@@ -1709,7 +1733,7 @@ StyleRuleKeyframes* BisonCSSParser::createKeyframesRule(const String& name, Pass
     return rulePtr;
 }
 
-static void recordSelectorStats(const CSSParserContext& context, const CSSSelectorList& selectorList)
+void BisonCSSParser::recordSelectorStats(const CSSParserContext& context, const CSSSelectorList& selectorList)
 {
     if (!context.useCounter())
         return;
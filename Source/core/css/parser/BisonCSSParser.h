@@ -97,6 +97,13 @@ public:
     bool parseValue(CSSPropertyID, bool important);
     void parseSelector(const String&, CSSSelectorList&);
 
+    // Used by CSSParserImpl, which builds rules itself and only hands the
+    // values and selectors it does not parse to this parser.
+    static PassRefPtrWillBeRawPtr<CSSValue> parseValueOnFastPath(CSSPropertyID, const String&, const CSSParserContext&);
+    bool parseValue(CSSPropertyID, const String&, bool important, StyleSheetContents* contextStyleSheet, WillBeHeapVector<CSSProperty, 256>&);
+    static PassRefPtrWillBeRawPtr<ImmutableStylePropertySet> createStylePropertySet(const WillBeHeapVector<CSSProperty, 256>&, CSSParserMode);
+    static void recordSelectorStats(const CSSParserContext&, const CSSSelectorList&);
+
     CSSParserSelector* createFloatingSelector();
     CSSParserSelector* createFloatingSelectorWithTagName(const QualifiedName&);
     PassOwnPtr<CSSParserSelector> sinkFloatingSelector(CSSParserSelector*);
@@ -0,0 +1,25 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "config.h"
+#include "core/css/parser/CSSLazyParsingState.h"
+
+#include "core/css/StylePropertySet.h"
+#include "core/css/parser/CSSParserImpl.h"
+
+namespace blink {
+
+CSSLazyParsingState::CSSLazyParsingState(const String& sheetText, const CSSParserContext& context)
+    : m_sheetText(sheetText)
+    , m_context(context, 0)
+{
+}
+
+PassRefPtrWillBeRawPtr<ImmutableStylePropertySet> CSSLazyParsingState::parseDeclarationBlock(unsigned start, unsigned end) const
+{
+    ASSERT(start <= end && end <= m_sheetText.length());
+    return CSSParserImpl::parseDeclarationBlock(m_sheetText.substring(start, end - start), m_context);
+}
+
+} // namespace blink
@@ -0,0 +1,44 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CSSLazyParsingState_h
+#define CSSLazyParsingState_h
+
+#include "core/css/parser/CSSParserMode.h"
+#include "platform/heap/Handle.h"
+#include "wtf/RefCounted.h"
+#include "wtf/text/WTFString.h"
+
+namespace blink {
+
+class ImmutableStylePropertySet;
+
+// CSSLazyParsingState is shared by the style rules of a sheet whose
+// declaration blocks CSSParserImpl skipped. It keeps the sheet text alive so
+// that a block can be parsed the first time its properties are needed.
+class CSSLazyParsingState FINAL : public RefCountedWillBeGarbageCollectedFinalized<CSSLazyParsingState> {
+public:
+    static PassRefPtrWillBeRawPtr<CSSLazyParsingState> create(const String& sheetText, const CSSParserContext& context)
+    {
+        return adoptRefWillBeNoop(new CSSLazyParsingState(sheetText, context));
+    }
+
+    // |start| and |end| delimit the text after the opening brace of the
+    // block, up to and possibly including its closing brace.
+    PassRefPtrWillBeRawPtr<ImmutableStylePropertySet> parseDeclarationBlock(unsigned start, unsigned end) const;
+
+    void trace(Visitor*) { }
+
+private:
+    CSSLazyParsingState(const String& sheetText, const CSSParserContext&);
+
+    String m_sheetText;
+    // Without a UseCounter, since the document that parsed the sheet may be
+    // gone by the time a block is parsed.
+    CSSParserContext m_context;
+};
+
+} // namespace blink
+
+#endif // CSSLazyParsingState_h
@@ -8,6 +8,8 @@
 #include "core/css/CSSKeyframeRule.h"
 #include "core/css/StyleColor.h"
 #include "core/css/StyleRule.h"
+#include "core/css/parser/CSSParserImpl.h"
+#include "platform/RuntimeEnabledFeatures.h"
 
 namespace blink {
 
@@ -33,6 +35,9 @@ PassRefPtrWillBeRawPtr<StyleRuleBase> CSSParser::parseRule(const CSSParserContex
 
 void CSSParser::parseSheet(const CSSParserContext& context, StyleSheetContents* styleSheet, const String& text, const TextPosition& startPosition, CSSParserObserver* observer, bool logErrors)
 {
+    // The inspector needs the source ranges BisonCSSParser reports.
+    if (RuntimeEnabledFeatures::newCSSParserEnabled() && !observer && CSSParserImpl::parseStyleSheet(text, context, styleSheet))
+        return;
     BisonCSSParser(context).parseSheet(styleSheet, text, startPosition, observer, logErrors);
 }
 
@@ -0,0 +1,376 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "config.h"
+#include "core/css/parser/CSSParserImpl.h"
+
+#include "core/css/CSSSelectorList.h"
+#include "core/css/MediaList.h"
+#include "core/css/StylePropertySet.h"
+#include "core/css/StyleRule.h"
+#include "core/css/StyleSheetContents.h"
+#include "core/css/parser/CSSLazyParsingState.h"
+#include "core/css/parser/CSSPropertyParser.h"
+#include "core/css/parser/MediaQueryParser.h"
+#include "platform/RuntimeEnabledFeatures.h"
+#include "platform/TraceEvent.h"
+
+namespace blink {
+
+CSSParserImpl::CSSParserImpl(const String& source, const CSSParserContext& context, StyleSheetContents* styleSheet)
+    : m_source(source)
+    , m_context(context)
+    , m_styleSheet(styleSheet)
+    , m_bisonParser(context)
+    , m_input(source)
+    , m_tokenizer(m_input)
+    , m_token(EOFToken)
+    , m_tokenStart(0)
+    , m_allowImportRules(true)
+    , m_hadSyntacticallyValidRule(false)
+{
+    // UA sheets are small and most of their rules match something.
+    if (styleSheet && RuntimeEnabledFeatures::lazyCSSParsingEnabled() && !isUASheetBehavior(context.mode()))
+        m_lazyParsingState = CSSLazyParsingState::create(source, context);
+}
+
+bool CSSParserImpl::parseStyleSheet(const String& source, const CSSParserContext& context, StyleSheetContents* styleSheet)
+{
+    TRACE_EVENT0("blink", "CSSParserImpl::parseStyleSheet");
+    return CSSParserImpl(source, context, styleSheet).parseStyleSheet();
+}
+
+PassRefPtrWillBeRawPtr<ImmutableStylePropertySet> CSSParserImpl::parseDeclarationBlock(const String& source, const CSSParserContext& context)
+{
+    TRACE_EVENT0("blink", "CSSParserImpl::parseDeclarationBlock");
+    CSSParserImpl parser(source, context, 0);
+    parser.consume();
+    parser.consumeDeclarationList();
+    return BisonCSSParser::createStylePropertySet(parser.m_parsedProperties, context.mode());
+}
+
+bool CSSParserImpl::parseStyleSheet()
+{
+    bool hadSyntacticallyValidCSSHeader = m_styleSheet->hasSyntacticallyValidCSSHeader();
+    consume();
+    RuleList rules;
+    if (!consumeRuleList(TopLevelRuleList, rules)) {
+        // Invalid rules before the bail out may have cleared the flag, which
+        // BisonCSSParser only ever clears.
+        m_styleSheet->setHasSyntacticallyValidCSSHeader(hadSyntacticallyValidCSSHeader);
+        return false;
+    }
+    ASSERT(rules.isEmpty());
+    for (size_t i = 0; i < m_pendingImportRules.size(); ++i)
+        m_styleSheet->parserAppendRule(m_pendingImportRules[i].release());
+    m_styleSheet->shrinkToFit();
+    return true;
+}
+
+void CSSParserImpl::consume()
+{
+    // The tokenizer moves past the end of the input when it consumes the EOF
+    // marker, so tokens are only ever consumed up to the EOF token.
+    m_tokenStart = std::min<size_t>(m_input.offset(), m_source.length());
+    m_token = m_tokenizer.nextToken();
+}
+
+void CSSParserImpl::consumeWhitespace()
+{
+    while (m_token.type() == WhitespaceToken || m_token.type() == CommentToken)
+        consume();
+}
+
+static bool isBlockStart(MediaQueryTokenType type, MediaQueryTokenType& closingType)
+{
+    switch (type) {
+    case LeftParenthesisToken:
+    case FunctionToken:
+        closingType = RightParenthesisToken;
+        return true;
+    case LeftBracketToken:
+        closingType = RightBracketToken;
+        return true;
+    case LeftBraceToken:
+        closingType = RightBraceToken;
+        return true;
+    default:
+        return false;
+    }
+}
+
+// http://dev.w3.org/csswg/css-syntax/#consume-a-component-value
+void CSSParserImpl::consumeComponentValue()
+{
+    ASSERT(m_token.type() != EOFToken);
+    // Blocks can nest arbitrarily deep, so this does not recurse.
+    Vector<MediaQueryTokenType, 8> closingTypes;
+    do {
+        MediaQueryTokenType closingType;
+        if (isBlockStart(m_token.type(), closingType))
+            closingTypes.append(closingType);
+        else if (!closingTypes.isEmpty() && m_token.type() == closingTypes.last())
+            closingTypes.removeLast();
+        consume();
+    } while (!closingTypes.isEmpty() && m_token.type() != EOFToken);
+}
+
+bool CSSParserImpl::atRuleListEnd(RuleListType type) const
+{
+    return m_token.type() == EOFToken || (type == NestedRuleList && m_token.type() == RightBraceToken);
+}
+
+String CSSParserImpl::sourceText(unsigned start, unsigned end) const
+{
+    ASSERT(start <= end && end <= m_source.length());
+    return m_source.substring(start, end - start);
+}
+
+void CSSParserImpl::appendRule(RuleListType type, RuleList& rules, PassRefPtrWillBeRawPtr<StyleRuleBase> rule)
+{
+    if (type == NestedRuleList) {
+        rules.append(rule);
+        return;
+    }
+
+    // Rules other than @charset and @import end the sheet's prologue.
+    m_allowImportRules = false;
+    m_hadSyntacticallyValidRule = true;
+    for (size_t i = 0; i < m_pendingImportRules.size(); ++i)
+        m_styleSheet->parserAppendRule(m_pendingImportRules[i].release());
+    m_pendingImportRules.clear();
+    m_styleSheet->parserAppendRule(rule);
+}
+
+// http://dev.w3.org/csswg/css-syntax/#consume-a-list-of-rules
+bool CSSParserImpl::consumeRuleList(RuleListType type, RuleList& rules)
+{
+    while (true) {
+        consumeWhitespace();
+        if (atRuleListEnd(type))
+            return true;
+
+        if (type == TopLevelRuleList && (m_token.type() == CDOToken || m_token.type() == CDCToken)) {
+            consume();
+            continue;
+        }
+
+        if (m_token.type() == AtKeywordToken) {
+            if (!consumeAtRule(type, rules))
+                return false;
+            continue;
+        }
+
+        if (RefPtrWillBeRawPtr<StyleRuleBase> rule = consumeStyleRule(type))
+            appendRule(type, rules, rule.release());
+        else
+            invalidBlockHit();
+    }
+}
+
+void CSSParserImpl::invalidBlockHit()
+{
+    // Cross-origin sheets served with the wrong MIME type are rejected
+    // unless they start with a valid rule, as in BisonCSSParser.
+    if (!m_hadSyntacticallyValidRule)
+        m_styleSheet->setHasSyntacticallyValidCSSHeader(false);
+}
+
+static bool isCharsetRulePrelude(const String& prelude, String& encoding)
+{
+    Vector<MediaQueryToken> tokens;
+    MediaQueryTokenizer::tokenize(prelude, tokens);
+    bool sawEncoding = false;
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        MediaQueryTokenType type = tokens[i].type();
+        if (type == WhitespaceToken || type == CommentToken || type == EOFToken)
+            continue;
+        if (type != StringToken || sawEncoding)
+            return false;
+        encoding = tokens[i].value();
+        sawEncoding = true;
+    }
+    return sawEncoding;
+}
+
+// http://dev.w3.org/csswg/css-syntax/#consume-an-at-rule
+bool CSSParserImpl::consumeAtRule(RuleListType type, RuleList& rules)
+{
+    ASSERT(m_token.type() == AtKeywordToken);
+    unsigned ruleStart = m_tokenStart;
+    String name = m_token.value();
+    consume();
+
+    unsigned preludeStart = m_tokenStart;
+    while (m_token.type() != SemicolonToken && m_token.type() != LeftBraceToken && !atRuleListEnd(type))
+        consumeComponentValue();
+    unsigned preludeEnd = m_tokenStart;
+    bool hasBlock = m_token.type() == LeftBraceToken;
+
+    if (equalIgnoringCase(name, "media") && hasBlock) {
+        RefPtrWillBeRawPtr<MediaQuerySet> mediaQueries = MediaQueryParser::parseMediaQuerySet(sourceText(preludeStart, preludeEnd));
+        consume();
+        RuleList childRules;
+        if (!consumeRuleList(NestedRuleList, childRules))
+            return false;
+        if (m_token.type() == RightBraceToken)
+            consume();
+        appendRule(type, rules, StyleRuleMedia::create(mediaQueries.release(), childRules));
+        return true;
+    }
+
+    if (hasBlock)
+        consumeComponentValue();
+    else if (m_token.type() == SemicolonToken)
+        consume();
+    unsigned ruleEnd = m_tokenStart;
+
+    if (equalIgnoringCase(name, "charset")) {
+        // Only valid as the very first thing in the sheet.
+        String encoding;
+        if (type == TopLevelRuleList && !ruleStart && !hasBlock && isCharsetRulePrelude(sourceText(preludeStart, preludeEnd), encoding))
+            m_styleSheet->parserSetEncodingFromCharsetRule(encoding);
+        return true;
+    }
+
+    if (equalIgnoringCase(name, "namespace")) {
+        // Namespace prefixes change how BisonCSSParser parses selectors, so
+        // a sheet declaring them is parsed by it from scratch. Nothing has
+        // been added to the sheet while @namespace is allowed. Anywhere else,
+        // including in @media, @namespace is invalid and ignored.
+        return type != TopLevelRuleList || !m_allowImportRules;
+    }
+
+    if (equalIgnoringCase(name, "import")) {
+        if (type != TopLevelRuleList || !m_allowImportRules)
+            return true;
+        RefPtrWillBeRawPtr<StyleRuleBase> rule = m_bisonParser.parseRule(m_styleSheet, sourceText(ruleStart, ruleEnd));
+        if (rule && rule->isImportRule()) {
+            m_hadSyntacticallyValidRule = true;
+            m_pendingImportRules.append(rule.release());
+        }
+        return true;
+    }
+
+    if (RefPtrWillBeRawPtr<StyleRuleBase> rule = m_bisonParser.parseRule(m_styleSheet, sourceText(ruleStart, ruleEnd)))
+        appendRule(type, rules, rule.release());
+    else if (hasBlock)
+        invalidBlockHit();
+    return true;
+}
+
+// http://dev.w3.org/csswg/css-syntax/#consume-a-qualified-rule
+PassRefPtrWillBeRawPtr<StyleRuleBase> CSSParserImpl::consumeStyleRule(RuleListType type)
+{
+    unsigned preludeStart = m_tokenStart;
+    while (m_token.type() != LeftBraceToken && !atRuleListEnd(type))
+        consumeComponentValue();
+    if (m_token.type() != LeftBraceToken)
+        return nullptr;
+
+    CSSSelectorList selectorList;
+    m_bisonParser.parseSelector(sourceText(preludeStart, m_tokenStart), selectorList);
+    if (!selectorList.isValid()) {
+        consumeComponentValue();
+        return nullptr;
+    }
+
+    RefPtrWillBeRawPtr<StyleRule> rule = StyleRule::create();
+    rule->wrapperAdoptSelectorList(selectorList);
+    consume();
+    if (m_lazyParsingState) {
+        unsigned blockStart = m_tokenStart;
+        while (m_token.type() != RightBraceToken && m_token.type() != EOFToken)
+            consumeComponentValue();
+        rule->setLazyProperties(m_lazyParsingState, blockStart, m_tokenStart);
+    } else {
+        consumeDeclarationList();
+        rule->setProperties(BisonCSSParser::createStylePropertySet(m_parsedProperties, m_context.mode()));
+        m_parsedProperties.clear();
+    }
+    if (m_token.type() == RightBraceToken)
+        consume();
+
+    BisonCSSParser::recordSelectorStats(m_context, rule->selectorList());
+    return rule.release();
+}
+
+// http://dev.w3.org/csswg/css-syntax/#consume-a-list-of-declarations
+void CSSParserImpl::consumeDeclarationList()
+{
+    while (m_token.type() != RightBraceToken && m_token.type() != EOFToken) {
+        switch (m_token.type()) {
+        case WhitespaceToken:
+        case CommentToken:
+        case SemicolonToken:
+            consume();
+            break;
+        case IdentToken:
+            consumeDeclaration();
+            break;
+        default:
+            // Style rules accept no at-rules, so anything else is skipped
+            // like an invalid declaration.
+            while (m_token.type() != SemicolonToken && m_token.type() != RightBraceToken && m_token.type() != EOFToken)
+                consumeComponentValue();
+            break;
+        }
+    }
+}
+
+// http://dev.w3.org/csswg/css-syntax/#consume-a-declaration
+void CSSParserImpl::consumeDeclaration()
+{
+    ASSERT(m_token.type() == IdentToken);
+    CSSPropertyID propertyID = cssPropertyID(m_token.value());
+    consume();
+    consumeWhitespace();
+    bool isValid = propertyID != CSSPropertyInvalid && m_token.type() == ColonToken;
+    if (m_token.type() == ColonToken)
+        consume();
+    consumeWhitespace();
+
+    // Track the last three tokens of the value that are not whitespace, to
+    // find a trailing "!important" and the end of the value before it.
+    unsigned valueStart = m_tokenStart;
+    unsigned lastEnd = valueStart;
+    unsigned previousEnd = valueStart;
+    unsigned endBeforePrevious = valueStart;
+    bool lastIsImportant = false;
+    bool lastIsBang = false;
+    bool previousIsBang = false;
+    while (m_token.type() != SemicolonToken && m_token.type() != RightBraceToken && m_token.type() != EOFToken) {
+        if (m_token.type() == WhitespaceToken || m_token.type() == CommentToken) {
+            consume();
+            continue;
+        }
+        bool isImportant = m_token.type() == IdentToken && equalIgnoringCase(m_token.value(), "important");
+        bool isBang = m_token.type() == DelimiterToken && m_token.delimiter() == '!';
+        consumeComponentValue();
+
+        endBeforePrevious = previousEnd;
+        previousEnd = lastEnd;
+        lastEnd = m_tokenStart;
+        previousIsBang = lastIsBang;
+        lastIsBang = isBang;
+        lastIsImportant = isImportant;
+    }
+
+    // Like CSSPropertyParser, only UA sheets may set -internal- properties.
+    // The fast paths below do not check this themselves.
+    if (!isValid || (!isInternalPropertyAndValueParsingEnabledForMode(m_context.mode()) && isInternalProperty(propertyID)))
+        return;
+    bool important = lastIsImportant && previousIsBang;
+    unsigned valueEnd = important ? endBeforePrevious : lastEnd;
+    if (valueEnd == valueStart)
+        return;
+
+    String value = sourceText(valueStart, valueEnd);
+    if (RefPtrWillBeRawPtr<CSSValue> parsedValue = BisonCSSParser::parseValueOnFastPath(propertyID, value, m_context))
+        m_parsedProperties.append(CSSProperty(propertyID, parsedValue.release(), important));
+    else
+        m_bisonParser.parseValue(propertyID, value, important, m_styleSheet, m_parsedProperties);
+}
+
+} // namespace blink
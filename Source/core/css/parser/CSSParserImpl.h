@@ -0,0 +1,95 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CSSParserImpl_h
+#define CSSParserImpl_h
+
+#include "core/css/CSSProperty.h"
+#include "core/css/parser/BisonCSSParser.h"
+#include "core/css/parser/MediaQueryInputStream.h"
+#include "core/css/parser/MediaQueryToken.h"
+#include "core/css/parser/MediaQueryTokenizer.h"
+#include "platform/heap/Handle.h"
+#include "wtf/Vector.h"
+#include "wtf/text/WTFString.h"
+
+namespace blink {
+
+class CSSLazyParsingState;
+class StyleRuleBase;
+class StyleSheetContents;
+
+// CSSParserImpl parses style sheets with a recursive descent parser that
+// pulls tokens from MediaQueryTokenizer as it goes, without building a token
+// list or CSSParserValues for the whole sheet. Style rules and @media rules
+// are built directly, and declaration values the fast paths of
+// BisonCSSParser handle become CSSProperties without going through the
+// grammar. Selectors, the remaining values and the other at-rules are handed
+// to a single BisonCSSParser as substrings of the sheet.
+class CSSParserImpl {
+    STACK_ALLOCATED();
+    WTF_MAKE_NONCOPYABLE(CSSParserImpl);
+public:
+    // Returns false without modifying the sheet if it needs features only
+    // BisonCSSParser implements, like namespace prefixes. Parse errors are
+    // not reported to the console.
+    static bool parseStyleSheet(const String&, const CSSParserContext&, StyleSheetContents*);
+    // Parses the contents of a declaration block, which may be followed by
+    // its closing brace.
+    static PassRefPtrWillBeRawPtr<ImmutableStylePropertySet> parseDeclarationBlock(const String&, const CSSParserContext&);
+
+private:
+    typedef WillBeHeapVector<RefPtrWillBeMember<StyleRuleBase> > RuleList;
+
+    enum RuleListType {
+        TopLevelRuleList,
+        NestedRuleList,
+    };
+
+    CSSParserImpl(const String&, const CSSParserContext&, StyleSheetContents*);
+
+    bool parseStyleSheet();
+
+    void consume();
+    void consumeWhitespace();
+    void consumeComponentValue();
+    bool atRuleListEnd(RuleListType) const;
+
+    // Return false if the sheet has to be parsed by BisonCSSParser.
+    bool consumeRuleList(RuleListType, RuleList&);
+    bool consumeAtRule(RuleListType, RuleList&);
+    PassRefPtrWillBeRawPtr<StyleRuleBase> consumeStyleRule(RuleListType);
+    void consumeDeclarationList();
+    void consumeDeclaration();
+
+    void invalidBlockHit();
+    void appendRule(RuleListType, RuleList&, PassRefPtrWillBeRawPtr<StyleRuleBase>);
+    String sourceText(unsigned start, unsigned end) const;
+
+    const String& m_source;
+    CSSParserContext m_context;
+    RawPtrWillBeMember<StyleSheetContents> m_styleSheet;
+    BisonCSSParser m_bisonParser;
+
+    MediaQueryInputStream m_input;
+    MediaQueryTokenizer m_tokenizer;
+    MediaQueryToken m_token;
+    unsigned m_tokenStart;
+
+    // Set when the declaration blocks of style rules are left to be parsed
+    // when their properties are first needed.
+    RefPtrWillBeMember<CSSLazyParsingState> m_lazyParsingState;
+
+    bool m_allowImportRules;
+    bool m_hadSyntacticallyValidRule;
+    // @import rules are only appended to the sheet, which starts loading
+    // them, once it is known that no @namespace rule makes us bail out.
+    RuleList m_pendingImportRules;
+
+    WillBeHeapVector<CSSProperty, 256> m_parsedProperties;
+};
+
+} // namespace blink
+
+#endif // CSSParserImpl_h
@@ -0,0 +1,182 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "config.h"
+#include "core/css/parser/CSSParserImpl.h"
+
+#include "core/css/MediaList.h"
+#include "core/css/StylePropertySet.h"
+#include "core/css/StyleRule.h"
+#include "core/css/StyleRuleImport.h"
+#include "core/css/StyleSheetContents.h"
+#include "core/css/parser/BisonCSSParser.h"
+#include "core/css/parser/CSSParser.h"
+#include "platform/RuntimeEnabledFeatures.h"
+#include "wtf/text/StringBuilder.h"
+
+#include <gtest/gtest.h>
+
+namespace blink {
+
+static void appendRules(StringBuilder& output, const WillBeHeapVector<RefPtrWillBeMember<StyleRuleBase> >& rules)
+{
+    for (size_t i = 0; i < rules.size(); ++i) {
+        StyleRuleBase* rule = rules[i].get();
+        if (rule->isStyleRule()) {
+            StyleRule* styleRule = toStyleRule(rule);
+            output.append(styleRule->selectorList().selectorsText());
+            output.appendLiteral(" { ");
+            output.append(styleRule->properties().asText());
+            output.appendLiteral(" } ");
+        } else if (rule->isMediaRule()) {
+            StyleRuleMedia* mediaRule = toStyleRuleMedia(rule);
+            output.appendLiteral("@media ");
+            output.append(mediaRule->mediaQueries()->mediaText());
+            output.appendLiteral(" { ");
+            appendRules(output, mediaRule->childRules());
+            output.appendLiteral("} ");
+        } else if (rule->isFontFaceRule()) {
+            output.appendLiteral("@font-face { ");
+            output.append(toStyleRuleFontFace(rule)->properties().asText());
+            output.appendLiteral(" } ");
+        } else {
+            output.appendLiteral("@other ");
+        }
+    }
+}
+
+static String serialize(const StyleSheetContents& sheet)
+{
+    StringBuilder output;
+    for (size_t i = 0; i < sheet.importRules().size(); ++i) {
+        output.appendLiteral("@import ");
+        output.append(sheet.importRules()[i]->href());
+        output.appendLiteral("; ");
+    }
+    appendRules(output, sheet.childRules());
+    return output.toString();
+}
+
+TEST(CSSParserImplTest, MatchesBisonCSSParser)
+{
+    const char* testCases[] = {
+        ".a, #b > c { color: red; width: 10px !important; margin: 1px 2px }",
+        "a { color: red; ; junk; width: ; } b { height: 5px }",
+        "a { color: red !important; color: blue; background-color: blue; background-color: green }",
+        "a { transform: translateX(10px); color: #00ff00; display: BLOCK; font: 12px/1.5 serif }",
+        "a { background: url(a.png) no-repeat; content: '}' } b { -webkit-unknown: 1px; color: red }",
+        "a:: { color: red } .b { color: green }",
+        "@media screen and (min-width: 100px) { .a { color: blue } .b { } } .c { color: red }",
+        "@media print { @media (color) { a { color: red } } }",
+        "@font-face { font-family: x; src: url(a.woff) } .c { color: red }",
+        "@import url(a.css); @import 'b.css' screen; .a { color: red }",
+        ".a { color: red } @import url(a.css); .b { color: blue }",
+        "@charset \"utf-8\"; .a { color: red } @charset \"utf-8\";",
+        "<!-- .a { color: red } --> .b { color: blue }",
+        "@keyframes k { from { opacity: 0 } to { opacity: 1 } } @page { margin: 1in }",
+        "@unknown foo { a { color: red } } .a { color: red }",
+        ".a { color: red",
+        0 // Do not remove the terminator line.
+    };
+
+    CSSParserContext context(HTMLStandardMode, 0);
+    for (int i = 0; testCases[i]; ++i) {
+        RefPtrWillBeRawPtr<StyleSheetContents> bisonSheet = StyleSheetContents::create(context);
+        BisonCSSParser(context).parseSheet(bisonSheet.get(), testCases[i], TextPosition::minimumPosition(), 0, false);
+
+        RefPtrWillBeRawPtr<StyleSheetContents> sheet = StyleSheetContents::create(context);
+        ASSERT_TRUE(CSSParserImpl::parseStyleSheet(testCases[i], context, sheet.get())) << testCases[i];
+        EXPECT_EQ(serialize(*bisonSheet), serialize(*sheet)) << testCases[i];
+        EXPECT_EQ(bisonSheet->hasSyntacticallyValidCSSHeader(), sheet->hasSyntacticallyValidCSSHeader()) << testCases[i];
+    }
+}
+
+TEST(CSSParserImplTest, BailsOutOnNamespaceRules)
+{
+    CSSParserContext context(HTMLStandardMode, 0);
+    RefPtrWillBeRawPtr<StyleSheetContents> sheet = StyleSheetContents::create(context);
+    EXPECT_FALSE(CSSParserImpl::parseStyleSheet("@import url(a.css); @namespace svg url(http://www.w3.org/2000/svg); svg|a { color: red }", context, sheet.get()));
+    EXPECT_EQ(0u, sheet->ruleCount());
+
+    // @namespace after other rules is invalid and ignored.
+    EXPECT_TRUE(CSSParserImpl::parseStyleSheet(".a { color: red } @namespace svg url(http://www.w3.org/2000/svg);", context, sheet.get()));
+    EXPECT_EQ(1u, sheet->ruleCount());
+}
+
+TEST(CSSParserImplTest, NamespaceRulesDoNotDuplicateRules)
+{
+    bool wasNewCSSParserEnabled = RuntimeEnabledFeatures::newCSSParserEnabled();
+    RuntimeEnabledFeatures::setNewCSSParserEnabled(true);
+
+    // @namespace in @media is ignored rather than handed to BisonCSSParser,
+    // which would append the rules before it a second time.
+    CSSParserContext context(HTMLStandardMode, 0);
+    RefPtrWillBeRawPtr<StyleSheetContents> sheet = StyleSheetContents::create(context);
+    CSSParser::parseSheet(context, sheet.get(), "a{color:red} @media screen { @namespace x url(y); }", TextPosition::minimumPosition(), 0, false);
+    EXPECT_EQ("a { color: red; } @media screen { } ", serialize(*sheet));
+
+    // An invalid rule before a bail out does not leave the header flag cleared
+    // by this parser behind.
+    const char* text = "a:: { color: red } @namespace svg url(http://www.w3.org/2000/svg); svg|a { color: red }";
+    RefPtrWillBeRawPtr<StyleSheetContents> bisonSheet = StyleSheetContents::create(context);
+    BisonCSSParser(context).parseSheet(bisonSheet.get(), text, TextPosition::minimumPosition(), 0, false);
+    sheet = StyleSheetContents::create(context);
+    CSSParser::parseSheet(context, sheet.get(), text, TextPosition::minimumPosition(), 0, false);
+    EXPECT_EQ(serialize(*bisonSheet), serialize(*sheet));
+    EXPECT_EQ(bisonSheet->hasSyntacticallyValidCSSHeader(), sheet->hasSyntacticallyValidCSSHeader());
+
+    RuntimeEnabledFeatures::setNewCSSParserEnabled(wasNewCSSParserEnabled);
+}
+
+TEST(CSSParserImplTest, InternalPropertiesAndValuesOnlyInUASheets)
+{
+    const char* text = "a { -internal-marquee-direction: up; -webkit-appearance: -internal-media-cast-off-button; color: red }";
+
+    CSSParserContext authorContext(HTMLStandardMode, 0);
+    RefPtrWillBeRawPtr<StyleSheetContents> sheet = StyleSheetContents::create(authorContext);
+    ASSERT_TRUE(CSSParserImpl::parseStyleSheet(text, authorContext, sheet.get()));
+    EXPECT_EQ("a { color: red; } ", serialize(*sheet));
+
+    CSSParserContext uaContext(UASheetMode, 0);
+    RefPtrWillBeRawPtr<StyleSheetContents> bisonSheet = StyleSheetContents::create(uaContext);
+    BisonCSSParser(uaContext).parseSheet(bisonSheet.get(), text, TextPosition::minimumPosition(), 0, false);
+    sheet = StyleSheetContents::create(uaContext);
+    ASSERT_TRUE(CSSParserImpl::parseStyleSheet(text, uaContext, sheet.get()));
+    EXPECT_EQ(serialize(*bisonSheet), serialize(*sheet));
+    EXPECT_EQ(3u, toStyleRule(sheet->childRules()[0].get())->properties().propertyCount());
+}
+
+TEST(CSSParserImplTest, LazyDeclarationBlocks)
+{
+    bool wasNewCSSParserEnabled = RuntimeEnabledFeatures::newCSSParserEnabled();
+    bool wasLazyCSSParsingEnabled = RuntimeEnabledFeatures::lazyCSSParsingEnabled();
+    RuntimeEnabledFeatures::setNewCSSParserEnabled(true);
+    RuntimeEnabledFeatures::setLazyCSSParsingEnabled(true);
+
+    const char* text = ".a { color: red; width: 10px !important } @media print { .b { margin: 1px 2px; content: '}' } } .c { color: blue";
+    CSSParserContext context(HTMLStandardMode, 0);
+    RefPtrWillBeRawPtr<StyleSheetContents> eagerSheet = StyleSheetContents::create(context);
+    BisonCSSParser(context).parseSheet(eagerSheet.get(), text, TextPosition::minimumPosition(), 0, false);
+    RefPtrWillBeRawPtr<StyleSheetContents> sheet = StyleSheetContents::create(context);
+    ASSERT_TRUE(CSSParserImpl::parseStyleSheet(text, context, sheet.get()));
+
+    ASSERT_EQ(3u, sheet->childRules().size());
+    StyleRule* firstRule = toStyleRule(sheet->childRules()[0].get());
+    StyleRule* nestedRule = toStyleRule(toStyleRuleMedia(sheet->childRules()[1].get())->childRules()[0].get());
+    EXPECT_FALSE(firstRule->hasParsedProperties());
+    EXPECT_FALSE(nestedRule->hasParsedProperties());
+    EXPECT_EQ(strlen(" color: red; width: 10px !important "), firstRule->unparsedDeclarationBlockLength());
+
+    EXPECT_EQ(".a", firstRule->selectorList().selectorsText());
+    EXPECT_FALSE(firstRule->hasParsedProperties());
+    EXPECT_EQ(serialize(*eagerSheet), serialize(*sheet));
+    EXPECT_TRUE(firstRule->hasParsedProperties());
+    EXPECT_TRUE(nestedRule->hasParsedProperties());
+    EXPECT_EQ(0u, firstRule->unparsedDeclarationBlockLength());
+
+    RuntimeEnabledFeatures::setNewCSSParserEnabled(wasNewCSSParserEnabled);
+    RuntimeEnabledFeatures::setLazyCSSParsingEnabled(wasLazyCSSParsingEnabled);
+}
+
+} // namespace blink
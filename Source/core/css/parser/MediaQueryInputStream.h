@@ -35,6 +35,13 @@ public:
 
     }
 
+    // The offset in the input of the next character, which is past the end
+    // of the input once the EOF marker has been consumed.
+    inline size_t offset() const
+    {
+        return m_offset;
+    }
+
     unsigned long long getUInt(unsigned start, unsigned end);
     double getDouble(unsigned start, unsigned end);
 
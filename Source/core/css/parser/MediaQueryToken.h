@@ -29,6 +29,12 @@ enum MediaQueryTokenType {
     RightBraceToken,
     StringToken,
     BadStringToken,
+    HashToken,
+    UrlToken,
+    BadUrlToken,
+    AtKeywordToken,
+    CDOToken,
+    CDCToken,
     EOFToken,
     CommentToken,
 };
@@ -150,6 +150,10 @@ MediaQueryToken MediaQueryTokenizer::hyphenMinus(UChar cc)
         reconsume(cc);
         return consumeNumericToken();
     }
+    if (m_input.nextInputChar() == '-' && m_input.peek(1) == '>') {
+        consume(2);
+        return MediaQueryToken(CDCToken);
+    }
     if (nextCharsAreIdentifier(cc)) {
         reconsume(cc);
         return consumeIdentLikeToken();
@@ -177,6 +181,31 @@ MediaQueryToken MediaQueryTokenizer::semiColon(UChar cc)
     return MediaQueryToken(SemicolonToken);
 }
 
+MediaQueryToken MediaQueryTokenizer::hash(UChar cc)
+{
+    UChar nextChar = m_input.nextInputChar();
+    if (isNameChar(nextChar) || twoCharsAreValidEscape(nextChar, m_input.peek(1)))
+        return MediaQueryToken(HashToken, consumeName());
+
+    return MediaQueryToken(DelimiterToken, cc);
+}
+
+MediaQueryToken MediaQueryTokenizer::commercialAt(UChar cc)
+{
+    if (nextCharsAreIdentifier())
+        return MediaQueryToken(AtKeywordToken, consumeName());
+    return MediaQueryToken(DelimiterToken, cc);
+}
+
+MediaQueryToken MediaQueryTokenizer::lessThan(UChar cc)
+{
+    if (m_input.nextInputChar() == '!' && m_input.peek(1) == '-' && m_input.peek(2) == '-') {
+        consume(3);
+        return MediaQueryToken(CDOToken);
+    }
+    return MediaQueryToken(DelimiterToken, cc);
+}
+
 MediaQueryToken MediaQueryTokenizer::reverseSolidus(UChar cc)
 {
     if (twoCharsAreValidEscape(cc, m_input.nextInputChar())) {
@@ -351,6 +380,13 @@ MediaQueryToken MediaQueryTokenizer::consumeIdentLikeToken()
 {
     String name = consumeName();
     if (consumeIfNext('(')) {
+        if (equalIgnoringCase(name, "url")) {
+            // A quoted url() is a function whose argument is a string token.
+            consumeUntilNonWhitespace();
+            UChar next = m_input.nextInputChar();
+            if (next != '"' && next != '\'')
+                return consumeUrlToken();
+        }
         return blockStart(LeftParenthesisToken, FunctionToken, name);
     }
     return MediaQueryToken(IdentToken, name);
@@ -391,6 +427,65 @@ MediaQueryToken MediaQueryTokenizer::consumeStringTokenUntil(UChar endingCodePoi
     }
 }
 
+static bool isNonPrintableCodePoint(UChar cc)
+{
+    return cc <= '\x8' || cc == '\xb' || (cc >= '\xe' && cc <= '\x1f') || cc == '\x7f';
+}
+
+// http://dev.w3.org/csswg/css-syntax/#consume-url-token
+MediaQueryToken MediaQueryTokenizer::consumeUrlToken()
+{
+    StringBuilder result;
+    while (true) {
+        UChar cc = consume();
+        if (cc == ')' || cc == kEndOfFileMarker) {
+            // The "reconsume" here deviates from the spec, but is required to avoid consuming past the EOF
+            if (cc == kEndOfFileMarker)
+                reconsume(cc);
+            return MediaQueryToken(UrlToken, result.toString());
+        }
+
+        if (isHTMLSpace<UChar>(cc)) {
+            consumeUntilNonWhitespace();
+            if (consumeIfNext(')') || m_input.nextInputChar() == kEndOfFileMarker)
+                return MediaQueryToken(UrlToken, result.toString());
+            break;
+        }
+
+        if (cc == '"' || cc == '\'' || cc == '(' || isNonPrintableCodePoint(cc))
+            break;
+
+        if (cc == '\\') {
+            if (twoCharsAreValidEscape(cc, m_input.nextInputChar())) {
+                result.append(consumeEscape());
+                continue;
+            }
+            break;
+        }
+
+        result.append(cc);
+    }
+
+    consumeBadUrlRemnants();
+    return MediaQueryToken(BadUrlToken);
+}
+
+// http://dev.w3.org/csswg/css-syntax/#consume-the-remnants-of-a-bad-url
+void MediaQueryTokenizer::consumeBadUrlRemnants()
+{
+    while (true) {
+        UChar cc = consume();
+        if (cc == ')')
+            return;
+        if (cc == kEndOfFileMarker) {
+            reconsume(cc);
+            return;
+        }
+        if (twoCharsAreValidEscape(cc, m_input.nextInputChar()))
+            consumeEscape();
+    }
+}
+
 void MediaQueryTokenizer::consumeUntilNonWhitespace()
 {
     // Using HTML space here rather than CSS space since we don't do preprocessing
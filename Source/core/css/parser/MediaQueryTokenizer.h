@@ -20,11 +20,14 @@ class MediaQueryTokenizer {
     WTF_MAKE_FAST_ALLOCATED;
 public:
     static void tokenize(String, Vector<MediaQueryToken>&);
-private:
-    MediaQueryTokenizer(MediaQueryInputStream&);
 
+    // Parsers that consume the tokens as they are produced, rather than
+    // tokenizing their whole input up front, pull them one at a time.
+    explicit MediaQueryTokenizer(MediaQueryInputStream&);
     MediaQueryToken nextToken();
 
+private:
+
     UChar consume();
     void consume(unsigned);
     void reconsume(UChar);
@@ -33,6 +36,9 @@ private:
     MediaQueryToken consumeIdentLikeToken();
     MediaQueryToken consumeNumber();
     MediaQueryToken consumeStringTokenUntil(UChar);
+    MediaQueryToken consumeUrlToken();
+
+    void consumeBadUrlRemnants();
 
     void consumeUntilNonWhitespace();
     bool consumeUntilCommentEndFound();
@@ -69,6 +75,9 @@ private:
     MediaQueryToken solidus(UChar);
     MediaQueryToken colon(UChar);
     MediaQueryToken semiColon(UChar);
+    MediaQueryToken hash(UChar);
+    MediaQueryToken commercialAt(UChar);
+    MediaQueryToken lessThan(UChar);
     MediaQueryToken reverseSolidus(UChar);
     MediaQueryToken asciiDigit(UChar);
     MediaQueryToken nameStart(UChar);
@@ -70,6 +70,36 @@ TEST(MediaQueryTokenizerTest, Basic)
     }
 }
 
+static void testTokenTypes(const char* input, const MediaQueryTokenType* expectedTypes, size_t expectedCount)
+{
+    Vector<MediaQueryToken> tokens;
+    MediaQueryTokenizer::tokenize(input, tokens);
+    ASSERT_EQ(expectedCount + 1, tokens.size()) << input;
+    for (size_t i = 0; i < expectedCount; ++i)
+        ASSERT_EQ(expectedTypes[i], tokens[i].type()) << input;
+    ASSERT_EQ(EOFToken, tokens.last().type()) << input;
+}
+
+TEST(MediaQueryTokenizerTest, StyleSheetTokens)
+{
+    const MediaQueryTokenType hash[] = { HashToken, WhitespaceToken, HashToken, WhitespaceToken, DelimiterToken, WhitespaceToken };
+    testTokenTypes("#foo #1a # ", hash, WTF_ARRAY_LENGTH(hash));
+    const MediaQueryTokenType atKeyword[] = { AtKeywordToken, WhitespaceToken, DelimiterToken, NumberToken };
+    testTokenTypes("@media @1", atKeyword, WTF_ARRAY_LENGTH(atKeyword));
+    const MediaQueryTokenType cdoCdc[] = { CDOToken, WhitespaceToken, CDCToken, WhitespaceToken, DelimiterToken, DelimiterToken };
+    testTokenTypes("<!-- --> <!", cdoCdc, WTF_ARRAY_LENGTH(cdoCdc));
+    const MediaQueryTokenType url[] = { UrlToken, WhitespaceToken, UrlToken, WhitespaceToken, FunctionToken, StringToken, WhitespaceToken, RightParenthesisToken };
+    testTokenTypes("url(a.png) url( b.png ) url( 'c.png' )", url, WTF_ARRAY_LENGTH(url));
+    const MediaQueryTokenType badUrl[] = { BadUrlToken, SemicolonToken };
+    testTokenTypes("url(a b.png);", badUrl, WTF_ARRAY_LENGTH(badUrl));
+
+    Vector<MediaQueryToken> tokens;
+    MediaQueryTokenizer::tokenize("#a\\-b url( c\\).png )", tokens);
+    ASSERT_EQ(4u, tokens.size());
+    EXPECT_EQ("a-b", tokens[0].value());
+    EXPECT_EQ("c).png", tokens[2].value());
+}
+
 TEST(MediaQueryTokenizerBlockTest, Basic)
 {
     BlockTestCase testCases[] = {
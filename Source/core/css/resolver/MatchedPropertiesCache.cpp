@@ -32,6 +32,7 @@
 #include "core/css/StylePropertySet.h"
 #include "core/css/resolver/StyleResolverState.h"
 #include "core/rendering/style/RenderStyle.h"
+#include "wtf/MainThread.h"
 
 namespace blink {
 
@@ -63,6 +64,11 @@ bool CachedMatchedPropertiesHashTraits::traceInCollection(Visitor* visitor, Memb
 }
 #endif
 
+// The entries hold RenderStyles whose substructures are mostly shared with the
+// styles of elements, so the cache is bounded by entry count rather than by an
+// estimate of their size.
+static const size_t maximumEntryCount = 4096;
+
 void CachedMatchedProperties::set(const RenderStyle* style, const RenderStyle* parentStyle, const MatchResult& matchResult)
 {
     matchedProperties.appendVector(matchResult.matchedProperties);
@@ -81,6 +87,19 @@ void CachedMatchedProperties::clear()
     parentRenderStyle = nullptr;
 }
 
+MatchedPropertiesCache& MatchedPropertiesCache::instance()
+{
+    DEFINE_STATIC_LOCAL(OwnPtrWillBePersistent<MatchedPropertiesCache>, cache, (adoptPtrWillBeNoop(new MatchedPropertiesCache())));
+    return *cache;
+}
+
+unsigned MatchedPropertiesCache::createPrivateScope()
+{
+    ASSERT(isMainThread());
+    static unsigned lastScope = sharedScope;
+    return ++lastScope;
+}
+
 MatchedPropertiesCache::MatchedPropertiesCache()
 #if !ENABLE(OILPAN)
     : m_additionsSinceLastSweep(0)
@@ -89,11 +108,13 @@ MatchedPropertiesCache::MatchedPropertiesCache()
 {
 }
 
-const CachedMatchedProperties* MatchedPropertiesCache::find(unsigned hash, const StyleResolverState& styleResolverState, const MatchResult& matchResult)
+const CachedMatchedProperties* MatchedPropertiesCache::find(unsigned hash, unsigned scope, const StyleResolverState& styleResolverState, const MatchResult& matchResult)
 {
+    ASSERT(isMainThread());
     ASSERT(hash);
 
-    Cache::iterator it = m_cache.find(hash);
+    Key key(hash, scope);
+    Cache::iterator it = m_cache.find(key);
     if (it == m_cache.end())
         return 0;
     CachedMatchedProperties* cacheItem = it->value.get();
@@ -110,11 +131,13 @@ const CachedMatchedProperties* MatchedPropertiesCache::find(unsigned hash, const
     }
     if (cacheItem->ranges != matchResult.ranges)
         return 0;
+    m_recentlyUsed.appendOrMoveToLast(key);
     return cacheItem;
 }
 
-void MatchedPropertiesCache::add(const RenderStyle* style, const RenderStyle* parentStyle, unsigned hash, const MatchResult& matchResult)
+unsigned MatchedPropertiesCache::add(const RenderStyle* style, const RenderStyle* parentStyle, unsigned hash, unsigned scope, unsigned resolverScope, const MatchResult& matchResult)
 {
+    ASSERT(isMainThread());
 #if !ENABLE(OILPAN)
     static const unsigned maxAdditionsBetweenSweeps = 100;
     if (++m_additionsSinceLastSweep >= maxAdditionsBetweenSweeps
@@ -125,7 +148,8 @@ void MatchedPropertiesCache::add(const RenderStyle* style, const RenderStyle* pa
 #endif
 
     ASSERT(hash);
-    Cache::AddResult addResult = m_cache.add(hash, nullptr);
+    Key key(hash, scope);
+    Cache::AddResult addResult = m_cache.add(key, nullptr);
     if (addResult.isNewEntry)
         addResult.storedValue->value = adoptPtrWillBeNoop(new CachedMatchedProperties);
 
@@ -134,22 +158,67 @@ void MatchedPropertiesCache::add(const RenderStyle* style, const RenderStyle* pa
         cacheItem->clear();
 
     cacheItem->set(style, parentStyle, matchResult);
+    cacheItem->resolverScope = resolverScope;
+    m_recentlyUsed.appendOrMoveToLast(key);
+
+    unsigned evictedCount = 0;
+    evictIfNeeded(evictedCount);
+    return evictedCount;
+}
+
+void MatchedPropertiesCache::remove(const Key& key)
+{
+    m_recentlyUsed.remove(key);
+    m_cache.remove(key);
+}
+
+void MatchedPropertiesCache::evictIfNeeded(unsigned& evictedCount)
+{
+    while (m_recentlyUsed.size() > maximumEntryCount) {
+        Key key = m_recentlyUsed.first();
+        if (m_cache.contains(key))
+            ++evictedCount;
+        remove(key);
+    }
 }
 
 void MatchedPropertiesCache::clear()
 {
     m_cache.clear();
+    m_recentlyUsed.clear();
+}
+
+void MatchedPropertiesCache::clearScope(unsigned scope)
+{
+    Vector<Key, 16> toRemove;
+    for (Cache::iterator it = m_cache.begin(); it != m_cache.end(); ++it) {
+        if (it->key.second == scope)
+            toRemove.append(it->key);
+    }
+    for (size_t i = 0; i < toRemove.size(); ++i)
+        remove(toRemove[i]);
+}
+
+size_t MatchedPropertiesCache::sizeOfScope(unsigned scope) const
+{
+    size_t size = 0;
+    for (Cache::const_iterator it = m_cache.begin(); it != m_cache.end(); ++it) {
+        if (it->key.second == scope)
+            ++size;
+    }
+    return size;
 }
 
-void MatchedPropertiesCache::clearViewportDependent()
+void MatchedPropertiesCache::clearViewportDependent(unsigned scope)
 {
-    Vector<unsigned, 16> toRemove;
+    Vector<Key, 16> toRemove;
     for (Cache::iterator it = m_cache.begin(); it != m_cache.end(); ++it) {
         CachedMatchedProperties* cacheItem = it->value.get();
-        if (cacheItem->renderStyle->hasViewportUnits())
+        if (it->key.second == scope && cacheItem->renderStyle->hasViewportUnits())
             toRemove.append(it->key);
     }
-    m_cache.removeAll(toRemove);
+    for (size_t i = 0; i < toRemove.size(); ++i)
+        remove(toRemove[i]);
 }
 
 #if !ENABLE(OILPAN)
@@ -158,7 +227,7 @@ void MatchedPropertiesCache::sweep(Timer<MatchedPropertiesCache>*)
     // Look for cache entries containing a style declaration with a single ref and remove them.
     // This may happen when an element attribute mutation causes it to generate a new inlineStyle()
     // or presentationAttributeStyle(), potentially leaving this cache with the last ref on the old one.
-    Vector<unsigned, 16> toRemove;
+    Vector<Key, 16> toRemove;
     Cache::iterator it = m_cache.begin();
     Cache::iterator end = m_cache.end();
     for (; it != end; ++it) {
@@ -171,7 +240,8 @@ void MatchedPropertiesCache::sweep(Timer<MatchedPropertiesCache>*)
             }
         }
     }
-    m_cache.removeAll(toRemove);
+    for (size_t i = 0; i < toRemove.size(); ++i)
+        remove(toRemove[i]);
     m_additionsSinceLastSweep = 0;
 }
 #endif
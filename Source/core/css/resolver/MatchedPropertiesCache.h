@@ -29,6 +29,7 @@
 #include "platform/heap/Handle.h"
 #include "wtf/Forward.h"
 #include "wtf/HashMap.h"
+#include "wtf/ListHashSet.h"
 #include "wtf/Noncopyable.h"
 
 namespace blink {
@@ -43,6 +44,8 @@ public:
     MatchRanges ranges;
     RefPtr<RenderStyle> renderStyle;
     RefPtr<RenderStyle> parentRenderStyle;
+    // The private scope of the StyleResolver that added the entry.
+    unsigned resolverScope;
 
     void set(const RenderStyle*, const RenderStyle* parentStyle, const MatchResult&);
     void clear();
@@ -58,25 +61,46 @@ struct CachedMatchedPropertiesHashTraits : HashTraits<Member<CachedMatchedProper
 };
 #endif
 
-class MatchedPropertiesCache {
-    DISALLOW_ALLOCATION();
+// MatchedPropertiesCache is shared by the StyleResolvers of all documents, so
+// that frames and documents using the same style sheets reuse each other's
+// cascade work. Entries live in a scope: every StyleResolver has a private
+// scope for styles that depend on its document, like ones with viewport units
+// or resources loaded by the document, and documents whose styles only depend
+// on the matched declarations share sharedScope. The least recently used
+// entries are evicted once the cache grows too large.
+class MatchedPropertiesCache FINAL : public NoBaseWillBeGarbageCollectedFinalized<MatchedPropertiesCache> {
     WTF_MAKE_NONCOPYABLE(MatchedPropertiesCache);
 public:
-    MatchedPropertiesCache();
+    static const unsigned sharedScope = 0;
+
+    static MatchedPropertiesCache& instance();
+    static unsigned createPrivateScope();
 
-    const CachedMatchedProperties* find(unsigned hash, const StyleResolverState&, const MatchResult&);
-    void add(const RenderStyle*, const RenderStyle* parentStyle, unsigned hash, const MatchResult&);
+    const CachedMatchedProperties* find(unsigned hash, unsigned scope, const StyleResolverState&, const MatchResult&);
+    // Returns the number of entries evicted to make room for the new one.
+    unsigned add(const RenderStyle*, const RenderStyle* parentStyle, unsigned hash, unsigned scope, unsigned resolverScope, const MatchResult&);
 
     void clear();
-    void clearViewportDependent();
+    void clearScope(unsigned scope);
+    void clearViewportDependent(unsigned scope);
+
+    size_t size() const { return m_cache.size(); }
+    size_t sizeOfScope(unsigned scope) const;
 
     static bool isCacheable(const Element*, const RenderStyle*, const RenderStyle* parentStyle);
 
     void trace(Visitor*);
 
 private:
+    typedef std::pair<unsigned, unsigned> Key;
+
+    MatchedPropertiesCache();
+
+    void remove(const Key&);
+    void evictIfNeeded(unsigned& evictedCount);
+
 #if ENABLE(OILPAN)
-    typedef HeapHashMap<unsigned, Member<CachedMatchedProperties>, DefaultHash<unsigned>::Hash, HashTraits<unsigned>, CachedMatchedPropertiesHashTraits > Cache;
+    typedef HeapHashMap<Key, Member<CachedMatchedProperties>, DefaultHash<Key>::Hash, HashTraits<Key>, CachedMatchedPropertiesHashTraits > Cache;
 #else
     // Every N additions to the matched declaration cache trigger a sweep where entries holding
     // the last reference to a style declaration are garbage collected.
@@ -84,10 +108,14 @@ private:
 
     unsigned m_additionsSinceLastSweep;
 
-    typedef HashMap<unsigned, OwnPtr<CachedMatchedProperties> > Cache;
+    typedef HashMap<Key, OwnPtr<CachedMatchedProperties> > Cache;
     Timer<MatchedPropertiesCache> m_sweepTimer;
 #endif
     Cache m_cache;
+
+    // Least recently used first. With Oilpan this can also hold the keys of
+    // entries that were dropped when their declarations died.
+    ListHashSet<Key> m_recentlyUsed;
 };
 
 }
@@ -0,0 +1,139 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "config.h"
+#include "core/css/resolver/MatchedPropertiesCache.h"
+
+#include "bindings/core/v8/ExceptionStatePlaceholder.h"
+#include "core/css/StylePropertySet.h"
+#include "core/css/resolver/StyleResolver.h"
+#include "core/css/resolver/StyleResolverState.h"
+#include "core/css/resolver/StyleResolverStats.h"
+#include "core/dom/Document.h"
+#include "core/frame/Settings.h"
+#include "core/html/HTMLElement.h"
+#include "core/rendering/style/RenderStyle.h"
+#include "core/testing/DummyPageHolder.h"
+#include <gtest/gtest.h>
+
+namespace blink {
+
+class MatchedPropertiesCacheTest : public ::testing::Test {
+protected:
+    virtual void SetUp() OVERRIDE
+    {
+        MatchedPropertiesCache::instance().clear();
+        m_firstPageHolder = DummyPageHolder::create(IntSize(800, 600));
+        m_secondPageHolder = DummyPageHolder::create(IntSize(800, 600));
+    }
+
+    virtual void TearDown() OVERRIDE
+    {
+        MatchedPropertiesCache::instance().clear();
+    }
+
+    Document& firstDocument() const { return m_firstPageHolder->document(); }
+    Document& secondDocument() const { return m_secondPageHolder->document(); }
+
+private:
+    OwnPtr<DummyPageHolder> m_firstPageHolder;
+    OwnPtr<DummyPageHolder> m_secondPageHolder;
+};
+
+TEST_F(MatchedPropertiesCacheTest, FindsEntriesInTheirScope)
+{
+    MatchedPropertiesCache& cache = MatchedPropertiesCache::instance();
+    RefPtr<RenderStyle> parentStyle = RenderStyle::create();
+    RefPtr<RenderStyle> style = RenderStyle::create();
+    StyleResolverState state(firstDocument(), firstDocument().body(), parentStyle.get());
+    state.setStyle(style);
+    RefPtrWillBeRawPtr<MutableStylePropertySet> properties = MutableStylePropertySet::create();
+    MatchResult matchResult;
+    matchResult.addMatchedProperties(properties.get());
+
+    unsigned scope = MatchedPropertiesCache::createPrivateScope();
+    unsigned otherScope = MatchedPropertiesCache::createPrivateScope();
+    EXPECT_EQ(0u, cache.add(style.get(), parentStyle.get(), 1, scope, scope, matchResult));
+    EXPECT_EQ(0u, cache.add(style.get(), parentStyle.get(), 1, MatchedPropertiesCache::sharedScope, otherScope, matchResult));
+
+    EXPECT_EQ(scope, cache.find(1, scope, state, matchResult)->resolverScope);
+    EXPECT_EQ(otherScope, cache.find(1, MatchedPropertiesCache::sharedScope, state, matchResult)->resolverScope);
+    EXPECT_FALSE(cache.find(1, otherScope, state, matchResult));
+
+    cache.clearScope(scope);
+    EXPECT_FALSE(cache.find(1, scope, state, matchResult));
+    EXPECT_TRUE(cache.find(1, MatchedPropertiesCache::sharedScope, state, matchResult));
+}
+
+TEST_F(MatchedPropertiesCacheTest, EvictsLeastRecentlyUsedEntries)
+{
+    MatchedPropertiesCache& cache = MatchedPropertiesCache::instance();
+    RefPtr<RenderStyle> parentStyle = RenderStyle::create();
+    RefPtr<RenderStyle> style = RenderStyle::create();
+    StyleResolverState state(firstDocument(), firstDocument().body(), parentStyle.get());
+    state.setStyle(style);
+    RefPtrWillBeRawPtr<MutableStylePropertySet> properties = MutableStylePropertySet::create();
+    MatchResult matchResult;
+    matchResult.addMatchedProperties(properties.get());
+
+    unsigned scope = MatchedPropertiesCache::sharedScope;
+    cache.add(style.get(), parentStyle.get(), 1, scope, scope, matchResult);
+    cache.add(style.get(), parentStyle.get(), 2, scope, scope, matchResult);
+    unsigned evictedCount = 0;
+    for (unsigned hash = 3; !evictedCount; ++hash) {
+        ASSERT_TRUE(cache.find(1, scope, state, matchResult));
+        evictedCount = cache.add(style.get(), parentStyle.get(), hash, scope, scope, matchResult);
+    }
+    EXPECT_EQ(1u, evictedCount);
+    EXPECT_TRUE(cache.find(1, scope, state, matchResult));
+    EXPECT_FALSE(cache.find(2, scope, state, matchResult));
+}
+
+TEST_F(MatchedPropertiesCacheTest, SharesStylesAcrossDocuments)
+{
+    const char* html = "<div><p>Text</p></div><ul><li>Item</li></ul>";
+    firstDocument().body()->setInnerHTML(html, ASSERT_NO_EXCEPTION);
+    firstDocument().updateLayout();
+    EXPECT_LT(0u, MatchedPropertiesCache::instance().size());
+
+    secondDocument().body()->setInnerHTML(html, ASSERT_NO_EXCEPTION);
+    StyleResolver& resolver = secondDocument().ensureStyleResolver();
+    resolver.enableStats();
+    secondDocument().updateLayout();
+    // The elements only match rules of the default style sheet, which all
+    // documents share.
+    EXPECT_LT(0u, resolver.stats()->matchedPropertyCacheSharedHit);
+    resolver.disableStats();
+}
+
+TEST_F(MatchedPropertiesCacheTest, DoesNotShareStylesDependingOnSettings)
+{
+    // Both documents match the declarations of the same shared sheet, but
+    // resize: auto resolves through the settings of each document.
+    const char* html = "<style>.a { resize: auto; overflow: auto }</style><div class='a'>Text</div>";
+    firstDocument().settings()->setTextAreasAreResizable(true);
+    secondDocument().settings()->setTextAreasAreResizable(false);
+
+    firstDocument().body()->setInnerHTML(html, ASSERT_NO_EXCEPTION);
+    firstDocument().updateLayout();
+    secondDocument().body()->setInnerHTML(html, ASSERT_NO_EXCEPTION);
+    secondDocument().updateLayout();
+
+    EXPECT_EQ(RESIZE_BOTH, toElement(firstDocument().body()->lastChild())->renderStyle()->resize());
+    EXPECT_EQ(RESIZE_NONE, toElement(secondDocument().body()->lastChild())->renderStyle()->resize());
+}
+
+TEST_F(MatchedPropertiesCacheTest, ClearsPrivateScopeWhenResolverGoesAway)
+{
+    // Styles with viewport units are only cached in the private scope.
+    firstDocument().body()->setInnerHTML("<style>.a { width: 10vw }</style><div class='a'>Text</div><div class='a'>Text</div>", ASSERT_NO_EXCEPTION);
+    firstDocument().updateLayout();
+    unsigned scope = firstDocument().ensureStyleResolver().matchedPropertiesCacheScope();
+    EXPECT_LT(0u, MatchedPropertiesCache::instance().sizeOfScope(scope));
+
+    firstDocument().clearStyleResolver();
+    EXPECT_EQ(0u, MatchedPropertiesCache::instance().sizeOfScope(scope));
+}
+
+} // namespace blink
@@ -0,0 +1,185 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "config.h"
+#include "core/css/resolver/ParallelRuleMatcher.h"
+
+#include "core/css/CompiledSelector.h"
+#include "core/css/RuleSet.h"
+#include "core/css/SelectorFilter.h"
+#include "core/dom/Element.h"
+#include "core/dom/ElementTraversal.h"
+#include "core/html/HTMLElement.h"
+#include "platform/TraceEvent.h"
+#include "platform/graphics/filters/ParallelJobs.h"
+
+namespace blink {
+
+// Starting a worker thread costs about as much as matching a few hundred
+// elements, so small recalcs are left to the main thread.
+static const size_t minimumElementsPerJob = 500;
+
+PassOwnPtr<ParallelRuleMatcher> ParallelRuleMatcher::create(Element& root, StyleRecalcChange change, const Vector<RuleSet*>& ruleSets)
+{
+#if ENABLE(OILPAN)
+    // The worker threads are not attached to the Oilpan heap, which
+    // SelectorFilter allocates its ancestor stack on.
+    return nullptr;
+#else
+    OwnPtr<ParallelRuleMatcher> matcher = adoptPtr(new ParallelRuleMatcher(ruleSets));
+    matcher->collectElements(root, change >= Inherit);
+    if (matcher->m_elements.size() < 2 * minimumElementsPerJob)
+        return nullptr;
+    matcher->matchElements();
+    return matcher.release();
+#endif
+}
+
+ParallelRuleMatcher::ParallelRuleMatcher(const Vector<RuleSet*>& ruleSets)
+    : m_ruleSets(ruleSets)
+    , m_elementsPerJob(0)
+{
+    for (size_t i = 0; i < m_ruleSets.size(); ++i) {
+        // The workers read the compact rule maps, and the RuleData addresses
+        // they record must stay the ones ElementRuleCollector will see.
+        m_ruleSets[i]->compactRulesIfNeeded();
+        m_ruleCounts.set(m_ruleSets[i], m_ruleSets[i]->ruleCount());
+    }
+}
+
+// Mirrors the way Element::recalcStyle() walks the tree, assuming no element
+// turns a change into a forced recalc of its children unless it is marked for
+// one already. Elements the guess misses simply match on the main thread.
+void ParallelRuleMatcher::collectElements(Element& element, bool forceRecalc)
+{
+    // Leaves out SVG and MathML, where class names can be out of date until
+    // the main thread synchronizes animated attributes.
+    if (!element.isHTMLElement() || !element.parentRenderStyle())
+        return;
+
+    if (forceRecalc || element.needsStyleRecalc()) {
+        m_elementIndices.set(&element, m_elements.size());
+        m_elements.append(&element);
+    }
+
+    bool forceChildRecalc = forceRecalc || element.styleChangeType() >= SubtreeStyleChange;
+    if (!forceChildRecalc && !element.childNeedsStyleRecalc())
+        return;
+    for (Element* child = ElementTraversal::firstChild(element); child; child = ElementTraversal::nextSibling(*child))
+        collectElements(*child, forceChildRecalc);
+}
+
+void ParallelRuleMatcher::matchElements()
+{
+    TRACE_EVENT1("blink", "ParallelRuleMatcher::matchElements", "elementCount", static_cast<unsigned>(m_elements.size()));
+
+    ParallelJobs<Job> parallelJobs(&ParallelRuleMatcher::matchElementsForJob, m_elements.size() / minimumElementsPerJob);
+    size_t numberOfJobs = parallelJobs.numberOfJobs();
+    // Consecutive elements in tree order mostly share ancestors, so each job
+    // takes a contiguous run and keeps its ancestor stack warm.
+    m_elementsPerJob = (m_elements.size() + numberOfJobs - 1) / numberOfJobs;
+    for (size_t i = 0; i < numberOfJobs; ++i) {
+        Job& job = parallelJobs.parameter(i);
+        job.matcher = this;
+        job.begin = std::min(i * m_elementsPerJob, m_elements.size());
+        job.end = std::min(job.begin + m_elementsPerJob, m_elements.size());
+    }
+    parallelJobs.execute();
+
+    m_jobs.resize(numberOfJobs);
+    for (size_t i = 0; i < numberOfJobs; ++i) {
+        Job& job = parallelJobs.parameter(i);
+        m_jobs[i].begin = job.begin;
+        m_jobs[i].end = job.end;
+        m_jobs[i].matchedRules.swap(job.matchedRules);
+        m_jobs[i].matchedRuleEnds.swap(job.matchedRuleEnds);
+    }
+}
+
+void ParallelRuleMatcher::matchElementsForJob(Job* job)
+{
+    const ParallelRuleMatcher& matcher = *job->matcher;
+    SelectorFilter selectorFilter;
+    job->matchedRuleEnds.reserveInitialCapacity(job->end - job->begin);
+    for (size_t i = job->begin; i < job->end; ++i) {
+        Element& element = *matcher.m_elements[i];
+        Element* parent = element.parentElement();
+
+        // Unwind the ancestor stack to the parent, or rebuild it when the
+        // element does not belong to the subtree matched last.
+        while (!selectorFilter.parentStackIsEmpty() && !selectorFilter.parentStackIsConsistent(parent))
+            selectorFilter.popParent();
+        if (parent && selectorFilter.parentStackIsEmpty())
+            selectorFilter.setupParentStack(*parent);
+
+        size_t firstMatch = job->matchedRules.size();
+        matcher.collectMatchingRules(element, parent ? &selectorFilter : 0, job->matchedRules);
+        std::sort(job->matchedRules.begin() + firstMatch, job->matchedRules.end());
+        job->matchedRuleEnds.append(job->matchedRules.size());
+
+        if (ElementTraversal::firstChild(element)) {
+            if (selectorFilter.parentStackIsEmpty())
+                selectorFilter.setupParentStack(element);
+            else
+                selectorFilter.pushParent(element);
+        }
+    }
+}
+
+// Visits the same lists of each RuleSet as ElementRuleCollector::collectMatchingRules().
+// Rules in the others all have pseudo classes or pseudo elements and are never compiled.
+void ParallelRuleMatcher::collectMatchingRules(Element& element, const SelectorFilter* selectorFilter, Vector<const RuleData*>& matchedRules) const
+{
+    for (size_t i = 0; i < m_ruleSets.size(); ++i) {
+        const RuleSet& ruleSet = *m_ruleSets[i];
+        if (element.hasID())
+            collectMatchingRulesForList(ruleSet.idRules(element.idForStyleResolution()), element, selectorFilter, matchedRules);
+        if (element.hasClass()) {
+            for (size_t j = 0; j < element.classNames().size(); ++j)
+                collectMatchingRulesForList(ruleSet.classRules(element.classNames()[j]), element, selectorFilter, matchedRules);
+        }
+        collectMatchingRulesForList(ruleSet.tagRules(element.localName()), element, selectorFilter, matchedRules);
+        collectMatchingRulesForList(ruleSet.universalRules(), element, selectorFilter, matchedRules);
+    }
+}
+
+template<typename RuleDataListType>
+void ParallelRuleMatcher::collectMatchingRulesForList(const RuleDataListType* rules, Element& element, const SelectorFilter* selectorFilter, Vector<const RuleData*>& matchedRules)
+{
+    if (!rules)
+        return;
+
+    for (typename RuleDataListType::const_iterator it = rules->begin(), end = rules->end(); it != end; ++it) {
+        const RuleData& ruleData = *it;
+        const CompiledSelector* compiledSelector = ruleData.compiledSelector();
+        if (!compiledSelector || !compiledSelector->canMatchOnWorkerThread())
+            continue;
+        if (selectorFilter && selectorFilter->fastRejectSelector<RuleData::maximumIdentifierCount>(ruleData.descendantSelectorIdentifierHashes(), element))
+            continue;
+        if (compiledSelector->matches(element))
+            matchedRules.append(&ruleData);
+    }
+}
+
+bool ParallelRuleMatcher::coversRuleSet(const RuleSet& ruleSet) const
+{
+    HashMap<const RuleSet*, unsigned>::const_iterator it = m_ruleCounts.find(&ruleSet);
+    // Rules added since matching have moved the RuleData we recorded.
+    return it != m_ruleCounts.end() && it->value == ruleSet.ruleCount();
+}
+
+ParallelRuleMatcher::ElementMatches ParallelRuleMatcher::matchesFor(const Element& element) const
+{
+    HashMap<const Element*, size_t>::const_iterator it = m_elementIndices.find(&element);
+    if (it == m_elementIndices.end())
+        return ElementMatches();
+    const Job& job = m_jobs[it->value / m_elementsPerJob];
+    ASSERT(it->value >= job.begin && it->value < job.end);
+    size_t indexInJob = it->value - job.begin;
+    const RuleData* const* matchedRules = job.matchedRules.data();
+    size_t begin = indexInJob ? job.matchedRuleEnds[indexInJob - 1] : 0;
+    return ElementMatches(this, matchedRules + begin, matchedRules + job.matchedRuleEnds[indexInJob]);
+}
+
+} // namespace blink
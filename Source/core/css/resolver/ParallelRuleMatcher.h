@@ -0,0 +1,108 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef ParallelRuleMatcher_h
+#define ParallelRuleMatcher_h
+
+#include "core/rendering/style/RenderStyleConstants.h"
+#include "wtf/FastAllocBase.h"
+#include "wtf/HashMap.h"
+#include "wtf/Noncopyable.h"
+#include "wtf/PassOwnPtr.h"
+#include "wtf/Vector.h"
+#include <algorithm>
+
+namespace blink {
+
+class Element;
+class RuleData;
+class RuleSet;
+class SelectorFilter;
+
+// ParallelRuleMatcher matches the compiled selectors of a set of RuleSets
+// against the elements a style recalc is about to resolve, split into runs of
+// whole subtrees across worker threads, each with its own SelectorFilter
+// ancestor stack. The recalc itself, and everything else that goes into a
+// RenderStyle, stays on the main thread: ElementRuleCollector only swaps a
+// compiled selector match for a lookup in the results.
+//
+// Workers only read the element tree and the RuleSets, which the main thread
+// does not touch while it waits for them. Anything depending on mutable state
+// elsewhere (pseudo classes such as :hover, attribute selectors that may
+// synchronize lazy attributes, shadow trees, rules added mid-recalc) is left
+// to the serial path.
+class ParallelRuleMatcher {
+    WTF_MAKE_NONCOPYABLE(ParallelRuleMatcher);
+    WTF_MAKE_FAST_ALLOCATED;
+public:
+    class ElementMatches {
+    public:
+        ElementMatches()
+            : m_matcher(0)
+            , m_begin(0)
+            , m_end(0)
+        {
+        }
+
+        ElementMatches(const ParallelRuleMatcher* matcher, const RuleData* const* begin, const RuleData* const* end)
+            : m_matcher(matcher)
+            , m_begin(begin)
+            , m_end(end)
+        {
+        }
+
+        // Whether contains() knows about the rules of this RuleSet that can match on a worker thread.
+        bool coversRuleSet(const RuleSet& ruleSet) const { return m_matcher && m_matcher->coversRuleSet(ruleSet); }
+        bool contains(const RuleData& ruleData) const { return std::binary_search(m_begin, m_end, &ruleData); }
+
+    private:
+        const ParallelRuleMatcher* m_matcher;
+        const RuleData* const* m_begin;
+        const RuleData* const* m_end;
+    };
+
+    // Returns nullptr when there are too few elements to make the threads worth it.
+    static PassOwnPtr<ParallelRuleMatcher> create(Element& root, StyleRecalcChange, const Vector<RuleSet*>&);
+
+    ElementMatches matchesFor(const Element&) const;
+
+private:
+    struct Job {
+        Job()
+            : matcher(0)
+            , begin(0)
+            , end(0)
+        {
+        }
+
+        const ParallelRuleMatcher* matcher;
+        size_t begin;
+        size_t end;
+        Vector<const RuleData*> matchedRules;
+        // One entry per element: the end of its matches in matchedRules.
+        Vector<size_t> matchedRuleEnds;
+    };
+
+    explicit ParallelRuleMatcher(const Vector<RuleSet*>&);
+
+    void collectElements(Element&, bool forceRecalc);
+    void matchElements();
+    static void matchElementsForJob(Job*);
+    void collectMatchingRules(Element&, const SelectorFilter*, Vector<const RuleData*>&) const;
+    template<typename RuleDataListType>
+    static void collectMatchingRulesForList(const RuleDataListType*, Element&, const SelectorFilter*, Vector<const RuleData*>&);
+
+    bool coversRuleSet(const RuleSet&) const;
+
+    Vector<RuleSet*> m_ruleSets;
+    HashMap<const RuleSet*, unsigned> m_ruleCounts;
+    Vector<Element*> m_elements;
+    HashMap<const Element*, size_t> m_elementIndices;
+    Vector<Job> m_jobs;
+    size_t m_elementsPerJob;
+};
+
+} // namespace blink
+
+#endif // ParallelRuleMatcher_h
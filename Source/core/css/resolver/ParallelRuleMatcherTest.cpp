@@ -0,0 +1,95 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "config.h"
+#include "core/css/resolver/ParallelRuleMatcher.h"
+
+#include "bindings/core/v8/ExceptionStatePlaceholder.h"
+#include "core/css/RuleSet.h"
+#include "core/css/resolver/ScopedStyleResolver.h"
+#include "core/dom/Document.h"
+#include "core/dom/Element.h"
+#include "core/dom/ElementTraversal.h"
+#include "core/html/HTMLElement.h"
+#include "core/testing/DummyPageHolder.h"
+#include "wtf/text/StringBuilder.h"
+#include <gtest/gtest.h>
+
+namespace blink {
+
+class ParallelRuleMatcherTest : public ::testing::Test {
+protected:
+    virtual void SetUp() OVERRIDE
+    {
+        m_dummyPageHolder = DummyPageHolder::create(IntSize(800, 600));
+    }
+
+    Document& document() const { return m_dummyPageHolder->document(); }
+
+private:
+    OwnPtr<DummyPageHolder> m_dummyPageHolder;
+};
+
+#if !ENABLE(OILPAN)
+TEST_F(ParallelRuleMatcherTest, MatchesCompiledSelectorsOfCoveredRuleSets)
+{
+    StringBuilder markup;
+    markup.append("<style>.a .b { color: red } div > span { color: green } [title] em { color: blue }</style>");
+    markup.append("<div class='a' title='t'><span id='inside' class='b'></span>");
+    for (unsigned i = 0; i < 1500; ++i)
+        markup.append("<span class='b'></span>");
+    markup.append("<em id='em'></em></div>");
+    markup.append("<p><span id='outside' class='b'></span></p>");
+    markup.append("<svg><g class='b'></g></svg>");
+    document().body()->setInnerHTML(markup.toString(), ASSERT_NO_EXCEPTION);
+    document().updateLayout();
+
+    Vector<RuleSet*> ruleSets;
+    document().scopedStyleResolver()->appendRuleSetsTo(ruleSets);
+    ASSERT_EQ(1u, ruleSets.size());
+    RuleSet& ruleSet = *ruleSets[0];
+
+    OwnPtr<ParallelRuleMatcher> matcher = ParallelRuleMatcher::create(*document().documentElement(), Force, ruleSets);
+    ASSERT_TRUE(matcher);
+
+    ASSERT_EQ(1u, ruleSet.classRules(AtomicString("b"))->size());
+    const RuleData& descendantRule = ruleSet.classRules(AtomicString("b"))->at(0);
+    ASSERT_EQ(1u, ruleSet.tagRules(AtomicString("span"))->size());
+    const RuleData& childRule = ruleSet.tagRules(AtomicString("span"))->at(0);
+    ASSERT_EQ(1u, ruleSet.tagRules(AtomicString("em"))->size());
+    const RuleData& attributeRule = ruleSet.tagRules(AtomicString("em"))->at(0);
+
+    ParallelRuleMatcher::ElementMatches insideMatches = matcher->matchesFor(*document().getElementById("inside"));
+    EXPECT_TRUE(insideMatches.coversRuleSet(ruleSet));
+    EXPECT_TRUE(insideMatches.contains(descendantRule));
+    EXPECT_TRUE(insideMatches.contains(childRule));
+
+    ParallelRuleMatcher::ElementMatches outsideMatches = matcher->matchesFor(*document().getElementById("outside"));
+    EXPECT_TRUE(outsideMatches.coversRuleSet(ruleSet));
+    EXPECT_FALSE(outsideMatches.contains(descendantRule));
+    EXPECT_FALSE(outsideMatches.contains(childRule));
+
+    // Attribute selectors are left to the main thread.
+    ParallelRuleMatcher::ElementMatches emMatches = matcher->matchesFor(*document().getElementById("em"));
+    EXPECT_TRUE(emMatches.coversRuleSet(ruleSet));
+    EXPECT_FALSE(emMatches.contains(attributeRule));
+
+    // So are elements outside the HTML namespace.
+    Element* svgChild = ElementTraversal::lastWithin(*document().body());
+    EXPECT_FALSE(svgChild->isHTMLElement());
+    EXPECT_FALSE(matcher->matchesFor(*svgChild).coversRuleSet(ruleSet));
+}
+#endif
+
+TEST_F(ParallelRuleMatcherTest, LeavesSmallRecalcsToTheMainThread)
+{
+    document().body()->setInnerHTML("<style>.a .b { color: red }</style><div class='a'><span class='b'></span></div>", ASSERT_NO_EXCEPTION);
+    document().updateLayout();
+
+    Vector<RuleSet*> ruleSets;
+    document().scopedStyleResolver()->appendRuleSetsTo(ruleSets);
+    EXPECT_FALSE(ParallelRuleMatcher::create(*document().documentElement(), Force, ruleSets));
+}
+
+} // namespace blink
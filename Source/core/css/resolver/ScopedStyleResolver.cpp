@@ -151,6 +151,12 @@ void ScopedStyleResolver::collectViewportRulesTo(StyleResolver* resolver) const
         resolver->viewportStyleResolver()->collectViewportRules(&m_authorStyleSheets[i]->contents()->ruleSet(), ViewportStyleResolver::AuthorOrigin);
 }
 
+void ScopedStyleResolver::appendRuleSetsTo(Vector<RuleSet*>& ruleSets) const
+{
+    for (size_t i = 0; i < m_authorStyleSheets.size(); ++i)
+        ruleSets.append(&m_authorStyleSheets[i]->contents()->ruleSet());
+}
+
 void ScopedStyleResolver::trace(Visitor* visitor)
 {
 #if ENABLE(OILPAN)
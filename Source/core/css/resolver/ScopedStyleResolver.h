@@ -67,6 +67,7 @@ public:
     void collectFeaturesTo(RuleFeatureSet&, HashSet<const StyleSheetContents*>& visitedSharedStyleSheetContents) const;
     void resetAuthorStyle();
     void collectViewportRulesTo(StyleResolver*) const;
+    void appendRuleSetsTo(Vector<RuleSet*>&) const;
 
     void trace(Visitor*);
 
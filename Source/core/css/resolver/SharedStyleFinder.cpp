@@ -50,6 +50,7 @@
 #include "core/svg/SVGElement.h"
 #include "wtf/HashSet.h"
 #include "wtf/text/AtomicString.h"
+#include "wtf/text/StringHash.h"
 
 namespace blink {
 
@@ -113,6 +114,31 @@ static inline const AtomicString& typeAttributeValue(const Element& element)
     return element.isSVGElement() ? element.getAttribute(typeAttr) : element.fastGetAttribute(typeAttr);
 }
 
+static inline unsigned atomicStringHash(const AtomicString& string)
+{
+    return string.isNull() ? 0 : string.impl()->existingHash();
+}
+
+unsigned SharedStyleFinder::styleSharingFingerprint(const Element& element)
+{
+    Element* parent = element.parentOrShadowHostElement();
+    if (!parent)
+        return 0;
+    // Elements that share ElementData have identical attributes, but elements
+    // created through the DOM never do, so hash the attributes themselves.
+    unsigned hashes[] = {
+        atomicStringHash(element.localName()),
+        PtrHash<RenderStyle*>::hash(parent->renderStyle()),
+        atomicStringHash(element.isSVGElement() ? element.getAttribute(classAttr) : element.fastGetAttribute(classAttr)),
+        atomicStringHash(element.fastGetAttribute(XMLNames::langAttr)),
+        atomicStringHash(element.fastGetAttribute(langAttr)),
+        atomicStringHash(typeAttributeValue(element)),
+        atomicStringHash(element.fastGetAttribute(readonlyAttr)),
+    };
+    unsigned hash = StringHasher::hashMemory<sizeof(hashes)>(hashes);
+    return AlreadyHashed::avoidDeletedValue(hash ? hash : 1);
+}
+
 bool SharedStyleFinder::sharingCandidateHasIdenticalStyleAffectingAttributes(Element& candidate) const
 {
     if (element().sharesSameElementData(candidate))
@@ -279,6 +305,16 @@ bool SharedStyleFinder::documentContainsValidCandidate() const
 
 inline Element* SharedStyleFinder::findElementForStyleSharing() const
 {
+    if (unsigned fingerprint = styleSharingFingerprint(element())) {
+        if (Element* candidate = m_styleResolver.styleSharingCandidate(fingerprint)) {
+            if (canShareStyleWithElement(*candidate)) {
+                INCREMENT_STYLE_STATS_COUNTER(m_styleResolver, sharedStyleFoundByFingerprint);
+                return candidate;
+            }
+            INCREMENT_STYLE_STATS_COUNTER(m_styleResolver, sharedStyleFingerprintMismatches);
+        }
+    }
+
     StyleSharingList& styleSharingList = m_styleResolver.styleSharingList();
     for (StyleSharingList::iterator it = styleSharingList.begin(); it != styleSharingList.end(); ++it) {
         Element& candidate = **it;
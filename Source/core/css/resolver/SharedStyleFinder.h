@@ -52,6 +52,11 @@ public:
 
     RenderStyle* findSharedStyle();
 
+    // Hashes the tag, parent style and style affecting attributes compared by
+    // canShareStyleWithElement(), so elements that can share a style usually
+    // have the same fingerprint. Returns 0 for elements without a parent.
+    static unsigned styleSharingFingerprint(const Element&);
+
 private:
     Element* findElementForStyleSharing() const;
 
@@ -0,0 +1,86 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "config.h"
+#include "core/css/resolver/SharedStyleFinder.h"
+
+#include "bindings/core/v8/ExceptionStatePlaceholder.h"
+#include "core/css/resolver/StyleResolver.h"
+#include "core/css/resolver/StyleResolverStats.h"
+#include "core/dom/Document.h"
+#include "core/dom/ElementTraversal.h"
+#include "core/dom/NodeRenderStyle.h"
+#include "core/html/HTMLElement.h"
+#include "core/testing/DummyPageHolder.h"
+#include "wtf/text/StringBuilder.h"
+#include <gtest/gtest.h>
+
+namespace blink {
+
+class SharedStyleFinderTest : public ::testing::Test {
+protected:
+    virtual void SetUp() OVERRIDE
+    {
+        m_dummyPageHolder = DummyPageHolder::create(IntSize(800, 600));
+    }
+
+    Document& document() const { return m_dummyPageHolder->document(); }
+
+private:
+    OwnPtr<DummyPageHolder> m_dummyPageHolder;
+};
+
+TEST_F(SharedStyleFinderTest, FingerprintMatchesCousinsWithSameAttributes)
+{
+    document().body()->setInnerHTML("<div><span id='a' class='x'></span></div><div><span id='b' class='x'></span><span id='c' class='y'></span></div>", ASSERT_NO_EXCEPTION);
+    document().updateLayout();
+
+    Element* a = document().getElementById("a");
+    Element* b = document().getElementById("b");
+    Element* c = document().getElementById("c");
+    ASSERT_EQ(a->parentElement()->renderStyle(), b->parentElement()->renderStyle());
+    EXPECT_EQ(SharedStyleFinder::styleSharingFingerprint(*a), SharedStyleFinder::styleSharingFingerprint(*b));
+    EXPECT_NE(SharedStyleFinder::styleSharingFingerprint(*b), SharedStyleFinder::styleSharingFingerprint(*c));
+    EXPECT_EQ(0u, SharedStyleFinder::styleSharingFingerprint(*document().documentElement()));
+}
+
+TEST_F(SharedStyleFinderTest, SharesStylesBetweenTableRows)
+{
+    // Each row has more distinct cells than fit in the style sharing list, so
+    // cells can only share with the cells of the previous row by fingerprint.
+    const unsigned cellCount = styleSharingListSize + 5;
+    StringBuilder markup;
+    markup.appendLiteral("<style>");
+    for (unsigned i = 0; i < cellCount; ++i)
+        markup.append(String::format(".c%u { padding: %upx }", i, i));
+    markup.appendLiteral("</style><table>");
+    for (unsigned row = 0; row < 2; ++row) {
+        markup.append(String::format("<tr id='r%u'>", row));
+        for (unsigned i = 0; i < cellCount; ++i)
+            markup.append(String::format("<td class='c%u'></td>", i));
+        markup.appendLiteral("</tr>");
+    }
+    markup.appendLiteral("</table>");
+
+    StyleResolver& resolver = document().ensureStyleResolver();
+    resolver.enableStats();
+    document().body()->setInnerHTML(markup.toString(), ASSERT_NO_EXCEPTION);
+    document().updateLayout();
+
+    Element* firstRow = document().getElementById("r0");
+    Element* secondRow = document().getElementById("r1");
+    ASSERT_EQ(firstRow->renderStyle(), secondRow->renderStyle());
+    Element* firstCell = ElementTraversal::firstChild(*firstRow);
+    Element* secondCell = ElementTraversal::firstChild(*secondRow);
+    for (unsigned i = 0; i < cellCount; ++i) {
+        ASSERT_TRUE(firstCell && secondCell);
+        EXPECT_EQ(firstCell->renderStyle(), secondCell->renderStyle()) << i;
+        firstCell = ElementTraversal::nextSibling(*firstCell);
+        secondCell = ElementTraversal::nextSibling(*secondCell);
+    }
+    EXPECT_LE(cellCount, resolver.statsTotals()->sharedStyleFoundByFingerprint);
+    resolver.disableStats();
+}
+
+} // namespace blink
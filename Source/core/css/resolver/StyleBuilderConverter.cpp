@@ -78,9 +78,18 @@ PassRefPtr<StyleReflection> StyleBuilderConverter::convertBoxReflect(StyleResolv
     return reflection.release();
 }
 
+// The text and link colors are those of the document.
+static void checkForDocumentDependentColor(StyleResolverState& state, const CSSPrimitiveValue* primitiveValue)
+{
+    CSSValueID valueID = primitiveValue->getValueID();
+    if (valueID == CSSValueWebkitText || valueID == CSSValueWebkitLink || valueID == CSSValueWebkitActivelink)
+        state.setHasDocumentDependentStyle();
+}
+
 Color StyleBuilderConverter::convertColor(StyleResolverState& state, CSSValue* value, bool forVisitedLink)
 {
     CSSPrimitiveValue* primitiveValue = toCSSPrimitiveValue(value);
+    checkForDocumentDependentColor(state, primitiveValue);
     return state.document().textLinkColors().colorFromPrimitiveValue(primitiveValue, state.style()->color(), forVisitedLink);
 }
 
@@ -594,6 +603,7 @@ StyleColor StyleBuilderConverter::convertStyleColor(StyleResolverState& state, C
     CSSPrimitiveValue* primitiveValue = toCSSPrimitiveValue(value);
     if (primitiveValue->getValueID() == CSSValueCurrentcolor)
         return StyleColor::currentColor();
+    checkForDocumentDependentColor(state, primitiveValue);
     return state.document().textLinkColors().colorFromPrimitiveValue(primitiveValue, Color(), forVisitedLink);
 }
 
@@ -350,6 +350,7 @@ void StyleBuilderFunctions::applyValueCSSPropertyResize(StyleResolverState& stat
 
     EResize r = RESIZE_NONE;
     if (primitiveValue->getValueID() == CSSValueAuto) {
+        state.setHasDocumentDependentStyle();
         if (Settings* settings = state.document().settings())
             r = settings->textAreasAreResizable() ? RESIZE_BOTH : RESIZE_NONE;
     } else {
@@ -1055,6 +1056,7 @@ void StyleBuilderFunctions::applyValueCSSPropertyWebkitAppRegion(StyleResolverSt
     if (!primitiveValue->getValueID())
         return;
     state.style()->setDraggableRegionMode(primitiveValue->getValueID() == CSSValueDrag ? DraggableRegionDrag : DraggableRegionNoDrag);
+    state.setHasDocumentDependentStyle();
     state.document().setHasAnnotatedRegions(true);
 }
 
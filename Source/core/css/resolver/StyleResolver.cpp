@@ -61,6 +61,7 @@
 #include "core/css/resolver/AnimatedStyleBuilder.h"
 #include "core/css/resolver/MatchResult.h"
 #include "core/css/resolver/MediaQueryResult.h"
+#include "core/css/resolver/ParallelRuleMatcher.h"
 #include "core/css/resolver/SharedStyleFinder.h"
 #include "core/css/resolver/StyleAdjuster.h"
 #include "core/css/resolver/StyleResolverParentScope.h"
@@ -79,6 +80,7 @@
 #include "core/inspector/InspectorInstrumentation.h"
 #include "core/rendering/RenderView.h"
 #include "core/rendering/style/KeyframeList.h"
+#include "core/rendering/style/StyleDataInterner.h"
 #include "core/svg/SVGDocumentExtensions.h"
 #include "core/svg/SVGElement.h"
 #include "core/svg/SVGFontFaceElement.h"
@@ -129,7 +131,8 @@ static void addFontFaceRule(Document* document, CSSFontSelector* cssFontSelector
 }
 
 StyleResolver::StyleResolver(Document& document)
-    : m_document(document)
+    : m_matchedPropertiesCacheScope(MatchedPropertiesCache::createPrivateScope())
+    , m_document(document)
     , m_viewportStyleResolver(ViewportStyleResolver::create(&document))
     , m_needCollectFeatures(false)
     , m_printMediaType(false)
@@ -148,6 +151,9 @@ StyleResolver::StyleResolver(Document& document)
 
     initWatchedSelectorRules(CSSSelectorWatch::from(document).watchedCallbackSelectors());
 
+    if (RuntimeEnabledFeatures::styleDataInterningEnabled())
+        m_styleDataInterner = StyleDataInterner::create();
+
 #if ENABLE(SVG_FONTS)
     if (document.svgExtensions()) {
         const WillBeHeapHashSet<RawPtrWillBeMember<SVGFontFaceElement> >& svgFontFaceElements = document.svgExtensions()->svgFontFaceElements();
@@ -328,6 +334,8 @@ void StyleResolver::addToStyleSharingList(Element& element)
     if (list.size() >= styleSharingListSize)
         list.removeLast();
     list.prepend(&element);
+    if (unsigned fingerprint = SharedStyleFinder::styleSharingFingerprint(element))
+        m_styleSharingMap.set(fingerprint, &element);
 }
 
 StyleSharingList& StyleResolver::styleSharingList()
@@ -346,6 +354,9 @@ StyleSharingList& StyleResolver::styleSharingList()
 void StyleResolver::clearStyleSharingList()
 {
     m_styleSharingLists.resize(0);
+    m_styleSharingMap.clear();
+    if (m_styleDataInterner)
+        m_styleDataInterner->clear();
 }
 
 void StyleResolver::pushParentElement(Element& parent)
@@ -370,8 +381,37 @@ void StyleResolver::popParentElement(Element& parent)
         m_selectorFilter.popParent();
 }
 
+void StyleResolver::startParallelRuleMatching(Element& root, StyleRecalcChange change)
+{
+    // Only the rule sets every element of the document matches against with
+    // the document as scope; anything else is matched on the main thread.
+    Vector<RuleSet*> ruleSets;
+    CSSDefaultStyleSheets& defaultStyleSheets = CSSDefaultStyleSheets::instance();
+    ruleSets.append(m_printMediaType ? defaultStyleSheets.defaultPrintStyle() : defaultStyleSheets.defaultStyle());
+    if (document().inQuirksMode())
+        ruleSets.append(defaultStyleSheets.defaultQuirksStyle());
+    if (ScopedStyleResolver* resolver = document().scopedStyleResolver())
+        resolver->appendRuleSetsTo(ruleSets);
+
+    m_parallelRuleMatcher = ParallelRuleMatcher::create(root, change, ruleSets);
+}
+
+void StyleResolver::finishParallelRuleMatching()
+{
+    m_parallelRuleMatcher.clear();
+}
+
 StyleResolver::~StyleResolver()
 {
+#if !ENABLE(OILPAN)
+    dispose();
+#endif
+}
+
+void StyleResolver::dispose()
+{
+    // Entries in the private scope can never be found again.
+    MatchedPropertiesCache::instance().clearScope(m_matchedPropertiesCacheScope);
 }
 
 void StyleResolver::matchAuthorRulesForShadowHost(Element* element, ElementRuleCollector& collector, bool includeEmptyRules, WillBeHeapVector<RawPtrWillBeMember<ScopedStyleResolver>, 8>& resolvers, WillBeHeapVector<RawPtrWillBeMember<ScopedStyleResolver>, 8>& resolversInShadowTree)
@@ -614,6 +654,8 @@ PassRefPtr<RenderStyle> StyleResolver::styleForElement(Element* element, RenderS
 
     {
         ElementRuleCollector collector(state.elementContext(), m_selectorFilter, state.style());
+        if (m_parallelRuleMatcher)
+            collector.setParallelRuleMatches(m_parallelRuleMatcher->matchesFor(*element));
 
         matchAllRules(state, collector, matchingBehavior != MatchAllRulesExcludingSMIL);
 
@@ -642,6 +684,15 @@ PassRefPtr<RenderStyle> StyleResolver::styleForElement(Element* element, RenderS
     if (state.style()->hasViewportUnits())
         document().setHasViewportUnits();
 
+    if (m_styleDataInterner) {
+        unsigned freedBytes = static_cast<unsigned>(m_styleDataInterner->intern(*state.style()));
+        INCREMENT_STYLE_STATS_COUNTER(*this, styleDataInterned);
+        if (stats()) {
+            stats()->styleDataFreedBytes += freedBytes;
+            statsTotals()->styleDataFreedBytes += freedBytes;
+        }
+    }
+
     // Now return the style.
     return state.takeStyle();
 }
@@ -1376,15 +1427,25 @@ static unsigned computeMatchedPropertiesHash(const MatchedProperties* properties
     return StringHasher::hashMemory(properties, sizeof(MatchedProperties) * size);
 }
 
+bool StyleResolver::canShareMatchedPropertiesCacheEntries()
+{
+    return !document().styleEngine()->usesRemUnits() && !document().styleEngine()->fontSelector()->fontFaceCache()->version();
+}
+
 void StyleResolver::invalidateMatchedPropertiesCache()
 {
-    m_matchedPropertiesCache.clear();
+    MatchedPropertiesCache& cache = MatchedPropertiesCache::instance();
+    cache.clearScope(m_matchedPropertiesCacheScope);
+    // Settings and system font changes reach every document, so shared
+    // entries have to go too.
+    if (canShareMatchedPropertiesCacheEntries())
+        cache.clearScope(MatchedPropertiesCache::sharedScope);
 }
 
 void StyleResolver::notifyResizeForViewportUnits()
 {
     collectViewportRules();
-    m_matchedPropertiesCache.clearViewportDependent();
+    MatchedPropertiesCache::instance().clearViewportDependent(m_matchedPropertiesCacheScope);
 }
 
 void StyleResolver::applyMatchedProperties(StyleResolverState& state, const MatchResult& matchResult)
@@ -1394,12 +1455,21 @@ void StyleResolver::applyMatchedProperties(StyleResolverState& state, const Matc
 
     INCREMENT_STYLE_STATS_COUNTER(*this, matchedPropertyApply);
 
+    MatchedPropertiesCache& matchedPropertiesCache = MatchedPropertiesCache::instance();
     unsigned cacheHash = matchResult.isCacheable ? computeMatchedPropertiesHash(matchResult.matchedProperties.data(), matchResult.matchedProperties.size()) : 0;
+    bool canShareCacheEntries = cacheHash && canShareMatchedPropertiesCacheEntries();
     bool applyInheritedOnly = false;
-    const CachedMatchedProperties* cachedMatchedProperties = cacheHash ? m_matchedPropertiesCache.find(cacheHash, state, matchResult) : 0;
+    const CachedMatchedProperties* cachedMatchedProperties = 0;
+    if (cacheHash) {
+        cachedMatchedProperties = matchedPropertiesCache.find(cacheHash, m_matchedPropertiesCacheScope, state, matchResult);
+        if (!cachedMatchedProperties && canShareCacheEntries)
+            cachedMatchedProperties = matchedPropertiesCache.find(cacheHash, MatchedPropertiesCache::sharedScope, state, matchResult);
+    }
 
     if (cachedMatchedProperties && MatchedPropertiesCache::isCacheable(element, state.style(), state.parentStyle())) {
         INCREMENT_STYLE_STATS_COUNTER(*this, matchedPropertyCacheHit);
+        if (cachedMatchedProperties->resolverScope != m_matchedPropertiesCacheScope)
+            INCREMENT_STYLE_STATS_COUNTER(*this, matchedPropertyCacheSharedHit);
         // We can build up the style by copying non-inherited properties from an earlier style object built using the same exact
         // style declarations. We then only need to apply the inherited properties, if any, as their values can depend on the
         // element context. This is fast and saves memory by reusing the style data structures.
@@ -1418,6 +1488,8 @@ void StyleResolver::applyMatchedProperties(StyleResolverState& state, const Matc
             return;
         }
         applyInheritedOnly = true;
+    } else if (cacheHash) {
+        INCREMENT_STYLE_STATS_COUNTER(*this, matchedPropertyCacheMiss);
     }
 
     // Now we have all of the matched rules in the appropriate order. Walk the rules and apply
@@ -1467,11 +1539,22 @@ void StyleResolver::applyMatchedProperties(StyleResolverState& state, const Matc
     applyMatchedProperties<LowPriorityProperties>(state, matchResult, true, matchResult.ranges.firstAuthorRule, matchResult.ranges.lastAuthorRule, applyInheritedOnly);
     applyMatchedProperties<LowPriorityProperties>(state, matchResult, true, matchResult.ranges.firstUARule, matchResult.ranges.lastUARule, applyInheritedOnly);
 
+    // Images and SVG documents that are not loaded yet are loaded through the
+    // fetcher of this document, so styles referencing them are not handed to
+    // other documents. Images that are already loaded belong to the shared
+    // CSSImageValue, which hands them to every document using it anyway.
+    bool loadsResources = !state.elementStyleResources().pendingImageProperties().isEmpty() || !state.elementStyleResources().pendingSVGDocuments().isEmpty();
     loadPendingResources(state);
 
     if (!cachedMatchedProperties && cacheHash && MatchedPropertiesCache::isCacheable(element, state.style(), state.parentStyle())) {
         INCREMENT_STYLE_STATS_COUNTER(*this, matchedPropertyCacheAdded);
-        m_matchedPropertiesCache.add(state.style(), state.parentStyle(), cacheHash, matchResult);
+        bool isShareable = canShareCacheEntries && !loadsResources && !state.hasDocumentDependentStyle() && !state.style()->hasViewportUnits();
+        unsigned scope = isShareable ? MatchedPropertiesCache::sharedScope : m_matchedPropertiesCacheScope;
+        unsigned evictedCount = matchedPropertiesCache.add(state.style(), state.parentStyle(), cacheHash, scope, m_matchedPropertiesCacheScope, matchResult);
+        if (stats()) {
+            stats()->matchedPropertyCacheEvicted += evictedCount;
+            statsTotals()->matchedPropertyCacheEvicted += evictedCount;
+        }
     }
 
     ASSERT(!state.fontBuilder().fontDirty());
@@ -1511,19 +1594,51 @@ void StyleResolver::enableStats(StatsReportType reportType)
         m_styleResolverStats->printMissedCandidateCount = true;
         m_styleResolverStatsTotals->printMissedCandidateCount = true;
     }
+    m_selectorFilter.setStats(m_styleResolverStats.get(), m_styleResolverStatsTotals.get());
 }
 
 void StyleResolver::disableStats()
 {
     m_styleResolverStatsSequence = 0;
+    m_selectorFilter.setStats(0, 0);
     m_styleResolverStats.clear();
     m_styleResolverStatsTotals.clear();
 }
 
+static void countUnparsedDeclarationBlocks(const WillBeHeapVector<RefPtrWillBeMember<StyleRuleBase> >& rules, unsigned& blocks, unsigned& bytes)
+{
+    for (size_t i = 0; i < rules.size(); ++i) {
+        StyleRuleBase* rule = rules[i].get();
+        if (rule->isStyleRule() && !toStyleRule(rule)->hasParsedProperties()) {
+            ++blocks;
+            bytes += toStyleRule(rule)->unparsedDeclarationBlockLength();
+        } else if (rule->isMediaRule()) {
+            countUnparsedDeclarationBlocks(toStyleRuleMedia(rule)->childRules(), blocks, bytes);
+        }
+    }
+}
+
+static void countUnparsedDeclarationBlocks(const StyleSheetContents& contents, unsigned& blocks, unsigned& bytes)
+{
+    for (size_t i = 0; i < contents.importRules().size(); ++i) {
+        if (StyleSheetContents* importedContents = contents.importRules()[i]->styleSheet())
+            countUnparsedDeclarationBlocks(*importedContents, blocks, bytes);
+    }
+    countUnparsedDeclarationBlocks(contents.childRules(), blocks, bytes);
+}
+
 void StyleResolver::printStats()
 {
     if (!m_styleResolverStats)
         return;
+    unsigned unparsedDeclarationBlocks = 0;
+    unsigned unparsedDeclarationBlockBytes = 0;
+    const WillBeHeapVector<RefPtrWillBeMember<CSSStyleSheet> >& authorSheets = document().styleEngine()->activeAuthorStyleSheets();
+    for (size_t i = 0; i < authorSheets.size(); ++i)
+        countUnparsedDeclarationBlocks(*authorSheets[i]->contents(), unparsedDeclarationBlocks, unparsedDeclarationBlockBytes);
+    m_styleResolverStats->unparsedDeclarationBlocks = m_styleResolverStatsTotals->unparsedDeclarationBlocks = unparsedDeclarationBlocks;
+    m_styleResolverStats->unparsedDeclarationBlockBytes = m_styleResolverStatsTotals->unparsedDeclarationBlockBytes = unparsedDeclarationBlockBytes;
+
     fprintf(stderr, "=== Style Resolver Stats (resolve #%u) (%s) ===\n", ++m_styleResolverStatsSequence, document().url().string().utf8().data());
     fprintf(stderr, "%s\n", m_styleResolverStats->report().utf8().data());
     fprintf(stderr, "== Totals ==\n");
@@ -1574,7 +1689,6 @@ void StyleResolver::trace(Visitor* visitor)
 {
 #if ENABLE(OILPAN)
     visitor->trace(m_keyframesRuleMap);
-    visitor->trace(m_matchedPropertiesCache);
     visitor->trace(m_viewportDependentMediaQueryResults);
     visitor->trace(m_selectorFilter);
     visitor->trace(m_viewportStyleResolver);
@@ -1584,6 +1698,7 @@ void StyleResolver::trace(Visitor* visitor)
     visitor->trace(m_watchedSelectorsRules);
     visitor->trace(m_treeBoundaryCrossingRules);
     visitor->trace(m_styleSharingLists);
+    visitor->trace(m_styleSharingMap);
     visitor->trace(m_pendingStyleSheets);
     visitor->trace(m_document);
 #endif
@@ -40,6 +40,7 @@
 #include "wtf/ListHashSet.h"
 #include "wtf/RefPtr.h"
 #include "wtf/Vector.h"
+#include "wtf/text/StringHash.h"
 
 namespace blink {
 
@@ -53,7 +54,9 @@ class Element;
 class ElementRuleCollector;
 class Interpolation;
 class MediaQueryEvaluator;
+class ParallelRuleMatcher;
 class RuleData;
+class StyleDataInterner;
 class StyleKeyframe;
 class StylePropertySet;
 class StyleResolverStats;
@@ -77,6 +80,8 @@ enum RuleMatchingBehavior {
 const unsigned styleSharingListSize = 15;
 const unsigned styleSharingMaxDepth = 32;
 typedef WillBeHeapDeque<RawPtrWillBeMember<Element>, styleSharingListSize> StyleSharingList;
+// Maps SharedStyleFinder::styleSharingFingerprint() to the most recent candidate with that fingerprint.
+typedef WillBeHeapHashMap<unsigned, RawPtrWillBeMember<Element>, AlreadyHashed> StyleSharingMap;
 
 struct CSSPropertyValue {
     STACK_ALLOCATED();
@@ -96,6 +101,11 @@ public:
     explicit StyleResolver(Document&);
     virtual ~StyleResolver();
 
+    // Drops the entries of the shared MatchedPropertiesCache only this
+    // resolver can use. Called before the resolver goes away.
+    void dispose();
+    unsigned matchedPropertiesCacheScope() const { return m_matchedPropertiesCacheScope; }
+
     // FIXME: StyleResolver should not be keeping tree-walk state.
     // These should move to some global tree-walk state, or should be contained in a
     // TreeWalkContext or similar which is passed in to StyleResolver methods when available.
@@ -103,6 +113,11 @@ public:
     void pushParentElement(Element&);
     void popParentElement(Element&);
 
+    // Matches rules up front on worker threads for the elements a style recalc
+    // of |root| is going to resolve, when there are enough of them.
+    void startParallelRuleMatching(Element& root, StyleRecalcChange);
+    void finishParallelRuleMatching();
+
     PassRefPtr<RenderStyle> styleForElement(Element*, RenderStyle* parentStyle = 0, StyleSharingBehavior = AllowStyleSharing,
         RuleMatchingBehavior = MatchAllRules);
 
@@ -183,6 +198,7 @@ public:
     }
 
     StyleSharingList& styleSharingList();
+    Element* styleSharingCandidate(unsigned fingerprint) const { return m_styleSharingMap.get(fingerprint); }
 
     bool hasRulesForId(const AtomicString&) const;
 
@@ -273,7 +289,12 @@ private:
 
     void cacheBorderAndBackground();
 
-    MatchedPropertiesCache m_matchedPropertiesCache;
+    // Styles computed for the document can be used by other documents unless
+    // they depend on its web fonts or on its root font size.
+    bool canShareMatchedPropertiesCacheEntries();
+
+    // The scope of MatchedPropertiesCache entries only this resolver uses.
+    unsigned m_matchedPropertiesCacheScope;
 
     OwnPtr<MediaQueryEvaluator> m_medium;
     MediaQueryResultList m_viewportDependentMediaQueryResults;
@@ -300,6 +321,12 @@ private:
 
     unsigned m_styleSharingDepth;
     WillBeHeapVector<OwnPtrWillBeMember<StyleSharingList>, styleSharingMaxDepth> m_styleSharingLists;
+    // Unlike the lists above this is not limited to recent elements at one depth, so
+    // candidates are found among cousins that have long dropped out of the lists.
+    StyleSharingMap m_styleSharingMap;
+
+    OwnPtr<ParallelRuleMatcher> m_parallelRuleMatcher;
+    OwnPtr<StyleDataInterner> m_styleDataInterner;
 
     OwnPtr<StyleResolverStats> m_styleResolverStats;
     OwnPtr<StyleResolverStats> m_styleResolverStatsTotals;
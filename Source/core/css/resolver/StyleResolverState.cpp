@@ -37,6 +37,7 @@ StyleResolverState::StyleResolverState(Document& document, Element* element, Ren
     , m_parentStyle(parentStyle)
     , m_applyPropertyToRegularStyle(true)
     , m_applyPropertyToVisitedLinkStyle(false)
+    , m_hasDocumentDependentStyle(false)
     , m_lineHeightValue(nullptr)
     , m_styleMap(*this, m_elementStyleResources)
 {
@@ -85,6 +85,12 @@ public:
     bool applyPropertyToRegularStyle() const { return m_applyPropertyToRegularStyle; }
     bool applyPropertyToVisitedLinkStyle() const { return m_applyPropertyToVisitedLinkStyle; }
 
+    // Set when a property was applied using settings or colors of the
+    // document, or with side effects on it. Other documents must then apply
+    // the properties themselves rather than reuse the style.
+    void setHasDocumentDependentStyle() { m_hasDocumentDependentStyle = true; }
+    bool hasDocumentDependentStyle() const { return m_hasDocumentDependentStyle; }
+
     // Holds all attribute names found while applying "content" properties that contain an "attr()" value.
     Vector<AtomicString>& contentAttrValues() { return m_contentAttrValues; }
 
@@ -147,6 +153,7 @@ private:
 
     bool m_applyPropertyToRegularStyle;
     bool m_applyPropertyToVisitedLinkStyle;
+    bool m_hasDocumentDependentStyle;
 
     RawPtrWillBeMember<CSSValue> m_lineHeightValue;
 
@@ -31,6 +31,8 @@
 #include "config.h"
 #include "core/css/resolver/StyleResolverStats.h"
 
+#include "core/css/StylePropertySet.h"
+#include "core/rendering/style/RenderStyle.h"
 #include "wtf/text/CString.h"
 #include "wtf/text/StringBuilder.h"
 
@@ -47,10 +49,23 @@ void StyleResolverStats::reset()
     sharedStyleRejectedByUncommonAttributeRules = 0;
     sharedStyleRejectedBySiblingRules = 0;
     sharedStyleRejectedByParent = 0;
+    sharedStyleFoundByFingerprint = 0;
+    sharedStyleFingerprintMismatches = 0;
     matchedPropertyApply = 0;
     matchedPropertyCacheHit = 0;
     matchedPropertyCacheInheritedHit = 0;
+    matchedPropertyCacheSharedHit = 0;
+    matchedPropertyCacheMiss = 0;
     matchedPropertyCacheAdded = 0;
+    matchedPropertyCacheEvicted = 0;
+    selectorFilterChecks = 0;
+    selectorFilterRejectedByAncestors = 0;
+    selectorFilterRejectedByAttributes = 0;
+    selectorFilterRejectedBySiblings = 0;
+    styleDataInterned = 0;
+    styleDataFreedBytes = 0;
+    unparsedDeclarationBlocks = 0;
+    unparsedDeclarationBlockBytes = 0;
 }
 
 String StyleResolverStats::report() const
@@ -63,6 +78,7 @@ String StyleResolverStats::report() const
     output.appendLiteral("Style sharing:\n");
     output.append(String::format("  %u elements were added to the sharing candidate list.\n", sharedStyleCandidates));
     output.append(String::format("  %u calls were made to findSharedStyle, %u found a candidate to share with (%.2f%%).\n", sharedStyleLookups, sharedStyleFound, PERCENT(sharedStyleFound, sharedStyleLookups)));
+    output.append(String::format("  %u candidates were found by fingerprint (%.2f%%), %u fingerprint matches could not share.\n", sharedStyleFoundByFingerprint, PERCENT(sharedStyleFoundByFingerprint, sharedStyleFound), sharedStyleFingerprintMismatches));
     if (printMissedCandidateCount)
         output.append(String::format("  %u candidates could have matched but were not in the list when searching (%.2f%%).\n", sharedStyleMissed, PERCENT(sharedStyleMissed, sharedStyleLookups)));
     output.append(String::format("  %u of found styles were rejected (%.2f%%), %.2f%% by uncommon attribute rules, %.2f%% by sibling rules and %.2f%% by parents disabling sharing.\n",
@@ -73,13 +89,38 @@ String StyleResolverStats::report() const
         PERCENT(sharedStyleRejectedByParent, sharedStylesRejected)));
     output.append(String::format("  %u of found styles were used for sharing (%.2f%%).\n", sharedStylesUsed, PERCENT(sharedStylesUsed, sharedStyleFound)));
     output.append(String::format("  %.2f%% of calls to findSharedStyle returned a shared style.\n", PERCENT(sharedStylesUsed, sharedStyleLookups)));
+    output.append(String::format("  Sharing saved at least %.1f KB of RenderStyles.\n", sharedStylesUsed * sizeof(RenderStyle) / 1024.0));
 
     output.append('\n');
 
     output.appendLiteral("Matched property cache:\n");
     output.append(String::format("  %u calls to applyMatchedProperties, %u hit the cache (%.2f%%).\n", matchedPropertyApply, matchedPropertyCacheHit, PERCENT(matchedPropertyCacheHit, matchedPropertyApply)));
     output.append(String::format("  %u cache hits also shared the inherited style (%.2f%%).\n", matchedPropertyCacheInheritedHit, PERCENT(matchedPropertyCacheInheritedHit, matchedPropertyCacheHit)));
+    output.append(String::format("  %u cache hits used entries added by other documents (%.2f%%).\n", matchedPropertyCacheSharedHit, PERCENT(matchedPropertyCacheSharedHit, matchedPropertyCacheHit)));
+    output.append(String::format("  %u cache lookups missed (%.2f%%).\n", matchedPropertyCacheMiss, PERCENT(matchedPropertyCacheMiss, matchedPropertyCacheHit + matchedPropertyCacheMiss)));
     output.append(String::format("  %u styles created in applyMatchedProperties were added to the cache (%.2f%%).\n", matchedPropertyCacheAdded, PERCENT(matchedPropertyCacheAdded, matchedPropertyApply)));
+    output.append(String::format("  %u cache entries were evicted.\n", matchedPropertyCacheEvicted));
+
+    output.append('\n');
+
+    unsigned selectorFilterRejected = selectorFilterRejectedByAncestors + selectorFilterRejectedByAttributes + selectorFilterRejectedBySiblings;
+    output.appendLiteral("Selector filter:\n");
+    output.append(String::format("  %u rules were checked against the filter, %u were rejected (%.2f%%).\n", selectorFilterChecks, selectorFilterRejected, PERCENT(selectorFilterRejected, selectorFilterChecks)));
+    output.append(String::format("  %.2f%% of rejections were by ancestor tags, ids and classes, %.2f%% by ancestor attributes and %.2f%% by siblings.\n",
+        PERCENT(selectorFilterRejectedByAncestors, selectorFilterRejected),
+        PERCENT(selectorFilterRejectedByAttributes, selectorFilterRejected),
+        PERCENT(selectorFilterRejectedBySiblings, selectorFilterRejected)));
+    output.append('\n');
+
+    output.appendLiteral("Style data interning:\n");
+    output.append(String::format("  %u styles were interned, %u bytes of data groups were freed (%.1f bytes per style).\n",
+        styleDataInterned, styleDataFreedBytes, styleDataInterned ? static_cast<double>(styleDataFreedBytes) / styleDataInterned : 0));
+    output.append('\n');
+
+    output.appendLiteral("Lazy declaration parsing:\n");
+    output.append(String::format("  %u declaration blocks of active author style sheets were never needed and are not parsed.\n", unparsedDeclarationBlocks));
+    output.append(String::format("  %u bytes of declaration text and about %u bytes of StylePropertySets are saved.\n",
+        unparsedDeclarationBlockBytes, unparsedDeclarationBlocks * StylePropertySet::averageSizeInBytes()));
 
     return output.toString();
 }
@@ -53,10 +53,26 @@ public:
     unsigned sharedStyleRejectedByUncommonAttributeRules;
     unsigned sharedStyleRejectedBySiblingRules;
     unsigned sharedStyleRejectedByParent;
+    unsigned sharedStyleFoundByFingerprint;
+    unsigned sharedStyleFingerprintMismatches;
     unsigned matchedPropertyApply;
     unsigned matchedPropertyCacheHit;
     unsigned matchedPropertyCacheInheritedHit;
+    unsigned matchedPropertyCacheSharedHit;
+    unsigned matchedPropertyCacheMiss;
     unsigned matchedPropertyCacheAdded;
+    unsigned matchedPropertyCacheEvicted;
+    unsigned selectorFilterChecks;
+    unsigned selectorFilterRejectedByAncestors;
+    unsigned selectorFilterRejectedByAttributes;
+    unsigned selectorFilterRejectedBySiblings;
+    unsigned styleDataInterned;
+    unsigned styleDataFreedBytes;
+
+    // Not counters: StyleResolver sets these from the active author sheets
+    // before printing a report.
+    unsigned unparsedDeclarationBlocks;
+    unsigned unparsedDeclarationBlockBytes;
 
     // We keep a separate flag for this since crawling the entire document to print
     // the number of missed candidates is very slow.
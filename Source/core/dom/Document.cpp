@@ -1871,8 +1871,12 @@ void Document::updateStyle(StyleRecalcChange change)
     if (Element* documentElement = this->documentElement()) {
         inheritHtmlAndBodyElementStyles(change);
         dirtyElementsForLayerUpdate();
-        if (documentElement->shouldCallRecalcStyle(change))
+        if (documentElement->shouldCallRecalcStyle(change)) {
+            if (RuntimeEnabledFeatures::parallelRuleMatchingEnabled())
+                ensureStyleResolver().startParallelRuleMatching(*documentElement, change);
             documentElement->recalcStyle(change);
+            ensureStyleResolver().finishParallelRuleMatching();
+        }
         while (dirtyElementsForLayerUpdate())
             documentElement->recalcStyle(NoChange);
     }
@@ -2428,7 +2428,7 @@ void Node::setCustomElementState(CustomElementState newState)
     setFlag(newState == Upgraded, CustomElementUpgradedFlag);
 
     if (oldState == NotCustomElement || newState == Upgraded)
-        setNeedsStyleRecalc(SubtreeStyleChange); // :unresolved has changed
+        toElement(this)->pseudoStateChanged(CSSSelector::PseudoUnresolved);
 }
 
 void Node::trace(Visitor* visitor)
@@ -33,6 +33,7 @@
 #include "core/css/CSSStyleSheet.h"
 #include "core/css/FontFaceCache.h"
 #include "core/css/StyleSheetContents.h"
+#include "core/css/StyleSheetContentsCache.h"
 #include "core/dom/DocumentStyleSheetCollector.h"
 #include "core/dom/Element.h"
 #include "core/dom/ProcessingInstruction.h"
@@ -46,6 +47,7 @@
 #include "core/page/Page.h"
 #include "core/frame/Settings.h"
 #include "platform/URLPatternMatcher.h"
+#include "platform/weborigin/SecurityOrigin.h"
 
 namespace blink {
 
@@ -504,8 +506,10 @@ void StyleEngine::clearResolver()
         const_cast<TreeScope&>((*it)->treeScope()).clearScopedStyleResolver();
     m_scopedStyleResolvers.clear();
 
-    if (m_resolver)
+    if (m_resolver) {
         document().updateStyleInvalidationIfNeeded();
+        m_resolver->dispose();
+    }
     m_resolver.clear();
 }
 
@@ -631,6 +635,13 @@ static bool isCacheableForStyleElement(const StyleSheetContents& contents)
     return true;
 }
 
+// RuleSets built from contents shared with other documents assume that the
+// rules have the security origin of the document, see ScopedStyleResolver::addRulesFromSheet().
+static bool canShareContentsWithOtherDocuments(const Document& document)
+{
+    return document.securityOrigin()->canRequest(document.baseURL());
+}
+
 PassRefPtrWillBeRawPtr<CSSStyleSheet> StyleEngine::createSheet(Element* e, const String& text, TextPosition startPosition, bool createdByParser)
 {
     RefPtrWillBeRawPtr<CSSStyleSheet> styleSheet = nullptr;
@@ -642,10 +653,25 @@ PassRefPtrWillBeRawPtr<CSSStyleSheet> StyleEngine::createSheet(Element* e, const
 
         WillBeHeapHashMap<AtomicString, RawPtrWillBeMember<StyleSheetContents> >::AddResult result = m_textToSheetCache.add(textContent, nullptr);
         if (result.isNewEntry || !result.storedValue->value) {
-            styleSheet = StyleEngine::parseSheet(e, text, startPosition, createdByParser);
-            if (result.isNewEntry && isCacheableForStyleElement(*styleSheet->contents())) {
-                result.storedValue->value = styleSheet->contents();
-                m_sheetToTextCache.add(styleSheet->contents(), textContent);
+            bool canShareContents = canShareContentsWithOtherDocuments(e->document());
+            RefPtrWillBeRawPtr<StyleSheetContents> sharedContents = nullptr;
+            if (canShareContents)
+                sharedContents = StyleSheetContentsCache::instance().find(textContent, CSSParserContext(e->document(), 0, KURL(), e->document().inputEncoding()));
+            if (sharedContents) {
+                styleSheet = CSSStyleSheet::createInline(sharedContents.release(), e, startPosition);
+            } else {
+                styleSheet = StyleEngine::parseSheet(e, text, startPosition, createdByParser);
+                if (canShareContents && isCacheableForStyleElement(*styleSheet->contents()))
+                    StyleSheetContentsCache::instance().add(textContent, styleSheet->contents());
+            }
+
+            // Entries of this cache have a single owner document, which the
+            // contents other documents can share may not keep.
+            StyleSheetContents* contents = styleSheet->contents();
+            bool isSharedWithOtherDocuments = canShareContents && !contents->hasMediaQueries();
+            if (result.isNewEntry && !isSharedWithOtherDocuments && isCacheableForStyleElement(*contents)) {
+                result.storedValue->value = contents;
+                m_sheetToTextCache.add(contents, textContent);
             }
         } else {
             StyleSheetContents* contents = result.storedValue->value;
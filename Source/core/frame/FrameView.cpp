@@ -102,7 +102,6 @@ FrameView::FrameView(LocalFrame* frame)
     , m_canHaveScrollbars(true)
     , m_slowRepaintObjectCount(0)
     , m_hasPendingLayout(false)
-    , m_layoutSubtreeRoot(0)
     , m_inSynchronousPostLayout(false)
     , m_postLayoutTasksTimer(this, &FrameView::postLayoutTimerFired)
     , m_updateWidgetsTimer(this, &FrameView::updateWidgetsTimerFired)
@@ -180,13 +179,14 @@ FrameView::~FrameView()
 void FrameView::reset()
 {
     m_hasPendingLayout = false;
-    m_layoutSubtreeRoot = 0;
+    m_layoutSubtreeRoots.clear();
     m_doFullPaintInvalidation = false;
     m_layoutSchedulingEnabled = true;
     m_inPerformLayout = false;
     m_canInvalidatePaintDuringPerformLayout = false;
     m_inSynchronousPostLayout = false;
     m_layoutCount = 0;
+    m_cachedLayoutResultCount = 0;
     m_nestedLayoutCount = 0;
     m_postLayoutTasksTimer.stop();
     m_updateWidgetsTimer.stop();
@@ -650,9 +650,19 @@ bool FrameView::isEnclosedInCompositingLayer() const
     return frameOwnerRenderer && frameOwnerRenderer->enclosingLayer()->enclosingLayerForPaintInvalidationCrossingFrameBoundaries();
 }
 
-RenderObject* FrameView::layoutRoot(bool onlyDuringLayout) const
+bool FrameView::isLayoutSubtreeRoot(const RenderObject& renderer, bool onlyDuringLayout) const
 {
-    return onlyDuringLayout && layoutPending() ? 0 : m_layoutSubtreeRoot;
+    if (onlyDuringLayout && layoutPending())
+        return false;
+    return m_layoutSubtreeRoots.contains(const_cast<RenderObject*>(&renderer));
+}
+
+void FrameView::clearLayoutSubtreeRootsAndMarkContainingBlocks()
+{
+    HashSet<RenderObject*>::iterator end = m_layoutSubtreeRoots.end();
+    for (HashSet<RenderObject*>::iterator it = m_layoutSubtreeRoots.begin(); it != end; ++it)
+        (*it)->markContainingBlocksForLayout(false);
+    m_layoutSubtreeRoots.clear();
 }
 
 inline void FrameView::forceLayoutParentViewIfNeeded()
@@ -721,9 +731,11 @@ void FrameView::performPreLayoutTasks()
     lifecycle().advanceTo(DocumentLifecycle::StyleClean);
 }
 
-void FrameView::performLayout(RenderObject* rootForThisLayout, bool inSubtreeLayout)
+void FrameView::performLayout(const Vector<RenderObject*>& rootsForThisLayout, bool inSubtreeLayout)
 {
-    TRACE_EVENT0("blink", "FrameView::performLayout");
+    // The number of roots is the number of subtrees that are laid out
+    // independently of each other.
+    TRACE_EVENT1("blink", "FrameView::performLayout", "roots", static_cast<unsigned>(rootsForThisLayout.size()));
 
     ScriptForbiddenScope forbidScript;
 
@@ -736,13 +748,16 @@ void FrameView::performLayout(RenderObject* rootForThisLayout, bool inSubtreeLay
     // FIXME: The 300 other lines in layout() probably belong in other helper functions
     // so that a single human could understand what layout() is actually doing.
 
-    LayoutState layoutState(*rootForThisLayout);
-
     forceLayoutParentViewIfNeeded();
 
-    // FIXME (crbug.com/256657): Do not do two layouts for text autosizing.
-    rootForThisLayout->layout();
-    gatherDebugLayoutRects(rootForThisLayout);
+    for (size_t i = 0; i < rootsForThisLayout.size(); ++i) {
+        RenderObject* rootForThisLayout = rootsForThisLayout[i];
+        LayoutState layoutState(*rootForThisLayout);
+
+        // FIXME (crbug.com/256657): Do not do two layouts for text autosizing.
+        rootForThisLayout->layout();
+        gatherDebugLayoutRects(rootForThisLayout);
+    }
 
     ResourceLoadPriorityOptimizer::resourceLoadPriorityOptimizer()->updateAllImageResourcePriorities();
 
@@ -806,10 +821,8 @@ void FrameView::layout(bool allowSubtree)
     // FIXME(361045): remove InspectorInstrumentation calls once DevTools Timeline migrates to tracing.
     InspectorInstrumentationCookie cookie = InspectorInstrumentation::willLayout(m_frame.get());
 
-    if (!allowSubtree && isSubtreeLayout()) {
-        m_layoutSubtreeRoot->markContainingBlocksForLayout(false);
-        m_layoutSubtreeRoot = 0;
-    }
+    if (!allowSubtree && isSubtreeLayout())
+        clearLayoutSubtreeRootsAndMarkContainingBlocks();
 
     performPreLayoutTasks();
 
@@ -820,15 +833,20 @@ void FrameView::layout(bool allowSubtree)
 
     Document* document = m_frame->document();
     bool inSubtreeLayout = isSubtreeLayout();
-    RenderObject* rootForThisLayout = inSubtreeLayout ? m_layoutSubtreeRoot : document->renderView();
-    if (!rootForThisLayout) {
+    Vector<RenderObject*> rootsForThisLayout;
+    if (inSubtreeLayout)
+        copyToVector(m_layoutSubtreeRoots, rootsForThisLayout);
+    else if (document->renderView())
+        rootsForThisLayout.append(document->renderView());
+    if (rootsForThisLayout.isEmpty()) {
         // FIXME: Do we need to set m_size here?
         ASSERT_NOT_REACHED();
         return;
     }
+    RenderObject* rootForThisLayout = rootsForThisLayout[0];
 
     FontCachePurgePreventer fontCachePurgePreventer;
-    RenderLayer* layer;
+    Vector<RenderLayer*> layers;
     {
         TemporaryChange<bool> changeSchedulingEnabled(m_layoutSchedulingEnabled, false);
 
@@ -896,22 +914,29 @@ void FrameView::layout(bool allowSubtree)
             m_doFullPaintInvalidation |= renderView()->shouldDoFullPaintInvalidationForNextLayout();
         }
 
-        layer = rootForThisLayout->enclosingLayer();
+        for (size_t i = 0; i < rootsForThisLayout.size(); ++i) {
+            RenderLayer* layer = rootsForThisLayout[i]->enclosingLayer();
+            if (!layers.contains(layer))
+                layers.append(layer);
+        }
 
-        performLayout(rootForThisLayout, inSubtreeLayout);
+        performLayout(rootsForThisLayout, inSubtreeLayout);
 
-        m_layoutSubtreeRoot = 0;
+        m_layoutSubtreeRoots.clear();
         // We need to ensure that we mark up all renderers up to the RenderView
         // for paint invalidation. This simplifies our code as we just always
         // do a full tree walk.
-        if (RenderObject* container = rootForThisLayout->container())
-            container->setMayNeedPaintInvalidation(true);
+        for (size_t i = 0; i < rootsForThisLayout.size(); ++i) {
+            if (RenderObject* container = rootsForThisLayout[i]->container())
+                container->setMayNeedPaintInvalidation(true);
+        }
     } // Reset m_layoutSchedulingEnabled to its previous value.
 
     if (!inSubtreeLayout && !toRenderView(rootForThisLayout)->document().printing())
         adjustViewSize();
 
-    layer->updateLayerPositionsAfterLayout();
+    for (size_t i = 0; i < layers.size(); ++i)
+        layers[i]->updateLayerPositionsAfterLayout();
 
     renderView()->compositor()->didLayout();
 
@@ -919,12 +944,17 @@ void FrameView::layout(bool allowSubtree)
 
     if (AXObjectCache* cache = rootForThisLayout->document().axObjectCache()) {
         const KURL& url = rootForThisLayout->document().url();
-        if (url.isValid() && !url.isAboutBlankURL())
-            cache->handleLayoutComplete(rootForThisLayout);
+        if (url.isValid() && !url.isAboutBlankURL()) {
+            for (size_t i = 0; i < rootsForThisLayout.size(); ++i)
+                cache->handleLayoutComplete(rootsForThisLayout[i]);
+        }
     }
     updateAnnotatedRegions();
 
-    ASSERT(!rootForThisLayout->needsLayout());
+#if ENABLE(ASSERT)
+    for (size_t i = 0; i < rootsForThisLayout.size(); ++i)
+        ASSERT(!rootsForThisLayout[i]->needsLayout());
+#endif
 
     if (document->hasListenerType(Document::OVERFLOWCHANGED_LISTENER))
         updateOverflowStatus(layoutSize().width() < contentsWidth(), layoutSize().height() < contentsHeight());
@@ -1734,10 +1764,8 @@ void FrameView::scheduleRelayout()
 {
     ASSERT(m_frame->view() == this);
 
-    if (isSubtreeLayout()) {
-        m_layoutSubtreeRoot->markContainingBlocksForLayout(false);
-        m_layoutSubtreeRoot = 0;
-    }
+    if (isSubtreeLayout())
+        clearLayoutSubtreeRootsAndMarkContainingBlocks();
     if (!m_layoutSchedulingEnabled)
         return;
     if (!needsLayout())
@@ -1782,27 +1810,43 @@ void FrameView::scheduleRelayoutOfSubtree(RenderObject* relayoutRoot)
     }
 
     if (layoutPending() || !m_layoutSchedulingEnabled) {
-        if (m_layoutSubtreeRoot != relayoutRoot) {
-            if (isObjectAncestorContainerOf(m_layoutSubtreeRoot, relayoutRoot)) {
+        if (isSubtreeLayout() && !m_layoutSubtreeRoots.contains(relayoutRoot)) {
+            RenderObject* containingRoot = 0;
+            Vector<RenderObject*> containedRoots;
+            HashSet<RenderObject*>::iterator end = m_layoutSubtreeRoots.end();
+            for (HashSet<RenderObject*>::iterator it = m_layoutSubtreeRoots.begin(); it != end; ++it) {
+                if (isObjectAncestorContainerOf(*it, relayoutRoot))
+                    containingRoot = *it;
+                else if (isObjectAncestorContainerOf(relayoutRoot, *it))
+                    containedRoots.append(*it);
+            }
+
+            if (containingRoot) {
                 // Keep the current root
-                relayoutRoot->markContainingBlocksForLayout(false, m_layoutSubtreeRoot);
-                ASSERT(!m_layoutSubtreeRoot->container() || !m_layoutSubtreeRoot->container()->needsLayout());
-            } else if (isSubtreeLayout() && isObjectAncestorContainerOf(relayoutRoot, m_layoutSubtreeRoot)) {
-                // Re-root at relayoutRoot
-                m_layoutSubtreeRoot->markContainingBlocksForLayout(false, relayoutRoot);
-                m_layoutSubtreeRoot = relayoutRoot;
-                ASSERT(!m_layoutSubtreeRoot->container() || !m_layoutSubtreeRoot->container()->needsLayout());
+                relayoutRoot->markContainingBlocksForLayout(false, containingRoot);
+                ASSERT(!containingRoot->container() || !containingRoot->container()->needsLayout());
+            } else if (!containedRoots.isEmpty() || (RuntimeEnabledFeatures::multipleLayoutRootsEnabled() && !isInPerformLayout())) {
+                // Re-root at relayoutRoot the roots it contains. A relayout boundary does not
+                // affect the layout of anything outside it, so the other roots are kept.
+                for (size_t i = 0; i < containedRoots.size(); ++i) {
+                    containedRoots[i]->markContainingBlocksForLayout(false, relayoutRoot);
+                    m_layoutSubtreeRoots.remove(containedRoots[i]);
+                }
+                m_layoutSubtreeRoots.add(relayoutRoot);
+                ASSERT(!relayoutRoot->container() || !relayoutRoot->container()->needsLayout());
             } else {
                 // Just do a full relayout
-                if (isSubtreeLayout())
-                    m_layoutSubtreeRoot->markContainingBlocksForLayout(false);
-                m_layoutSubtreeRoot = 0;
+                clearLayoutSubtreeRootsAndMarkContainingBlocks();
                 relayoutRoot->markContainingBlocksForLayout(false);
             }
+        } else if (!isSubtreeLayout()) {
+            // A full relayout is pending.
+            relayoutRoot->markContainingBlocksForLayout(false);
         }
     } else if (m_layoutSchedulingEnabled) {
-        m_layoutSubtreeRoot = relayoutRoot;
-        ASSERT(!m_layoutSubtreeRoot->container() || !m_layoutSubtreeRoot->container()->needsLayout());
+        m_layoutSubtreeRoots.clear();
+        m_layoutSubtreeRoots.add(relayoutRoot);
+        ASSERT(!relayoutRoot->container() || !relayoutRoot->container()->needsLayout());
         m_hasPendingLayout = true;
 
         page()->animator().scheduleVisualUpdate();
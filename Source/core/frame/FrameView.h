@@ -32,6 +32,7 @@
 #include "platform/graphics/Color.h"
 #include "platform/scroll/ScrollView.h"
 #include "wtf/Forward.h"
+#include "wtf/HashSet.h"
 #include "wtf/OwnPtr.h"
 #include "wtf/text/WTFString.h"
 
@@ -100,9 +101,15 @@ public:
     void setCanInvalidatePaintDuringPerformLayout(bool b) { m_canInvalidatePaintDuringPerformLayout = b; }
     bool canInvalidatePaintDuringPerformLayout() const { return m_canInvalidatePaintDuringPerformLayout; }
 
-    RenderObject* layoutRoot(bool onlyDuringLayout = false) const;
-    void clearLayoutSubtreeRoot() { m_layoutSubtreeRoot = 0; }
+    // The roots of the subtrees that the pending or current layout is limited to.
+    // None of them contains another, so each can be laid out on its own.
+    const HashSet<RenderObject*>& layoutSubtreeRoots() const { return m_layoutSubtreeRoots; }
+    bool isLayoutSubtreeRoot(const RenderObject&, bool onlyDuringLayout = false) const;
+    void clearLayoutSubtreeRoot(const RenderObject& root) { m_layoutSubtreeRoots.remove(const_cast<RenderObject*>(&root)); }
     int layoutCount() const { return m_layoutCount; }
+    // The number of boxes that kept the result of their previous layout.
+    unsigned cachedLayoutResultCount() const { return m_cachedLayoutResultCount; }
+    void didUseCachedLayoutResult() { ++m_cachedLayoutResultCount; }
 
     bool needsLayout() const;
     void setNeedsLayout();
@@ -315,7 +322,7 @@ public:
     // FIXME: This should probably be renamed as the 'inSubtreeLayout' parameter
     // passed around the FrameView layout methods can be true while this returns
     // false.
-    bool isSubtreeLayout() const { return !!m_layoutSubtreeRoot; }
+    bool isSubtreeLayout() const { return !m_layoutSubtreeRoots.isEmpty(); }
 
     // Sets the tickmarks for the FrameView, overriding the default behavior
     // which is to display the tickmarks corresponding to find results.
@@ -372,7 +379,8 @@ private:
     void updateCounters();
     void forceLayoutParentViewIfNeeded();
     void performPreLayoutTasks();
-    void performLayout(RenderObject* rootForThisLayout, bool inSubtreeLayout);
+    void performLayout(const Vector<RenderObject*>& rootsForThisLayout, bool inSubtreeLayout);
+    void clearLayoutSubtreeRootsAndMarkContainingBlocks();
     void scheduleOrPerformPostLayoutTasks();
     void performPostLayoutTasks();
 
@@ -458,13 +466,14 @@ private:
     unsigned m_slowRepaintObjectCount;
 
     bool m_hasPendingLayout;
-    RenderObject* m_layoutSubtreeRoot;
+    HashSet<RenderObject*> m_layoutSubtreeRoots;
 
     bool m_layoutSchedulingEnabled;
     bool m_inPerformLayout;
     bool m_canInvalidatePaintDuringPerformLayout;
     bool m_inSynchronousPostLayout;
     int m_layoutCount;
+    unsigned m_cachedLayoutResultCount;
     unsigned m_nestedLayoutCount;
     Timer<FrameView> m_postLayoutTasksTimer;
     Timer<FrameView> m_updateWidgetsTimer;
@@ -0,0 +1,125 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "config.h"
+#include "core/frame/FrameView.h"
+
+#include "core/HTMLNames.h"
+#include "core/dom/Element.h"
+#include "core/rendering/RenderBox.h"
+#include "core/rendering/RenderView.h"
+#include "core/rendering/RenderingTestHelper.h"
+#include "platform/RuntimeEnabledFeatures.h"
+#include <gtest/gtest.h>
+
+namespace blink {
+
+namespace {
+
+// Runs each test with MultipleLayoutRoots disabled and enabled.
+class FrameViewLayoutRootsTest : public RenderingTest, public testing::WithParamInterface<bool> {
+protected:
+    virtual void SetUp() OVERRIDE
+    {
+        m_wasEnabled = RuntimeEnabledFeatures::multipleLayoutRootsEnabled();
+        RuntimeEnabledFeatures::setMultipleLayoutRootsEnabled(GetParam());
+        RenderingTest::SetUp();
+        setBodyInnerHTML("<style>.boundary { width: 200px; height: 200px; overflow: hidden }</style>"
+            "<div id='first' class='boundary'><div id='firstContent'>First</div>"
+            "<div id='nested' class='boundary' style='width: 100px; height: 100px'><div id='nestedContent'>Nested</div></div></div>"
+            "<div id='second' class='boundary'><div id='secondContent'>Second</div></div>");
+    }
+
+    virtual void TearDown() OVERRIDE
+    {
+        RuntimeEnabledFeatures::setMultipleLayoutRootsEnabled(m_wasEnabled);
+    }
+
+    RenderBox* renderBox(const char* id) const
+    {
+        return toRenderBox(document().getElementById(AtomicString(id))->renderer());
+    }
+
+    // Changes the height of the element, which schedules a layout of the
+    // subtree of the relayout boundary containing it.
+    void setHeight(const char* id, const char* height)
+    {
+        document().getElementById(AtomicString(id))->setAttribute(HTMLNames::styleAttr, AtomicString(String::format("height: %s", height)));
+        document().updateRenderTreeIfNeeded();
+    }
+
+    const HashSet<RenderObject*>& layoutSubtreeRoots() const { return document().view()->layoutSubtreeRoots(); }
+
+    void updateLayout()
+    {
+        document().view()->updateLayoutAndStyleIfNeededRecursive();
+        EXPECT_FALSE(document().view()->needsLayout());
+        EXPECT_TRUE(layoutSubtreeRoots().isEmpty());
+    }
+
+private:
+    bool m_wasEnabled;
+};
+
+INSTANTIATE_TEST_CASE_P(MultipleLayoutRoots, FrameViewLayoutRootsTest, testing::Bool());
+
+TEST_P(FrameViewLayoutRootsTest, DisjointRoots)
+{
+    setHeight("firstContent", "30px");
+    EXPECT_EQ(1u, layoutSubtreeRoots().size());
+    EXPECT_TRUE(layoutSubtreeRoots().contains(renderBox("first")));
+
+    setHeight("secondContent", "40px");
+    if (RuntimeEnabledFeatures::multipleLayoutRootsEnabled()) {
+        EXPECT_EQ(2u, layoutSubtreeRoots().size());
+        EXPECT_TRUE(layoutSubtreeRoots().contains(renderBox("first")));
+        EXPECT_TRUE(layoutSubtreeRoots().contains(renderBox("second")));
+        EXPECT_FALSE(document().renderView()->needsLayout());
+    } else {
+        // Two roots turn into a full layout.
+        EXPECT_TRUE(layoutSubtreeRoots().isEmpty());
+        EXPECT_TRUE(document().renderView()->needsLayout());
+    }
+
+    updateLayout();
+    EXPECT_EQ(LayoutUnit(30), renderBox("firstContent")->height());
+    EXPECT_EQ(LayoutUnit(40), renderBox("secondContent")->height());
+}
+
+TEST_P(FrameViewLayoutRootsTest, RootInExistingRoot)
+{
+    setHeight("firstContent", "30px");
+    EXPECT_TRUE(layoutSubtreeRoots().contains(renderBox("first")));
+
+    // The existing root already covers the new one.
+    setHeight("nestedContent", "20px");
+    EXPECT_EQ(1u, layoutSubtreeRoots().size());
+    EXPECT_TRUE(layoutSubtreeRoots().contains(renderBox("first")));
+    EXPECT_FALSE(document().renderView()->needsLayout());
+
+    updateLayout();
+    EXPECT_EQ(LayoutUnit(30), renderBox("firstContent")->height());
+    EXPECT_EQ(LayoutUnit(20), renderBox("nestedContent")->height());
+}
+
+TEST_P(FrameViewLayoutRootsTest, RootContainingExistingRoot)
+{
+    setHeight("nestedContent", "20px");
+    EXPECT_EQ(1u, layoutSubtreeRoots().size());
+    EXPECT_TRUE(layoutSubtreeRoots().contains(renderBox("nested")));
+
+    // The new root replaces the root it contains.
+    setHeight("firstContent", "30px");
+    EXPECT_EQ(1u, layoutSubtreeRoots().size());
+    EXPECT_TRUE(layoutSubtreeRoots().contains(renderBox("first")));
+    EXPECT_FALSE(document().renderView()->needsLayout());
+
+    updateLayout();
+    EXPECT_EQ(LayoutUnit(30), renderBox("firstContent")->height());
+    EXPECT_EQ(LayoutUnit(20), renderBox("nestedContent")->height());
+}
+
+} // namespace
+
+} // namespace blink
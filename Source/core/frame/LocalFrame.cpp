@@ -469,20 +469,24 @@ void LocalFrame::createView(const IntSize& viewportSize, const Color& background
 
 void LocalFrame::countObjectsNeedingLayout(unsigned& needsLayoutObjects, unsigned& totalObjects, bool& isPartial)
 {
-    RenderObject* root = view()->layoutRoot();
+    Vector<RenderObject*> roots;
+    copyToVector(view()->layoutSubtreeRoots(), roots);
     isPartial = true;
-    if (!root) {
+    if (roots.isEmpty()) {
         isPartial = false;
-        root = contentRenderer();
+        roots.append(contentRenderer());
     }
 
     needsLayoutObjects = 0;
     totalObjects = 0;
 
-    for (RenderObject* o = root; o; o = o->nextInPreOrder(root)) {
-        ++totalObjects;
-        if (o->needsLayout())
-            ++needsLayoutObjects;
+    for (size_t i = 0; i < roots.size(); ++i) {
+        RenderObject* root = roots[i];
+        for (RenderObject* o = root; o; o = o->nextInPreOrder(root)) {
+            ++totalObjects;
+            if (o->needsLayout())
+                ++needsLayoutObjects;
+        }
     }
 }
 
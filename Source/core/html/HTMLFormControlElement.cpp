@@ -185,9 +185,8 @@ void HTMLFormControlElement::disabledAttributeChanged()
 void HTMLFormControlElement::requiredAttributeChanged()
 {
     setNeedsValidityCheck();
-    // Style recalculation is needed because style selectors may include
-    // :required and :optional pseudo-classes.
-    setNeedsStyleRecalc(SubtreeStyleChange);
+    pseudoStateChanged(CSSSelector::PseudoRequired);
+    pseudoStateChanged(CSSSelector::PseudoOptional);
 }
 
 bool HTMLFormControlElement::supportsAutofocus() const
@@ -206,7 +205,7 @@ void HTMLFormControlElement::setAutofilled(bool autofilled)
         return;
 
     m_isAutofilled = autofilled;
-    setNeedsStyleRecalc(SubtreeStyleChange);
+    pseudoStateChanged(CSSSelector::PseudoAutofill);
 }
 
 static bool shouldAutofocusOnAttach(const HTMLFormControlElement* element)
@@ -402,7 +401,8 @@ void HTMLFormControlElement::setNeedsWillValidateCheck()
     m_willValidateInitialized = true;
     m_willValidate = newWillValidate;
     setNeedsValidityCheck();
-    setNeedsStyleRecalc(SubtreeStyleChange);
+    pseudoStateChanged(CSSSelector::PseudoValid);
+    pseudoStateChanged(CSSSelector::PseudoInvalid);
     if (!m_willValidate)
         hideVisibleValidationMessage();
 }
@@ -493,7 +493,10 @@ void HTMLFormControlElement::setNeedsValidityCheck()
     bool newIsValid = valid();
     if (willValidate() && newIsValid != m_isValid) {
         // Update style for pseudo classes such as :valid :invalid.
-        setNeedsStyleRecalc(SubtreeStyleChange);
+        pseudoStateChanged(CSSSelector::PseudoValid);
+        pseudoStateChanged(CSSSelector::PseudoInvalid);
+        pseudoStateChanged(CSSSelector::PseudoInRange);
+        pseudoStateChanged(CSSSelector::PseudoOutOfRange);
     }
     m_isValid = newIsValid;
 
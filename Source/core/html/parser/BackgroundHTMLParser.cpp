@@ -250,6 +250,7 @@ void BackgroundHTMLParser::sendTokensToMainThread()
     chunk->xssInfos.swap(m_pendingXSSInfos);
     chunk->tokenizerState = m_tokenizer->state();
     chunk->treeBuilderState = m_treeBuilderSimulator.state();
+    chunk->speculativeTree = m_treeBuilderSimulator.takeSpeculativeTree();
     chunk->inputCheckpoint = m_input.createCheckpoint(m_pendingTokens->size());
     chunk->preloadScannerCheckpoint = m_preloadScanner->createCheckpoint();
     chunk->tokens = m_pendingTokens.release();
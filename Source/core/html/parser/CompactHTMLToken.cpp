@@ -64,11 +64,13 @@ CompactHTMLToken::CompactHTMLToken(const HTMLToken* token, const TextPosition& t
     case HTMLToken::StartTag:
         m_attributes.reserveInitialCapacity(token->attributes().size());
         for (Vector<HTMLToken::Attribute>::const_iterator it = token->attributes().begin(); it != token->attributes().end(); ++it)
-            m_attributes.append(Attribute(attemptStaticStringCreation(it->name, Likely8Bit), StringImpl::create8BitIfPossible(it->value)));
+            m_attributes.append(Attribute(attemptSharedAtomicStringCreation(it->name, Likely8Bit), StringImpl::create8BitIfPossible(it->value)));
         // Fall through!
     case HTMLToken::EndTag:
         m_selfClosing = token->selfClosing();
-        // Fall through!
+        m_isAll8BitData = token->isAll8BitData();
+        m_data = attemptSharedAtomicStringCreation(token->data(), token->isAll8BitData() ? Force8Bit : Force16Bit);
+        break;
     case HTMLToken::Comment:
     case HTMLToken::Character: {
         m_isAll8BitData = token->isAll8BitData();
@@ -33,6 +33,7 @@
 #include "core/dom/DocumentFragment.h"
 #include "core/dom/DocumentType.h"
 #include "core/dom/Element.h"
+#include "core/dom/MutationObserver.h"
 #include "core/dom/ScriptLoader.h"
 #include "core/dom/Text.h"
 #include "core/frame/LocalFrame.h"
@@ -42,9 +43,11 @@
 #include "core/html/HTMLScriptElement.h"
 #include "core/html/HTMLTemplateElement.h"
 #include "core/html/parser/AtomicHTMLToken.h"
+#include "core/html/parser/CompactHTMLToken.h"
 #include "core/html/parser/HTMLParserIdioms.h"
 #include "core/html/parser/HTMLStackItem.h"
 #include "core/html/parser/HTMLToken.h"
+#include "core/html/parser/HTMLTreeBuilderSimulator.h"
 #include "core/loader/FrameLoader.h"
 #include "core/loader/FrameLoaderClient.h"
 #include "core/svg/SVGScriptElement.h"
@@ -697,6 +700,81 @@ void HTMLConstructionSite::insertTextNode(const String& string, WhitespaceMode w
     m_pendingText.append(dummyTask.parent, dummyTask.nextChild, string, whitespaceMode);
 }
 
+bool HTMLConstructionSite::canInsertSpeculativeTree(const SpeculativeTreeRun& run) const
+{
+    HTMLStackItem* item = currentStackItem();
+    if (!item->isInHTMLNamespace() || item->hasTagName(templateTag) || shouldFosterParent())
+        return false;
+    unsigned firstUnopenElementIndex;
+    if (indexOfFirstUnopenFormattingElement(firstUnopenElementIndex))
+        return false;
+    if (m_openElements.stackDepth() + run.maximumDepth > maximumHTMLParserDOMTreeDepth)
+        return false;
+    if (run.assumesNoPInButtonScope && m_openElements.inButtonScope(pTag))
+        return false;
+    // Observers would see each subtree inserted at once rather than one node
+    // at a time.
+    return !m_document->hasMutationObserversOfType(MutationObserver::ChildList);
+}
+
+void HTMLConstructionSite::insertSpeculativeTree(const CompactHTMLToken* tokens, const SpeculativeTreeRun& run)
+{
+    ASSERT(canInsertSpeculativeTree(run));
+    Document& document = ownerDocumentForCurrentNode();
+    WillBeHeapVector<RefPtrWillBeMember<HTMLElement> > openElements;
+    Vector<size_t> openElementTokens;
+
+    for (size_t i = 0; i < run.steps.size(); ++i) {
+        const CompactHTMLToken& token = tokens[i];
+        const SpeculativeTreeRun::Step& step = run.steps[i];
+
+        for (unsigned j = 0; j < step.elementsToClose; ++j) {
+            // The outermost element is told it is done when it gets attached.
+            if (openElements.size() > 1)
+                openElements.last()->finishParsingChildren();
+            openElements.removeLast();
+            openElementTokens.removeLast();
+        }
+
+        switch (token.type()) {
+        case HTMLToken::StartTag: {
+            AtomicHTMLToken atomicToken(token);
+            RefPtrWillBeRawPtr<HTMLElement> element = createHTMLElement(&atomicToken);
+            if (openElements.isEmpty()) {
+                attachLater(currentNode(), element, step.closedWithinRun);
+            } else {
+                openElements.last()->parserAppendChild(element);
+                element->beginParsingChildren();
+            }
+            openElements.append(element.release());
+            openElementTokens.append(i);
+            break;
+        }
+        case HTMLToken::EndTag:
+            break;
+        case HTMLToken::Character:
+            if (openElements.isEmpty())
+                insertTextNode(token.data());
+            else
+                openElements.last()->parserAppendChild(Text::create(document, atomizeIfAllWhitespace(token.data(), WhitespaceUnknown)));
+            break;
+        case HTMLToken::Comment:
+            if (openElements.isEmpty())
+                attachLater(currentNode(), Comment::create(document, token.data()));
+            else
+                openElements.last()->parserAppendChild(Comment::create(document, token.data()));
+            break;
+        default:
+            ASSERT_NOT_REACHED();
+        }
+    }
+
+    for (size_t i = 0; i < openElements.size(); ++i) {
+        AtomicHTMLToken atomicToken(tokens[openElementTokens[i]]);
+        m_openElements.push(HTMLStackItem::create(openElements[i].release(), &atomicToken));
+    }
+}
+
 void HTMLConstructionSite::reparent(HTMLElementStack::ElementRecord* newParent, HTMLElementStack::ElementRecord* child)
 {
     HTMLConstructionSiteTask task(HTMLConstructionSiteTask::Reparent);
@@ -101,9 +101,11 @@ enum FlushMode {
 };
 
 class AtomicHTMLToken;
+class CompactHTMLToken;
 class Document;
 class Element;
 class HTMLFormElement;
+struct SpeculativeTreeRun;
 
 class HTMLConstructionSite FINAL {
     WTF_MAKE_NONCOPYABLE(HTMLConstructionSite);
@@ -156,6 +158,13 @@ public:
     void insertTextNode(const String&, WhitespaceMode = WhitespaceUnknown);
     void insertForeignElement(AtomicHTMLToken*, const AtomicString& namespaceURI);
 
+    // Inserts the nodes for a speculative tree run starting at |tokens|.
+    // Elements opened within the run are built while their outermost
+    // ancestor is still detached; elements still open at the end of the run
+    // are pushed on the stack of open elements.
+    bool canInsertSpeculativeTree(const SpeculativeTreeRun&) const;
+    void insertSpeculativeTree(const CompactHTMLToken* tokens, const SpeculativeTreeRun&);
+
     void insertHTMLHtmlStartTagBeforeHTML(AtomicHTMLToken*);
     void insertHTMLHtmlStartTagInBody(AtomicHTMLToken*);
     void insertHTMLBodyStartTagInBody(AtomicHTMLToken*);
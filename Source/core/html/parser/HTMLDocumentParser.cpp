@@ -449,6 +449,9 @@ void HTMLDocumentParser::processParsedChunkFromBackgroundParser(PassOwnPtr<Parse
 
     OwnPtr<ParsedChunk> chunk(popChunk);
     OwnPtr<CompactHTMLTokenStream> tokens = chunk->tokens.release();
+    SpeculativeTree speculativeTree;
+    speculativeTree.swap(chunk->speculativeTree);
+    size_t nextSpeculativeTreeRun = 0;
 
     HTMLParserThread::shared()->postTask(bind(&BackgroundHTMLParser::startedChunkWithCheckpoint, m_backgroundParser, chunk->inputCheckpoint));
 
@@ -473,6 +476,19 @@ void HTMLDocumentParser::processParsedChunkFromBackgroundParser(PassOwnPtr<Parse
             break;
         }
 
+        if (nextSpeculativeTreeRun < speculativeTree.size() && speculativeTree[nextSpeculativeTreeRun].firstToken == static_cast<size_t>(it - tokens->begin())) {
+            const SpeculativeTreeRun& run = speculativeTree[nextSpeculativeTreeRun++];
+            if (m_treeBuilder->canBuildSpeculativeTree(run)) {
+                size_t runLength = run.steps.size();
+                m_textPosition = it[runLength - 1].textPosition();
+                m_treeBuilder->buildSpeculativeTree(it, run);
+                it += runLength - 1;
+                if (isStopped())
+                    break;
+                continue;
+            }
+        }
+
         m_textPosition = it->textPosition();
 
         constructTreeFromCompactHTMLToken(*it);
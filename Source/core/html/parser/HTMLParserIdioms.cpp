@@ -400,11 +400,9 @@ String attemptStaticStringCreation(const LChar* characters, size_t size)
     return String(characters, size);
 }
 
-String attemptStaticStringCreation(const UChar* characters, size_t size, CharacterWidth width)
+static String createString(const UChar* characters, size_t size, CharacterWidth width)
 {
-    String string(findStringIfStatic(characters, size));
-    if (string.impl())
-        return string;
+    String string;
     if (width == Likely8Bit)
         string = StringImpl::create8BitIfPossible(characters, size);
     else if (width == Force8Bit)
@@ -415,4 +413,23 @@ String attemptStaticStringCreation(const UChar* characters, size_t size, Charact
     return string;
 }
 
+String attemptStaticStringCreation(const UChar* characters, size_t size, CharacterWidth width)
+{
+    String string(findStringIfStatic(characters, size));
+    if (string.impl())
+        return string;
+    return createString(characters, size, width);
+}
+
+String attemptSharedAtomicStringCreation(const UChar* characters, size_t size, CharacterWidth width)
+{
+    String string(findStringIfStatic(characters, size));
+    if (string.impl())
+        return string;
+    string = AtomicString::findOrAddShared(characters, size);
+    if (string.impl())
+        return string;
+    return createString(characters, size, width);
+}
+
 }
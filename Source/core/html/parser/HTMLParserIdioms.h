@@ -123,6 +123,17 @@ inline static String attemptStaticStringCreation(const Vector<UChar, inlineCapac
     return attemptStaticStringCreation(vector.data(), vector.size(), width);
 }
 
+// Like attemptStaticStringCreation(), but names that aren't static strings are
+// looked up in the process-wide AtomicString table, so that the main thread
+// gets them already atomized. See AtomicString::enableSharedTable().
+String attemptSharedAtomicStringCreation(const UChar*, size_t, CharacterWidth);
+
+template<size_t inlineCapacity>
+inline static String attemptSharedAtomicStringCreation(const Vector<UChar, inlineCapacity>& vector, CharacterWidth width)
+{
+    return attemptSharedAtomicStringCreation(vector.data(), vector.size(), width);
+}
+
 inline static String attemptStaticStringCreation(const String str)
 {
     if (!str.is8Bit())
@@ -31,6 +31,7 @@
 #include "core/frame/LocalFrame.h"
 #include "core/frame/Settings.h"
 #include "core/loader/FrameLoader.h"
+#include "platform/RuntimeEnabledFeatures.h"
 
 namespace blink {
 
@@ -49,6 +50,10 @@ HTMLParserOptions::HTMLParserOptions(Document* document)
     // FIXME: Gecko does not load javascript: urls synchronously, why do we?
     // See LayoutTests/loader/iframe-sync-loads.html
     useThreading = document && !document->importsController() && !document->url().isAboutBlankURL();
+
+    // Speculative tree building is driven by the background parser, so it
+    // only applies to threaded parsing.
+    useSpeculativeTreeBuilding = useThreading && RuntimeEnabledFeatures::speculativeTreeBuildingEnabled();
 }
 
 }
@@ -35,6 +35,7 @@ public:
     bool scriptEnabled;
     bool pluginsEnabled;
     bool useThreading;
+    bool useSpeculativeTreeBuilding;
 
     explicit HTMLParserOptions(Document* = 0);
 };
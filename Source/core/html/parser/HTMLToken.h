@@ -341,6 +341,20 @@ public:
         m_currentAttribute->value.append(character);
     }
 
+    void appendToAttributeValue(const LChar* characters, unsigned length)
+    {
+        ASSERT(m_type == StartTag || m_type == EndTag);
+        ASSERT(m_currentAttribute->valueRange.start);
+        m_currentAttribute->value.append(characters, length);
+    }
+
+    void appendToAttributeValue(const UChar* characters, unsigned length)
+    {
+        ASSERT(m_type == StartTag || m_type == EndTag);
+        ASSERT(m_currentAttribute->valueRange.start);
+        m_currentAttribute->value.append(characters, length);
+    }
+
     void appendToAttributeValue(size_t i, const String& value)
     {
         ASSERT(!value.isEmpty());
@@ -405,6 +419,20 @@ public:
         m_data.appendVector(characters);
     }
 
+    void appendToCharacter(const LChar* characters, unsigned length)
+    {
+        ASSERT(m_type == Character);
+        m_data.append(characters, length);
+    }
+
+    void appendToCharacter(const UChar* characters, unsigned length)
+    {
+        ASSERT(m_type == Character);
+        m_data.append(characters, length);
+        for (unsigned i = 0; i < length; ++i)
+            m_orAllData |= characters[i];
+    }
+
     /* Comment Tokens */
 
     const DataVector& comment() const
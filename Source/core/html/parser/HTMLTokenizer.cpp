@@ -36,9 +36,16 @@
 #include "platform/NotImplemented.h"
 #include "core/xml/parser/MarkupTokenizerInlines.h"
 #include "wtf/ASCIICType.h"
+#include "wtf/BitwiseOperations.h"
 #include "wtf/text/AtomicString.h"
 #include "wtf/unicode/Unicode.h"
 
+#if CPU(X86) || CPU(X86_64)
+#include <emmintrin.h>
+#elif HAVE(ARM_NEON_INTRINSICS)
+#include <arm_neon.h>
+#endif
+
 // Please don't use DEFINE_STATIC_LOCAL in this file. The HTMLTokenizer is used
 // from multiple threads and DEFINE_STATIC_LOCAL isn't threadsafe.
 #undef DEFINE_STATIC_LOCAL
@@ -99,6 +106,163 @@ static inline bool isEndTagBufferingState(HTMLTokenizer::State state)
     }
 }
 
+// Characters in a run are appended to the token without going through the
+// state machine one at a time. A run ends at the state's delimiter, at '&',
+// and at anything the InputStreamPreprocessor or the line number tracking
+// needs to see ('\r', '\n' and '\0').
+static inline bool isOrdinaryRunCharacter(UChar cc, UChar delimiter)
+{
+    return cc != delimiter && cc != '&' && cc != '\r' && cc != '\n' && cc;
+}
+
+#if CPU(X86) || CPU(X86_64)
+static inline unsigned ordinaryCharacterRunLength(const LChar* characters, unsigned length, UChar delimiter)
+{
+    unsigned i = 0;
+    if (delimiter <= 0xFF) {
+        const __m128i delimiters = _mm_set1_epi8(static_cast<char>(delimiter));
+        const __m128i ampersands = _mm_set1_epi8('&');
+        const __m128i carriageReturns = _mm_set1_epi8('\r');
+        const __m128i newlines = _mm_set1_epi8('\n');
+        const __m128i zeros = _mm_setzero_si128();
+        for (; i + 16 <= length; i += 16) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(characters + i));
+            __m128i stops = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, delimiters), _mm_cmpeq_epi8(block, ampersands)),
+                _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, carriageReturns), _mm_cmpeq_epi8(block, newlines)), _mm_cmpeq_epi8(block, zeros)));
+            if (unsigned mask = _mm_movemask_epi8(stops))
+                return i + countTrailingZeros32(mask);
+        }
+    }
+    for (; i < length && isOrdinaryRunCharacter(characters[i], delimiter); ++i) { }
+    return i;
+}
+
+static inline unsigned ordinaryCharacterRunLength(const UChar* characters, unsigned length, UChar delimiter)
+{
+    const __m128i delimiters = _mm_set1_epi16(delimiter);
+    const __m128i ampersands = _mm_set1_epi16('&');
+    const __m128i carriageReturns = _mm_set1_epi16('\r');
+    const __m128i newlines = _mm_set1_epi16('\n');
+    const __m128i zeros = _mm_setzero_si128();
+    unsigned i = 0;
+    for (; i + 8 <= length; i += 8) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(characters + i));
+        __m128i stops = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi16(block, delimiters), _mm_cmpeq_epi16(block, ampersands)),
+            _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi16(block, carriageReturns), _mm_cmpeq_epi16(block, newlines)), _mm_cmpeq_epi16(block, zeros)));
+        // Each matching 16-bit lane sets two bits of the mask.
+        if (unsigned mask = _mm_movemask_epi8(stops))
+            return i + countTrailingZeros32(mask) / 2;
+    }
+    for (; i < length && isOrdinaryRunCharacter(characters[i], delimiter); ++i) { }
+    return i;
+}
+#elif HAVE(ARM_NEON_INTRINSICS)
+static inline bool anyLaneSet(uint8x16_t stops)
+{
+    uint8x8_t folded = vorr_u8(vget_low_u8(stops), vget_high_u8(stops));
+    return vget_lane_u64(vreinterpret_u64_u8(folded), 0);
+}
+
+static inline unsigned ordinaryCharacterRunLength(const LChar* characters, unsigned length, UChar delimiter)
+{
+    unsigned i = 0;
+    if (delimiter <= 0xFF) {
+        const uint8x16_t delimiters = vdupq_n_u8(delimiter);
+        const uint8x16_t ampersands = vdupq_n_u8('&');
+        const uint8x16_t carriageReturns = vdupq_n_u8('\r');
+        const uint8x16_t newlines = vdupq_n_u8('\n');
+        const uint8x16_t zeros = vdupq_n_u8(0);
+        for (; i + 16 <= length; i += 16) {
+            uint8x16_t block = vld1q_u8(characters + i);
+            uint8x16_t stops = vorrq_u8(vorrq_u8(vceqq_u8(block, delimiters), vceqq_u8(block, ampersands)),
+                vorrq_u8(vorrq_u8(vceqq_u8(block, carriageReturns), vceqq_u8(block, newlines)), vceqq_u8(block, zeros)));
+            // The scalar loop below finds the exact position within the block.
+            if (anyLaneSet(stops))
+                break;
+        }
+    }
+    for (; i < length && isOrdinaryRunCharacter(characters[i], delimiter); ++i) { }
+    return i;
+}
+
+static inline unsigned ordinaryCharacterRunLength(const UChar* characters, unsigned length, UChar delimiter)
+{
+    const uint16x8_t delimiters = vdupq_n_u16(delimiter);
+    const uint16x8_t ampersands = vdupq_n_u16('&');
+    const uint16x8_t carriageReturns = vdupq_n_u16('\r');
+    const uint16x8_t newlines = vdupq_n_u16('\n');
+    const uint16x8_t zeros = vdupq_n_u16(0);
+    unsigned i = 0;
+    for (; i + 8 <= length; i += 8) {
+        uint16x8_t block = vld1q_u16(characters + i);
+        uint16x8_t stops = vorrq_u16(vorrq_u16(vceqq_u16(block, delimiters), vceqq_u16(block, ampersands)),
+            vorrq_u16(vorrq_u16(vceqq_u16(block, carriageReturns), vceqq_u16(block, newlines)), vceqq_u16(block, zeros)));
+        if (anyLaneSet(vreinterpretq_u8_u16(stops)))
+            break;
+    }
+    for (; i < length && isOrdinaryRunCharacter(characters[i], delimiter); ++i) { }
+    return i;
+}
+#else
+template<typename CharType>
+static inline unsigned ordinaryCharacterRunLength(const CharType* characters, unsigned length, UChar delimiter)
+{
+    unsigned i = 0;
+    for (; i < length && isOrdinaryRunCharacter(characters[i], delimiter); ++i) { }
+    return i;
+}
+#endif
+
+// The run never includes the last character of the current substring, so
+// that advancing past it never has to move on to the next substring.
+inline bool HTMLTokenizer::consumeCharacterRun(SegmentedString& source, UChar delimiter)
+{
+    unsigned length = source.remainingLengthOfCurrentSubstring();
+    if (length < 2)
+        return false;
+    if (source.currentSubstringIs8Bit()) {
+        const LChar* characters = source.currentCharacters8();
+        unsigned runLength = ordinaryCharacterRunLength(characters, length - 1, delimiter);
+        if (!runLength)
+            return false;
+        m_token->ensureIsCharacterToken();
+        m_token->appendToCharacter(characters, runLength);
+        source.advancePastNonNewlines(runLength);
+        return true;
+    }
+    const UChar* characters = source.currentCharacters16();
+    unsigned runLength = ordinaryCharacterRunLength(characters, length - 1, delimiter);
+    if (!runLength)
+        return false;
+    m_token->ensureIsCharacterToken();
+    m_token->appendToCharacter(characters, runLength);
+    source.advancePastNonNewlines(runLength);
+    return true;
+}
+
+inline bool HTMLTokenizer::consumeAttributeValueRun(SegmentedString& source, UChar quote)
+{
+    unsigned length = source.remainingLengthOfCurrentSubstring();
+    if (length < 2)
+        return false;
+    if (source.currentSubstringIs8Bit()) {
+        const LChar* characters = source.currentCharacters8();
+        unsigned runLength = ordinaryCharacterRunLength(characters, length - 1, quote);
+        if (!runLength)
+            return false;
+        m_token->appendToAttributeValue(characters, runLength);
+        source.advancePastNonNewlines(runLength);
+        return true;
+    }
+    const UChar* characters = source.currentCharacters16();
+    unsigned runLength = ordinaryCharacterRunLength(characters, length - 1, quote);
+    if (!runLength)
+        return false;
+    m_token->appendToAttributeValue(characters, runLength);
+    source.advancePastNonNewlines(runLength);
+    return true;
+}
+
 #define HTML_BEGIN_STATE(stateName) BEGIN_STATE(HTMLTokenizer, stateName)
 #define HTML_RECONSUME_IN(stateName) RECONSUME_IN(HTMLTokenizer, stateName)
 #define HTML_ADVANCE_TO(stateName) ADVANCE_TO(HTMLTokenizer, stateName)
@@ -243,6 +407,8 @@ bool HTMLTokenizer::nextToken(SegmentedString& source, HTMLToken& token)
         } else if (cc == kEndOfFileMarker)
             return emitEndOfFile(source);
         else {
+            if (consumeCharacterRun(source, '<'))
+                HTML_SWITCH_TO(DataState);
             bufferCharacter(cc);
             HTML_ADVANCE_TO(DataState);
         }
@@ -264,6 +430,8 @@ bool HTMLTokenizer::nextToken(SegmentedString& source, HTMLToken& token)
         else if (cc == kEndOfFileMarker)
             return emitEndOfFile(source);
         else {
+            if (consumeCharacterRun(source, '<'))
+                HTML_SWITCH_TO(RCDATAState);
             bufferCharacter(cc);
             HTML_ADVANCE_TO(RCDATAState);
         }
@@ -283,6 +451,8 @@ bool HTMLTokenizer::nextToken(SegmentedString& source, HTMLToken& token)
         else if (cc == kEndOfFileMarker)
             return emitEndOfFile(source);
         else {
+            if (consumeCharacterRun(source, '<'))
+                HTML_SWITCH_TO(RAWTEXTState);
             bufferCharacter(cc);
             HTML_ADVANCE_TO(RAWTEXTState);
         }
@@ -295,6 +465,8 @@ bool HTMLTokenizer::nextToken(SegmentedString& source, HTMLToken& token)
         else if (cc == kEndOfFileMarker)
             return emitEndOfFile(source);
         else {
+            if (consumeCharacterRun(source, '<'))
+                HTML_SWITCH_TO(ScriptDataState);
             bufferCharacter(cc);
             HTML_ADVANCE_TO(ScriptDataState);
         }
@@ -950,6 +1122,8 @@ bool HTMLTokenizer::nextToken(SegmentedString& source, HTMLToken& token)
             m_token->endAttributeValue(source.numberOfCharactersConsumed());
             HTML_RECONSUME_IN(DataState);
         } else {
+            if (consumeAttributeValueRun(source, '"'))
+                HTML_SWITCH_TO(AttributeValueDoubleQuotedState);
             m_token->appendToAttributeValue(cc);
             HTML_ADVANCE_TO(AttributeValueDoubleQuotedState);
         }
@@ -968,6 +1142,8 @@ bool HTMLTokenizer::nextToken(SegmentedString& source, HTMLToken& token)
             m_token->endAttributeValue(source.numberOfCharactersConsumed());
             HTML_RECONSUME_IN(DataState);
         } else {
+            if (consumeAttributeValueRun(source, '\''))
+                HTML_SWITCH_TO(AttributeValueSingleQuotedState);
             m_token->appendToAttributeValue(cc);
             HTML_ADVANCE_TO(AttributeValueSingleQuotedState);
         }
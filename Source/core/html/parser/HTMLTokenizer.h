@@ -198,6 +198,12 @@ private:
 
     inline bool processEntity(SegmentedString&);
 
+    // Append a run of characters that need no per-character processing
+    // straight from the current substring of |source|. Return false if the
+    // current character starts no such run.
+    inline bool consumeCharacterRun(SegmentedString&, UChar delimiter);
+    inline bool consumeAttributeValueRun(SegmentedString&, UChar quote);
+
     inline void parseError();
 
     inline void bufferCharacter(UChar character)
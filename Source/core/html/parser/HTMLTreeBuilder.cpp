@@ -39,11 +39,13 @@
 #include "core/html/HTMLDocument.h"
 #include "core/html/HTMLFormElement.h"
 #include "core/html/parser/AtomicHTMLToken.h"
+#include "core/html/parser/CompactHTMLToken.h"
 #include "core/html/parser/HTMLDocumentParser.h"
 #include "core/html/parser/HTMLParserIdioms.h"
 #include "core/html/parser/HTMLStackItem.h"
 #include "core/html/parser/HTMLToken.h"
 #include "core/html/parser/HTMLTokenizer.h"
+#include "core/html/parser/HTMLTreeBuilderSimulator.h"
 #include "platform/NotImplemented.h"
 #include "platform/text/PlatformLocale.h"
 #include "wtf/MainThread.h"
@@ -393,6 +395,33 @@ void HTMLTreeBuilder::constructTree(AtomicHTMLToken* token)
     // We might be detached now.
 }
 
+bool HTMLTreeBuilder::canBuildSpeculativeTree(const SpeculativeTreeRun& run) const
+{
+    // The simulator only records tokens that the "in body" insertion mode
+    // handles without reconstructing active formatting elements or looking
+    // at elements opened before the run, apart from <p> in button scope.
+    return m_insertionMode == InBodyMode
+        && m_templateInsertionModes.isEmpty()
+        && !m_shouldSkipLeadingNewline
+        && m_tree.canInsertSpeculativeTree(run);
+}
+
+void HTMLTreeBuilder::buildSpeculativeTree(const CompactHTMLToken* tokens, const SpeculativeTreeRun& run)
+{
+    ASSERT(canBuildSpeculativeTree(run));
+    if (m_framesetOk) {
+        for (size_t i = 0; i < run.steps.size(); ++i) {
+            if (tokens[i].type() == HTMLToken::Character && !isAllWhitespaceOrReplacementCharacters(tokens[i].data())) {
+                m_framesetOk = false;
+                break;
+            }
+        }
+    }
+    m_tree.insertSpeculativeTree(tokens, run);
+    m_tree.executeQueuedTasks();
+    // We might be detached now.
+}
+
 void HTMLTreeBuilder::processToken(AtomicHTMLToken* token)
 {
     if (token->type() == HTMLToken::Character) {
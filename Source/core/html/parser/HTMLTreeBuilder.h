@@ -42,6 +42,7 @@
 namespace blink {
 
 class AtomicHTMLToken;
+class CompactHTMLToken;
 class Document;
 class DocumentFragment;
 class Element;
@@ -50,6 +51,7 @@ class HTMLToken;
 class HTMLDocument;
 class Node;
 class HTMLDocumentParser;
+struct SpeculativeTreeRun;
 
 class HTMLTreeBuilder FINAL : public NoBaseWillBeGarbageCollectedFinalized<HTMLTreeBuilder> {
     WTF_MAKE_NONCOPYABLE(HTMLTreeBuilder); WTF_MAKE_FAST_ALLOCATED_WILL_BE_REMOVED;
@@ -75,6 +77,12 @@ public:
 
     void constructTree(AtomicHTMLToken*);
 
+    // Builds the nodes for a run of tokens recorded by the background
+    // parser's HTMLTreeBuilderSimulator in one pass. The run must start with
+    // the token the tree builder would process next.
+    bool canBuildSpeculativeTree(const SpeculativeTreeRun&) const;
+    void buildSpeculativeTree(const CompactHTMLToken*, const SpeculativeTreeRun&);
+
     bool hasParserBlockingScript() const { return !!m_scriptToProcess; }
     // Must be called to take the parser-blocking script before calling the parser again.
     PassRefPtrWillBeRawPtr<Element> takeScriptToProcess(TextPosition& scriptStartPosition);
@@ -29,6 +29,7 @@
 #include "core/HTMLNames.h"
 #include "core/MathMLNames.h"
 #include "core/SVGNames.h"
+#include "core/dom/Text.h"
 #include "core/html/parser/HTMLParserIdioms.h"
 #include "core/html/parser/HTMLTokenizer.h"
 #include "core/html/parser/HTMLTreeBuilder.h"
@@ -105,8 +106,44 @@ static bool tokenExitsMath(const CompactHTMLToken& token)
         || threadSafeMatch(tagName, MathMLNames::mtextTag);
 }
 
+// Speculative tree runs shorter than this are not worth sending to the main
+// thread; the tree builder handles their tokens one at a time instead.
+static const size_t minimumSpeculativeTreeRunLength = 8;
+
+static const QualifiedName* speculativeTreeTag(const String& tagName, bool& isSpecial)
+{
+    // Start tags for these close an open <p>, then insert an element. End tags
+    // pop up to the matching element. All of them are "special" elements.
+    const QualifiedName* const specialTags[] = {
+        &addressTag, &articleTag, &asideTag, &blockquoteTag, &divTag, &figcaptionTag,
+        &figureTag, &footerTag, &headerTag, &mainTag, &navTag, &pTag, &sectionTag
+    };
+    // These are only handled by the "any other start tag" and "any other end
+    // tag" steps of the "in body" insertion mode.
+    const QualifiedName* const ordinaryTags[] = {
+        &abbrTag, &bdiTag, &citeTag, &dfnTag, &kbdTag, &markTag,
+        &qTag, &sampTag, &spanTag, &subTag, &supTag, &varTag
+    };
+
+    for (size_t i = 0; i < WTF_ARRAY_LENGTH(specialTags); ++i) {
+        if (threadSafeMatch(tagName, *specialTags[i])) {
+            isSpecial = true;
+            return specialTags[i];
+        }
+    }
+    for (size_t i = 0; i < WTF_ARRAY_LENGTH(ordinaryTags); ++i) {
+        if (threadSafeMatch(tagName, *ordinaryTags[i])) {
+            isSpecial = false;
+            return ordinaryTags[i];
+        }
+    }
+    return 0;
+}
+
 HTMLTreeBuilderSimulator::HTMLTreeBuilderSimulator(const HTMLParserOptions& options)
     : m_options(options)
+    , m_simulatedTokenCount(0)
+    , m_lastStepWasCharacter(false)
 {
     m_namespaceStack.append(HTML);
 }
@@ -131,6 +168,9 @@ HTMLTreeBuilderSimulator::State HTMLTreeBuilderSimulator::stateFor(HTMLTreeBuild
 
 bool HTMLTreeBuilderSimulator::simulate(const CompactHTMLToken& token, HTMLTokenizer* tokenizer)
 {
+    if (m_options.useSpeculativeTreeBuilding)
+        updateSpeculativeTree(token);
+
     if (token.type() == HTMLToken::StartTag) {
         const String& tagName = token.data();
         if (threadSafeMatch(tagName, SVGNames::svgTag))
@@ -180,4 +220,122 @@ bool HTMLTreeBuilderSimulator::simulate(const CompactHTMLToken& token, HTMLToken
     return true;
 }
 
+SpeculativeTree HTMLTreeBuilderSimulator::takeSpeculativeTree()
+{
+    endSpeculativeTreeRun();
+    m_simulatedTokenCount = 0;
+    SpeculativeTree tree;
+    tree.swap(m_speculativeTree);
+    return tree;
+}
+
+void HTMLTreeBuilderSimulator::updateSpeculativeTree(const CompactHTMLToken& token)
+{
+    size_t tokenIndex = m_simulatedTokenCount++;
+    if (m_currentRun.steps.isEmpty()) {
+        m_currentRun.firstToken = tokenIndex;
+        m_currentRun.maximumDepth = 0;
+        m_currentRun.assumesNoPInButtonScope = false;
+    }
+    if (inForeignContent() || !extendSpeculativeTreeRun(token))
+        endSpeculativeTreeRun();
+}
+
+bool HTMLTreeBuilderSimulator::extendSpeculativeTreeRun(const CompactHTMLToken& token)
+{
+    SpeculativeTreeRun::Step step = { 0, false };
+
+    switch (token.type()) {
+    case HTMLToken::StartTag: {
+        bool isSpecial;
+        const QualifiedName* tag = speculativeTreeTag(token.data(), isSpecial);
+        if (!tag)
+            return false;
+        if (isSpecial) {
+            // "Close a p element" if there is one in button scope. None of the
+            // elements we handle are scope boundaries, so any <p> opened in the
+            // run counts. A <p> opened before the run is for the main thread to
+            // rule out.
+            size_t index = m_speculativeOpenElements.size();
+            while (index && m_speculativeOpenElements[index - 1].tag != &pTag)
+                --index;
+            if (index)
+                step.elementsToClose = m_speculativeOpenElements.size() - index + 1;
+            else
+                m_currentRun.assumesNoPInButtonScope = true;
+        }
+        closeSpeculativeElements(step.elementsToClose);
+        SpeculativeOpenElement element = { tag, isSpecial, m_currentRun.steps.size() };
+        m_speculativeOpenElements.append(element);
+        m_currentRun.maximumDepth = std::max<unsigned>(m_currentRun.maximumDepth, m_speculativeOpenElements.size());
+        break;
+    }
+    case HTMLToken::EndTag: {
+        bool isSpecial;
+        const QualifiedName* tag = speculativeTreeTag(token.data(), isSpecial);
+        if (!tag)
+            return false;
+        // Special end tags pop up to the matching element. Other end tags do
+        // too, unless a special element comes first, which makes the tree
+        // builder ignore them. Either way, an element opened before the run
+        // would have to be examined, which we leave to the tree builder.
+        size_t index = m_speculativeOpenElements.size();
+        while (index) {
+            const SpeculativeOpenElement& element = m_speculativeOpenElements[index - 1];
+            if (element.tag == tag) {
+                step.elementsToClose = m_speculativeOpenElements.size() - index + 1;
+                break;
+            }
+            if (!isSpecial && element.isSpecial)
+                break;
+            --index;
+        }
+        if (!index)
+            return false;
+        closeSpeculativeElements(step.elementsToClose);
+        break;
+    }
+    case HTMLToken::Character:
+        // Adjacent character tokens would share a text node, which could need
+        // splitting at the length limit. Leave that to the tree builder.
+        if (m_lastStepWasCharacter || token.data().length() >= Text::defaultLengthLimit)
+            return false;
+        break;
+    case HTMLToken::Comment:
+        break;
+    default:
+        return false;
+    }
+
+    // An end tag the tree builder ignores inserts nothing, so character
+    // tokens on either side of it still share a text node.
+    if (token.type() != HTMLToken::EndTag || step.elementsToClose)
+        m_lastStepWasCharacter = token.type() == HTMLToken::Character;
+    m_currentRun.steps.append(step);
+    return true;
+}
+
+void HTMLTreeBuilderSimulator::closeSpeculativeElements(size_t count)
+{
+    ASSERT(count <= m_speculativeOpenElements.size());
+    for (size_t i = 0; i < count; ++i) {
+        m_currentRun.steps[m_speculativeOpenElements.last().step].closedWithinRun = true;
+        m_speculativeOpenElements.removeLast();
+    }
+}
+
+void HTMLTreeBuilderSimulator::endSpeculativeTreeRun()
+{
+    if (m_currentRun.steps.size() >= minimumSpeculativeTreeRunLength) {
+        m_speculativeTree.append(SpeculativeTreeRun());
+        m_speculativeTree.last().firstToken = m_currentRun.firstToken;
+        m_speculativeTree.last().steps.swap(m_currentRun.steps);
+        m_speculativeTree.last().maximumDepth = m_currentRun.maximumDepth;
+        m_speculativeTree.last().assumesNoPInButtonScope = m_currentRun.assumesNoPInButtonScope;
+    }
+    m_currentRun.steps.clear();
+    m_speculativeOpenElements.clear();
+    m_lastStepWasCharacter = false;
+}
+
 }
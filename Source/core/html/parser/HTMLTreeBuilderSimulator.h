@@ -34,6 +34,29 @@ namespace blink {
 class CompactHTMLToken;
 class HTMLTokenizer;
 class HTMLTreeBuilder;
+class QualifiedName;
+
+// A stretch of tokens that HTMLTreeBuilder would handle in the "in body"
+// insertion mode without looking at any element that was open before the
+// stretch began. HTMLTreeBuilder::buildSpeculativeTree() creates the nodes
+// for such a stretch in one pass instead of processing each token.
+struct SpeculativeTreeRun {
+    struct Step {
+        // How many of the elements opened within the run this token closes
+        // (before inserting its own element, for start tags).
+        unsigned elementsToClose;
+        // Set on start tags whose element is closed before the run ends.
+        bool closedWithinRun;
+    };
+
+    size_t firstToken;
+    Vector<Step> steps; // One for each token of the run.
+    unsigned maximumDepth;
+    // Set when a start tag in the run would close a <p> opened before it.
+    bool assumesNoPInButtonScope;
+};
+
+typedef Vector<SpeculativeTreeRun> SpeculativeTree;
 
 class HTMLTreeBuilderSimulator {
     WTF_MAKE_FAST_ALLOCATED;
@@ -56,13 +79,34 @@ public:
 
     bool simulate(const CompactHTMLToken&, HTMLTokenizer*);
 
+    // Returns the runs recorded for the tokens simulated since the last call.
+    // Token indices are relative to the first of those tokens.
+    SpeculativeTree takeSpeculativeTree();
+
 private:
+    struct SpeculativeOpenElement {
+        const QualifiedName* tag;
+        bool isSpecial;
+        size_t step;
+    };
+
     explicit HTMLTreeBuilderSimulator(HTMLTreeBuilder*);
 
     bool inForeignContent() const { return m_namespaceStack.last() != HTML; }
 
+    void updateSpeculativeTree(const CompactHTMLToken&);
+    bool extendSpeculativeTreeRun(const CompactHTMLToken&);
+    void closeSpeculativeElements(size_t count);
+    void endSpeculativeTreeRun();
+
     HTMLParserOptions m_options;
     State m_namespaceStack;
+
+    size_t m_simulatedTokenCount;
+    SpeculativeTree m_speculativeTree;
+    SpeculativeTreeRun m_currentRun;
+    Vector<SpeculativeOpenElement> m_speculativeOpenElements;
+    bool m_lastStepWasCharacter;
 };
 
 }
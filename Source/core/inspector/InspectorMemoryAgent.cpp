@@ -32,10 +32,58 @@
 #include "core/inspector/InspectorMemoryAgent.h"
 
 #include "core/inspector/InspectorCounters.h"
+#include "platform/Partitions.h"
 #include "wtf/OwnPtr.h"
 
 namespace blink {
 
+namespace {
+
+class PartitionStatsBuilder FINAL : public WTF::PartitionStatsDumper {
+public:
+    PartitionStatsBuilder()
+        : m_partitions(TypeBuilder::Array<TypeBuilder::Memory::PartitionStats>::create())
+        , m_buckets(TypeBuilder::Array<TypeBuilder::Memory::PartitionBucketStats>::create())
+    {
+    }
+
+    virtual void partitionDumpBucketStats(const char*, const WTF::PartitionBucketMemoryStats& stats) OVERRIDE
+    {
+        m_buckets->addItem(TypeBuilder::Memory::PartitionBucketStats::create()
+            .setSlotSize(static_cast<int>(stats.bucketSlotSize))
+            .setActiveBytes(stats.activeBytes)
+            .setResidentBytes(stats.residentBytes)
+            .setDecommittableBytes(stats.decommittableBytes)
+            .setFullPages(static_cast<int>(stats.numFullPages))
+            .setActivePages(static_cast<int>(stats.numActivePages))
+            .setEmptyPages(static_cast<int>(stats.numEmptyPages))
+            .setDecommittedPages(static_cast<int>(stats.numDecommittedPages))
+            .release());
+    }
+
+    virtual void partitionDumpTotals(const char* partitionName, const WTF::PartitionMemoryStats& totals) OVERRIDE
+    {
+        m_partitions->addItem(TypeBuilder::Memory::PartitionStats::create()
+            .setName(partitionName)
+            .setMmappedBytes(totals.totalMmappedBytes)
+            .setCommittedBytes(totals.totalCommittedBytes)
+            .setResidentBytes(totals.totalResidentBytes)
+            .setActiveBytes(totals.totalActiveBytes)
+            .setDecommittableBytes(totals.totalDecommittableBytes)
+            .setBuckets(m_buckets.release())
+            .release());
+        m_buckets = TypeBuilder::Array<TypeBuilder::Memory::PartitionBucketStats>::create();
+    }
+
+    PassRefPtr<TypeBuilder::Array<TypeBuilder::Memory::PartitionStats> > release() { return m_partitions.release(); }
+
+private:
+    RefPtr<TypeBuilder::Array<TypeBuilder::Memory::PartitionStats> > m_partitions;
+    RefPtr<TypeBuilder::Array<TypeBuilder::Memory::PartitionBucketStats> > m_buckets;
+};
+
+} // namespace
+
 InspectorMemoryAgent::~InspectorMemoryAgent()
 {
 }
@@ -47,6 +95,13 @@ void InspectorMemoryAgent::getDOMCounters(ErrorString*, int* documents, int* nod
     *jsEventListeners = InspectorCounters::counterValue(InspectorCounters::JSEventListenerCounter);
 }
 
+void InspectorMemoryAgent::getPartitionAllocStats(ErrorString*, RefPtr<TypeBuilder::Array<TypeBuilder::Memory::PartitionStats> >& partitions)
+{
+    PartitionStatsBuilder builder;
+    Partitions::dumpMemoryStats(&builder);
+    partitions = builder.release();
+}
+
 InspectorMemoryAgent::InspectorMemoryAgent()
     : InspectorBaseAgent<InspectorMemoryAgent>("Memory")
     , m_frontend(0)
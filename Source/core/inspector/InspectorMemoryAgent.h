@@ -51,6 +51,7 @@ public:
     virtual ~InspectorMemoryAgent();
 
     virtual void getDOMCounters(ErrorString*, int* documents, int* nodes, int* jsEventListeners) OVERRIDE;
+    virtual void getPartitionAllocStats(ErrorString*, RefPtr<TypeBuilder::Array<TypeBuilder::Memory::PartitionStats> >& partitions) OVERRIDE;
 
     virtual void setFrontend(InspectorFrontend*) OVERRIDE;
     virtual void clearFrontend() OVERRIDE;
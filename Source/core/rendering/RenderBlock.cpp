@@ -1357,6 +1357,9 @@ void RenderBlock::updateScrollInfoAfterLayout()
 
 void RenderBlock::layout()
 {
+    if (useCachedLayoutResultIfPossible())
+        return;
+
     OverflowEventDispatcher dispatcher(this);
 
     // Update our first letter info now.
@@ -1372,6 +1375,8 @@ void RenderBlock::layout()
         clearLayoutOverflow();
 
     invalidateBackgroundObscurationStatus();
+
+    updateCachedLayoutResult();
 }
 
 bool RenderBlock::updateImageLoadingPriorities()
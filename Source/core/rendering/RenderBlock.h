@@ -494,6 +494,8 @@ protected:
     // FIXME: This is temporary as we move code that accesses block flow
     // member variables out of RenderBlock and into RenderBlockFlow.
     friend class RenderBlockFlow;
+    // RenderBox only caches the layout of blocks that contain their floats and margins.
+    friend class RenderBox;
 };
 
 DEFINE_RENDER_OBJECT_TYPE_CASTS(RenderBlock, isRenderBlock());
@@ -1615,7 +1615,7 @@ void RenderBlockFlow::checkFloatsInCleanLine(RootInlineBox* line, Vector<FloatWi
         RenderBox* floatingBox = *it;
         floatingBox->layoutIfNeeded();
         LayoutSize newSize(floatingBox->width() + floatingBox->marginWidth(), floatingBox->height() + floatingBox->marginHeight());
-        if (floats[floatIndex].object != floatingBox) {
+        if (floatIndex >= floats.size() || floats[floatIndex].object != floatingBox) {
             encounteredNewFloat = true;
             return;
         }
@@ -1646,6 +1646,9 @@ RootInlineBox* RenderBlockFlow::determineStartPosition(LineLayoutState& layoutSt
         bool paginated = view()->layoutState() && view()->layoutState()->isPaginated();
         LayoutUnit paginationDelta = 0;
         size_t floatIndex = 0;
+        // The last clean line with a float that is still where it was, in
+        // the order of the floats in the block.
+        RootInlineBox* lastLineWithMatchedFloat = 0;
         for (curr = firstRootBox(); curr && !curr->isDirty(); curr = curr->nextRootBox()) {
             if (paginated) {
                 paginationDelta -= curr->paginationStrut();
@@ -1662,11 +1665,18 @@ RootInlineBox* RenderBlockFlow::determineStartPosition(LineLayoutState& layoutSt
                 }
             }
 
-            // If a new float has been inserted before this line or before its last known float, just do a full layout.
+            // If a float has been inserted or removed before this line or before its last known float,
+            // it comes after the last float that is still in place, so lay out again from that float's line.
+            // determineEndPosition finds the same mismatch, so every line after that one is laid out again.
             bool encounteredNewFloat = false;
+            size_t previousFloatIndex = floatIndex;
             checkFloatsInCleanLine(curr, layoutState.floats(), floatIndex, encounteredNewFloat, dirtiedByFloat);
-            if (encounteredNewFloat)
-                layoutState.markForFullLayout();
+            if (floatIndex > previousFloatIndex)
+                lastLineWithMatchedFloat = curr;
+            if (encounteredNewFloat) {
+                curr = lastLineWithMatchedFloat ? lastLineWithMatchedFloat : firstRootBox();
+                break;
+            }
 
             if (dirtiedByFloat || layoutState.isFullLayout())
                 break;
@@ -56,6 +56,7 @@
 #include "core/rendering/RenderView.h"
 #include "core/rendering/compositing/RenderLayerCompositor.h"
 #include "platform/LengthFunctions.h"
+#include "platform/RuntimeEnabledFeatures.h"
 #include "platform/geometry/FloatQuad.h"
 #include "platform/geometry/TransformState.h"
 #include <algorithm>
@@ -1013,6 +1014,100 @@ void RenderBox::clearOverrideContainingBlockContentLogicalHeight()
         gOverrideContainingBlockLogicalHeightMap->remove(this);
 }
 
+bool RenderBox::canCacheLayoutResult() const
+{
+    if (!RuntimeEnabledFeatures::layoutResultCacheEnabled())
+        return false;
+
+    // Only boxes that establish a block formatting context, so that neither floats
+    // nor margins of their children interact with the outside. Boxes that place
+    // themselves or are sized by their table are left out.
+    if (!isRenderBlock() || !toRenderBlock(this)->createsBlockFormattingContext())
+        return false;
+    if (isAnonymous() || isInline() || isFloatingOrOutOfFlowPositioned() || isWritingModeRoot() || isDocumentElement()
+        || isTableCell() || isTableCaption() || isRenderFlowThread() || style()->specifiesColumns())
+        return false;
+
+    // In quirks mode percentage heights in the subtree may resolve against
+    // ancestors of the box.
+    if (!parent() || document().inQuirksMode())
+        return false;
+
+    // The width of a box that avoids floats depends on its position.
+    RenderBlock* cb = containingBlock();
+    if (cb->isRenderBlockFlow() && toRenderBlockFlow(cb)->containsFloats())
+        return false;
+
+    // Where a box breaks across pages depends on its position as well.
+    LayoutState* layoutState = view()->layoutState();
+    return !layoutState || !layoutState->isPaginated();
+}
+
+bool RenderBox::needsLayoutOnlyBecauseOfContainer() const
+{
+    if (selfNeedsLayout() || posChildNeedsLayout() || needsSimplifiedNormalFlowLayout() || needsPositionedMovementLayout())
+        return false;
+
+    // Anything marked for layout in the subtree also marks the child it is in.
+    for (RenderObject* child = slowFirstChild(); child; child = child->nextSibling()) {
+        if (child->needsLayout())
+            return false;
+    }
+    return true;
+}
+
+RenderBoxLayoutConstraints RenderBox::currentLayoutConstraints() const
+{
+    RenderBoxLayoutConstraints constraints;
+    constraints.m_containingBlockLogicalWidth = containingBlockLogicalWidthForContent();
+    if (hasOverrideWidth())
+        constraints.m_overrideLogicalContentWidth = overrideLogicalContentWidth();
+    if (hasOverrideHeight())
+        constraints.m_overrideLogicalContentHeight = overrideLogicalContentHeight();
+    constraints.m_hasOverrideContainingBlockLogicalWidth = hasOverrideContainingBlockLogicalWidth();
+    if (constraints.m_hasOverrideContainingBlockLogicalWidth)
+        constraints.m_overrideContainingBlockContentLogicalWidth = overrideContainingBlockContentLogicalWidth();
+    constraints.m_hasOverrideContainingBlockLogicalHeight = hasOverrideContainingBlockLogicalHeight();
+    if (constraints.m_hasOverrideContainingBlockLogicalHeight)
+        constraints.m_overrideContainingBlockContentLogicalHeight = overrideContainingBlockContentLogicalHeight();
+    // Percentage heights in the subtree resolve against boxes inside of it.
+    if (hasRelativeLogicalHeight())
+        constraints.m_percentageResolutionLogicalHeight = computePercentageLogicalHeight(Length(100, Percent));
+    return constraints;
+}
+
+bool RenderBox::useCachedLayoutResultIfPossible()
+{
+    if (!m_rareData || !m_rareData->m_hasCachedLayoutResult || !needsLayoutOnlyBecauseOfContainer())
+        return false;
+
+    const RenderBoxLayoutResult& result = m_rareData->m_cachedLayoutResult;
+    if (!canCacheLayoutResult() || result.m_constraints != currentLayoutConstraints())
+        return false;
+
+    setSize(result.m_size);
+    m_marginBox = result.m_margins;
+    clearNeedsLayout();
+    frameView()->didUseCachedLayoutResult();
+    return true;
+}
+
+void RenderBox::updateCachedLayoutResult()
+{
+    if (!canCacheLayoutResult()) {
+        if (m_rareData)
+            m_rareData->m_hasCachedLayoutResult = false;
+        return;
+    }
+
+    RenderBoxRareData& rareData = ensureRareData();
+    RenderBoxLayoutResult& result = rareData.m_cachedLayoutResult;
+    result.m_constraints = currentLayoutConstraints();
+    result.m_size = size();
+    result.m_margins = m_marginBox;
+    rareData.m_hasCachedLayoutResult = true;
+}
+
 LayoutUnit RenderBox::adjustBorderBoxLogicalWidthForBoxSizing(LayoutUnit width) const
 {
     LayoutUnit bordersPlusPadding = borderAndPaddingLogicalWidth();
@@ -1911,7 +2006,7 @@ void RenderBox::computeLogicalWidth(LogicalExtentComputedValues& computedValues)
     }
 
     // If layout is limited to a subtree, the subtree root's logical width does not change.
-    if (node() && view()->frameView() && view()->frameView()->layoutRoot(true) == this)
+    if (node() && view()->frameView() && view()->frameView()->isLayoutSubtreeRoot(*this, true))
         return;
 
     // The parent box is flexing us, so it has increased or decreased our
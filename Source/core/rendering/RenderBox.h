@@ -46,6 +46,52 @@ enum ScrollOffsetClamping {
     ScrollOffsetClamped
 };
 
+// The sizes given to a box from outside of it that its layout depends on.
+struct RenderBoxLayoutConstraints {
+    RenderBoxLayoutConstraints()
+        : m_containingBlockLogicalWidth(-1)
+        , m_overrideLogicalContentWidth(-1)
+        , m_overrideLogicalContentHeight(-1)
+        , m_overrideContainingBlockContentLogicalWidth(-1)
+        , m_overrideContainingBlockContentLogicalHeight(-1)
+        , m_percentageResolutionLogicalHeight(-1)
+        , m_hasOverrideContainingBlockLogicalWidth(false)
+        , m_hasOverrideContainingBlockLogicalHeight(false)
+    {
+    }
+
+    bool operator==(const RenderBoxLayoutConstraints& o) const
+    {
+        return m_containingBlockLogicalWidth == o.m_containingBlockLogicalWidth
+            && m_overrideLogicalContentWidth == o.m_overrideLogicalContentWidth
+            && m_overrideLogicalContentHeight == o.m_overrideLogicalContentHeight
+            && m_overrideContainingBlockContentLogicalWidth == o.m_overrideContainingBlockContentLogicalWidth
+            && m_overrideContainingBlockContentLogicalHeight == o.m_overrideContainingBlockContentLogicalHeight
+            && m_percentageResolutionLogicalHeight == o.m_percentageResolutionLogicalHeight
+            && m_hasOverrideContainingBlockLogicalWidth == o.m_hasOverrideContainingBlockLogicalWidth
+            && m_hasOverrideContainingBlockLogicalHeight == o.m_hasOverrideContainingBlockLogicalHeight;
+    }
+    bool operator!=(const RenderBoxLayoutConstraints& o) const { return !(*this == o); }
+
+    LayoutUnit m_containingBlockLogicalWidth;
+    LayoutUnit m_overrideLogicalContentWidth;
+    LayoutUnit m_overrideLogicalContentHeight;
+    // Grid items resolve percentages against these, and -1 is a valid value.
+    LayoutUnit m_overrideContainingBlockContentLogicalWidth;
+    LayoutUnit m_overrideContainingBlockContentLogicalHeight;
+    // What percentage heights of the box itself resolve against.
+    LayoutUnit m_percentageResolutionLogicalHeight;
+    bool m_hasOverrideContainingBlockLogicalWidth;
+    bool m_hasOverrideContainingBlockLogicalHeight;
+};
+
+// The result of the last layout of a box and the constraints it was laid out with.
+struct RenderBoxLayoutResult {
+    RenderBoxLayoutConstraints m_constraints;
+    LayoutSize m_size;
+    LayoutBoxExtent m_margins;
+};
+
 struct RenderBoxRareData {
     WTF_MAKE_NONCOPYABLE(RenderBoxRareData); WTF_MAKE_FAST_ALLOCATED;
 public:
@@ -54,6 +100,7 @@ public:
         , m_overrideLogicalContentHeight(-1)
         , m_overrideLogicalContentWidth(-1)
         , m_previousBorderBoxSize(-1, -1)
+        , m_hasCachedLayoutResult(false)
     {
     }
 
@@ -65,6 +112,10 @@ public:
 
     // Set by RenderBox::updatePreviousBorderBoxSizeIfNeeded().
     LayoutSize m_previousBorderBoxSize;
+
+    // Set by RenderBox::updateCachedLayoutResult().
+    RenderBoxLayoutResult m_cachedLayoutResult;
+    bool m_hasCachedLayoutResult;
 };
 
 class RenderBox : public RenderBoxModelObject {
@@ -621,9 +672,16 @@ public:
     bool backgroundHasOpaqueTopLayer() const;
 
     void updateIntrinsicContentLogicalHeight(LayoutUnit intrinsicContentLogicalHeight) const { m_intrinsicContentLogicalHeight = intrinsicContentLogicalHeight; }
+
 protected:
     virtual void willBeDestroyed() OVERRIDE;
 
+    // Containers lay out children with percentage heights whenever they are laid out
+    // themselves, and flex and grid containers lay out their items again while they
+    // size them. A box that receives the same constraints as in its last layout, and
+    // whose subtree is otherwise clean, keeps the size and margins of that layout.
+    bool useCachedLayoutResultIfPossible();
+    void updateCachedLayoutResult();
 
     virtual void styleWillChange(StyleDifference, const RenderStyle& newStyle) OVERRIDE;
     virtual void styleDidChange(StyleDifference, const RenderStyle* oldStyle) OVERRIDE;
@@ -712,6 +770,10 @@ private:
 
     bool logicalHeightComputesAsNone(SizeType) const;
 
+    bool canCacheLayoutResult() const;
+    bool needsLayoutOnlyBecauseOfContainer() const;
+    RenderBoxLayoutConstraints currentLayoutConstraints() const;
+
     virtual InvalidationReason invalidatePaintIfNeeded(const PaintInvalidationState&, const RenderLayerModelObject& newPaintInvalidationContainer) OVERRIDE FINAL;
 
     bool isBox() const WTF_DELETED_FUNCTION; // This will catch anyone doing an unnecessary check.
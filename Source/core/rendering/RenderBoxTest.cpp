@@ -0,0 +1,95 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "config.h"
+#include "core/rendering/RenderBox.h"
+
+#include "core/HTMLNames.h"
+#include "core/dom/Element.h"
+#include "core/rendering/RenderingTestHelper.h"
+#include "platform/RuntimeEnabledFeatures.h"
+#include <gtest/gtest.h>
+
+namespace blink {
+
+namespace {
+
+class RenderBoxLayoutResultCacheTest : public RenderingTest {
+protected:
+    virtual void SetUp() OVERRIDE
+    {
+        m_wasEnabled = RuntimeEnabledFeatures::layoutResultCacheEnabled();
+        RuntimeEnabledFeatures::setLayoutResultCacheEnabled(true);
+        RenderingTest::SetUp();
+        document().setCompatibilityMode(Document::NoQuirksMode);
+    }
+
+    virtual void TearDown() OVERRIDE
+    {
+        RuntimeEnabledFeatures::setLayoutResultCacheEnabled(m_wasEnabled);
+    }
+
+    RenderBox* renderBox(const char* id) const
+    {
+        return toRenderBox(document().getElementById(AtomicString(id))->renderer());
+    }
+
+    unsigned cachedLayoutResultCount() const { return document().view()->cachedLayoutResultCount(); }
+
+    void updateLayout()
+    {
+        document().view()->updateLayoutAndStyleIfNeededRecursive();
+    }
+
+private:
+    bool m_wasEnabled;
+};
+
+TEST_F(RenderBoxLayoutResultCacheTest, PercentHeightChildKeepsResult)
+{
+    setBodyInnerHTML("<div id='container' style='height: 300px'>"
+        "<div id='target' style='height: 50%; overflow: hidden'>Some text</div>"
+        "<div id='sibling'>Other text</div></div>");
+    EXPECT_EQ(LayoutUnit(150), renderBox("target")->logicalHeight());
+
+    // The container lays out its percentage height child again, with the same constraints.
+    unsigned hitCount = cachedLayoutResultCount();
+    document().getElementById("sibling")->setTextContent("Changed text");
+    updateLayout();
+    EXPECT_EQ(hitCount + 1, cachedLayoutResultCount());
+    EXPECT_EQ(LayoutUnit(150), renderBox("target")->logicalHeight());
+}
+
+TEST_F(RenderBoxLayoutResultCacheTest, ChangedConstraintsLayOutAgain)
+{
+    setBodyInnerHTML("<div id='container' style='height: 300px; width: 300px'>"
+        "<div id='target' style='height: 50%; overflow: hidden'>Some text</div></div>");
+
+    unsigned hitCount = cachedLayoutResultCount();
+    document().getElementById("container")->setAttribute(HTMLNames::styleAttr, "height: 400px; width: 300px");
+    updateLayout();
+    EXPECT_EQ(hitCount, cachedLayoutResultCount());
+    EXPECT_EQ(LayoutUnit(200), renderBox("target")->logicalHeight());
+
+    document().getElementById("container")->setAttribute(HTMLNames::styleAttr, "height: 400px; width: 200px");
+    updateLayout();
+    EXPECT_EQ(hitCount, cachedLayoutResultCount());
+    EXPECT_EQ(LayoutUnit(200), renderBox("target")->logicalWidth());
+}
+
+TEST_F(RenderBoxLayoutResultCacheTest, DirtySubtreeLaysOutAgain)
+{
+    setBodyInnerHTML("<div id='container' style='height: 300px'>"
+        "<div id='target' style='height: 50%; overflow: hidden'><div id='inner'>Some text</div></div></div>");
+
+    unsigned hitCount = cachedLayoutResultCount();
+    document().getElementById("inner")->setAttribute(HTMLNames::styleAttr, "height: 20px");
+    updateLayout();
+    EXPECT_EQ(hitCount, cachedLayoutResultCount());
+    EXPECT_EQ(LayoutUnit(20), renderBox("inner")->logicalHeight());
+}
+
+} // namespace
+
+} // namespace blink
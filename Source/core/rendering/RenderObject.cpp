@@ -2334,13 +2334,13 @@ inline void RenderObject::clearLayoutRootIfNeeded() const
 {
     if (frame()) {
         if (FrameView* view = frame()->view()) {
-            if (view->layoutRoot() == this) {
+            if (view->isLayoutSubtreeRoot(*this)) {
                 if (!documentBeingDestroyed())
                     ASSERT_NOT_REACHED();
                 // This indicates a failure to layout the child, which is why
                 // the layout root is still set to |this|. Make sure to clear it
                 // since we are getting destroyed.
-                view->clearLayoutSubtreeRoot();
+                view->clearLayoutSubtreeRoot(*this);
             }
         }
     }
@@ -40,6 +40,8 @@
 #include "core/rendering/RenderView.h"
 #include "core/rendering/TextRunConstructor.h"
 #include "core/rendering/break_lines.h"
+#include "core/rendering/line/TextSegmentWidths.h"
+#include "platform/RuntimeEnabledFeatures.h"
 #include "platform/fonts/Character.h"
 #include "platform/fonts/FontCache.h"
 #include "platform/geometry/FloatQuad.h"
@@ -68,6 +70,9 @@ class SecureTextTimer;
 typedef HashMap<RenderText*, SecureTextTimer*> SecureTextTimerMap;
 static SecureTextTimerMap* gSecureTextTimers = 0;
 
+typedef HashMap<const RenderText*, OwnPtr<TextSegmentWidths> > SegmentWidthsMap;
+static SegmentWidthsMap* gSegmentWidths = 0;
+
 class SecureTextTimer FINAL : public TimerBase {
 public:
     SecureTextTimer(RenderText* renderText)
@@ -142,6 +147,7 @@ RenderText::RenderText(Node* node, PassRefPtr<StringImpl> str)
     , m_linesDirty(false)
     , m_containsReversedText(false)
     , m_knownToHaveNoOverflowAndNoFallbackFonts(false)
+    , m_hasSegmentWidths(false)
     , m_minWidth(-1)
     , m_maxWidth(-1)
     , m_firstLineMinWidth(0)
@@ -197,6 +203,7 @@ void RenderText::styleDidChange(StyleDifference diff, const RenderStyle* oldStyl
     if (diff.needsFullLayout()) {
         setNeedsLayoutAndPrefWidthsRecalc();
         m_knownToHaveNoOverflowAndNoFallbackFonts = false;
+        clearSegmentWidths();
     }
 
     RenderStyle* newStyle = style();
@@ -233,6 +240,7 @@ void RenderText::willBeDestroyed()
 {
     if (SecureTextTimer* secureTextTimer = gSecureTextTimers ? gSecureTextTimers->take(this) : 0)
         delete secureTextTimer;
+    clearSegmentWidths();
 
     removeAndDestroyTextBoxes();
     RenderObject::willBeDestroyed();
@@ -711,6 +719,28 @@ LayoutRect RenderText::localCaretRect(InlineBox* inlineBox, int caretOffset, Lay
     return style()->isHorizontalWritingMode() ? IntRect(left, top, caretWidth, height) : IntRect(top, left, height, caretWidth);
 }
 
+bool RenderText::widthFromSegments(unsigned from, unsigned len, const Font& f, float& width) const
+{
+    if (!RuntimeEnabledFeatures::segmentedTextShapingEnabled() || canUseSimpleFontCodePath() || &f != &style()->font())
+        return false;
+
+    if (!gSegmentWidths)
+        gSegmentWidths = new SegmentWidthsMap;
+    OwnPtr<TextSegmentWidths>& segmentWidths = gSegmentWidths->add(this, nullptr).storedValue->value;
+    if (!segmentWidths || !segmentWidths->isValidFor(f))
+        segmentWidths = TextSegmentWidths::create(const_cast<RenderText*>(this), f);
+    m_hasSegmentWidths = true;
+    return segmentWidths->width(from, len, width);
+}
+
+void RenderText::clearSegmentWidths()
+{
+    if (!m_hasSegmentWidths)
+        return;
+    gSegmentWidths->remove(this);
+    m_hasSegmentWidths = false;
+}
+
 ALWAYS_INLINE float RenderText::widthFromCache(const Font& f, int start, int len, float xPos, TextDirection textDirection, HashSet<const SimpleFontData*>* fallbackFonts, GlyphOverflow* glyphOverflow) const
 {
     if (style()->hasTextCombine() && isCombineText()) {
@@ -1382,6 +1412,7 @@ void RenderText::setTextInternal(PassRefPtr<StringImpl> text)
 
     m_isAllASCII = m_text.containsOnlyASCII();
     m_canUseSimpleFontCodePath = computeCanUseSimpleFontCodePath();
+    clearSegmentWidths();
 }
 
 void RenderText::secureText(UChar mask)
@@ -141,6 +141,11 @@ public:
 
     bool canUseSimpleFontCodePath() const { return m_canUseSimpleFontCodePath; }
 
+    // Looks up the width of a range of text that takes the complex text path
+    // from the widths of its segments between line break opportunities,
+    // which are shaped once. Returns false if the width is not known.
+    bool widthFromSegments(unsigned from, unsigned len, const Font&, float& width) const;
+
     void removeAndDestroyTextBoxes();
 
     PassRefPtr<AbstractInlineTextBox> firstAbstractInlineTextBox();
@@ -163,6 +168,7 @@ private:
     void computePreferredLogicalWidths(float leadWidth, HashSet<const SimpleFontData*>& fallbackFonts, GlyphOverflow&);
 
     bool computeCanUseSimpleFontCodePath() const;
+    void clearSegmentWidths();
 
     // Make length() private so that callers that have a RenderText*
     // will use the more efficient textLength() instead, while
@@ -201,6 +207,7 @@ private:
     bool m_isAllASCII : 1;
     bool m_canUseSimpleFontCodePath : 1;
     mutable bool m_knownToHaveNoOverflowAndNoFallbackFonts : 1;
+    mutable bool m_hasSegmentWidths : 1;
 
     float m_minWidth;
     float m_maxWidth;
@@ -519,6 +519,12 @@ ALWAYS_INLINE float textWidth(RenderText* text, unsigned from, unsigned len, con
     if (isFixedPitch || (!from && len == text->textLength()) || text->style()->hasTextCombine())
         return text->width(from, len, font, xPos, text->style()->direction(), fallbackFonts, &glyphOverflow);
 
+    // Without tabs the width does not depend on xPos, and text made up of
+    // the same segments always has the same width.
+    float width;
+    if (collapseWhiteSpace && text->widthFromSegments(from, len, font, width))
+        return width;
+
     TextRun run = constructTextRun(text, font, text, from, len, text->style());
     run.setCharacterScanForCodePath(!text->canUseSimpleFontCodePath());
     run.setUseComplexCodePath(!text->canUseSimpleFontCodePath());
@@ -0,0 +1,78 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "config.h"
+#include "core/rendering/line/TextSegmentWidths.h"
+
+#include "core/rendering/RenderText.h"
+#include "core/rendering/TextRunConstructor.h"
+#include "core/rendering/break_lines.h"
+#include "platform/text/TextBreakIterator.h"
+#include <algorithm>
+
+namespace blink {
+
+static inline bool isSegmentSpace(UChar c)
+{
+    return c == ' ' || c == '\t' || c == '\n';
+}
+
+PassOwnPtr<TextSegmentWidths> TextSegmentWidths::create(RenderText* text, const Font& font)
+{
+    return adoptPtr(new TextSegmentWidths(text, font));
+}
+
+TextSegmentWidths::TextSegmentWidths(RenderText* text, const Font& font)
+    : m_font(font)
+{
+    // Word spacing is added at the ends of words, which the shaper cannot
+    // find in a segment on its own.
+    if (font.fontDescription().wordSpacing())
+        return;
+
+    RenderStyle* style = text->style();
+    LazyLineBreakIterator lineBreakIterator(text->text(), style->locale());
+    int nextBreakable = -1;
+    unsigned length = text->textLength();
+    HashSet<const SimpleFontData*> fallbackFonts;
+
+    m_offsets.append(0);
+    m_widths.append(0);
+    for (unsigned offset = 1; offset <= length; ++offset) {
+        if (offset < length && !isBreakable(lineBreakIterator, offset, nextBreakable)
+            && !(isSegmentSpace((*text)[offset - 1]) && !isSegmentSpace((*text)[offset])))
+            continue;
+
+        unsigned start = m_offsets.last();
+        TextRun run = constructTextRun(text, font, text, start, offset - start, style);
+        run.setCharacterScanForCodePath(true);
+        run.setUseComplexCodePath(true);
+        float segmentWidth = font.width(run, &fallbackFonts);
+
+        // Line layout needs to know which words use fallback fonts, so text
+        // that uses them is measured as before.
+        if (!fallbackFonts.isEmpty()) {
+            m_offsets.clear();
+            m_widths.clear();
+            return;
+        }
+
+        m_offsets.append(offset);
+        m_widths.append(m_widths.last() + segmentWidth);
+    }
+}
+
+bool TextSegmentWidths::width(unsigned from, unsigned length, float& width) const
+{
+    const unsigned* start = std::lower_bound(m_offsets.begin(), m_offsets.end(), from);
+    if (start == m_offsets.end() || *start != from)
+        return false;
+    const unsigned* end = std::lower_bound(start, m_offsets.end(), from + length);
+    if (end == m_offsets.end() || *end != from + length)
+        return false;
+    width = m_widths[end - m_offsets.begin()] - m_widths[start - m_offsets.begin()];
+    return true;
+}
+
+} // namespace blink
@@ -0,0 +1,48 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TextSegmentWidths_h
+#define TextSegmentWidths_h
+
+#include "platform/fonts/Font.h"
+#include "wtf/FastAllocBase.h"
+#include "wtf/Noncopyable.h"
+#include "wtf/PassOwnPtr.h"
+#include "wtf/Vector.h"
+
+namespace blink {
+
+class RenderText;
+
+// The widths of the text of a RenderText that takes the complex text path,
+// split into segments at line break opportunities and at the ends of runs of
+// spaces. Each segment is shaped once, and the widths of the ranges the line
+// breaker measures, which start and end at such positions, are looked up
+// from the running sums of the segment widths instead of shaping the range
+// again on every layout.
+class TextSegmentWidths {
+    WTF_MAKE_NONCOPYABLE(TextSegmentWidths); WTF_MAKE_FAST_ALLOCATED;
+public:
+    static PassOwnPtr<TextSegmentWidths> create(RenderText*, const Font&);
+
+    bool isValidFor(const Font& font) const { return m_font == font; }
+
+    // Returns false if the width of the range is not known, because it does
+    // not start and end at segment boundaries or because the text could not
+    // be measured in segments.
+    bool width(unsigned from, unsigned length, float& width) const;
+
+private:
+    TextSegmentWidths(RenderText*, const Font&);
+
+    Font m_font;
+    // The segment boundaries in ascending order, and the widths of the text
+    // up to each of them.
+    Vector<unsigned> m_offsets;
+    Vector<float> m_widths;
+};
+
+} // namespace blink
+
+#endif // TextSegmentWidths_h
@@ -0,0 +1,98 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "config.h"
+#include "core/rendering/line/TextSegmentWidths.h"
+
+#include "core/dom/Element.h"
+#include "core/rendering/RenderText.h"
+#include "core/rendering/RenderingTestHelper.h"
+#include "core/rendering/TextRunConstructor.h"
+#include <gtest/gtest.h>
+
+namespace blink {
+
+namespace {
+
+class TextSegmentWidthsTest : public RenderingTest {
+protected:
+    RenderText* renderText(const char* id) const
+    {
+        return toRenderText(document().getElementById(AtomicString(id))->firstChild()->renderer());
+    }
+
+    // Checks that every range the widths are known for has the width
+    // Font::width gives for the whole range, and returns the number of such
+    // ranges.
+    unsigned checkKnownWidths(RenderText* text, const TextSegmentWidths& segmentWidths)
+    {
+        const Font& font = text->style()->font();
+        unsigned count = 0;
+        unsigned length = text->textLength();
+        for (unsigned from = 0; from < length; ++from) {
+            for (unsigned to = from + 1; to <= length; ++to) {
+                float width;
+                if (!segmentWidths.width(from, to - from, width))
+                    continue;
+                TextRun run = constructTextRun(text, font, text, from, to - from, text->style());
+                run.setCharacterScanForCodePath(true);
+                run.setUseComplexCodePath(true);
+                EXPECT_NEAR(font.width(run), width, 0.01f) << from << "-" << to;
+                ++count;
+            }
+        }
+        return count;
+    }
+
+    bool needsFallbackFonts(RenderText* text)
+    {
+        const Font& font = text->style()->font();
+        TextRun run = constructTextRun(text, font, text, 0, text->textLength(), text->style());
+        run.setCharacterScanForCodePath(true);
+        run.setUseComplexCodePath(true);
+        HashSet<const SimpleFontData*> fallbackFonts;
+        font.width(run, &fallbackFonts);
+        return !fallbackFonts.isEmpty();
+    }
+};
+
+TEST_F(TextSegmentWidthsTest, WidthsMatchFontWidth)
+{
+    // Kerning pairs and ligatures within words, and runs of spaces.
+    setBodyInnerHTML("<div id='text'>AVAVA To. Wa  office-ffl fi,   Yo</div>");
+    RenderText* text = renderText("text");
+    ASSERT_FALSE(needsFallbackFonts(text));
+    const Font& font = text->style()->font();
+    OwnPtr<TextSegmentWidths> segmentWidths = TextSegmentWidths::create(text, font);
+    EXPECT_TRUE(segmentWidths->isValidFor(font));
+
+    EXPECT_GT(checkKnownWidths(text, *segmentWidths), 0u);
+    float width;
+    EXPECT_TRUE(segmentWidths->width(0, text->textLength(), width));
+    // Ranges within words are not known.
+    EXPECT_FALSE(segmentWidths->width(1, 2, width));
+}
+
+TEST_F(TextSegmentWidthsTest, WidthsMatchFontWidthForMixedArabicAndHindi)
+{
+    setBodyInnerHTML("<div id='text'>\xD9\x85\xD8\xB1\xD8\xAD\xD8\xA8\xD8\xA7 \xD8\xA8\xD8\xA7\xD9\x84\xD8\xB9\xD8\xA7\xD9\x84\xD9\x85 "
+        "\xE0\xA4\xA8\xE0\xA4\xAE\xE0\xA4\xB8\xE0\xA5\x8D\xE0\xA4\xA4\xE0\xA5\x87  \xE0\xA4\xA6\xE0\xA5\x81\xE0\xA4\xA8\xE0\xA4\xBF\xE0\xA4\xAF\xE0\xA4\xBE "
+        "\xD8\xB3\xD9\x84\xD8\xA7\xD9\x85-\xE0\xA4\xB6\xE0\xA4\xBE\xE0\xA4\x82\xE0\xA4\xA4\xE0\xA4\xBF</div>");
+    RenderText* text = renderText("text");
+    const Font& font = text->style()->font();
+    OwnPtr<TextSegmentWidths> segmentWidths = TextSegmentWidths::create(text, font);
+    EXPECT_TRUE(segmentWidths->isValidFor(font));
+
+    // The widths are not known at all if the text needs fallback fonts,
+    // which depends on the fonts installed.
+    unsigned count = checkKnownWidths(text, *segmentWidths);
+    if (needsFallbackFonts(text))
+        EXPECT_EQ(0u, count);
+    else
+        EXPECT_GT(count, 0u);
+}
+
+} // namespace
+
+} // namespace blink
@@ -35,6 +35,8 @@ public:
     const T& operator*() const { return *get(); }
     const T* operator->() const { return get(); }
 
+    bool hasOneRef() const { return m_data->hasOneRef(); }
+
     T* access()
     {
         if (!m_data->hasOneRef())
@@ -123,6 +123,7 @@ class RenderStyle: public RefCounted<RenderStyle> {
     friend class CSSComputedStyleDeclaration; // Ignores visited styles, so needs to be able to see unvisited info.
     friend class StyleBuilderFunctions; // Sets color styles
     friend class CachedUAStyle; // Saves Border/Background information for later comparison.
+    friend class StyleDataInterner; // Shares equal data groups between styles.
 
     // FIXME: When we stop resolving currentColor at style time, these can be removed.
     friend class CSSToStyleMap;
@@ -0,0 +1,85 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "config.h"
+#include "core/rendering/style/StyleDataInterner.h"
+
+namespace blink {
+
+template <typename T>
+static bool dataEquals(const T& a, const T& b)
+{
+    return a == b;
+}
+
+// operator== ignores the compositor animation flags, which are updated on
+// styles that are already in use, but interned groups must match exactly.
+static bool dataEquals(const StyleRareNonInheritedData& a, const StyleRareNonInheritedData& b)
+{
+    return a == b
+        && a.m_runningOpacityAnimationOnCompositor == b.m_runningOpacityAnimationOnCompositor
+        && a.m_runningTransformAnimationOnCompositor == b.m_runningTransformAnimationOnCompositor
+        && a.m_runningFilterAnimationOnCompositor == b.m_runningFilterAnimationOnCompositor;
+}
+
+template <typename T>
+size_t StyleDataInterner::Table<T>::intern(DataRef<T>& data)
+{
+    // Styles mostly share groups they did not set with their parent or the
+    // initial style, so look for the group itself before comparing values.
+    for (size_t i = 0; i < m_entries.size(); ++i) {
+        if (m_entries[i].get() == data.get()) {
+            moveToFront(i);
+            return 0;
+        }
+    }
+    for (size_t i = 0; i < m_entries.size(); ++i) {
+        if (dataEquals(*m_entries[i], *data)) {
+            size_t freedBytes = data.hasOneRef() ? sizeof(T) : 0;
+            data = m_entries[i];
+            moveToFront(i);
+            return freedBytes;
+        }
+    }
+    if (m_entries.size() == maximumSize)
+        m_entries.removeLast();
+    m_entries.insert(0, data);
+    return 0;
+}
+
+template <typename T>
+void StyleDataInterner::Table<T>::moveToFront(size_t index)
+{
+    if (!index)
+        return;
+    DataRef<T> data = m_entries[index];
+    m_entries.remove(index);
+    m_entries.insert(0, data);
+}
+
+size_t StyleDataInterner::intern(RenderStyle& style)
+{
+    return m_box.intern(style.m_box)
+        + m_visual.intern(style.visual)
+        + m_background.intern(style.m_background)
+        + m_surround.intern(style.surround)
+        + m_rareNonInheritedData.intern(style.rareNonInheritedData)
+        + m_rareInheritedData.intern(style.rareInheritedData)
+        + m_inherited.intern(style.inherited)
+        + m_svgStyle.intern(style.m_svgStyle);
+}
+
+void StyleDataInterner::clear()
+{
+    m_box.clear();
+    m_visual.clear();
+    m_background.clear();
+    m_surround.clear();
+    m_rareNonInheritedData.clear();
+    m_rareInheritedData.clear();
+    m_inherited.clear();
+    m_svgStyle.clear();
+}
+
+} // namespace blink
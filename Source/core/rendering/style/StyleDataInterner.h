@@ -0,0 +1,65 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef StyleDataInterner_h
+#define StyleDataInterner_h
+
+#include "core/rendering/style/RenderStyle.h"
+#include "wtf/FastAllocBase.h"
+#include "wtf/Noncopyable.h"
+#include "wtf/PassOwnPtr.h"
+#include "wtf/Vector.h"
+
+namespace blink {
+
+// StyleDataInterner points the data groups of resolved styles at equal groups
+// of previously interned styles, so that a group copied by a setter is freed
+// once it turns out to hold the same values as a group seen before. The
+// groups have no hash, so for each group type the few most recently interned
+// distinct groups are kept and compared against, most recent first.
+//
+// The interned groups stay shared by all styles that use them. Setters on any
+// of those styles copy the group first, as for any other shared group.
+class StyleDataInterner {
+    WTF_MAKE_NONCOPYABLE(StyleDataInterner); WTF_MAKE_FAST_ALLOCATED;
+public:
+    static PassOwnPtr<StyleDataInterner> create()
+    {
+        return adoptPtr(new StyleDataInterner);
+    }
+
+    // Returns the number of bytes of groups that were freed.
+    size_t intern(RenderStyle&);
+    // Called with the style sharing lists after each style recalc, so that
+    // the interner does not keep groups of discarded styles alive.
+    void clear();
+
+private:
+    StyleDataInterner() { }
+
+    template <typename T> class Table {
+    public:
+        size_t intern(DataRef<T>&);
+        void clear() { m_entries.clear(); }
+
+    private:
+        void moveToFront(size_t index);
+
+        static const size_t maximumSize = 4;
+        Vector<DataRef<T>, maximumSize> m_entries;
+    };
+
+    Table<StyleBoxData> m_box;
+    Table<StyleVisualData> m_visual;
+    Table<StyleBackgroundData> m_background;
+    Table<StyleSurroundData> m_surround;
+    Table<StyleRareNonInheritedData> m_rareNonInheritedData;
+    Table<StyleRareInheritedData> m_rareInheritedData;
+    Table<StyleInheritedData> m_inherited;
+    Table<SVGRenderStyle> m_svgStyle;
+};
+
+} // namespace blink
+
+#endif // StyleDataInterner_h
@@ -0,0 +1,72 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "config.h"
+#include "core/rendering/style/StyleDataInterner.h"
+
+#include <gtest/gtest.h>
+
+using namespace blink;
+
+namespace {
+
+TEST(StyleDataInternerTest, SharesEqualGroups)
+{
+    OwnPtr<StyleDataInterner> interner = StyleDataInterner::create();
+    RefPtr<RenderStyle> first = RenderStyle::create();
+    RefPtr<RenderStyle> second = RenderStyle::create();
+    first->setFillOpacity(0.5);
+    second->setFillOpacity(0.5);
+    ASSERT_NE(&first->svgStyle(), &second->svgStyle());
+
+    EXPECT_EQ(0u, interner->intern(*first));
+    EXPECT_EQ(sizeof(SVGRenderStyle), interner->intern(*second));
+    EXPECT_EQ(&first->svgStyle(), &second->svgStyle());
+
+    // Interning again finds the group itself and frees nothing.
+    EXPECT_EQ(0u, interner->intern(*second));
+}
+
+TEST(StyleDataInternerTest, DoesNotShareDifferentGroups)
+{
+    OwnPtr<StyleDataInterner> interner = StyleDataInterner::create();
+    RefPtr<RenderStyle> first = RenderStyle::create();
+    RefPtr<RenderStyle> second = RenderStyle::create();
+    first->setFillOpacity(0.5);
+    second->setFillOpacity(0.25);
+
+    interner->intern(*first);
+    EXPECT_EQ(0u, interner->intern(*second));
+    EXPECT_NE(&first->svgStyle(), &second->svgStyle());
+}
+
+TEST(StyleDataInternerTest, SettersCopySharedGroups)
+{
+    OwnPtr<StyleDataInterner> interner = StyleDataInterner::create();
+    RefPtr<RenderStyle> first = RenderStyle::create();
+    RefPtr<RenderStyle> second = RenderStyle::create();
+    first->setFillOpacity(0.5);
+    second->setFillOpacity(0.5);
+    interner->intern(*first);
+    interner->intern(*second);
+
+    second->setFillOpacity(0.25);
+    EXPECT_NE(&first->svgStyle(), &second->svgStyle());
+    EXPECT_EQ(0.5, first->fillOpacity());
+    EXPECT_EQ(0.25, second->fillOpacity());
+
+    // The interner keeps its own reference, so the last style using a group
+    // does not modify it in place either.
+    RefPtr<RenderStyle> third = RenderStyle::create();
+    third->setFillOpacity(0.5);
+    interner->intern(*third);
+    first.clear();
+    third->setFillOpacity(0.75);
+    RefPtr<RenderStyle> fourth = RenderStyle::create();
+    fourth->setFillOpacity(0.5);
+    interner->intern(*fourth);
+    EXPECT_EQ(0.5, fourth->fillOpacity());
+}
+
+} // namespace
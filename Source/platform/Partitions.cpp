@@ -31,6 +31,8 @@
 #include "config.h"
 #include "platform/Partitions.h"
 
+#include "wtf/WTF.h"
+
 namespace blink {
 
 SizeSpecificPartitionAllocator<3072> Partitions::m_objectModelAllocator;
@@ -51,4 +53,11 @@ void Partitions::shutdown()
     (void) m_objectModelAllocator.shutdown();
 }
 
+void Partitions::dumpMemoryStats(WTF::PartitionStatsDumper* dumper)
+{
+    partitionDumpStats(m_objectModelAllocator.root(), "objectModel", dumper);
+    partitionDumpStats(m_renderingAllocator.root(), "rendering", dumper);
+    WTF::Partitions::dumpMemoryStats(dumper);
+}
+
 } // namespace blink
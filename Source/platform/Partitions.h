@@ -40,6 +40,8 @@ class PLATFORM_EXPORT Partitions {
 public:
     static void init();
     static void shutdown();
+    // Reports the statistics of the Blink partitions and of the WTF ones.
+    static void dumpMemoryStats(WTF::PartitionStatsDumper*);
 
     ALWAYS_INLINE static PartitionRoot* getObjectModelPartition() { return m_objectModelAllocator.root(); }
     ALWAYS_INLINE static PartitionRoot* getRenderingPartition() { return m_renderingAllocator.root(); }
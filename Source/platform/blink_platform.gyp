@@ -254,6 +254,7 @@
           ['include', 'fonts/harfbuzz/FontHarfBuzz\\.cpp$'],
           ['include', 'fonts/harfbuzz/HarfBuzzFace\\.(cpp|h)$'],
           ['include', 'fonts/harfbuzz/HarfBuzzFaceSkia\\.cpp$'],
+          ['include', 'fonts/harfbuzz/HarfBuzzShapeCache\\.(cpp|h)$'],
           ['include', 'fonts/harfbuzz/HarfBuzzShaper\\.(cpp|h)$'],
           ['include', 'fonts/opentype/OpenTypeTypes\\.h$'],
           ['include', 'fonts/opentype/OpenTypeVerticalData\\.(cpp|h)$'],
@@ -335,6 +336,7 @@
           # Mac uses Harfbuzz.
           ['include', 'fonts/harfbuzz/HarfBuzzFaceCoreText\\.cpp$'],
           ['include', 'fonts/harfbuzz/HarfBuzzFace\\.(cpp|h)$'],
+          ['include', 'fonts/harfbuzz/HarfBuzzShapeCache\\.(cpp|h)$'],
           ['include', 'fonts/harfbuzz/HarfBuzzShaper\\.(cpp|h)$'],
 
           ['include', 'geometry/mac/FloatPointMac\\.mm$'],
@@ -77,6 +77,7 @@
         '<(DEPTH)/url/url.gyp:url_lib',
         'blink_platform.gyp:blink_common',
         'blink_platform.gyp:blink_platform',
+        '<(DEPTH)/third_party/harfbuzz-ng/harfbuzz.gyp:harfbuzz-ng',
       ],
       'defines': [
         'INSIDE_BLINK',
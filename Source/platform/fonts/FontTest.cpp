@@ -27,9 +27,16 @@
 
 #include "config.h"
 
+#include "platform/RuntimeEnabledFeatures.h"
 #include "platform/fonts/Character.h"
 #include "platform/fonts/Font.h"
 
+#include "platform/fonts/FontDescription.h"
+#include "platform/fonts/harfbuzz/HarfBuzzShapeCache.h"
+#include "platform/fonts/harfbuzz/HarfBuzzShaper.h"
+#include "platform/text/TextRun.h"
+#include "public/platform/Platform.h"
+#include "wtf/text/StringBuilder.h"
 #include <gtest/gtest.h>
 
 namespace blink {
@@ -362,5 +369,169 @@ TEST(FontTest, TestIsCJKIdeographOrSymbol)
     TestSpecificUChar32RangeIdeographSymbol(0x1F200, 0x1F6FF);
 }
 
-} // namespace blink
+static hb_buffer_t* createShapedBuffer(unsigned glyphCount)
+{
+    hb_buffer_t* buffer = hb_buffer_create();
+    for (unsigned i = 0; i < glyphCount; ++i)
+        hb_buffer_add(buffer, 'a', i);
+    return buffer;
+}
+
+static HarfBuzzShapeCacheKey shapeCacheKey(const String& text)
+{
+    return HarfBuzzShapeCacheKey(text, HB_DIRECTION_LTR, HB_SCRIPT_LATIN, hb_language_from_string("en", -1), Vector<hb_feature_t, 4>(), false);
+}
+
+TEST(FontTest, HarfBuzzShapeCacheFindAndAdd)
+{
+    OwnPtr<HarfBuzzShapeCache> cache = HarfBuzzShapeCache::create();
+    EXPECT_FALSE(cache->find(shapeCacheKey("word")));
+
+    hb_buffer_t* buffer = createShapedBuffer(4);
+    cache->add(shapeCacheKey("word"), buffer);
+    EXPECT_EQ(buffer, cache->find(shapeCacheKey("word")));
+    EXPECT_EQ(1u, cache->size());
+    EXPECT_LT(0u, cache->sizeInBytes());
+
+    // Anything that changes the shaping result is part of the key.
+    EXPECT_FALSE(cache->find(HarfBuzzShapeCacheKey("word", HB_DIRECTION_RTL, HB_SCRIPT_LATIN, hb_language_from_string("en", -1), Vector<hb_feature_t, 4>(), false)));
+    EXPECT_FALSE(cache->find(HarfBuzzShapeCacheKey("word", HB_DIRECTION_LTR, HB_SCRIPT_LATIN, hb_language_from_string("tr", -1), Vector<hb_feature_t, 4>(), false)));
+    EXPECT_FALSE(cache->find(HarfBuzzShapeCacheKey("word", HB_DIRECTION_LTR, HB_SCRIPT_LATIN, hb_language_from_string("en", -1), Vector<hb_feature_t, 4>(), true)));
+    Vector<hb_feature_t, 4> features;
+    hb_feature_t kerning = { HB_TAG('k', 'e', 'r', 'n'), 0, 0, static_cast<unsigned>(-1) };
+    features.append(kerning);
+    EXPECT_FALSE(cache->find(HarfBuzzShapeCacheKey("word", HB_DIRECTION_LTR, HB_SCRIPT_LATIN, hb_language_from_string("en", -1), features, false)));
+
+    size_t totalSizeInBytes = HarfBuzzShapeCache::totalSizeInBytes();
+    cache->clear();
+    EXPECT_EQ(0u, cache->size());
+    EXPECT_EQ(0u, cache->sizeInBytes());
+    EXPECT_FALSE(cache->find(shapeCacheKey("word")));
+    EXPECT_GT(totalSizeInBytes, HarfBuzzShapeCache::totalSizeInBytes());
+}
+
+TEST(FontTest, HarfBuzzShapeCacheEvictsLeastRecentlyUsed)
+{
+    OwnPtr<HarfBuzzShapeCache> cache = HarfBuzzShapeCache::create();
+    cache->add(shapeCacheKey("first"), createShapedBuffer(5));
+    cache->find(shapeCacheKey("first"));
+    for (unsigned i = 0; i < 4096; ++i) {
+        cache->add(shapeCacheKey(String::number(i)), createShapedBuffer(1));
+        // Keep the first entry recently used.
+        EXPECT_TRUE(cache->find(shapeCacheKey("first")));
+    }
+    EXPECT_GT(4096u, cache->size());
+    EXPECT_FALSE(cache->find(shapeCacheKey("0")));
+    EXPECT_TRUE(cache->find(shapeCacheKey("4095")));
+
+    // Entries that would take up a large part of the cache are not kept.
+    cache->add(shapeCacheKey("large"), createShapedBuffer(16 * 1024));
+    EXPECT_FALSE(cache->find(shapeCacheKey("large")));
+}
+
+TEST(FontTest, HarfBuzzShapeCacheLimitsApplyToAllCaches)
+{
+    OwnPtr<HarfBuzzShapeCache> firstCache = HarfBuzzShapeCache::create();
+    OwnPtr<HarfBuzzShapeCache> secondCache = HarfBuzzShapeCache::create();
+    firstCache->add(shapeCacheKey("first"), createShapedBuffer(5));
+    for (unsigned i = 0; i < 4096; ++i)
+        secondCache->add(shapeCacheKey(String::number(i)), createShapedBuffer(1));
+    EXPECT_FALSE(firstCache->find(shapeCacheKey("first")));
+    EXPECT_EQ(0u, firstCache->size());
+    EXPECT_GT(4096u, HarfBuzzShapeCache::totalSize());
+
+    unsigned totalSize = HarfBuzzShapeCache::totalSize();
+    unsigned size = secondCache->size();
+    secondCache.clear();
+    EXPECT_EQ(totalSize - size, HarfBuzzShapeCache::totalSize());
+}
 
+class ShapeCachePlatform : public Platform {
+public:
+    virtual void cryptographicallyRandomValues(unsigned char* buffer, size_t length) OVERRIDE { }
+};
+
+// Installs a Platform for loading fonts. The previous Platform and the
+// WordByWordShaping setting are restored when the test ends, also when an
+// assertion fails.
+class ShapingTestScope {
+public:
+    ShapingTestScope()
+        : m_oldPlatform(Platform::current())
+        , m_wordByWordShapingWasEnabled(RuntimeEnabledFeatures::wordByWordShapingEnabled())
+    {
+        Platform::initialize(&m_platform);
+    }
+
+    ~ShapingTestScope()
+    {
+        RuntimeEnabledFeatures::setWordByWordShapingEnabled(m_wordByWordShapingWasEnabled);
+        Platform::initialize(m_oldPlatform);
+    }
+
+private:
+    ShapeCachePlatform m_platform;
+    Platform* m_oldPlatform;
+    bool m_wordByWordShapingWasEnabled;
+};
+
+// Measures a paragraph of repeated Arabic words, which is shaped by HarfBuzz,
+// twice. The second time the words are found in the shape cache.
+TEST(FontTest, ComplexTextWidthUsesShapeCache)
+{
+    ShapingTestScope scope;
+
+    FontDescription fontDescription;
+    fontDescription.setGenericFamily(FontDescription::StandardFamily);
+    fontDescription.setSpecifiedSize(16);
+    fontDescription.setComputedSize(16);
+    Font font(fontDescription);
+    font.update(nullptr);
+    ASSERT_TRUE(font.primaryFont());
+
+    static const UChar word[] = { 0x0643, 0x062A, 0x0627, 0x0628, ' ' };
+    StringBuilder builder;
+    for (unsigned i = 0; i < 200; ++i)
+        builder.append(word, WTF_ARRAY_LENGTH(word));
+    String paragraph = builder.toString();
+    TextRun run(paragraph, 0, 0, TextRun::AllowTrailingExpansion, RTL);
+
+    float width = font.width(run);
+    unsigned hitCount = HarfBuzzShapeCache::totalHitCount();
+    EXPECT_EQ(width, font.width(run));
+    EXPECT_LE(hitCount + 1, HarfBuzzShapeCache::totalHitCount());
+}
+
+// Shaping a word at a time must give the same widths as shaping whole runs,
+// kerning included. Fonts with lookups involving spaces are shaped whole
+// either way.
+TEST(FontTest, WordByWordShapingMatchesWholeRunWidth)
+{
+    ShapingTestScope scope;
+
+    FontDescription fontDescription;
+    fontDescription.setGenericFamily(FontDescription::StandardFamily);
+    fontDescription.setSpecifiedSize(16);
+    fontDescription.setComputedSize(16);
+    fontDescription.setKerning(FontDescription::NormalKerning);
+    Font font(fontDescription);
+    font.update(nullptr);
+    ASSERT_TRUE(font.primaryFont());
+
+    static const UChar arabic[] = { 0x0643, 0x062A, 0x0627, 0x0628, ' ', 0x0644, 0x0627, ' ', 0x0641, 0x064A, ' ', ' ', 0x0628, 0x064A, 0x062A };
+    const String texts[] = { "AV Wa To. fi ffl T, Yo  \"quoted\" words", String(arabic, WTF_ARRAY_LENGTH(arabic)) };
+    const TextDirection directions[] = { LTR, RTL };
+    for (size_t i = 0; i < WTF_ARRAY_LENGTH(texts); ++i) {
+        // Font::width() would find the first width in its width cache.
+        TextRun run(texts[i], 0, 0, TextRun::AllowTrailingExpansion, directions[i]);
+        RuntimeEnabledFeatures::setWordByWordShapingEnabled(false);
+        HarfBuzzShaper wholeRunShaper(&font, run);
+        ASSERT_TRUE(wholeRunShaper.shape());
+        RuntimeEnabledFeatures::setWordByWordShapingEnabled(true);
+        HarfBuzzShaper wordShaper(&font, run);
+        ASSERT_TRUE(wordShaper.shape());
+        EXPECT_FLOAT_EQ(wholeRunShaper.totalWidth(), wordShaper.totalWidth()) << i;
+    }
+}
+
+} // namespace blink
@@ -32,6 +32,8 @@
 #include "platform/fonts/harfbuzz/HarfBuzzFace.h"
 
 #include "platform/fonts/FontPlatformData.h"
+#include "platform/fonts/harfbuzz/HarfBuzzShapeCache.h"
+#include "wtf/unicode/CharacterNames.h"
 #include "hb-ot.h"
 #include "hb.h"
 
@@ -81,6 +83,8 @@ HarfBuzzFace::HarfBuzzFace(FontPlatformData* platformData, uint64_t uniqueID)
     : m_platformData(platformData)
     , m_uniqueID(uniqueID)
     , m_scriptForVerticalText(HB_SCRIPT_INVALID)
+    , m_checkedSpaceInLookups(false)
+    , m_hasSpaceInLookups(false)
 {
     HarfBuzzFaceCache::AddResult result = harfBuzzFaceCache()->add(m_uniqueID, nullptr);
     if (result.isNewEntry)
@@ -128,4 +132,39 @@ void HarfBuzzFace::setScriptForVerticalGlyphSubstitution(hb_buffer_t* buffer)
     hb_buffer_set_script(buffer, m_scriptForVerticalText);
 }
 
+HarfBuzzShapeCache* HarfBuzzFace::shapeCache()
+{
+    if (!m_shapeCache)
+        m_shapeCache = HarfBuzzShapeCache::create();
+    return m_shapeCache.get();
+}
+
+static bool lookupsInvolveGlyph(hb_face_t* face, hb_tag_t tableTag, hb_codepoint_t glyph)
+{
+    hb_set_t* glyphs = hb_set_create();
+    bool involvesGlyph = false;
+    unsigned lookupCount = hb_ot_layout_table_get_lookup_count(face, tableTag);
+    for (unsigned lookupIndex = 0; lookupIndex < lookupCount && !involvesGlyph; ++lookupIndex) {
+        // The glyphs before and after the input are the context of the lookup.
+        hb_set_clear(glyphs);
+        hb_ot_layout_lookup_collect_glyphs(face, tableTag, lookupIndex, glyphs, glyphs, glyphs, 0);
+        involvesGlyph = hb_set_has(glyphs, glyph);
+    }
+    hb_set_destroy(glyphs);
+    return involvesGlyph;
+}
+
+bool HarfBuzzFace::hasSpaceInLookups()
+{
+    if (!m_checkedSpaceInLookups) {
+        hb_font_t* font = createFont();
+        hb_codepoint_t spaceGlyph;
+        if (hb_font_get_glyph(font, space, 0, &spaceGlyph))
+            m_hasSpaceInLookups = lookupsInvolveGlyph(m_face, HB_OT_TAG_GSUB, spaceGlyph) || lookupsInvolveGlyph(m_face, HB_OT_TAG_GPOS, spaceGlyph);
+        hb_font_destroy(font);
+        m_checkedSpaceInLookups = true;
+    }
+    return m_hasSpaceInLookups;
+}
+
 } // namespace blink
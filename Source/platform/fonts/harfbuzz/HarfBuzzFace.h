@@ -34,6 +34,7 @@
 #include <hb.h>
 
 #include "wtf/HashMap.h"
+#include "wtf/OwnPtr.h"
 #include "wtf/PassRefPtr.h"
 #include "wtf/RefCounted.h"
 #include "wtf/RefPtr.h"
@@ -41,6 +42,7 @@
 namespace blink {
 
 class FontPlatformData;
+class HarfBuzzShapeCache;
 
 class HarfBuzzFace : public RefCounted<HarfBuzzFace> {
 public:
@@ -57,6 +59,15 @@ public:
 
     void setScriptForVerticalGlyphSubstitution(hb_buffer_t*);
 
+    // Shaping results depend on the size and rendering settings of the font,
+    // so they are cached per HarfBuzzFace rather than per hb_face_t.
+    HarfBuzzShapeCache* shapeCache();
+
+    // Whether any GSUB or GPOS lookup of the font involves the space glyph,
+    // like a ligature or a kerning pair that spans a space. Text can only be
+    // shaped a word at a time in fonts where none does.
+    bool hasSpaceInLookups();
+
 private:
     HarfBuzzFace(FontPlatformData*, uint64_t);
 
@@ -68,6 +79,11 @@ private:
     WTF::HashMap<uint32_t, uint16_t>* m_glyphCacheForFaceCacheEntry;
 
     hb_script_t m_scriptForVerticalText;
+
+    bool m_checkedSpaceInLookups;
+    bool m_hasSpaceInLookups;
+
+    OwnPtr<HarfBuzzShapeCache> m_shapeCache;
 };
 
 } // namespace blink
@@ -0,0 +1,186 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "config.h"
+#include "platform/fonts/harfbuzz/HarfBuzzShapeCache.h"
+
+#include "wtf/MainThread.h"
+#include "wtf/StdLibExtras.h"
+#include "wtf/StringHasher.h"
+#include <string.h>
+
+namespace blink {
+
+// The limits apply to all caches together, since there is a cache for every
+// face and size in use.
+static const unsigned maximumEntryCount = 2048;
+static const size_t maximumSizeInBytes = 1024 * 1024;
+// A single entry may not use more than this share of the caches.
+static const size_t maximumEntrySizeInBytes = maximumSizeInBytes / 16;
+
+static unsigned s_totalEntryCount = 0;
+static size_t s_totalSizeInBytes = 0;
+static unsigned s_totalHitCount = 0;
+static unsigned s_totalMissCount = 0;
+
+unsigned HarfBuzzShapeCacheKey::hash() const
+{
+    unsigned hashCodes[6] = {
+        m_text.impl() ? m_text.impl()->hash() : 0,
+        static_cast<unsigned>(m_direction),
+        static_cast<unsigned>(m_script),
+        PtrHash<hb_language_t>::hash(m_language),
+        m_features.isEmpty() ? 0 : StringHasher::hashMemory(m_features.data(), m_features.size() * sizeof(hb_feature_t)),
+        m_upperCase
+    };
+    return StringHasher::hashMemory<sizeof(hashCodes)>(hashCodes);
+}
+
+bool HarfBuzzShapeCacheKey::operator==(const HarfBuzzShapeCacheKey& other) const
+{
+    return m_text == other.m_text
+        && m_direction == other.m_direction
+        && m_script == other.m_script
+        && m_language == other.m_language
+        && m_features.size() == other.m_features.size()
+        && !memcmp(m_features.data(), other.m_features.data(), m_features.size() * sizeof(hb_feature_t))
+        && m_upperCase == other.m_upperCase;
+}
+
+size_t HarfBuzzShapeCacheKey::estimatedSizeInBytes() const
+{
+    return sizeof(*this) + m_text.length() * sizeof(UChar) + m_features.size() * sizeof(hb_feature_t);
+}
+
+class HarfBuzzShapeCache::Entry : public DoublyLinkedListNode<Entry> {
+    WTF_MAKE_NONCOPYABLE(Entry); WTF_MAKE_FAST_ALLOCATED;
+    friend class DoublyLinkedListNode<Entry>;
+public:
+    Entry(HarfBuzzShapeCache* cache, const HarfBuzzShapeCacheKey& key, hb_buffer_t* buffer)
+        : m_cache(cache)
+        , m_key(key)
+        , m_buffer(buffer)
+        , m_prev(0)
+        , m_next(0)
+    {
+        unsigned glyphCount = hb_buffer_get_length(buffer);
+        m_sizeInBytes = sizeof(*this) + key.estimatedSizeInBytes() + glyphCount * (sizeof(hb_glyph_info_t) + sizeof(hb_glyph_position_t));
+    }
+    ~Entry() { hb_buffer_destroy(m_buffer); }
+
+    HarfBuzzShapeCache* cache() const { return m_cache; }
+    const HarfBuzzShapeCacheKey& key() const { return m_key; }
+    hb_buffer_t* buffer() const { return m_buffer; }
+    size_t sizeInBytes() const { return m_sizeInBytes; }
+
+private:
+    HarfBuzzShapeCache* m_cache;
+    HarfBuzzShapeCacheKey m_key;
+    hb_buffer_t* m_buffer;
+    size_t m_sizeInBytes;
+    Entry* m_prev;
+    Entry* m_next;
+};
+
+DoublyLinkedList<HarfBuzzShapeCache::Entry>& HarfBuzzShapeCache::recentlyUsed()
+{
+    DEFINE_STATIC_LOCAL(DoublyLinkedList<Entry>, recentlyUsed, ());
+    return recentlyUsed;
+}
+
+HarfBuzzShapeCache::HarfBuzzShapeCache()
+    : m_sizeInBytes(0)
+{
+}
+
+HarfBuzzShapeCache::~HarfBuzzShapeCache()
+{
+    clear();
+}
+
+hb_buffer_t* HarfBuzzShapeCache::find(const HarfBuzzShapeCacheKey& key)
+{
+    ASSERT(isMainThread());
+    EntryMap::iterator it = m_entries.find(key);
+    if (it == m_entries.end()) {
+        ++s_totalMissCount;
+        return 0;
+    }
+    ++s_totalHitCount;
+    Entry* entry = it->value.get();
+    recentlyUsed().remove(entry);
+    recentlyUsed().append(entry);
+    return entry->buffer();
+}
+
+void HarfBuzzShapeCache::add(const HarfBuzzShapeCacheKey& key, hb_buffer_t* buffer)
+{
+    ASSERT(isMainThread());
+    OwnPtr<Entry> entry = adoptPtr(new Entry(this, key, buffer));
+    if (entry->sizeInBytes() > maximumEntrySizeInBytes)
+        return;
+
+    EntryMap::AddResult result = m_entries.add(key, nullptr);
+    if (result.isNewEntry) {
+        ++s_totalEntryCount;
+    } else {
+        Entry* oldEntry = result.storedValue->value.get();
+        recentlyUsed().remove(oldEntry);
+        m_sizeInBytes -= oldEntry->sizeInBytes();
+        s_totalSizeInBytes -= oldEntry->sizeInBytes();
+    }
+    recentlyUsed().append(entry.get());
+    m_sizeInBytes += entry->sizeInBytes();
+    s_totalSizeInBytes += entry->sizeInBytes();
+    result.storedValue->value = entry.release();
+
+    // Evict the least recently used entries of any cache.
+    while (s_totalEntryCount > maximumEntryCount || s_totalSizeInBytes > maximumSizeInBytes) {
+        Entry* leastRecentlyUsed = recentlyUsed().head();
+        ASSERT(leastRecentlyUsed);
+        leastRecentlyUsed->cache()->remove(leastRecentlyUsed);
+    }
+}
+
+void HarfBuzzShapeCache::clear()
+{
+    for (EntryMap::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+        recentlyUsed().remove(it->value.get());
+    s_totalEntryCount -= m_entries.size();
+    s_totalSizeInBytes -= m_sizeInBytes;
+    m_sizeInBytes = 0;
+    m_entries.clear();
+}
+
+void HarfBuzzShapeCache::remove(Entry* entry)
+{
+    ASSERT(entry->cache() == this);
+    recentlyUsed().remove(entry);
+    --s_totalEntryCount;
+    m_sizeInBytes -= entry->sizeInBytes();
+    s_totalSizeInBytes -= entry->sizeInBytes();
+    m_entries.remove(entry->key());
+}
+
+unsigned HarfBuzzShapeCache::totalSize()
+{
+    return s_totalEntryCount;
+}
+
+size_t HarfBuzzShapeCache::totalSizeInBytes()
+{
+    return s_totalSizeInBytes;
+}
+
+unsigned HarfBuzzShapeCache::totalHitCount()
+{
+    return s_totalHitCount;
+}
+
+unsigned HarfBuzzShapeCache::totalMissCount()
+{
+    return s_totalMissCount;
+}
+
+} // namespace blink
@@ -0,0 +1,118 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef HarfBuzzShapeCache_h
+#define HarfBuzzShapeCache_h
+
+#include "hb.h"
+#include "platform/PlatformExport.h"
+#include "wtf/Assertions.h"
+#include "wtf/DoublyLinkedList.h"
+#include "wtf/HashMap.h"
+#include "wtf/HashTableDeletedValueType.h"
+#include "wtf/OwnPtr.h"
+#include "wtf/PassOwnPtr.h"
+#include "wtf/Vector.h"
+#include "wtf/text/WTFString.h"
+
+namespace blink {
+
+// Everything apart from the font that the shaping of a piece of text depends on.
+class HarfBuzzShapeCacheKey {
+    WTF_MAKE_FAST_ALLOCATED;
+public:
+    HarfBuzzShapeCacheKey()
+        : m_direction(HB_DIRECTION_INVALID)
+        , m_script(HB_SCRIPT_INVALID)
+        , m_language(0)
+        , m_upperCase(false) { }
+    // upperCase is set when the text is shaped in upper case for small caps.
+    HarfBuzzShapeCacheKey(const String& text, hb_direction_t direction, hb_script_t script, hb_language_t language, const Vector<hb_feature_t, 4>& features, bool upperCase)
+        : m_text(text)
+        , m_direction(direction)
+        , m_script(script)
+        , m_language(language)
+        , m_features(features)
+        , m_upperCase(upperCase) { }
+    HarfBuzzShapeCacheKey(WTF::HashTableDeletedValueType)
+        : m_text(WTF::HashTableDeletedValue)
+        , m_direction(HB_DIRECTION_INVALID)
+        , m_script(HB_SCRIPT_INVALID)
+        , m_language(0)
+        , m_upperCase(false) { }
+
+    unsigned hash() const;
+    bool operator==(const HarfBuzzShapeCacheKey&) const;
+    bool isHashTableDeletedValue() const { return m_text.isHashTableDeletedValue(); }
+
+    const String& text() const { return m_text; }
+    size_t estimatedSizeInBytes() const;
+
+private:
+    String m_text;
+    hb_direction_t m_direction;
+    hb_script_t m_script;
+    hb_language_t m_language;
+    Vector<hb_feature_t> m_features;
+    bool m_upperCase;
+};
+
+struct HarfBuzzShapeCacheKeyHash {
+    static unsigned hash(const HarfBuzzShapeCacheKey& key) { return key.hash(); }
+    static bool equal(const HarfBuzzShapeCacheKey& a, const HarfBuzzShapeCacheKey& b) { return a == b; }
+    static const bool safeToCompareToEmptyOrDeleted = false;
+};
+
+struct HarfBuzzShapeCacheKeyTraits : WTF::SimpleClassHashTraits<HarfBuzzShapeCacheKey> { };
+
+// Caches shaped HarfBuzz buffers of one font, most often single words, so
+// that text that appears again, within a run or in other runs, is not shaped
+// again when it is measured or painted. All caches together are bounded both
+// in the number of entries and in the estimated memory they use, and evict
+// the least recently used entries of any cache first.
+class PLATFORM_EXPORT HarfBuzzShapeCache {
+    WTF_MAKE_NONCOPYABLE(HarfBuzzShapeCache); WTF_MAKE_FAST_ALLOCATED;
+public:
+    static PassOwnPtr<HarfBuzzShapeCache> create()
+    {
+        return adoptPtr(new HarfBuzzShapeCache);
+    }
+    ~HarfBuzzShapeCache();
+
+    // The returned buffer is owned by the cache and only valid until the
+    // next call to add() or clear() on any cache.
+    hb_buffer_t* find(const HarfBuzzShapeCacheKey&);
+    // Takes ownership of the shaped buffer. Buffers too large to be worth
+    // keeping are destroyed right away.
+    void add(const HarfBuzzShapeCacheKey&, hb_buffer_t*);
+    void clear();
+
+    unsigned size() const { return m_entries.size(); }
+    size_t sizeInBytes() const { return m_sizeInBytes; }
+
+    // Totals over all caches, which the limits apply to, and for measuring
+    // the effectiveness of the caches.
+    static unsigned totalSize();
+    static size_t totalSizeInBytes();
+    static unsigned totalHitCount();
+    static unsigned totalMissCount();
+
+private:
+    class Entry;
+    typedef HashMap<HarfBuzzShapeCacheKey, OwnPtr<Entry>, HarfBuzzShapeCacheKeyHash, HarfBuzzShapeCacheKeyTraits> EntryMap;
+
+    HarfBuzzShapeCache();
+
+    // The entries of all caches, least recently used first.
+    static DoublyLinkedList<Entry>& recentlyUsed();
+
+    void remove(Entry*);
+
+    EntryMap m_entries;
+    size_t m_sizeInBytes;
+};
+
+} // namespace blink
+
+#endif // HarfBuzzShapeCache_h
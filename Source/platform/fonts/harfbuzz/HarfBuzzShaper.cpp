@@ -39,6 +39,7 @@
 #include "platform/fonts/Font.h"
 #include "platform/fonts/GlyphBuffer.h"
 #include "platform/fonts/harfbuzz/HarfBuzzFace.h"
+#include "platform/fonts/harfbuzz/HarfBuzzShapeCache.h"
 #include "platform/text/SurrogatePairAwareTextIterator.h"
 #include "platform/text/TextBreakIterator.h"
 #include "wtf/Compiler.h"
@@ -48,10 +49,6 @@
 #include <unicode/uchar.h>
 #include <unicode/uscript.h>
 
-#include <list>
-#include <map>
-#include <string>
-
 namespace blink {
 
 template<typename T>
@@ -78,138 +75,6 @@ private:
     DestroyFunction m_destroy;
 };
 
-
-static const unsigned cHarfBuzzCacheMaxSize = 256;
-
-struct CachedShapingResultsLRUNode;
-struct CachedShapingResults;
-typedef std::map<std::wstring, CachedShapingResults*> CachedShapingResultsMap;
-typedef std::list<CachedShapingResultsLRUNode*> CachedShapingResultsLRU;
-
-struct CachedShapingResults {
-    CachedShapingResults(hb_buffer_t* harfBuzzBuffer, const Font* runFont, hb_direction_t runDir, const String& newLocale);
-    ~CachedShapingResults();
-
-    hb_buffer_t* buffer;
-    Font font;
-    hb_direction_t dir;
-    String locale;
-    CachedShapingResultsLRU::iterator lru;
-};
-
-struct CachedShapingResultsLRUNode {
-    CachedShapingResultsLRUNode(const CachedShapingResultsMap::iterator& cacheEntry);
-    ~CachedShapingResultsLRUNode();
-
-    CachedShapingResultsMap::iterator entry;
-};
-
-CachedShapingResults::CachedShapingResults(hb_buffer_t* harfBuzzBuffer, const Font* fontData, hb_direction_t dirData, const String& newLocale)
-    : buffer(harfBuzzBuffer)
-    , font(*fontData)
-    , dir(dirData)
-    , locale(newLocale)
-{
-}
-
-CachedShapingResults::~CachedShapingResults()
-{
-    hb_buffer_destroy(buffer);
-}
-
-CachedShapingResultsLRUNode::CachedShapingResultsLRUNode(const CachedShapingResultsMap::iterator& cacheEntry)
-    : entry(cacheEntry)
-{
-}
-
-CachedShapingResultsLRUNode::~CachedShapingResultsLRUNode()
-{
-}
-
-class HarfBuzzRunCache {
-public:
-    HarfBuzzRunCache();
-    ~HarfBuzzRunCache();
-
-    CachedShapingResults* find(const std::wstring& key) const;
-    void remove(CachedShapingResults* node);
-    void moveToBack(CachedShapingResults* node);
-    bool insert(const std::wstring& key, CachedShapingResults* run);
-
-private:
-    CachedShapingResultsMap m_harfBuzzRunMap;
-    CachedShapingResultsLRU m_harfBuzzRunLRU;
-};
-
-
-HarfBuzzRunCache::HarfBuzzRunCache()
-{
-}
-
-HarfBuzzRunCache::~HarfBuzzRunCache()
-{
-    for (CachedShapingResultsMap::iterator it = m_harfBuzzRunMap.begin(); it != m_harfBuzzRunMap.end(); ++it)
-        delete it->second;
-    for (CachedShapingResultsLRU::iterator it = m_harfBuzzRunLRU.begin(); it != m_harfBuzzRunLRU.end(); ++it)
-        delete *it;
-}
-
-bool HarfBuzzRunCache::insert(const std::wstring& key, CachedShapingResults* data)
-{
-    std::pair<CachedShapingResultsMap::iterator, bool> results =
-        m_harfBuzzRunMap.insert(CachedShapingResultsMap::value_type(key, data));
-
-    if (!results.second)
-        return false;
-
-    CachedShapingResultsLRUNode* node = new CachedShapingResultsLRUNode(results.first);
-
-    m_harfBuzzRunLRU.push_back(node);
-    data->lru = --m_harfBuzzRunLRU.end();
-
-    if (m_harfBuzzRunMap.size() > cHarfBuzzCacheMaxSize) {
-        CachedShapingResultsLRUNode* lru = m_harfBuzzRunLRU.front();
-        CachedShapingResults* foo = lru->entry->second;
-        m_harfBuzzRunMap.erase(lru->entry);
-        m_harfBuzzRunLRU.pop_front();
-        delete foo;
-        delete lru;
-    }
-
-    return true;
-}
-
-inline CachedShapingResults* HarfBuzzRunCache::find(const std::wstring& key) const
-{
-    CachedShapingResultsMap::const_iterator it = m_harfBuzzRunMap.find(key);
-
-    return it != m_harfBuzzRunMap.end() ? it->second : 0;
-}
-
-inline void HarfBuzzRunCache::remove(CachedShapingResults* node)
-{
-    CachedShapingResultsLRUNode* lruNode = *node->lru;
-
-    m_harfBuzzRunLRU.erase(node->lru);
-    m_harfBuzzRunMap.erase(lruNode->entry);
-    delete lruNode;
-    delete node;
-}
-
-inline void HarfBuzzRunCache::moveToBack(CachedShapingResults* node)
-{
-    CachedShapingResultsLRUNode* lruNode = *node->lru;
-    m_harfBuzzRunLRU.erase(node->lru);
-    m_harfBuzzRunLRU.push_back(lruNode);
-    node->lru = --m_harfBuzzRunLRU.end();
-}
-
-HarfBuzzRunCache& harfBuzzRunCache()
-{
-    DEFINE_STATIC_LOCAL(HarfBuzzRunCache, globalHarfBuzzRunCache, ());
-    return globalHarfBuzzRunCache;
-}
-
 static inline float harfBuzzPositionToFloat(hb_position_t value)
 {
     return static_cast<float>(value) / (1 << 16);
@@ -265,13 +130,15 @@ HarfBuzzShaper::HarfBuzzRun::~HarfBuzzRun()
 {
 }
 
-inline void HarfBuzzShaper::HarfBuzzRun::applyShapeResult(hb_buffer_t* harfBuzzBuffer)
+inline unsigned HarfBuzzShaper::HarfBuzzRun::appendShapeResult(hb_buffer_t* harfBuzzBuffer)
 {
-    m_numGlyphs = hb_buffer_get_length(harfBuzzBuffer);
+    unsigned glyphOffset = m_numGlyphs;
+    m_numGlyphs += hb_buffer_get_length(harfBuzzBuffer);
     m_glyphs.resize(m_numGlyphs);
     m_advances.resize(m_numGlyphs);
     m_glyphToCharacterIndexes.resize(m_numGlyphs);
     m_offsets.resize(m_numGlyphs);
+    return glyphOffset;
 }
 
 inline void HarfBuzzShaper::HarfBuzzRun::setGlyphAndPositions(unsigned index, uint16_t glyphId, float advance, float offsetX, float offsetY)
@@ -817,14 +684,26 @@ static const uint16_t* toUint16(const UChar* src)
     return reinterpret_cast<const uint16_t*>(src);
 }
 
+// Returns the end of the word starting at start, including the spaces that
+// follow it. Whether glyphs interact across a space is up to the font, so
+// this is only used for fonts whose lookups do not involve the space glyph.
+static unsigned wordEnd(const UChar* normalizedBuffer, unsigned start, unsigned end)
+{
+    unsigned index = start;
+    while (index < end && normalizedBuffer[index] != space)
+        ++index;
+    while (index < end && normalizedBuffer[index] == space)
+        ++index;
+    return index;
+}
+
 bool HarfBuzzShaper::shapeHarfBuzzRuns()
 {
     HarfBuzzScopedPtr<hb_buffer_t> harfBuzzBuffer(hb_buffer_create(), hb_buffer_destroy);
 
-    HarfBuzzRunCache& runCache = harfBuzzRunCache();
     const FontDescription& fontDescription = m_font->fontDescription();
-    const String& localeString = fontDescription.locale();
-    CString locale = localeString.latin1();
+    CString locale = fontDescription.locale().latin1();
+    hb_language_t language = hb_language_from_string(locale.data(), locale.length());
 
     for (unsigned i = 0; i < m_harfBuzzRuns.size(); ++i) {
         unsigned runIndex = m_run.rtl() ? m_harfBuzzRuns.size() - i - 1 : i;
@@ -838,75 +717,93 @@ bool HarfBuzzShaper::shapeHarfBuzzRuns()
         if (!face)
             return false;
 
-        hb_buffer_set_language(harfBuzzBuffer.get(), hb_language_from_string(locale.data(), locale.length()));
-        hb_buffer_set_script(harfBuzzBuffer.get(), currentRun->script());
-        hb_buffer_set_direction(harfBuzzBuffer.get(), currentRun->direction());
-
-        const UChar* src = m_normalizedBuffer.get() + currentRun->startIndex();
-        std::wstring key(src, src + currentRun->numCharacters());
-
-        CachedShapingResults* cachedResults = runCache.find(key);
-        if (cachedResults) {
-            if (cachedResults->dir == currentRun->direction() && cachedResults->font == *m_font && cachedResults->locale == localeString) {
-                currentRun->applyShapeResult(cachedResults->buffer);
-                setGlyphPositionsForHarfBuzzRun(currentRun, cachedResults->buffer);
-
-                hb_buffer_clear_contents(harfBuzzBuffer.get());
-
-                runCache.moveToBack(cachedResults);
-
+        HarfBuzzShapeCache* shapeCache = face->shapeCache();
+        HarfBuzzScopedPtr<hb_font_t> harfBuzzFont(0, hb_font_destroy);
+        bool upperCase = fontDescription.variant() == FontVariantSmallCaps && u_islower(m_normalizedBuffer[currentRun->startIndex()]);
+
+        // Where the font allows it, runs are shaped and cached a word at a
+        // time, so that words repeated within and across text runs are only
+        // shaped once. Otherwise the whole run is shaped and cached at once.
+        Vector<unsigned, 32> wordStarts;
+        unsigned runEnd = currentRun->startIndex() + currentRun->numCharacters();
+        if (RuntimeEnabledFeatures::wordByWordShapingEnabled() && !face->hasSpaceInLookups()) {
+            for (unsigned start = currentRun->startIndex(); start < runEnd; start = wordEnd(m_normalizedBuffer.get(), start, runEnd))
+                wordStarts.append(start);
+        } else {
+            wordStarts.append(currentRun->startIndex());
+        }
+        wordStarts.append(runEnd);
+
+        float totalAdvance = 0;
+        FloatPoint glyphOrigin;
+        for (unsigned j = 0; j + 1 < wordStarts.size(); ++j) {
+            // HarfBuzz returns glyphs in visual order, so the words of RTL
+            // runs are added last to first.
+            unsigned wordIndex = currentRun->rtl() ? wordStarts.size() - j - 2 : j;
+            unsigned wordStart = wordStarts[wordIndex];
+            unsigned wordLength = wordStarts[wordIndex + 1] - wordStart;
+            unsigned characterOffset = wordStart - currentRun->startIndex();
+            HarfBuzzShapeCacheKey key(String(m_normalizedBuffer.get() + wordStart, wordLength),
+                currentRun->direction(), currentRun->script(), language, m_features, upperCase);
+
+            if (hb_buffer_t* cachedBuffer = shapeCache->find(key)) {
+                totalAdvance += setGlyphPositionsForHarfBuzzRun(currentRun, cachedBuffer, characterOffset, glyphOrigin);
                 continue;
             }
 
-            runCache.remove(cachedResults);
-        }
-
-        // Add a space as pre-context to the buffer. This prevents showing dotted-circle
-        // for combining marks at the beginning of runs.
-        static const uint16_t preContext = space;
-        hb_buffer_add_utf16(harfBuzzBuffer.get(), &preContext, 1, 1, 0);
-
-        if (fontDescription.variant() == FontVariantSmallCaps && u_islower(m_normalizedBuffer[currentRun->startIndex()])) {
-            String upperText = String(m_normalizedBuffer.get() + currentRun->startIndex(), currentRun->numCharacters()).upper();
-            ASSERT(!upperText.is8Bit()); // m_normalizedBuffer is 16 bit, therefore upperText is 16 bit, even after we call makeUpper().
-            hb_buffer_add_utf16(harfBuzzBuffer.get(), toUint16(upperText.characters16()), currentRun->numCharacters(), 0, currentRun->numCharacters());
-        } else {
-            hb_buffer_add_utf16(harfBuzzBuffer.get(), toUint16(m_normalizedBuffer.get() + currentRun->startIndex()), currentRun->numCharacters(), 0, currentRun->numCharacters());
-        }
+            hb_buffer_set_language(harfBuzzBuffer.get(), language);
+            hb_buffer_set_script(harfBuzzBuffer.get(), currentRun->script());
+            hb_buffer_set_direction(harfBuzzBuffer.get(), currentRun->direction());
+
+            // Add a space as pre-context to the buffer. This prevents showing dotted-circle
+            // for combining marks at the beginning of runs.
+            static const uint16_t preContext = space;
+            hb_buffer_add_utf16(harfBuzzBuffer.get(), &preContext, 1, 1, 0);
+
+            if (upperCase) {
+                String upperText = key.text().upper();
+                ASSERT(!upperText.is8Bit()); // m_normalizedBuffer is 16 bit, therefore upperText is 16 bit, even after we call makeUpper().
+                hb_buffer_add_utf16(harfBuzzBuffer.get(), toUint16(upperText.characters16()), wordLength, 0, wordLength);
+            } else {
+                hb_buffer_add_utf16(harfBuzzBuffer.get(), toUint16(m_normalizedBuffer.get() + wordStart), wordLength, 0, wordLength);
+            }
 
-        if (fontDescription.orientation() == Vertical)
-            face->setScriptForVerticalGlyphSubstitution(harfBuzzBuffer.get());
+            if (fontDescription.orientation() == Vertical)
+                face->setScriptForVerticalGlyphSubstitution(harfBuzzBuffer.get());
 
-        HarfBuzzScopedPtr<hb_font_t> harfBuzzFont(face->createFont(), hb_font_destroy);
+            if (!harfBuzzFont.get())
+                harfBuzzFont.set(face->createFont());
 
-        hb_shape(harfBuzzFont.get(), harfBuzzBuffer.get(), m_features.isEmpty() ? 0 : m_features.data(), m_features.size());
-        currentRun->applyShapeResult(harfBuzzBuffer.get());
-        setGlyphPositionsForHarfBuzzRun(currentRun, harfBuzzBuffer.get());
+            hb_shape(harfBuzzFont.get(), harfBuzzBuffer.get(), m_features.isEmpty() ? 0 : m_features.data(), m_features.size());
+            totalAdvance += setGlyphPositionsForHarfBuzzRun(currentRun, harfBuzzBuffer.get(), characterOffset, glyphOrigin);
 
-        runCache.insert(key, new CachedShapingResults(harfBuzzBuffer.get(), m_font, currentRun->direction(), localeString));
+            shapeCache->add(key, harfBuzzBuffer.get());
+            harfBuzzBuffer.set(hb_buffer_create());
+        }
 
-        harfBuzzBuffer.set(hb_buffer_create());
+        currentRun->setWidth(totalAdvance > 0.0 ? totalAdvance : 0.0);
+        m_totalWidth += currentRun->width();
     }
 
     return true;
 }
 
-void HarfBuzzShaper::setGlyphPositionsForHarfBuzzRun(HarfBuzzRun* currentRun, hb_buffer_t* harfBuzzBuffer)
+float HarfBuzzShaper::setGlyphPositionsForHarfBuzzRun(HarfBuzzRun* currentRun, hb_buffer_t* harfBuzzBuffer, unsigned characterOffset, FloatPoint& glyphOrigin)
 {
     const SimpleFontData* currentFontData = currentRun->fontData();
     hb_glyph_info_t* glyphInfos = hb_buffer_get_glyph_infos(harfBuzzBuffer, 0);
     hb_glyph_position_t* glyphPositions = hb_buffer_get_glyph_positions(harfBuzzBuffer, 0);
 
+    unsigned numGlyphs = hb_buffer_get_length(harfBuzzBuffer);
+    unsigned glyphOffset = currentRun->appendShapeResult(harfBuzzBuffer);
     if (!currentRun->hasGlyphToCharacterIndexes()) {
         // FIXME: https://crbug.com/337886
         ASSERT_NOT_REACHED();
-        return;
+        return 0;
     }
 
-    unsigned numGlyphs = currentRun->numGlyphs();
     uint16_t* glyphToCharacterIndexes = currentRun->glyphToCharacterIndexes();
     float totalAdvance = 0;
-    FloatPoint glyphOrigin;
 
     // HarfBuzz returns the shaping result in visual order. We need not to flip for RTL.
     for (size_t i = 0; i < numGlyphs; ++i) {
@@ -916,11 +813,12 @@ void HarfBuzzShaper::setGlyphPositionsForHarfBuzzRun(HarfBuzzRun* currentRun, hb
         float offsetY = -harfBuzzPositionToFloat(glyphPositions[i].y_offset);
         float advance = harfBuzzPositionToFloat(glyphPositions[i].x_advance);
 
-        unsigned currentCharacterIndex = currentRun->startIndex() + glyphInfos[i].cluster;
+        unsigned cluster = characterOffset + glyphInfos[i].cluster;
+        unsigned currentCharacterIndex = currentRun->startIndex() + cluster;
         bool isClusterEnd = runEnd || glyphInfos[i].cluster != glyphInfos[i + 1].cluster;
         float spacing = 0;
 
-        glyphToCharacterIndexes[i] = glyphInfos[i].cluster;
+        glyphToCharacterIndexes[glyphOffset + i] = cluster;
 
         if (isClusterEnd && !Character::treatAsZeroWidthSpace(m_normalizedBuffer[currentCharacterIndex]))
             spacing += m_letterSpacing;
@@ -929,7 +827,7 @@ void HarfBuzzShaper::setGlyphPositionsForHarfBuzzRun(HarfBuzzRun* currentRun, hb
             spacing += determineWordBreakSpacing();
 
         if (currentFontData->isZeroWidthSpaceGlyph(glyph)) {
-            currentRun->setGlyphAndPositions(i, glyph, 0, 0, 0);
+            currentRun->setGlyphAndPositions(glyphOffset + i, glyph, 0, 0, 0);
             continue;
         }
 
@@ -941,7 +839,7 @@ void HarfBuzzShaper::setGlyphPositionsForHarfBuzzRun(HarfBuzzRun* currentRun, hb
                 offsetX += m_letterSpacing;
         }
 
-        currentRun->setGlyphAndPositions(i, glyph, advance, offsetX, offsetY);
+        currentRun->setGlyphAndPositions(glyphOffset + i, glyph, advance, offsetX, offsetY);
 
         FloatRect glyphBounds = currentFontData->boundsForGlyph(glyph);
         glyphBounds.move(glyphOrigin.x(), glyphOrigin.y());
@@ -950,8 +848,7 @@ void HarfBuzzShaper::setGlyphPositionsForHarfBuzzRun(HarfBuzzRun* currentRun, hb
 
         totalAdvance += advance;
     }
-    currentRun->setWidth(totalAdvance > 0.0 ? totalAdvance : 0.0);
-    m_totalWidth += currentRun->width();
+    return totalAdvance;
 }
 
 void HarfBuzzShaper::fillGlyphBufferFromHarfBuzzRun(GlyphBuffer* glyphBuffer, HarfBuzzRun* currentRun, FloatPoint& firstOffsetOfNextRun)
@@ -77,7 +77,9 @@ private:
             return adoptPtr(new HarfBuzzRun(fontData, startIndex, numCharacters, direction, script));
         }
 
-        void applyShapeResult(hb_buffer_t*);
+        // Makes room for the glyphs of a shaped buffer after the glyphs the
+        // run already has, and returns the index of the first of them.
+        unsigned appendShapeResult(hb_buffer_t*);
         void setGlyphAndPositions(unsigned index, uint16_t glyphId, float advance, float offsetX, float offsetY);
         void setWidth(float width) { m_width = width; }
 
@@ -132,7 +134,9 @@ private:
     bool fillGlyphBuffer(GlyphBuffer*);
     void fillGlyphBufferFromHarfBuzzRun(GlyphBuffer*, HarfBuzzRun*, FloatPoint& firstOffsetOfNextRun);
     void fillGlyphBufferForTextEmphasis(GlyphBuffer*, HarfBuzzRun* currentRun);
-    void setGlyphPositionsForHarfBuzzRun(HarfBuzzRun*, hb_buffer_t*);
+    // Appends the glyphs of a buffer shaped from the characters of the run
+    // starting at characterOffset, and returns their total advance.
+    float setGlyphPositionsForHarfBuzzRun(HarfBuzzRun*, hb_buffer_t*, unsigned characterOffset, FloatPoint& glyphOrigin);
     void addHarfBuzzRun(unsigned startCharacter, unsigned endCharacter, const SimpleFontData*, UScriptCode);
 
     const Font* m_font;
@@ -159,8 +163,6 @@ private:
     float m_totalWidth;
     FloatBoxExtent m_glyphBoundingBox;
     HashSet<const SimpleFontData*>* m_fallbackFonts;
-
-    friend struct CachedShapingResults;
 };
 
 } // namespace blink
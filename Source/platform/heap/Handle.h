@@ -725,6 +725,8 @@ public:
 // All Member fields of a class must be traced in the class' trace method.
 // During the mark phase of the GC all live objects are marked as live and
 // all Member fields of a live object will be traced marked as live as well.
+// Pointers stored into a Member while incremental marking is in progress are
+// recorded by the write barrier, see Heap::writeBarrier.
 template<typename T>
 class Member {
     WTF_DISALLOW_CONSTRUCTION_FROM_ZERO(Member);
@@ -740,15 +742,18 @@ public:
 
     Member(T* raw) : m_raw(raw)
     {
+        Heap::writeBarrier(m_raw);
     }
 
     explicit Member(T& raw) : m_raw(&raw)
     {
+        Heap::writeBarrier(m_raw);
     }
 
     template<typename U>
     Member(const RawPtr<U>& other) : m_raw(other.get())
     {
+        Heap::writeBarrier(m_raw);
     }
 
     Member(WTF::HashTableDeletedValueType) : m_raw(reinterpret_cast<T*>(-1))
@@ -758,12 +763,12 @@ public:
     bool isHashTableDeletedValue() const { return m_raw == reinterpret_cast<T*>(-1); }
 
     template<typename U>
-    Member(const Persistent<U>& other) : m_raw(other) { }
+    Member(const Persistent<U>& other) : m_raw(other) { Heap::writeBarrier(m_raw); }
 
-    Member(const Member& other) : m_raw(other) { }
+    Member(const Member& other) : m_raw(other) { Heap::writeBarrier(m_raw); }
 
     template<typename U>
-    Member(const Member<U>& other) : m_raw(other) { }
+    Member(const Member<U>& other) : m_raw(other) { Heap::writeBarrier(m_raw); }
 
     T* release()
     {
@@ -791,6 +796,14 @@ public:
     Member& operator=(const Persistent<U>& other)
     {
         m_raw = other;
+        Heap::writeBarrier(m_raw);
+        return *this;
+    }
+
+    Member& operator=(const Member& other)
+    {
+        m_raw = other.m_raw;
+        Heap::writeBarrier(m_raw);
         return *this;
     }
 
@@ -798,6 +811,7 @@ public:
     Member& operator=(const Member<U>& other)
     {
         m_raw = other;
+        Heap::writeBarrier(m_raw);
         return *this;
     }
 
@@ -805,6 +819,7 @@ public:
     Member& operator=(U* other)
     {
         m_raw = other;
+        Heap::writeBarrier(m_raw);
         return *this;
     }
 
@@ -812,6 +827,7 @@ public:
     Member& operator=(RawPtr<U> other)
     {
         m_raw = other;
+        Heap::writeBarrier(m_raw);
         return *this;
     }
 
@@ -821,7 +837,12 @@ public:
         return *this;
     }
 
-    void swap(Member<T>& other) { std::swap(m_raw, other.m_raw); }
+    void swap(Member<T>& other)
+    {
+        std::swap(m_raw, other.m_raw);
+        Heap::writeBarrier(m_raw);
+        Heap::writeBarrier(other.m_raw);
+    }
 
     T* get() const { return m_raw; }
 
@@ -943,6 +964,13 @@ public:
         return *this;
     }
 
+    WeakMember& operator=(const WeakMember& other)
+    {
+        this->m_raw = other.m_raw;
+        Heap::writeBarrier(this->m_raw);
+        return *this;
+    }
+
     template<typename U>
     WeakMember& operator=(const Member<U>& other)
     {
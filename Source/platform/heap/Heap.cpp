@@ -39,15 +39,16 @@
 #include "public/platform/Platform.h"
 #include "wtf/AddressSpaceRandomization.h"
 #include "wtf/Assertions.h"
+#include "wtf/HashMap.h"
+#include "wtf/HashSet.h"
 #include "wtf/LeakAnnotations.h"
 #include "wtf/PassOwnPtr.h"
+#include <algorithm>
+#include <utility>
 #if ENABLE(GC_PROFILE_MARKING)
-#include "wtf/HashMap.h"
-#include "wtf/HashSet.h"
 #include "wtf/text/StringBuilder.h"
 #include "wtf/text/StringHash.h"
 #include <stdio.h>
-#include <utility>
 #endif
 #if ENABLE(GC_PROFILE_HEAP)
 #include "platform/TracedValue.h"
@@ -589,10 +590,12 @@ template<typename Header>
 ThreadHeap<Header>::ThreadHeap(ThreadState* state, int index)
     : m_currentAllocationPoint(0)
     , m_remainingAllocationSize(0)
+    , m_allocationAreaStart(0)
     , m_firstPage(0)
     , m_firstLargeHeapObject(0)
     , m_firstPageAllocatedDuringSweeping(0)
     , m_lastPageAllocatedDuringSweeping(0)
+    , m_firstUnsweptPage(0)
     , m_mergePoint(0)
     , m_biggestFreeListIndex(0)
     , m_threadState(state)
@@ -608,6 +611,7 @@ ThreadHeap<Header>::~ThreadHeap()
 {
     ASSERT(!m_firstPage);
     ASSERT(!m_firstLargeHeapObject);
+    ASSERT(!m_firstUnsweptPage);
 }
 
 template<typename Header>
@@ -621,6 +625,10 @@ void ThreadHeap<Header>::cleanupPages()
         Heap::orphanedPagePool()->addOrphanedPage(m_index, page);
     m_firstPage = 0;
 
+    for (HeapPage<Header>* page = m_firstUnsweptPage; page; page = page->m_next)
+        Heap::orphanedPagePool()->addOrphanedPage(m_index, page);
+    m_firstUnsweptPage = 0;
+
     for (LargeHeapObject<Header>* largeObject = m_firstLargeHeapObject; largeObject; largeObject = largeObject->m_next)
         Heap::orphanedPagePool()->addOrphanedPage(m_index, largeObject);
     m_firstLargeHeapObject = 0;
@@ -674,6 +682,8 @@ void ThreadHeap<Header>::ensureCurrentAllocation(size_t minSize, const GCInfo* g
     }
     if (allocateFromFreeList(minSize))
         return;
+    if (m_firstUnsweptPage && lazySweepForAllocation(minSize))
+        return;
     if (coalesce(minSize) && allocateFromFreeList(minSize))
         return;
     addPageToHeap(gcInfo);
@@ -692,6 +702,10 @@ BaseHeapPage* ThreadHeap<Header>::heapPageFromAddress(Address address)
         if (page->contains(address))
             return page;
     }
+    for (HeapPage<Header>* page = m_firstUnsweptPage; page; page = page->next()) {
+        if (page->contains(address))
+            return page;
+    }
     for (LargeHeapObject<Header>* current = m_firstLargeHeapObject; current; current = current->next()) {
         // Check that large pages are blinkPageSize aligned (modulo the
         // osPageSize for the guard page).
@@ -944,6 +958,10 @@ Address ThreadHeap<Header>::allocateLargeObject(size_t size, const GCInfo* gcInf
     largeObject->link(&m_firstLargeHeapObject);
     stats().increaseAllocatedSpace(largeObject->size());
     stats().increaseObjectSpace(largeObject->payloadSize());
+    // Large objects are not allocated from an allocation area. Report them
+    // to the incremental marker like a pointer written to the heap.
+    if (threadState()->isIncrementalMarking())
+        threadState()->recordWriteBarrier(result);
     return result;
 }
 
@@ -1266,6 +1284,7 @@ void ThreadHeap<Header>::sweepNormalPages(HeapStats* stats)
             previous = page;
             page = page->next();
         }
+        stats->increaseSweptSpace(blinkPageSize);
     }
 }
 
@@ -1275,6 +1294,7 @@ void ThreadHeap<Header>::sweepLargePages(HeapStats* stats)
     TRACE_EVENT0("blink_gc", "ThreadHeap::sweepLargePages");
     LargeHeapObject<Header>** previousNext = &m_firstLargeHeapObject;
     for (LargeHeapObject<Header>* current = m_firstLargeHeapObject; current;) {
+        stats->increaseSweptSpace(current->size());
         if (current->isMarked()) {
             stats->increaseAllocatedSpace(current->size());
             stats->increaseObjectSpace(current->payloadSize());
@@ -1326,6 +1346,151 @@ void ThreadHeap<Header>::postSweepProcessing()
     }
 }
 
+template<typename Header>
+bool ThreadHeap<Header>::prepareForLazySweep(HeapStats* stats)
+{
+    ASSERT(isConsistentForSweeping());
+    ASSERT(!m_firstUnsweptPage);
+    sweepLargePages(stats);
+    m_firstUnsweptPage = m_firstPage;
+    m_firstPage = 0;
+    return !!m_firstUnsweptPage;
+}
+
+template<typename Header>
+void ThreadHeap<Header>::sweepUnsweptPage()
+{
+    HeapPage<Header>* page = m_firstUnsweptPage;
+    ASSERT(page);
+    page->resetPromptlyFreedSize();
+    if (page->isEmpty()) {
+        HeapPage<Header>::unlink(this, page, &m_firstUnsweptPage);
+        --m_numberOfNormalPages;
+    } else {
+        page->sweep(&stats(), this);
+        m_firstUnsweptPage = page->next();
+        page->link(&m_firstPage);
+    }
+    stats().increaseSweptSpace(blinkPageSize);
+    if (!m_firstUnsweptPage)
+        m_threadState->didFinishLazySweepingHeap();
+}
+
+template<typename Header>
+bool ThreadHeap<Header>::lazySweepForAllocation(size_t minSize)
+{
+    TRACE_EVENT0("blink_gc", "ThreadHeap::lazySweepForAllocation");
+    double startTime = WTF::currentTimeMS();
+    bool success = false;
+    while (m_firstUnsweptPage && !success) {
+        sweepUnsweptPage();
+        success = allocateFromFreeList(minSize);
+    }
+    stats().increaseLazySweepTime(WTF::currentTimeMS() - startTime);
+    return success;
+}
+
+template<typename Header>
+bool ThreadHeap<Header>::lazySweep(double deadline)
+{
+    // Sweep at least one page per call to make progress.
+    while (m_firstUnsweptPage) {
+        sweepUnsweptPage();
+        if (m_firstUnsweptPage && WTF::currentTime() >= deadline)
+            return false;
+    }
+    return true;
+}
+
+template<typename Header>
+void ThreadHeap<Header>::completeLazySweep()
+{
+    while (m_firstUnsweptPage)
+        sweepUnsweptPage();
+}
+
+template<typename Header>
+Address ThreadHeap<Header>::allocateForCompaction(size_t allocationSize, const GCInfo* gcInfo)
+{
+    // Sweeping is in progress, so new pages are put on the list of pages
+    // allocated during sweeping and are not swept in this cycle.
+    ASSERT(m_threadState->isSweepInProgress());
+    ensureCurrentAllocation(allocationSize, gcInfo);
+    Address headerAddress = m_currentAllocationPoint;
+    m_currentAllocationPoint += allocationSize;
+    m_remainingAllocationSize -= allocationSize;
+    ASAN_UNPOISON_MEMORY_REGION(headerAddress, allocationSize);
+    return headerAddress;
+}
+
+template<typename Header>
+size_t ThreadHeap<Header>::compact(const HashSet<Address>& movableObjects, Vector<std::pair<Address, Address> >& relocations)
+{
+    ASSERT(isConsistentForSweeping());
+    const size_t pagePayloadSize = HeapPage<Header>::payloadSize();
+
+    // Evacuate the pages that are at most half full and on which all live
+    // objects can be moved.
+    Vector<HeapPage<Header>*> evacuationCandidates;
+    size_t liveSize = 0;
+    for (HeapPage<Header>* page = m_firstPage; page; page = page->next()) {
+        size_t pageLiveSize = 0;
+        bool isMovable = true;
+        for (Address headerAddress = page->payload(); headerAddress < page->end(); ) {
+            Header* header = reinterpret_cast<Header*>(headerAddress);
+            headerAddress += header->size();
+            if (header->isFree() || !header->isMarked())
+                continue;
+            if (!movableObjects.contains(reinterpret_cast<Address>(header))) {
+                isMovable = false;
+                break;
+            }
+            pageLiveSize += header->size();
+        }
+        if (isMovable && pageLiveSize <= pagePayloadSize / 2) {
+            evacuationCandidates.append(page);
+            liveSize += pageLiveSize;
+        }
+    }
+
+    // Only compact if it is likely to release pages.
+    if (evacuationCandidates.size() <= liveSize / pagePayloadSize + 1)
+        return 0;
+
+    TRACE_EVENT0("blink_gc", "ThreadHeap::compact");
+    int pageCountBeforeCompaction = m_numberOfNormalPages;
+    for (size_t i = 0; i < evacuationCandidates.size(); ++i) {
+        HeapPage<Header>* page = evacuationCandidates[i];
+        for (Address headerAddress = page->payload(); headerAddress < page->end(); ) {
+            Header* header = reinterpret_cast<Header*>(headerAddress);
+            size_t size = header->size();
+            if (header->isFree()) {
+                headerAddress += size;
+                continue;
+            }
+            if (header->isMarked()) {
+                // The copy is swept as part of the next garbage collection.
+                Address newHeaderAddress = allocateForCompaction(size, header->gcInfo());
+                memcpy(newHeaderAddress, headerAddress, size);
+                Header* newHeader = reinterpret_cast<Header*>(newHeaderAddress);
+                newHeader->unmark();
+                stats().increaseObjectSpace(newHeader->payloadSize());
+                relocations.append(std::make_pair(headerAddress, newHeaderAddress));
+            } else {
+                ASAN_UNPOISON_MEMORY_REGION(header->payload(), header->payloadSize());
+                page->finalize(header);
+            }
+            headerAddress += size;
+        }
+        // Leave a single free block on the page so that sweeping releases it.
+        new (NotNull, page->payload()) BasicObjectHeader(BasicObjectHeader::freeListEncodedSize(pagePayloadSize));
+        ASSERT(page->isEmpty());
+    }
+
+    int releasedPageCount = evacuationCandidates.size() - (m_numberOfNormalPages - pageCountBeforeCompaction);
+    return releasedPageCount > 0 ? releasedPageCount * blinkPageSize : 0;
+}
+
 #if ENABLE(ASSERT)
 template<typename Header>
 bool ThreadHeap<Header>::isConsistentForSweeping()
@@ -1359,6 +1524,45 @@ void ThreadHeap<Header>::makeConsistentForSweeping()
     clearFreeLists();
 }
 
+template<typename Header>
+void ThreadHeap<Header>::recordAllocationsForIncrementalMarking(Address nextAllocationPoint)
+{
+    if (currentAllocationPoint() && currentAllocationPoint() != m_allocationAreaStart)
+        m_incrementalMarkingAllocations.append(std::make_pair(m_allocationAreaStart, currentAllocationPoint()));
+    m_allocationAreaStart = nextAllocationPoint;
+}
+
+template<typename Header>
+void ThreadHeap<Header>::markObjectsAllocatedDuringIncrementalMarking(Visitor* visitor)
+{
+    ASSERT(ThreadState::isAnyThreadInGC());
+    // Retiring the allocation area makes the pages iterable and records
+    // the objects allocated from it. Unlike makeConsistentForSweeping,
+    // the free lists are kept since the heap is not swept.
+    if (ownsNonEmptyAllocationArea())
+        addToFreeList(currentAllocationPoint(), remainingAllocationSize());
+    setAllocationPoint(0, 0);
+
+    for (size_t i = 0; i < m_incrementalMarkingAllocations.size(); ++i) {
+        Address start = m_incrementalMarkingAllocations[i].first;
+        Address end = m_incrementalMarkingAllocations[i].second;
+        HeapPage<Header>* page = static_cast<HeapPage<Header>*>(pageHeaderFromObject(start));
+        // The object start bitmap used for conservative marking does not
+        // know about the new objects.
+        page->clearObjectStartBitMap();
+        for (Address headerAddress = start; headerAddress < end; ) {
+            Header* header = reinterpret_cast<Header*>(headerAddress);
+            ASSERT(header->size() > 0);
+            if (page->hasVTable(header) && !vTableInitialized(header->payload()))
+                visitor->markNoTracing(header);
+            else
+                visitor->mark(header, page->traceCallback(header));
+            headerAddress += header->size();
+        }
+    }
+    m_incrementalMarkingAllocations.shrink(0);
+}
+
 template<typename Header>
 void ThreadHeap<Header>::clearLiveAndMarkDead()
 {
@@ -1912,6 +2116,12 @@ public:
         Heap::pushPostMarkingCallback(const_cast<void*>(object), markNoTracingCallback);
     }
 
+    virtual void registerBackingStoreReference(void* slot) OVERRIDE
+    {
+        if (Heap::isCompacting())
+            Heap::registerBackingStoreReference(slot);
+    }
+
     virtual void registerWeakMembers(const void* closure, const void* containingObject, WeakPointerCallback callback) OVERRIDE
     {
         Heap::pushWeakObjectPointerCallback(const_cast<void*>(closure), const_cast<void*>(containingObject), callback);
@@ -2068,6 +2278,7 @@ void Heap::init()
     s_heapDoesNotContainCache = new HeapDoesNotContainCache();
     s_markingVisitor = new MarkingVisitor(s_markingStack);
     s_freePagePool = new FreePagePool();
+    s_backingStoreReferences = new Vector<void*>();
     s_orphanedPagePool = new OrphanedPagePool();
     s_markingThreads = new Vector<OwnPtr<blink::WebThread> >();
     if (blink::Platform::current()) {
@@ -2101,6 +2312,8 @@ void Heap::doShutdown()
     s_heapDoesNotContainCache = 0;
     delete s_freePagePool;
     s_freePagePool = 0;
+    delete s_backingStoreReferences;
+    s_backingStoreReferences = 0;
     delete s_orphanedPagePool;
     s_orphanedPagePool = 0;
     delete s_weakCallbackStack;
@@ -2354,6 +2567,15 @@ void Heap::collectGarbage(ThreadState::StackState stackState, ThreadState::Cause
 
     s_lastGCWasConservative = false;
 
+    // Compaction needs every reference to a moved backing store to be
+    // known, so it is restricted to precise garbage collections of a
+    // single thread whose marking is done entirely by this collection.
+    clearBackingStoreReferences();
+    s_isCompacting = s_compactionEnabled
+        && stackState == ThreadState::NoHeapPointersOnStack
+        && ThreadState::attachedThreads().size() == 1
+        && !isIncrementalMarking();
+
     TRACE_EVENT2("blink_gc", "Heap::collectGarbage",
         "precise", stackState == ThreadState::NoHeapPointersOnStack,
         "forced", cause == ThreadState::ForcedGC);
@@ -2368,6 +2590,11 @@ void Heap::collectGarbage(ThreadState::StackState stackState, ThreadState::Cause
     // torn down).
     NoAllocationScope<AnyThread> noAllocationScope;
 
+    // If an incremental marking cycle is in progress its marks are kept
+    // and the remaining marking work is completed by this collection.
+    if (isIncrementalMarking())
+        finishIncrementalMarking();
+
     prepareForGC();
 
     // 1. trace persistent roots.
@@ -2383,8 +2610,11 @@ void Heap::collectGarbage(ThreadState::StackState stackState, ThreadState::Cause
     // 4. trace objects reachable from the stack "roots" including ephemerons.
     // Only do the processing if we found a pointer to an object on one of the
     // thread stacks.
-    if (lastGCWasConservative())
+    if (lastGCWasConservative()) {
+        if (isCompacting())
+            clearBackingStoreReferences();
         processMarkingStackInParallel();
+    }
 
     postMarkingProcessing();
     globalWeakProcessing();
@@ -2415,6 +2645,178 @@ void Heap::collectGarbage(ThreadState::StackState stackState, ThreadState::Cause
         ScriptForbiddenScope::exit();
 }
 
+bool Heap::startIncrementalMarking()
+{
+    ThreadState* state = ThreadState::current();
+    ASSERT(state->isMainThread());
+    ASSERT(!isIncrementalMarking());
+    state->clearGCRequested();
+
+    // The mark bits of the previous collection are cleared by sweeping.
+    state->performPendingSweep();
+    state->completeLazySweep();
+
+    GCScope gcScope(ThreadState::NoHeapPointersOnStack);
+    if (!gcScope.allThreadsParked() || ThreadState::attachedThreads().size() != 1)
+        return false;
+
+    TRACE_EVENT0("blink_gc", "Heap::startIncrementalMarking");
+    NoAllocationScope<AnyThread> noAllocationScope;
+
+    // Retire the allocation areas so that the thread heaps can record the
+    // areas they allocate from once marking has started.
+    state->visitIncrementalMarkingRoots(s_markingVisitor);
+    state->setIncrementalMarking(true);
+    s_isIncrementalMarking = true;
+
+    ThreadState::visitPersistentRoots(s_markingVisitor);
+    return true;
+}
+
+bool Heap::advanceIncrementalMarking(double deadline)
+{
+    // Check the deadline after this many trace callbacks.
+    static const size_t stepGranularity = 64;
+
+    ThreadState* state = ThreadState::current();
+    ASSERT(state->isIncrementalMarking());
+    ASSERT(ThreadState::attachedThreads().size() == 1);
+
+    TRACE_EVENT0("blink_gc", "Heap::advanceIncrementalMarking");
+    double timeStamp = WTF::currentTimeMS();
+    bool markingStackIsEmpty = false;
+    state->enterGC();
+    {
+        NoAllocationScope<AnyThread> noAllocationScope;
+        state->visitIncrementalMarkingRoots(s_markingVisitor);
+        while (!markingStackIsEmpty) {
+            for (size_t i = 0; i < stepGranularity; ++i) {
+                if (!popAndInvokeTraceCallback<GlobalMarking>(s_markingStack, s_markingVisitor)) {
+                    markingStackIsEmpty = true;
+                    break;
+                }
+            }
+            if (WTF::currentTime() >= deadline)
+                break;
+        }
+    }
+    state->leaveGC();
+
+    double stepTime = WTF::currentTimeMS() - timeStamp;
+    state->recordIncrementalMarkingStep(stepTime);
+    if (blink::Platform::current())
+        blink::Platform::current()->histogramCustomCounts("BlinkGC.IncrementalMarkingStep", stepTime, 0, 10 * 1000, 50);
+    return markingStackIsEmpty;
+}
+
+void Heap::finishIncrementalMarking()
+{
+    ASSERT(ThreadState::isAnyThreadInGC());
+    TRACE_EVENT0("blink_gc", "Heap::finishIncrementalMarking");
+    ThreadState::AttachedThreadStateSet& threads = ThreadState::attachedThreads();
+    for (ThreadState::AttachedThreadStateSet::iterator it = threads.begin(), end = threads.end(); it != end; ++it) {
+        if ((*it)->isIncrementalMarking()) {
+            (*it)->visitIncrementalMarkingRoots(s_markingVisitor);
+            (*it)->setIncrementalMarking(false);
+        }
+    }
+    s_isIncrementalMarking = false;
+}
+
+void Heap::writeBarrierSlow(const void* value)
+{
+    if (!value || value == reinterpret_cast<const void*>(-1))
+        return;
+    // Only the thread doing incremental marking records its writes. All
+    // other threads are stopped when marking is finished.
+    ThreadState* state = ThreadState::current();
+    if (state && state->isIncrementalMarking())
+        state->recordWriteBarrier(value);
+}
+
+void Heap::setCompactionEnabled(bool enabled)
+{
+    s_compactionEnabled = enabled;
+}
+
+void Heap::registerBackingStoreReference(void* slot)
+{
+    MutexLocker locker(markingMutex());
+    s_backingStoreReferences->append(slot);
+}
+
+void Heap::clearBackingStoreReferences()
+{
+    s_isCompacting = false;
+    s_backingStoreReferences->clear();
+}
+
+static bool relocationSourceLessThan(Address address, const std::pair<Address, Address>& relocation)
+{
+    return address < relocation.first;
+}
+
+void Heap::compact(ThreadState* state)
+{
+    ASSERT(isCompacting());
+    ASSERT(state->isSweepInProgress());
+    TRACE_EVENT0("blink_gc", "Heap::compact");
+    typedef HeapIndexTrait<CollectionBackingHeap>::HeaderType HeaderType;
+    typedef HeapIndexTrait<CollectionBackingHeap>::HeapType HeapType;
+
+    // A backing store can only be moved if all references to it can be
+    // updated. Backing stores that are referred to from more than one
+    // recorded slot are left in place.
+    HashMap<Address, void**> slotForBackingStore;
+    HashSet<Address> pinnedBackingStores;
+    for (size_t i = 0; i < s_backingStoreReferences->size(); ++i) {
+        void** slot = static_cast<void**>(s_backingStoreReferences->at(i));
+        Address backingStore = static_cast<Address>(*slot);
+        if (!backingStore)
+            continue;
+        HashMap<Address, void**>::AddResult result = slotForBackingStore.add(backingStore, slot);
+        if (!result.isNewEntry && result.storedValue->value != slot)
+            pinnedBackingStores.add(backingStore);
+    }
+    HashSet<Address> movableObjects;
+    for (HashMap<Address, void**>::iterator it = slotForBackingStore.begin(), end = slotForBackingStore.end(); it != end; ++it) {
+        if (!pinnedBackingStores.contains(it->key))
+            movableObjects.add(it->key - sizeof(HeaderType));
+    }
+
+    Vector<std::pair<Address, Address> > relocations;
+    size_t compactedSpace = 0;
+    compactedSpace += static_cast<HeapType*>(state->heap(CollectionBackingHeap))->compact(movableObjects, relocations);
+    compactedSpace += static_cast<HeapType*>(state->heap(CollectionBackingHeapNonFinalized))->compact(movableObjects, relocations);
+
+    if (!relocations.isEmpty()) {
+        std::sort(relocations.begin(), relocations.end());
+        HashMap<Address, Address> movedBackingStores;
+        for (size_t i = 0; i < relocations.size(); ++i)
+            movedBackingStores.add(relocations[i].first + sizeof(HeaderType), relocations[i].second + sizeof(HeaderType));
+
+        for (size_t i = 0; i < s_backingStoreReferences->size(); ++i) {
+            Address slotAddress = static_cast<Address>(s_backingStoreReferences->at(i));
+            // The slot is in the new copy if it is part of a moved backing
+            // store, e.g., the buffer of a vector nested in another vector.
+            std::pair<Address, Address>* relocation = std::upper_bound(relocations.begin(), relocations.end(), slotAddress, relocationSourceLessThan);
+            if (relocation != relocations.begin()) {
+                --relocation;
+                size_t offset = slotAddress - relocation->first;
+                if (offset < reinterpret_cast<HeaderType*>(relocation->second)->size())
+                    slotAddress = relocation->second + offset;
+            }
+            void** slot = reinterpret_cast<void**>(slotAddress);
+            HashMap<Address, Address>::iterator moved = movedBackingStores.find(static_cast<Address>(*slot));
+            if (moved != movedBackingStores.end())
+                *slot = moved->value;
+        }
+    }
+
+    state->stats().increaseCompactedSpace(compactedSpace);
+    clearBackingStoreReferences();
+}
+
 void Heap::collectGarbageForTerminatingThread(ThreadState* state)
 {
     // We explicitly do not enter a safepoint while doing thread specific
@@ -2427,6 +2829,18 @@ void Heap::collectGarbageForTerminatingThread(ThreadState* state)
         state->enterGC();
         state->prepareForGC();
 
+        // The global callback stacks can hold work of an incremental
+        // marking cycle of the main thread. Set it aside so that the
+        // thread local GC neither performs nor drops it.
+        CallbackStack* incrementalMarkingStacks[] = { 0, 0, 0, 0 };
+        CallbackStack** globalStacks[] = { &s_markingStack, &s_postMarkingCallbackStack, &s_weakCallbackStack, &s_ephemeronStack };
+        if (isIncrementalMarking()) {
+            for (size_t i = 0; i < WTF_ARRAY_LENGTH(globalStacks); ++i) {
+                incrementalMarkingStacks[i] = *globalStacks[i];
+                *globalStacks[i] = new CallbackStack();
+            }
+        }
+
         // 1. trace the thread local persistent roots. For thread local GCs we
         // don't trace the stack (ie. no conservative scanning) since this is
         // only called during thread shutdown where there should be no objects
@@ -2446,6 +2860,13 @@ void Heap::collectGarbageForTerminatingThread(ThreadState* state)
         postMarkingProcessing();
         globalWeakProcessing();
 
+        if (incrementalMarkingStacks[0]) {
+            for (size_t i = 0; i < WTF_ARRAY_LENGTH(globalStacks); ++i) {
+                delete *globalStacks[i];
+                *globalStacks[i] = incrementalMarkingStacks[i];
+            }
+        }
+
         state->leaveGC();
     }
     state->performPendingSweep();
@@ -2586,6 +3007,9 @@ void ThreadHeap<Header>::prepareHeapForTermination()
     for (HeapPage<Header>* page = m_firstPage; page; page = page->next()) {
         page->setTerminating();
     }
+    for (HeapPage<Header>* page = m_firstUnsweptPage; page; page = page->next()) {
+        page->setTerminating();
+    }
     for (LargeHeapObject<Header>* current = m_firstLargeHeapObject; current; current = current->next()) {
         current->setTerminating();
     }
@@ -2602,8 +3026,12 @@ BaseHeap* ThreadHeap<Header>::split(int numberOfNormalPages)
     ASSERT(numberOfNormalPages > 0);
     ThreadHeap<Header>* splitOff = new ThreadHeap(m_threadState, m_index);
     HeapPage<Header>* splitPoint = m_firstPage;
-    for (int i = 1; i < numberOfNormalPages; i++)
+    // The page count includes the pages allocated by heap compaction,
+    // which are not on the list of pages to sweep.
+    int i = 1;
+    for (; i < numberOfNormalPages && splitPoint->next(); i++)
         splitPoint = splitPoint->next();
+    numberOfNormalPages = i;
     splitOff->m_firstPage = m_firstPage;
     m_firstPage = splitPoint->m_next;
     splitOff->m_mergePoint = splitPoint;
@@ -2689,11 +3117,14 @@ void Heap::makeConsistentForSweeping()
 
 void HeapAllocator::backingFree(void* address)
 {
-    if (!address || ThreadState::isAnyThreadInGC())
+    // The backing may already be on the marking stack of an incremental
+    // marking cycle, so it cannot be freed before the cycle is finished.
+    if (!address || ThreadState::isAnyThreadInGC() || Heap::isIncrementalMarking())
         return;
 
+    // Backings on pages that have not been swept yet are still marked.
     ThreadState* state = ThreadState::current();
-    if (state->isSweepInProgress())
+    if (state->isSweepInProgress() || state->isLazySweeping())
         return;
 
     // Don't promptly free large objects because their page is never reused
@@ -2730,6 +3161,10 @@ CallbackStack* Heap::s_ephemeronStack;
 HeapDoesNotContainCache* Heap::s_heapDoesNotContainCache;
 bool Heap::s_shutdownCalled = false;
 bool Heap::s_lastGCWasConservative = false;
+bool Heap::s_isIncrementalMarking = false;
+bool Heap::s_compactionEnabled = false;
+bool Heap::s_isCompacting = false;
+Vector<void*>* Heap::s_backingStoreReferences;
 FreePagePool* Heap::s_freePagePool;
 OrphanedPagePool* Heap::s_orphanedPagePool;
 }
@@ -810,11 +810,28 @@ public:
     virtual void sweep(HeapStats*) = 0;
     virtual void postSweepProcessing() = 0;
 
+    // Sweep the large objects of this part of the Blink heap and set
+    // the normal pages aside to be swept later. Only heaps without
+    // finalizers can be swept lazily. Returns true if there are pages
+    // left to sweep.
+    virtual bool prepareForLazySweep(HeapStats*) = 0;
+    // Sweep the pages set aside by prepareForLazySweep until they are
+    // all swept or the deadline (in seconds) has passed. Returns true
+    // once all pages have been swept.
+    virtual bool lazySweep(double deadline) = 0;
+    virtual void completeLazySweep() = 0;
+
     virtual void clearFreeLists() = 0;
     virtual void clearLiveAndMarkDead() = 0;
 
     virtual void makeConsistentForSweeping() = 0;
 
+    // Retire the current allocation area and mark all objects that were
+    // allocated since the last call while incremental marking is in
+    // progress. The objects are pushed onto the marking stack so that
+    // the marker traces their contents.
+    virtual void markObjectsAllocatedDuringIncrementalMarking(Visitor*) = 0;
+
 #if ENABLE(ASSERT)
     virtual bool isConsistentForSweeping() = 0;
 
@@ -862,11 +879,17 @@ public:
     virtual void sweep(HeapStats*);
     virtual void postSweepProcessing();
 
+    virtual bool prepareForLazySweep(HeapStats*);
+    virtual bool lazySweep(double deadline);
+    virtual void completeLazySweep();
+
     virtual void clearFreeLists();
     virtual void clearLiveAndMarkDead();
 
     virtual void makeConsistentForSweeping();
 
+    virtual void markObjectsAllocatedDuringIncrementalMarking(Visitor*);
+
 #if ENABLE(ASSERT)
     virtual bool isConsistentForSweeping();
 
@@ -889,6 +912,13 @@ public:
 
     virtual void prepareHeapForTermination();
 
+    // Evacuate the live objects on sparsely populated pages that are
+    // contained in movableObjects to new pages. The evacuated pages are
+    // left empty so that sweeping releases them. The (from, to) header
+    // addresses of the moved objects are appended to relocations.
+    // Returns the number of bytes of pages that are released.
+    size_t compact(const HashSet<Address>& movableObjects, Vector<std::pair<Address, Address> >& relocations);
+
     virtual int normalPageCount() { return m_numberOfNormalPages; }
 
     virtual BaseHeap* split(int numberOfNormalPages);
@@ -910,11 +940,15 @@ private:
     {
         ASSERT(!point || heapPageFromAddress(point));
         ASSERT(size <= HeapPage<Header>::payloadSize());
+        if (UNLIKELY(m_threadState->isIncrementalMarking()))
+            recordAllocationsForIncrementalMarking(point);
         m_currentAllocationPoint = point;
         m_remainingAllocationSize = size;
     }
     void ensureCurrentAllocation(size_t, const GCInfo*);
     bool allocateFromFreeList(size_t);
+    Address allocateForCompaction(size_t, const GCInfo*);
+    void recordAllocationsForIncrementalMarking(Address nextAllocationPoint);
 
     void freeLargeObject(LargeHeapObject<Header>*, LargeHeapObject<Header>**);
     void allocatePage(const GCInfo*);
@@ -926,17 +960,28 @@ private:
 
     void sweepNormalPages(HeapStats*);
     void sweepLargePages(HeapStats*);
+    void sweepUnsweptPage();
+    bool lazySweepForAllocation(size_t);
     bool coalesce(size_t);
 
     Address m_currentAllocationPoint;
     size_t m_remainingAllocationSize;
 
+    // While incremental marking is in progress, the start of the current
+    // allocation area and the [start, end) ranges of the allocation areas
+    // that have been bump allocated from since the last marking step.
+    Address m_allocationAreaStart;
+    Vector<std::pair<Address, Address> > m_incrementalMarkingAllocations;
+
     HeapPage<Header>* m_firstPage;
     LargeHeapObject<Header>* m_firstLargeHeapObject;
 
     HeapPage<Header>* m_firstPageAllocatedDuringSweeping;
     HeapPage<Header>* m_lastPageAllocatedDuringSweeping;
 
+    // Pages that are left to be swept while lazy sweeping.
+    HeapPage<Header>* m_firstUnsweptPage;
+
     // Merge point for parallel sweep.
     HeapPage<Header>* m_mergePoint;
 
@@ -1022,6 +1067,43 @@ public:
 
     static void collectGarbage(ThreadState::StackState, ThreadState::CauseOfGC = ThreadState::NormalGC);
     static void collectGarbageForTerminatingThread(ThreadState*);
+
+    // Incremental marking splits the marking phase of a garbage collection
+    // into bounded steps that are interleaved with the execution of the
+    // main thread. It is only supported while the main thread is the only
+    // thread attached to the heap. startIncrementalMarking returns false if
+    // a cycle could not be started, in which case the caller should fall
+    // back to collectGarbage. advanceIncrementalMarking performs marking
+    // work until the given deadline (in seconds, see WTF::currentTime) and
+    // returns true when the marking stack has been drained. The cycle is
+    // finalized by the next call to collectGarbage, which rescans the roots
+    // and completes marking in a single pause.
+    static bool startIncrementalMarking();
+    static bool advanceIncrementalMarking(double deadline);
+    static bool isIncrementalMarking() { return s_isIncrementalMarking; }
+
+    // Write barrier for incremental marking. Must be called when a pointer
+    // to a heap object is stored into a heap object.
+    static void writeBarrier(const void* value)
+    {
+        if (UNLIKELY(s_isIncrementalMarking))
+            writeBarrierSlow(value);
+    }
+
+    // Heap compaction moves the live collection backing stores off
+    // sparsely populated pages of the collection backing heaps, so that
+    // the pages can be released and decommitted. When enabled, precise
+    // garbage collections that find no heap pointers on the stack while
+    // the current thread is the only attached thread record the slots
+    // that collections report for their backings while marking. Before
+    // sweeping, compact evacuates the pages where every live backing has
+    // exactly one recorded slot and updates the slots.
+    static void setCompactionEnabled(bool);
+    static bool compactionEnabled() { return s_compactionEnabled; }
+    static bool isCompacting() { return s_isCompacting; }
+    static void registerBackingStoreReference(void* slot);
+    static void compact(ThreadState*);
+
     static void collectAllGarbage();
     static void processMarkingStackEntries(int* numberOfMarkingThreads);
     static void processMarkingStackOnMultipleThreads();
@@ -1073,6 +1155,10 @@ public:
     static OrphanedPagePool* orphanedPagePool() { return s_orphanedPagePool; }
 
 private:
+    static void writeBarrierSlow(const void*);
+    static void finishIncrementalMarking();
+    static void clearBackingStoreReferences();
+
     static Visitor* s_markingVisitor;
     static Vector<OwnPtr<blink::WebThread> >* s_markingThreads;
     static CallbackStack* s_markingStack;
@@ -1082,6 +1168,10 @@ private:
     static HeapDoesNotContainCache* s_heapDoesNotContainCache;
     static bool s_shutdownCalled;
     static bool s_lastGCWasConservative;
+    static bool s_isIncrementalMarking;
+    static bool s_compactionEnabled;
+    static bool s_isCompacting;
+    static Vector<void*>* s_backingStoreReferences;
     static FreePagePool* s_freePagePool;
     static OrphanedPagePool* s_orphanedPagePool;
     friend class ThreadState;
@@ -1563,6 +1653,24 @@ public:
     PLATFORM_EXPORT static void backingFree(void* address);
 
     static void free(void* address) { }
+
+    // Incremental marking write barriers for collections that exchange
+    // their backing stores or move elements between inline buffers. The
+    // element types are not known for inline buffers, so every word is
+    // treated as a potential pointer.
+    static void backingWriteBarrier(void* address)
+    {
+        Heap::writeBarrier(address);
+    }
+    static void inlineBufferWriteBarrier(void* buffer, size_t size)
+    {
+        if (LIKELY(!Heap::isIncrementalMarking()))
+            return;
+        void** end = reinterpret_cast<void**>(static_cast<char*>(buffer) + size);
+        for (void** slot = reinterpret_cast<void**>(buffer); slot < end; ++slot)
+            Heap::writeBarrier(*slot);
+    }
+
     template<typename T>
     static void* newArray(size_t bytes)
     {
@@ -1608,6 +1716,11 @@ public:
         visitor->registerWeakTable(closure, iterationCallback, iterationDoneCallback);
     }
 
+    static void registerBackingStoreReference(Visitor* visitor, void* slot)
+    {
+        visitor->registerBackingStoreReference(slot);
+    }
+
 #if ENABLE(ASSERT)
     static bool weakTableRegistered(Visitor* visitor, const void* closure)
     {
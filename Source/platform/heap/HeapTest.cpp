@@ -224,6 +224,42 @@ private:
     bool m_parkedAllThreads; // False if we fail to park all threads
 };
 
+// Enables or disables lazy sweeping until the end of the scope.
+class LazySweepingScope {
+public:
+    explicit LazySweepingScope(bool enabled)
+        : m_wasEnabled(ThreadState::lazySweepingEnabled())
+    {
+        ThreadState::setLazySweepingEnabled(enabled);
+    }
+
+    ~LazySweepingScope()
+    {
+        ThreadState::setLazySweepingEnabled(m_wasEnabled);
+    }
+
+private:
+    bool m_wasEnabled;
+};
+
+// Enables or disables heap compaction until the end of the scope.
+class CompactionScope {
+public:
+    explicit CompactionScope(bool enabled)
+        : m_wasEnabled(Heap::compactionEnabled())
+    {
+        Heap::setCompactionEnabled(enabled);
+    }
+
+    ~CompactionScope()
+    {
+        Heap::setCompactionEnabled(m_wasEnabled);
+    }
+
+private:
+    bool m_wasEnabled;
+};
+
 static void getHeapStats(HeapStats* stats)
 {
     TestGCScope scope(ThreadState::NoHeapPointersOnStack);
@@ -5338,4 +5374,392 @@ TEST(HeapTest, NonNodeAllocatingNodeInDestructor)
     NonNodeAllocatingNodeInDestructor::s_node = 0;
 }
 
+class IncrementalMarkingNode : public GarbageCollectedFinalized<IncrementalMarkingNode> {
+public:
+    static IncrementalMarkingNode* create(int value)
+    {
+        return new IncrementalMarkingNode(value);
+    }
+
+    virtual ~IncrementalMarkingNode()
+    {
+        ++s_destructorCalls;
+    }
+
+    void trace(Visitor* visitor)
+    {
+        visitor->trace(m_next);
+        visitor->trace(m_wrapper);
+        visitor->trace(m_vector);
+        visitor->trace(m_inlineVector);
+        visitor->trace(m_map);
+    }
+
+    int value() const { return m_value; }
+
+    Member<IncrementalMarkingNode> m_next;
+    Member<IntWrapper> m_wrapper;
+    HeapVector<Member<IntWrapper> > m_vector;
+    HeapVector<Member<IntWrapper>, 2> m_inlineVector;
+    HeapHashMap<int, Member<IntWrapper> > m_map;
+
+    static int s_destructorCalls;
+
+private:
+    explicit IncrementalMarkingNode(int value) : m_value(value) { }
+
+    int m_value;
+};
+
+int IncrementalMarkingNode::s_destructorCalls = 0;
+
+// Sum of the values of all objects reachable from the given list.
+static int sumOfReachableValues(IncrementalMarkingNode* node)
+{
+    int sum = 0;
+    for (; node; node = node->m_next) {
+        sum += node->value();
+        if (node->m_wrapper)
+            sum += node->m_wrapper->value();
+        for (size_t i = 0; i < node->m_vector.size(); ++i)
+            sum += node->m_vector[i]->value();
+        for (size_t i = 0; i < node->m_inlineVector.size(); ++i)
+            sum += node->m_inlineVector[i]->value();
+        for (HeapHashMap<int, Member<IntWrapper> >::iterator it = node->m_map.begin(); it != node->m_map.end(); ++it)
+            sum += it->value->value();
+    }
+    return sum;
+}
+
+static IncrementalMarkingNode* createIncrementalMarkingList(int length)
+{
+    IncrementalMarkingNode* head = 0;
+    for (int i = 0; i < length; ++i) {
+        IncrementalMarkingNode* node = IncrementalMarkingNode::create(i);
+        node->m_next = head;
+        node->m_wrapper = IntWrapper::create(i);
+        node->m_vector.append(IntWrapper::create(i));
+        node->m_inlineVector.append(IntWrapper::create(i));
+        node->m_map.add(i + 1, IntWrapper::create(i));
+        head = node;
+    }
+    return head;
+}
+
+static IncrementalMarkingNode* lastIncrementalMarkingNode(IncrementalMarkingNode* node)
+{
+    while (node->m_next)
+        node = node->m_next;
+    return node;
+}
+
+// Starts an incremental marking cycle and finishes it at the end of the scope
+// if it is still running, so that a failed assertion does not leave the heap
+// in the middle of marking.
+class IncrementalMarkingScope {
+public:
+    IncrementalMarkingScope()
+        : m_started(Heap::startIncrementalMarking())
+    {
+    }
+
+    ~IncrementalMarkingScope()
+    {
+        if (Heap::isIncrementalMarking())
+            Heap::collectGarbage(ThreadState::NoHeapPointersOnStack);
+    }
+
+    bool started() const { return m_started; }
+
+private:
+    bool m_started;
+};
+
+// Performs the smallest possible incremental marking step. The deadline has
+// always passed, so each step processes a single batch of trace callbacks.
+static bool performMinimalIncrementalMarkingStep()
+{
+    return Heap::advanceIncrementalMarking(0);
+}
+
+TEST(HeapTest, IncrementalMarking)
+{
+    HeapStats initialHeapStats;
+    clearOutOldGarbage(&initialHeapStats);
+    IntWrapper::s_destructorCalls = 0;
+    IncrementalMarkingNode::s_destructorCalls = 0;
+
+    const int length = 200;
+    Persistent<IncrementalMarkingNode> list = createIncrementalMarkingList(length);
+    // Garbage created before marking starts must be collected.
+    createIncrementalMarkingList(10);
+
+    IncrementalMarkingScope marking;
+    ASSERT_TRUE(marking.started());
+    EXPECT_TRUE(Heap::isIncrementalMarking());
+    EXPECT_TRUE(ThreadState::current()->isIncrementalMarking());
+
+    // The list is traced from its head. Move objects from the tail of the
+    // list, which is traced last, to the head and store newly allocated
+    // objects into the head. The vector backing of the head is reserved up
+    // front, so that the appends are not hidden by a reallocation. Nothing
+    // becomes unreachable, so everything must survive.
+    Vector<IncrementalMarkingNode*> nodes;
+    for (IncrementalMarkingNode* node = list; node; node = node->m_next)
+        nodes.append(node);
+    list->m_vector.reserveCapacity(4 * length);
+    int expectedSum = sumOfReachableValues(list);
+    int step = 0;
+    do {
+        IncrementalMarkingNode* node = nodes[length - 1 - step];
+        if (list->m_wrapper)
+            list->m_vector.append(list->m_wrapper);
+        list->m_wrapper = node->m_wrapper;
+        node->m_wrapper = nullptr;
+        list->m_vector.append(node->m_vector.last());
+        node->m_vector.clear();
+        list->m_inlineVector.swap(node->m_inlineVector);
+        list->m_map.swap(node->m_map);
+
+        list->m_vector.append(IntWrapper::create(step));
+        list->m_map.add(2 * length + step, IntWrapper::create(step));
+        IncrementalMarkingNode* newNode = IncrementalMarkingNode::create(step);
+        newNode->m_wrapper = IntWrapper::create(step);
+        newNode->m_next = list->m_next;
+        list->m_next = newNode;
+        expectedSum += 4 * step;
+        ++step;
+    } while (!performMinimalIncrementalMarkingStep() && step < length - 1);
+
+    ThreadState* state = ThreadState::current();
+    EXPECT_LT(1u, state->incrementalMarkingStepCount());
+    RecordProperty("incrementalMarkingSteps", state->incrementalMarkingStepCount());
+    RecordProperty("maxIncrementalMarkingStepTimeUs", static_cast<int>(state->maxIncrementalMarkingStepTimeMs() * 1000));
+
+    Heap::collectGarbage(ThreadState::NoHeapPointersOnStack);
+    EXPECT_FALSE(Heap::isIncrementalMarking());
+    EXPECT_FALSE(state->isIncrementalMarking());
+    EXPECT_EQ(expectedSum, sumOfReachableValues(list));
+    EXPECT_EQ(10, IncrementalMarkingNode::s_destructorCalls);
+    EXPECT_EQ(40, IntWrapper::s_destructorCalls);
+
+    list.clear();
+    Heap::collectGarbage(ThreadState::NoHeapPointersOnStack);
+    EXPECT_EQ(10 + length + step, IncrementalMarkingNode::s_destructorCalls);
+}
+
+TEST(HeapTest, IncrementalMarkingFloatingGarbage)
+{
+    HeapStats initialHeapStats;
+    clearOutOldGarbage(&initialHeapStats);
+    IncrementalMarkingNode::s_destructorCalls = 0;
+
+    const int length = 100;
+    Persistent<IncrementalMarkingNode> list = createIncrementalMarkingList(length);
+    IncrementalMarkingScope marking;
+    ASSERT_TRUE(marking.started());
+    // Objects allocated during marking survive the cycle even if they are
+    // unreachable, as do objects that were reachable when marking started.
+    IncrementalMarkingNode::create(-1);
+    while (!performMinimalIncrementalMarkingStep()) { }
+    list->m_next = nullptr;
+    Heap::collectGarbage(ThreadState::NoHeapPointersOnStack);
+    EXPECT_EQ(0, IncrementalMarkingNode::s_destructorCalls);
+
+    Heap::collectGarbage(ThreadState::NoHeapPointersOnStack);
+    EXPECT_EQ(length, IncrementalMarkingNode::s_destructorCalls);
+}
+
+TEST(HeapTest, IncrementalMarkingLargeObjects)
+{
+    HeapStats initialHeapStats;
+    clearOutOldGarbage(&initialHeapStats);
+    IntWrapper::s_destructorCalls = 0;
+
+    Persistent<IncrementalMarkingNode> list = createIncrementalMarkingList(100);
+    IncrementalMarkingScope marking;
+    ASSERT_TRUE(marking.started());
+    EXPECT_FALSE(performMinimalIncrementalMarkingStep());
+    // The list head has been traced. Give it a backing store that is large
+    // enough to be allocated as a large object.
+    const size_t largeCapacity = blinkPageSize / sizeof(Member<IntWrapper>);
+    HeapVector<Member<IntWrapper> > largeVector;
+    largeVector.reserveCapacity(largeCapacity);
+    for (int i = 0; i < 10; ++i)
+        largeVector.append(IntWrapper::create(i));
+    list->m_vector.swap(largeVector);
+    largeVector.clear();
+    while (!performMinimalIncrementalMarkingStep()) { }
+    Heap::collectGarbage(ThreadState::NoHeapPointersOnStack);
+
+    ASSERT_EQ(10u, list->m_vector.size());
+    for (int i = 0; i < 10; ++i)
+        EXPECT_EQ(i, list->m_vector[i]->value());
+    // The wrapper that was swapped out of the list had already been marked.
+    EXPECT_EQ(0, IntWrapper::s_destructorCalls);
+    Heap::collectGarbage(ThreadState::NoHeapPointersOnStack);
+    EXPECT_EQ(1, IntWrapper::s_destructorCalls);
+}
+
+TEST(HeapTest, IncrementalMarkingSameTypeMemberAssignment)
+{
+    HeapStats initialHeapStats;
+    clearOutOldGarbage(&initialHeapStats);
+
+    const int length = 200;
+    Persistent<IncrementalMarkingNode> list = createIncrementalMarkingList(length);
+    IncrementalMarkingNode* tail = lastIncrementalMarkingNode(list);
+    list->m_wrapper = nullptr;
+    Heap::collectGarbage(ThreadState::NoHeapPointersOnStack);
+    IntWrapper::s_destructorCalls = 0;
+
+    IncrementalMarkingScope marking;
+    ASSERT_TRUE(marking.started());
+    EXPECT_FALSE(performMinimalIncrementalMarkingStep());
+    // The list head has been traced, but its tail has not. Move the wrapper of
+    // the tail into the head with a Member<IntWrapper> to Member<IntWrapper>
+    // assignment, so that it is only reachable through the traced head.
+    list->m_wrapper = tail->m_wrapper;
+    tail->m_wrapper = nullptr;
+    while (!performMinimalIncrementalMarkingStep()) { }
+    Heap::collectGarbage(ThreadState::NoHeapPointersOnStack);
+
+    EXPECT_EQ(0, IntWrapper::s_destructorCalls);
+    ASSERT_TRUE(list->m_wrapper);
+    EXPECT_EQ(0, list->m_wrapper->value());
+}
+
+TEST(HeapTest, IncrementalMarkingFinishedAtSafePoint)
+{
+    HeapStats initialHeapStats;
+    clearOutOldGarbage(&initialHeapStats);
+    IntWrapper::s_destructorCalls = 0;
+
+    Persistent<IntWrapper> wrapper = IntWrapper::create(1);
+    IncrementalMarkingScope marking;
+    ASSERT_TRUE(marking.started());
+    // Requested GCs finish the marking cycle at the next safepoint.
+    ThreadState::current()->setGCRequested();
+    ThreadState::current()->safePoint(ThreadState::NoHeapPointersOnStack);
+    EXPECT_FALSE(Heap::isIncrementalMarking());
+    EXPECT_EQ(1, wrapper->value());
+    EXPECT_EQ(0, IntWrapper::s_destructorCalls);
+}
+
+TEST(HeapTest, LazySweeping)
+{
+    HeapStats initialHeapStats;
+    clearOutOldGarbage(&initialHeapStats);
+    ThreadState* state = ThreadState::current();
+
+    // Allocate a few pages worth of non-finalized objects and keep every
+    // tenth of them alive.
+    const int count = 1000;
+    Persistent<HeapVector<Member<SimpleObject> > > live = new HeapVector<Member<SimpleObject> >();
+    for (int i = 0; i < count; ++i) {
+        SimpleObject* object = SimpleObject::create();
+        if (!(i % 10))
+            live->append(object);
+    }
+    live->shrinkToFit();
+
+    LazySweepingScope lazySweeping(true);
+    Heap::collectGarbage(ThreadState::NoHeapPointersOnStack);
+    EXPECT_TRUE(state->isLazySweeping());
+    HeapStats pauseStats = state->stats();
+    EXPECT_EQ(0, pauseStats.lazySweepTimeMs());
+    RecordProperty("lazySweepPauseTimeUs", static_cast<int>(pauseStats.sweepPauseTimeMs() * 1000));
+
+    // Garbage collections complete the sweep before marking.
+    Heap::collectGarbage(ThreadState::NoHeapPointersOnStack);
+    EXPECT_TRUE(state->isLazySweeping());
+    state->completeLazySweep();
+    EXPECT_FALSE(state->isLazySweeping());
+    HeapStats lazyStats = state->stats();
+    EXPECT_GT(lazyStats.sweptSpace(), pauseStats.sweptSpace());
+    ASSERT_EQ(static_cast<size_t>(count / 10), live->size());
+
+    // Sweeping eagerly frees the same amount of memory.
+    LazySweepingScope eagerSweeping(false);
+    Heap::collectGarbage(ThreadState::NoHeapPointersOnStack);
+    HeapStats eagerStats = state->stats();
+    EXPECT_EQ(lazyStats.totalObjectSpace(), eagerStats.totalObjectSpace());
+    EXPECT_EQ(lazyStats.totalAllocatedSpace(), eagerStats.totalAllocatedSpace());
+    EXPECT_EQ(lazyStats.sweptSpace(), eagerStats.sweptSpace());
+    EXPECT_EQ(0, eagerStats.lazySweepTimeMs());
+    RecordProperty("eagerSweepPauseTimeUs", static_cast<int>(eagerStats.sweepPauseTimeMs() * 1000));
+}
+
+TEST(HeapTest, LazySweepingOnAllocation)
+{
+    HeapStats initialHeapStats;
+    clearOutOldGarbage(&initialHeapStats);
+    ThreadState* state = ThreadState::current();
+
+    for (int i = 0; i < 1000; ++i)
+        SimpleObject::create();
+
+    LazySweepingScope lazySweeping(true);
+    Heap::collectGarbage(ThreadState::NoHeapPointersOnStack);
+    EXPECT_TRUE(state->isLazySweeping());
+    size_t sweptSpace = state->stats().sweptSpace();
+
+    // All the pages are empty, so the allocation has to sweep all of them
+    // before it finds a free list entry on a new page.
+    SimpleObject* object = SimpleObject::create();
+    EXPECT_TRUE(object);
+    EXPECT_FALSE(state->isLazySweeping());
+    EXPECT_GT(state->stats().sweptSpace(), sweptSpace);
+}
+
+TEST(HeapTest, CompactCollectionBackingStores)
+{
+    HeapStats initialHeapStats;
+    clearOutOldGarbage(&initialHeapStats);
+    ThreadState* state = ThreadState::current();
+
+    // Allocate a few pages worth of collection backing stores and keep
+    // every tenth of them alive so that the pages are sparsely populated.
+    // The buffers of the nested vectors are referred to from the backing
+    // store of the outer vector, which can be moved as well.
+    typedef HeapVector<Member<IntWrapper> > IntVector;
+    const int count = 5000;
+    Persistent<HeapVector<Member<IncrementalMarkingNode> > > nodes = new HeapVector<Member<IncrementalMarkingNode> >();
+    Persistent<HeapVector<IntVector> > vectors = new HeapVector<IntVector>();
+    int expectedSum = 0;
+    for (int i = 0; i < count; ++i) {
+        IncrementalMarkingNode* node = IncrementalMarkingNode::create(i);
+        node->m_vector.append(IntWrapper::create(i));
+        node->m_map.add(i + 1, IntWrapper::create(i));
+        if (i % 10)
+            continue;
+        nodes->append(node);
+        vectors->append(IntVector());
+        vectors->last().append(IntWrapper::create(i));
+        expectedSum += 3 * i;
+    }
+
+    CompactionScope compaction(true);
+    Heap::collectGarbage(ThreadState::NoHeapPointersOnStack);
+    EXPECT_FALSE(Heap::isCompacting());
+    EXPECT_LT(0u, state->stats().compactedSpace());
+
+    // Compaction only relocates the backing stores, the contents and the
+    // objects referred to from them stay the same.
+    for (int gc = 0; gc < 2; ++gc) {
+        int sum = 0;
+        for (size_t i = 0; i < nodes->size(); ++i) {
+            sum += sumOfReachableValues(nodes->at(i));
+            EXPECT_EQ(static_cast<int>(i * 10), nodes->at(i)->m_map.get(i * 10 + 1)->value());
+        }
+        EXPECT_EQ(expectedSum, sum);
+        ASSERT_EQ(static_cast<size_t>(count / 10), vectors->size());
+        for (size_t i = 0; i < vectors->size(); ++i) {
+            ASSERT_EQ(1u, vectors->at(i).size());
+            EXPECT_EQ(static_cast<int>(i * 10), vectors->at(i)[0]->value());
+        }
+        Heap::collectGarbage(ThreadState::NoHeapPointersOnStack);
+    }
+}
+
 } // namespace blink
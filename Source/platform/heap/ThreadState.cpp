@@ -37,6 +37,7 @@
 #include "platform/heap/CallbackStack.h"
 #include "platform/heap/Handle.h"
 #include "platform/heap/Heap.h"
+#include "platform/scheduler/Scheduler.h"
 #include "public/platform/Platform.h"
 #include "public/platform/WebThread.h"
 #include "wtf/ThreadingPrimitives.h"
@@ -104,6 +105,8 @@ WTF::ThreadSpecific<ThreadState*>* ThreadState::s_threadSpecific = 0;
 uint8_t ThreadState::s_mainThreadStateStorage[sizeof(ThreadState)];
 SafePointBarrier* ThreadState::s_safePointBarrier = 0;
 bool ThreadState::s_inGC = false;
+bool ThreadState::s_incrementalMarkingEnabled = false;
+bool ThreadState::s_lazySweepingEnabled = false;
 
 static Mutex& threadAttachMutex()
 {
@@ -310,6 +313,11 @@ ThreadState::ThreadState()
     , m_sweepInProgress(false)
     , m_noAllocationCount(0)
     , m_inGC(false)
+    , m_isIncrementalMarking(false)
+    , m_incrementalMarkingStepCount(0)
+    , m_maxIncrementalMarkingStepTimeMs(0)
+    , m_lazySweepingHeapCount(0)
+    , m_objectSpaceBeforeSweep(0)
     , m_heapContainsCache(adoptPtr(new HeapContainsCache()))
     , m_isTerminating(false)
     , m_lowCollectionRate(false)
@@ -378,6 +386,11 @@ void ThreadState::detachMainThread()
     // safepoint.
     ThreadState* state = mainThreadState();
 
+    // Finish an incremental marking cycle in progress, the marker must not
+    // refer to the heap pages once they are orphaned.
+    if (state->isIncrementalMarking())
+        Heap::collectGarbage(NoHeapPointersOnStack);
+
     {
         SafePointAwareMutexLocker locker(threadAttachMutex(), NoHeapPointersOnStack);
 
@@ -762,10 +775,16 @@ bool ThreadState::increasedEnoughToGC(size_t newSize, size_t oldSize)
 // into account.
 bool ThreadState::shouldGC()
 {
+    // While incremental marking is in progress only request a GC, which
+    // finishes the marking cycle, if the heap keeps growing rapidly.
+    if (m_isIncrementalMarking)
+        return increasedEnoughToForceConservativeGC(m_stats.totalObjectSpace(), m_statsAfterLastGC.totalObjectSpace());
+
     // Do not GC during sweeping. We allow allocation during
     // finalization, but those allocations are not allowed
-    // to lead to nested garbage collections.
-    return !m_sweepInProgress && increasedEnoughToGC(m_stats.totalObjectSpace(), m_statsAfterLastGC.totalObjectSpace());
+    // to lead to nested garbage collections. While lazy sweeping
+    // the stats only account for the pages swept so far.
+    return !m_sweepInProgress && !isLazySweeping() && increasedEnoughToGC(m_stats.totalObjectSpace(), m_statsAfterLastGC.totalObjectSpace());
 }
 
 // Trigger conservative garbage collection on a 100% increase in size,
@@ -784,10 +803,16 @@ bool ThreadState::increasedEnoughToForceConservativeGC(size_t newSize, size_t ol
 // into account.
 bool ThreadState::shouldForceConservativeGC()
 {
+    // An incremental marking cycle is finished at the next safepoint
+    // rather than from within an allocation, where objects that are
+    // under construction would be traced.
+    if (m_isIncrementalMarking)
+        return false;
+
     // Do not GC during sweeping. We allow allocation during
     // finalization, but those allocations are not allowed
     // to lead to nested garbage collections.
-    return !m_sweepInProgress && increasedEnoughToForceConservativeGC(m_stats.totalObjectSpace(), m_statsAfterLastGC.totalObjectSpace());
+    return !m_sweepInProgress && !isLazySweeping() && increasedEnoughToForceConservativeGC(m_stats.totalObjectSpace(), m_statsAfterLastGC.totalObjectSpace());
 }
 
 bool ThreadState::sweepRequested()
@@ -836,11 +861,150 @@ void ThreadState::performPendingGC(StackState stackState)
             setForcePreciseGCForTesting(false);
             Heap::collectAllGarbage();
         } else if (gcRequested()) {
-            Heap::collectGarbage(NoHeapPointersOnStack);
+            if (canStartIncrementalMarking() && Heap::startIncrementalMarking())
+                scheduleIncrementalMarkingStep();
+            else
+                Heap::collectGarbage(NoHeapPointersOnStack);
         }
     }
 }
 
+void ThreadState::setIncrementalMarkingEnabled(bool enabled)
+{
+    s_incrementalMarkingEnabled = enabled;
+}
+
+void ThreadState::setIncrementalMarking(bool isIncrementalMarking)
+{
+    ASSERT(isAnyThreadInGC());
+    ASSERT(m_writeBarrierBuffer.isEmpty());
+    m_isIncrementalMarking = isIncrementalMarking;
+    if (isIncrementalMarking) {
+        m_incrementalMarkingStepCount = 0;
+        m_maxIncrementalMarkingStepTimeMs = 0;
+    }
+}
+
+bool ThreadState::canStartIncrementalMarking()
+{
+    // Marking steps are run as idle tasks of the main thread.
+    return s_incrementalMarkingEnabled && isMainThread() && !m_isIncrementalMarking && !m_sweepInProgress && Scheduler::shared();
+}
+
+void ThreadState::scheduleIncrementalMarkingStep()
+{
+    if (Scheduler* scheduler = Scheduler::shared())
+        scheduler->postIdleTask(FROM_HERE, WTF::bind<double>(&ThreadState::performIncrementalMarkingStep, this));
+}
+
+void ThreadState::performIncrementalMarkingStep(double allottedTimeMs)
+{
+    // Used when the scheduler does not know how long the thread is idle.
+    static const double defaultStepTimeMs = 2;
+
+    checkThread();
+    if (!m_isIncrementalMarking)
+        return;
+
+    bool markingDone;
+    {
+        // Holding the lock keeps other threads from attaching and from
+        // starting a GC while the marker runs.
+        SafePointAwareMutexLocker locker(threadAttachMutex(), NoHeapPointersOnStack);
+        // The cycle may have been finished while waiting for the lock.
+        if (!m_isIncrementalMarking)
+            return;
+        double stepTimeMs = allottedTimeMs > 0 ? allottedTimeMs : defaultStepTimeMs;
+        markingDone = attachedThreads().size() != 1 || Heap::advanceIncrementalMarking(WTF::currentTime() + stepTimeMs / 1000);
+    }
+    if (markingDone)
+        Heap::collectGarbage(HeapPointersOnStack);
+    else
+        scheduleIncrementalMarkingStep();
+}
+
+void ThreadState::visitIncrementalMarkingRoots(Visitor* visitor)
+{
+    ASSERT(isAnyThreadInGC());
+    // Retire the allocation areas first. The write barrier buffer is
+    // processed with conservative marking, which needs iterable pages.
+    for (int i = 0; i < NumberOfHeaps; i++)
+        m_heaps[i]->markObjectsAllocatedDuringIncrementalMarking(visitor);
+    for (size_t i = 0; i < m_writeBarrierBuffer.size(); ++i)
+        checkAndMarkPointer(visitor, m_writeBarrierBuffer[i]);
+    m_writeBarrierBuffer.shrink(0);
+}
+
+void ThreadState::recordIncrementalMarkingStep(double stepTimeMs)
+{
+    ++m_incrementalMarkingStepCount;
+    if (stepTimeMs > m_maxIncrementalMarkingStepTimeMs)
+        m_maxIncrementalMarkingStepTimeMs = stepTimeMs;
+}
+
+void ThreadState::setLazySweepingEnabled(bool enabled)
+{
+    s_lazySweepingEnabled = enabled;
+}
+
+bool ThreadState::canLazySweep()
+{
+    // The remaining pages are swept by idle tasks of the main thread
+    // when it has a scheduler. Otherwise they are swept by allocations
+    // and before the next garbage collection.
+    return s_lazySweepingEnabled && isMainThread() && !m_isTerminating;
+}
+
+void ThreadState::scheduleLazySweep()
+{
+    if (Scheduler* scheduler = Scheduler::shared())
+        scheduler->postIdleTask(FROM_HERE, WTF::bind<double>(&ThreadState::performIdleLazySweep, this));
+}
+
+void ThreadState::performIdleLazySweep(double allottedTimeMs)
+{
+    // Used when the scheduler does not know how long the thread is idle.
+    static const double defaultSweepTimeMs = 2;
+
+    checkThread();
+    if (!isLazySweeping())
+        return;
+
+    TRACE_EVENT0("blink_gc", "ThreadState::performIdleLazySweep");
+    double startTime = WTF::currentTimeMS();
+    double sweepTimeMs = allottedTimeMs > 0 ? allottedTimeMs : defaultSweepTimeMs;
+    double deadline = WTF::currentTime() + sweepTimeMs / 1000;
+    for (int i = 0; i < NumberOfNonFinalizedHeaps; i++) {
+        if (!m_heaps[FirstNonFinalizedHeap + i]->lazySweep(deadline))
+            break;
+    }
+    m_stats.increaseLazySweepTime(WTF::currentTimeMS() - startTime);
+    if (isLazySweeping())
+        scheduleLazySweep();
+}
+
+void ThreadState::completeLazySweep()
+{
+    if (!isLazySweeping())
+        return;
+
+    TRACE_EVENT0("blink_gc", "ThreadState::completeLazySweep");
+    double startTime = WTF::currentTimeMS();
+    for (int i = 0; i < NumberOfNonFinalizedHeaps; i++)
+        m_heaps[FirstNonFinalizedHeap + i]->completeLazySweep();
+    ASSERT(!isLazySweeping());
+    m_stats.increaseLazySweepTime(WTF::currentTimeMS() - startTime);
+}
+
+void ThreadState::didFinishLazySweepingHeap()
+{
+    ASSERT(m_lazySweepingHeapCount > 0);
+    if (--m_lazySweepingHeapCount)
+        return;
+    getStats(m_statsAfterLastGC);
+    setLowCollectionRate(m_stats.totalObjectSpace() > (m_objectSpaceBeforeSweep >> 1));
+}
+
 void ThreadState::setForcePreciseGCForTesting(bool value)
 {
     checkThread();
@@ -872,6 +1036,9 @@ bool ThreadState::isConsistentForSweeping()
 
 void ThreadState::prepareForGC()
 {
+    // Pages that have not been swept yet still carry the mark bits
+    // of the previous collection.
+    completeLazySweep();
     for (int i = 0; i < NumberOfHeaps; i++) {
         BaseHeap* heap = m_heaps[i];
         heap->makeConsistentForSweeping();
@@ -1103,7 +1270,9 @@ void ThreadState::performPendingSweep()
         TRACE_EVENT_SET_SAMPLING_STATE("blink", "BlinkGCSweeping");
     }
 
-    size_t objectSpaceBeforeSweep = m_stats.totalObjectSpace();
+    ASSERT(!isLazySweeping());
+    bool lazySweep = canLazySweep();
+    m_objectSpaceBeforeSweep = m_stats.totalObjectSpace();
     {
         NoSweepScope scope(this);
 
@@ -1121,6 +1290,11 @@ void ThreadState::performPendingSweep()
         // Sweeping will recalculate the stats
         m_stats.clear();
 
+        // Move live collection backing stores off sparsely populated pages
+        // so that sweeping releases the evacuated pages.
+        if (Heap::isCompacting())
+            Heap::compact(this);
+
         // Sweep the non-finalized heap pages on multiple threads.
         // Attempt to load-balance by having the sweeper thread sweep as
         // close to half of the pages as possible.
@@ -1140,7 +1314,7 @@ void ThreadState::performPendingSweep()
         static const int minNumberOfPagesForParallelSweep = 10;
         HeapStats heapStatsVector[NumberOfNonFinalizedHeaps];
         BaseHeap* splitOffHeaps[NumberOfNonFinalizedHeaps] = { 0 };
-        for (int i = 0; i < NumberOfNonFinalizedHeaps && pagesToSweepInParallel > 0; i++) {
+        for (int i = 0; i < NumberOfNonFinalizedHeaps && pagesToSweepInParallel > 0 && !lazySweep; i++) {
             BaseHeap* heap = m_heaps[FirstNonFinalizedHeap + i];
             int pageCount = heap->normalPageCount();
             // Only use the sweeper thread if it exists and there are
@@ -1160,11 +1334,16 @@ void ThreadState::performPendingSweep()
 
         {
             // Sweep the remainder of the non-finalized pages (or all of them
-            // if there is no sweeper thread).
+            // if there is no sweeper thread). When sweeping lazily only the
+            // large objects are swept here.
             TRACE_EVENT0("blink_gc", "ThreadState::sweepNonFinalizedHeaps");
             for (int i = 0; i < NumberOfNonFinalizedHeaps; i++) {
                 HeapStats stats;
-                m_heaps[FirstNonFinalizedHeap + i]->sweep(&stats);
+                BaseHeap* heap = m_heaps[FirstNonFinalizedHeap + i];
+                if (!lazySweep)
+                    heap->sweep(&stats);
+                else if (heap->prepareForLazySweep(&stats))
+                    ++m_lazySweepingHeapCount;
                 m_stats.add(&stats);
             }
         }
@@ -1191,15 +1370,24 @@ void ThreadState::performPendingSweep()
         for (int i = 0; i < NumberOfHeaps; i++)
             m_heaps[i]->postSweepProcessing();
 
-        getStats(m_statsAfterLastGC);
+        m_stats.setSweepPauseTime(WTF::currentTimeMS() - timeStamp);
+
+        // The stats after a lazy sweep are known once all pages have
+        // been swept. See didFinishLazySweepingHeap.
+        if (!isLazySweeping())
+            getStats(m_statsAfterLastGC);
 
     } // End NoSweepScope
     clearGCRequested();
     clearSweepRequested();
-    // If we collected less than 50% of objects, record that the
-    // collection rate is low which we use to determine when to
-    // perform the next GC.
-    setLowCollectionRate(m_stats.totalObjectSpace() > (objectSpaceBeforeSweep >> 1));
+    if (isLazySweeping()) {
+        scheduleLazySweep();
+    } else {
+        // If we collected less than 50% of objects, record that the
+        // collection rate is low which we use to determine when to
+        // perform the next GC.
+        setLowCollectionRate(m_stats.totalObjectSpace() > (m_objectSpaceBeforeSweep >> 1));
+    }
 
     if (blink::Platform::current()) {
         blink::Platform::current()->histogramCustomCounts("BlinkGC.PerformPendingSweep", WTF::currentTimeMS() - timeStamp, 0, 10 * 1000, 50);
@@ -214,18 +214,35 @@ FOR_EACH_TYPED_HEAP(DEFINE_TYPED_HEAP_TRAIT)
 // A HeapStats structure keeps track of the amount of memory allocated
 // for a Blink heap and how much of that memory is used for actual
 // Blink objects. These stats are used in the heuristics to determine
-// when to perform garbage collections.
+// when to perform garbage collections. The sweeping counters describe
+// the sweep that followed the last garbage collection.
 class HeapStats {
 public:
-    HeapStats() : m_totalObjectSpace(0), m_totalAllocatedSpace(0) { }
+    HeapStats()
+        : m_totalObjectSpace(0)
+        , m_totalAllocatedSpace(0)
+        , m_sweptSpace(0)
+        , m_sweepPauseTimeMs(0)
+        , m_lazySweepTimeMs(0)
+        , m_compactedSpace(0)
+    {
+    }
 
     size_t totalObjectSpace() const { return m_totalObjectSpace; }
     size_t totalAllocatedSpace() const { return m_totalAllocatedSpace; }
+    size_t sweptSpace() const { return m_sweptSpace; }
+    double sweepPauseTimeMs() const { return m_sweepPauseTimeMs; }
+    double lazySweepTimeMs() const { return m_lazySweepTimeMs; }
+    size_t compactedSpace() const { return m_compactedSpace; }
 
     void add(HeapStats* other)
     {
         m_totalObjectSpace += other->m_totalObjectSpace;
         m_totalAllocatedSpace += other->m_totalAllocatedSpace;
+        m_sweptSpace += other->m_sweptSpace;
+        m_sweepPauseTimeMs += other->m_sweepPauseTimeMs;
+        m_lazySweepTimeMs += other->m_lazySweepTimeMs;
+        m_compactedSpace += other->m_compactedSpace;
     }
 
     void inline increaseObjectSpace(size_t newObjectSpace)
@@ -248,12 +265,26 @@ public:
         m_totalAllocatedSpace -= deadAllocatedSpace;
     }
 
+    void inline increaseSweptSpace(size_t sweptSpace)
+    {
+        m_sweptSpace += sweptSpace;
+    }
+
+    void setSweepPauseTime(double timeMs) { m_sweepPauseTimeMs = timeMs; }
+    void increaseLazySweepTime(double timeMs) { m_lazySweepTimeMs += timeMs; }
+    void increaseCompactedSpace(size_t compactedSpace) { m_compactedSpace += compactedSpace; }
+
     void clear()
     {
         m_totalObjectSpace = 0;
         m_totalAllocatedSpace = 0;
+        m_sweptSpace = 0;
+        m_sweepPauseTimeMs = 0;
+        m_lazySweepTimeMs = 0;
+        m_compactedSpace = 0;
     }
 
+    // Only the space counters can be recomputed by scanning the heap.
     bool operator==(const HeapStats& other)
     {
         return m_totalAllocatedSpace == other.m_totalAllocatedSpace
@@ -263,6 +294,10 @@ public:
 private:
     size_t m_totalObjectSpace; // Actually contains objects that may be live, not including headers.
     size_t m_totalAllocatedSpace; // Allocated from the OS.
+    size_t m_sweptSpace; // Page and large object space swept, including freed pages.
+    double m_sweepPauseTimeMs; // Time spent in ThreadState::performPendingSweep.
+    double m_lazySweepTimeMs; // Time spent sweeping pages after the pause.
+    size_t m_compactedSpace; // Page space released by heap compaction.
 
     friend class HeapTester;
 };
@@ -417,6 +452,38 @@ public:
 
     void prepareForGC();
 
+    // Incremental marking. When enabled, a garbage collection requested
+    // by the main thread starts an incremental marking cycle instead of
+    // a stop-the-world collection. Marking steps are performed as idle
+    // tasks and the cycle is finalized by a regular collection once the
+    // marking stack has been drained. See Heap::startIncrementalMarking.
+    static void setIncrementalMarkingEnabled(bool);
+    bool isIncrementalMarking() const { return m_isIncrementalMarking; }
+    void setIncrementalMarking(bool);
+    void performIncrementalMarkingStep(double allottedTimeMs);
+
+    // Mark the objects allocated and the pointers recorded by the write
+    // barrier since the last incremental marking step.
+    void visitIncrementalMarkingRoots(Visitor*);
+    void recordWriteBarrier(const void* value) { m_writeBarrierBuffer.append(reinterpret_cast<Address>(const_cast<void*>(value))); }
+
+    void recordIncrementalMarkingStep(double stepTimeMs);
+    size_t incrementalMarkingStepCount() const { return m_incrementalMarkingStepCount; }
+    double maxIncrementalMarkingStepTimeMs() const { return m_maxIncrementalMarkingStepTimeMs; }
+
+    // Lazy sweeping. When enabled, the main thread does not sweep the
+    // pages of the non-finalized heaps after a garbage collection.
+    // Instead the pages are swept on demand when an allocation finds
+    // the free lists empty, and by idle tasks. Sweeping is completed
+    // before the next garbage collection starts. Pages of finalized
+    // heaps and large objects are always swept eagerly.
+    static void setLazySweepingEnabled(bool);
+    static bool lazySweepingEnabled() { return s_lazySweepingEnabled; }
+    bool isLazySweeping() const { return m_lazySweepingHeapCount > 0; }
+    void completeLazySweep();
+    void performIdleLazySweep(double allottedTimeMs);
+    void didFinishLazySweepingHeap();
+
     // Safepoint related functionality.
     //
     // When a thread attempts to perform GC it needs to stop all other threads
@@ -647,6 +714,10 @@ private:
     }
 
     void performPendingGC(StackState);
+    bool canStartIncrementalMarking();
+    void scheduleIncrementalMarkingStep();
+    bool canLazySweep();
+    void scheduleLazySweep();
 
     // Finds the Blink HeapPage in this thread-specific heap
     // corresponding to a given address. Return 0 if the address is
@@ -675,6 +746,9 @@ private:
     // and outermost GC has started.
     static bool s_inGC;
 
+    static bool s_incrementalMarkingEnabled;
+    static bool s_lazySweepingEnabled;
+
     // We can't create a static member of type ThreadState here
     // because it will introduce global constructor and destructor.
     // We would like to manage lifetime of the ThreadState attached
@@ -702,6 +776,12 @@ private:
     bool m_sweepInProgress;
     size_t m_noAllocationCount;
     bool m_inGC;
+    bool m_isIncrementalMarking;
+    Vector<Address> m_writeBarrierBuffer;
+    size_t m_incrementalMarkingStepCount;
+    double m_maxIncrementalMarkingStepTimeMs;
+    int m_lazySweepingHeapCount;
+    size_t m_objectSpaceBeforeSweep;
     BaseHeap* m_heaps[NumberOfHeaps];
     OwnPtr<HeapContainsCache> m_heapContainsCache;
     HeapStats m_stats;
@@ -346,6 +346,12 @@ public:
     // weak processing.
     virtual void registerDelayedMarkNoTracing(const void*) = 0;
 
+    // Used by collections to report the slot that holds their backing
+    // store after marking it. A backing that is only referenced from a
+    // single reported slot can be moved by heap compaction, which then
+    // updates the slot.
+    virtual void registerBackingStoreReference(void* slot) { }
+
     // If the object calls this during the regular trace callback, then the
     // WeakPointerCallback argument may be called later, when the strong roots
     // have all been found. The WeakPointerCallback will normally use isAlive
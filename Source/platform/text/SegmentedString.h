@@ -60,7 +60,7 @@ public:
 
     void clear() { m_length = 0; m_data.string16Ptr = 0; m_is8Bit = false;}
 
-    bool is8Bit() { return m_is8Bit; }
+    bool is8Bit() const { return m_is8Bit; }
 
     bool excludeLineNumbers() const { return !m_doNotExcludeLineNumbers; }
     bool doNotExcludeLineNumbers() const { return m_doNotExcludeLineNumbers; }
@@ -125,6 +125,17 @@ public:
         return incrementAndGetCurrentChar16();
     }
 
+    ALWAYS_INLINE UChar skipAndGetCurrentChar(unsigned count)
+    {
+        ASSERT(m_length);
+        if (is8Bit()) {
+            m_data.string8Ptr += count;
+            return *m_data.string8Ptr;
+        }
+        m_data.string16Ptr += count;
+        return *m_data.string16Ptr;
+    }
+
 public:
     union {
         const LChar* string8Ptr;
@@ -289,6 +300,29 @@ public:
     // have space for at least |count| characters.
     void advance(unsigned count, UChar* consumedCharacters);
 
+    // Tokenizers can consume runs of ordinary characters in bulk: they scan
+    // the rest of the current substring, starting at the current character,
+    // and then skip the run with advancePastNonNewlines(). There is nothing to
+    // scan while pushed characters are pending.
+    unsigned remainingLengthOfCurrentSubstring() const { return m_pushedChar1 ? 0 : m_currentString.m_length; }
+    bool currentSubstringIs8Bit() const { return m_currentString.is8Bit(); }
+    const LChar* currentCharacters8() const { ASSERT(currentSubstringIs8Bit()); return m_currentString.m_data.string8Ptr; }
+    const UChar* currentCharacters16() const { ASSERT(!currentSubstringIs8Bit()); return m_currentString.m_data.string16Ptr; }
+
+    // Skips |count| characters of the current substring, none of which may be
+    // a newline. At least one character of the substring must remain.
+    void advancePastNonNewlines(unsigned count)
+    {
+        ASSERT(!m_pushedChar1);
+        ASSERT(count < static_cast<unsigned>(m_currentString.m_length));
+        if (!count)
+            return;
+        m_currentString.m_length -= count;
+        m_currentChar = m_currentString.skipAndGetCurrentChar(count);
+        if (m_currentString.m_length == 1)
+            updateSlowCaseFunctionPointers();
+    }
+
     bool escaped() const { return m_pushedChar1; }
 
     int numberOfCharactersConsumed() const
@@ -83,4 +83,43 @@ TEST(SegmentedStringTest, CurrentChar)
     }
 }
 
+TEST(SegmentedStringTest, AdvancePastNonNewlines)
+{
+    SegmentedString source(String("abcdef"));
+    source.append(SegmentedString(String("gh\nij")));
+    EXPECT_EQ(6u, source.remainingLengthOfCurrentSubstring());
+    EXPECT_TRUE(source.currentSubstringIs8Bit());
+    EXPECT_EQ('a', source.currentCharacters8()[0]);
+
+    source.advancePastNonNewlines(4);
+    EXPECT_EQ('e', source.currentChar());
+    EXPECT_EQ(2u, source.remainingLengthOfCurrentSubstring());
+    EXPECT_EQ(4, source.numberOfCharactersConsumed());
+
+    // Leaving a single character must keep ordinary advancing working
+    // across the substring boundary.
+    source.advancePastNonNewlines(1);
+    EXPECT_EQ('f', source.currentChar());
+    source.advance();
+    EXPECT_EQ('g', source.currentChar());
+    EXPECT_EQ("gh\nij", source.toString());
+
+    source.advancePastNonNewlines(1);
+    EXPECT_EQ('h', source.currentChar());
+    source.advanceAndUpdateLineNumber();
+    source.advancePastNewlineAndUpdateLineNumber();
+    EXPECT_EQ('i', source.currentChar());
+    EXPECT_EQ(1, source.currentLine().zeroBasedInt());
+    EXPECT_EQ(0, source.currentColumn().zeroBasedInt());
+}
+
+TEST(SegmentedStringTest, NoRunWhilePushedCharactersArePending)
+{
+    SegmentedString source(String("bcd"));
+    source.push('a');
+    EXPECT_EQ(0u, source.remainingLengthOfCurrentSubstring());
+    source.advance();
+    EXPECT_EQ(3u, source.remainingLengthOfCurrentSubstring());
+}
+
 } // namespace
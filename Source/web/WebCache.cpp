@@ -31,6 +31,7 @@
 #include "config.h"
 #include "public/web/WebCache.h"
 
+#include "core/css/StyleSheetContentsCache.h"
 #include "core/fetch/MemoryCache.h"
 
 namespace blink {
@@ -59,6 +60,7 @@ void WebCache::clear()
     MemoryCache* cache = memoryCache();
     if (cache)
         cache->evictResources();
+    StyleSheetContentsCache::instance().clear();
 }
 
 void WebCache::getUsageStats(UsageStats* result)
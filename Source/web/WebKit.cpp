@@ -145,6 +145,8 @@ void initializeWithoutV8(Platform* platform)
     WTF::setRandomSource(cryptographicallyRandomValues);
     WTF::initialize(currentTimeFunction, monotonicallyIncreasingTimeFunction);
     WTF::initializeMainThread(callOnMainThreadFunction);
+    // Lets the HTML parser thread hand atomized names to the main thread.
+    AtomicString::enableSharedTable();
     Heap::init();
     Scheduler::initializeOnMainThread();
 
@@ -0,0 +1,115 @@
+// Copyright 2014 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "config.h"
+
+#include "core/dom/Document.h"
+#include "core/dom/Element.h"
+#include "core/dom/Text.h"
+#include "core/frame/LocalFrame.h"
+#include "core/page/Page.h"
+#include "core/testing/URLTestHelpers.h"
+#include "platform/RuntimeEnabledFeatures.h"
+#include "web/WebLocalFrameImpl.h"
+#include "web/WebViewImpl.h"
+#include "web/tests/FrameTestHelpers.h"
+#include "wtf/text/StringBuilder.h"
+#include <gtest/gtest.h>
+
+namespace {
+
+using blink::FrameTestHelpers::WebViewHelper;
+using blink::URLTestHelpers::toKURL;
+using namespace blink;
+
+// Appends one line per node of the subtree at |node|, so that trees with the
+// same markup but different text node boundaries compare differently.
+void dumpTree(const Node& node, unsigned depth, StringBuilder& dump)
+{
+    for (unsigned i = 0; i < depth; ++i)
+        dump.append(' ');
+    if (node.isElementNode())
+        dump.append(toElement(node).tagName());
+    else if (node.isTextNode())
+        dump.append("#text \"" + toText(node).data() + "\"");
+    else
+        dump.append(node.nodeName());
+    dump.append('\n');
+    for (Node* child = node.firstChild(); child; child = child->nextSibling())
+        dumpTree(*child, depth + 1, dump);
+}
+
+// Loads |html| through the threaded HTML parser and returns a dump of the
+// resulting document.
+String parse(const std::string& html, bool useSpeculativeTreeBuilding)
+{
+    bool wasEnabled = RuntimeEnabledFeatures::speculativeTreeBuildingEnabled();
+    RuntimeEnabledFeatures::setSpeculativeTreeBuildingEnabled(useSpeculativeTreeBuilding);
+
+    WebViewHelper webViewHelper;
+    webViewHelper.initialize();
+    FrameTestHelpers::loadHTMLString(webViewHelper.webView()->mainFrame(), html, toKURL("http://www.test.com/"));
+    Document* document = toLocalFrame(webViewHelper.webViewImpl()->page()->mainFrame())->document();
+    StringBuilder dump;
+    dumpTree(*document->documentElement(), 0, dump);
+
+    RuntimeEnabledFeatures::setSpeculativeTreeBuildingEnabled(wasEnabled);
+    return dump.toString();
+}
+
+void expectSameTree(const std::string& html)
+{
+    String expected = parse(html, false);
+    EXPECT_EQ(expected, parse(html, true)) << html;
+}
+
+TEST(SpeculativeTreeBuildingTest, BlockStartTagsCloseParagraphs)
+{
+    expectSameTree("<body><p>one<div>two</div><p>three<section>four</section>"
+        "<p>five<span>six<article>seven</article></span><p>eight<p>nine</body>");
+}
+
+TEST(SpeculativeTreeBuildingTest, StrayAndIgnoredEndTags)
+{
+    // </span> is ignored while a <div> inside it is open, and </div> closes the
+    // <span> inside it. A stray </p> inserts an empty paragraph.
+    expectSameTree("<body><div>one<span>two<div>three</span>four</div>five</span>"
+        "six</div><div><span>seven</div>eight</span></p>nine<div>ten</div></body>");
+    // The text on either side of an ignored end tag is a single text node.
+    expectSameTree("<body><div>one</span>two</div><div>three<span>four<div>five"
+        "</span>six</div></span>seven</div></body>");
+}
+
+TEST(SpeculativeTreeBuildingTest, TopLevelTextAndComments)
+{
+    expectSameTree("<body>one<!--two-->three<div>four</div>five<!--six-->"
+        "<span>seven</span>eight<!--nine--></body>");
+}
+
+TEST(SpeculativeTreeBuildingTest, ElementsOpenAtEndOfRun)
+{
+    // <b> is not part of any run, so the run before it ends with the <div>,
+    // <span> and <section> still open.
+    expectSameTree("<body><div>one<span>two<!--three-->four<p>five</p><section>six"
+        "<b>seven</b>eight</section>nine</span>ten</div><div>eleven</div></body>");
+}
+
+TEST(SpeculativeTreeBuildingTest, RunSplitAcrossChunks)
+{
+    // The background parser sends at most 1000 tokens in a chunk, so this run
+    // continues in the next chunk with elements still open.
+    StringBuilder html;
+    html.appendLiteral("<body><div><section>");
+    for (int i = 0; i < 700; ++i) {
+        html.appendLiteral("<span>");
+        html.appendNumber(i);
+        html.appendLiteral("</span>");
+        if (!(i % 100))
+            html.appendLiteral("<p>paragraph");
+    }
+    html.appendLiteral("</section>tail</div></body>");
+    expectSameTree(html.toString().utf8().data());
+}
+
+} // namespace
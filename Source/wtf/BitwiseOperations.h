@@ -36,6 +36,7 @@
 // zeros in a binary value, starting with the most significant bit. C does not
 // have an operator to do this, but fortunately the various compilers have
 // built-ins that map to fast underlying processor instructions.
+// countTrailingZeros() does the same starting with the least significant bit.
 
 #include "wtf/CPU.h"
 #include "wtf/Compiler.h"
@@ -56,6 +57,12 @@ ALWAYS_INLINE uint32_t countLeadingZeros32(uint32_t x)
     return LIKELY(_BitScanReverse(&index, x)) ? (31 - index) : 32;
 }
 
+ALWAYS_INLINE uint32_t countTrailingZeros32(uint32_t x)
+{
+    unsigned long index;
+    return LIKELY(_BitScanForward(&index, x)) ? index : 32;
+}
+
 #if CPU(64BIT)
 
 // MSVC only supplies _BitScanForward64 when building for a 64-bit target.
@@ -79,6 +86,11 @@ ALWAYS_INLINE uint32_t countLeadingZeros32(uint32_t x)
     return LIKELY(x) ? __builtin_clz(x) : 32;
 }
 
+ALWAYS_INLINE uint32_t countTrailingZeros32(uint32_t x)
+{
+    return LIKELY(x) ? __builtin_ctz(x) : 32;
+}
+
 ALWAYS_INLINE uint64_t countLeadingZeros64(uint64_t x)
 {
     return LIKELY(x) ? __builtin_clzll(x) : 64;
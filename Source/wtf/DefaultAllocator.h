@@ -88,6 +88,8 @@ public:
         return reinterpret_cast<Return>(fastMalloc(size));
     }
     WTF_EXPORT static void backingFree(void* address);
+    static void backingWriteBarrier(void*) { }
+    static void inlineBufferWriteBarrier(void*, size_t) { }
     static void free(void* address)
     {
         fastFree(address);
@@ -125,6 +127,11 @@ public:
         ASSERT_NOT_REACHED();
     }
 
+    static void registerBackingStoreReference(...)
+    {
+        ASSERT_NOT_REACHED();
+    }
+
 #if ENABLE(ASSERT)
     static bool weakTableRegistered(...)
     {
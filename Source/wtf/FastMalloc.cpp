@@ -61,6 +61,12 @@ void fastMallocShutdown()
     gPartition.shutdown();
 }
 
+void fastMallocDumpPartitionStats(PartitionStatsDumper* dumper)
+{
+    if (gInitialized)
+        partitionDumpStatsGeneric(gPartition.root(), "fastMalloc", dumper);
+}
+
 void* fastMalloc(size_t n)
 {
     if (UNLIKELY(!gInitialized)) {
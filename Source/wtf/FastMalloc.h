@@ -25,8 +25,11 @@
 
 namespace WTF {
 
+class PartitionStatsDumper;
+
 // Initialization is implicit on first use.
 WTF_EXPORT void fastMallocShutdown();
+WTF_EXPORT void fastMallocDumpPartitionStats(PartitionStatsDumper*);
 
 // These functions crash safely if an allocation fails.
 WTF_EXPORT void* fastMalloc(size_t);
@@ -30,7 +30,11 @@
 #include "wtf/PassOwnPtr.h"
 #include "wtf/PassRefPtr.h"
 #include "wtf/RefCounted.h"
+#include "wtf/Vector.h"
+#include "wtf/text/StringHash.h"
+#include "wtf/text/WTFString.h"
 #include <gtest/gtest.h>
+#include <time.h>
 
 namespace {
 
@@ -260,4 +264,122 @@ TEST(HashMapTest, AddResult)
     EXPECT_EQ(1, map.get(1)->v());
 }
 
+typedef HashMap<String, int, StringHash, GroupedProbingHashTraits<String> > GroupedStringMap;
+
+TEST(HashMapTest, GroupedProbing)
+{
+    GroupedStringMap map;
+    for (int i = 1; i <= 1000; ++i)
+        EXPECT_TRUE(map.add(String::number(i), i).isNewEntry);
+    EXPECT_FALSE(map.add("1", 0).isNewEntry);
+    EXPECT_EQ(1000u, map.size());
+    for (int i = 1; i <= 1000; ++i)
+        EXPECT_EQ(i, map.get(String::number(i)));
+    EXPECT_FALSE(map.contains("0"));
+    EXPECT_FALSE(map.contains("1001"));
+
+    // Removed keys leave deleted buckets, which are reused.
+    for (int i = 1; i <= 1000; i += 2)
+        map.remove(String::number(i));
+    EXPECT_EQ(500u, map.size());
+    for (int i = 1; i <= 1000; ++i)
+        EXPECT_EQ(!(i % 2), map.contains(String::number(i)));
+    for (int i = 1; i <= 1000; i += 2)
+        map.set(String::number(i), -i);
+    for (int i = 1; i <= 1000; ++i)
+        EXPECT_EQ(i % 2 ? -i : i, map.get(String::number(i)));
+
+    int sum = 0;
+    for (GroupedStringMap::iterator it = map.begin(); it != map.end(); ++it)
+        sum += it->value;
+    EXPECT_EQ(500, sum);
+
+    GroupedStringMap copy(map);
+    map.clear();
+    EXPECT_TRUE(map.isEmpty());
+    EXPECT_FALSE(map.contains("2"));
+    EXPECT_EQ(1000u, copy.size());
+    EXPECT_EQ(2, copy.get("2"));
+    map.swap(copy);
+    EXPECT_EQ(-1, map.get("1"));
+    EXPECT_TRUE(copy.isEmpty());
+}
+
+struct CollidingIntHash {
+    static unsigned hash(int key) { return key & 1; }
+    static bool equal(int a, int b) { return a == b; }
+    static const bool safeToCompareToEmptyOrDeleted = true;
+};
+
+TEST(HashMapTest, GroupedProbingCollisions)
+{
+    // All keys land in the same two buckets with the same control byte, so
+    // probing has to go through many groups.
+    HashMap<int, int, CollidingIntHash, GroupedProbingHashTraits<int> > map;
+    for (int i = 1; i <= 200; ++i)
+        map.add(i, i * 2);
+    for (int i = 1; i <= 200; ++i)
+        EXPECT_EQ(i * 2, map.get(i));
+    EXPECT_FALSE(map.contains(201));
+
+    for (int round = 0; round < 10; ++round) {
+        for (int i = 1; i <= 200; i += 3)
+            map.remove(i);
+        for (int i = 1; i <= 200; ++i)
+            EXPECT_EQ((i - 1) % 3 ? i * 2 : 0, map.get(i));
+        for (int i = 1; i <= 200; i += 3)
+            map.add(i, i * 2);
+    }
+    EXPECT_EQ(200u, map.size());
+}
+
+static void recordBenchmarkProperty(const char* name, const char* suffix, int value)
+{
+    String key = String(name) + suffix;
+    ::testing::Test::RecordProperty(key.utf8().data(), value);
+}
+
+template<typename Map>
+static void runLookupBenchmark(const char* name, bool hasControlBytes, const Vector<String>& keys, const Vector<String>& misses)
+{
+    static const int kRounds = 20;
+    clock_t start = clock();
+    Map map;
+    for (size_t i = 0; i < keys.size(); ++i)
+        map.add(keys[i], i);
+    double insertMs = (clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+
+    start = clock();
+    size_t found = 0;
+    for (int round = 0; round < kRounds; ++round) {
+        for (size_t i = 0; i < keys.size(); ++i)
+            found += map.contains(keys[i]);
+        for (size_t i = 0; i < misses.size(); ++i)
+            found += map.contains(misses[i]);
+    }
+    double lookupMs = (clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+    EXPECT_EQ(kRounds * keys.size(), found);
+
+    size_t bytesPerBucket = sizeof(typename Map::ValueType) + (hasControlBytes ? 1 : 0);
+    double bytesPerEntry = static_cast<double>(map.capacity() * bytesPerBucket) / map.size();
+
+    recordBenchmarkProperty(name, "InsertMs", static_cast<int>(insertMs));
+    recordBenchmarkProperty(name, "LookupMs", static_cast<int>(lookupMs));
+    recordBenchmarkProperty(name, "BytesPerEntry", static_cast<int>(bytesPerEntry));
+}
+
+// Compares the classic and the grouped probing table layouts. Run with
+// --gtest_also_run_disabled_tests.
+TEST(HashMapTest, DISABLED_GroupedProbingThroughput)
+{
+    Vector<String> keys;
+    Vector<String> misses;
+    for (int i = 0; i < 100000; ++i) {
+        keys.append("key" + String::number(i));
+        misses.append("miss" + String::number(i));
+    }
+    runLookupBenchmark<HashMap<String, int> >("classic", false, keys, misses);
+    runLookupBenchmark<GroupedStringMap>("grouped", true, keys, misses);
+}
+
 } // namespace
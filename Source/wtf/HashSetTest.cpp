@@ -80,6 +80,42 @@ TEST(HashSetTest, InitialCapacity)
     generateTestCapacityUpToSize<128>();
 }
 
+TEST(HashSetTest, GroupedProbing)
+{
+    const unsigned groupWidth = WTF::HashTableControlBytes::groupWidth;
+    HashSet<int, DefaultHash<int>::Hash, GroupedProbingHashTraits<int> > set;
+    EXPECT_EQ(0u, set.capacity());
+
+    // Tables with control bytes hold at least one group of buckets.
+    set.add(1);
+    EXPECT_EQ(groupWidth, set.capacity());
+
+    for (int i = 1; i <= 1000; ++i)
+        set.add(i);
+    EXPECT_EQ(1000u, set.size());
+    for (int i = 1; i <= 1000; ++i)
+        EXPECT_TRUE(set.contains(i));
+    EXPECT_FALSE(set.contains(1001));
+
+    for (int i = 1; i <= 1000; ++i) {
+        set.remove(i);
+        EXPECT_FALSE(set.contains(i));
+        if (i < 1000)
+            EXPECT_TRUE(set.contains(i + 1));
+    }
+    EXPECT_TRUE(set.isEmpty());
+    EXPECT_EQ(groupWidth, set.capacity());
+
+    set.add(42);
+    EXPECT_TRUE(set.contains(42));
+    size_t count = 0;
+    for (HashSet<int, DefaultHash<int>::Hash, GroupedProbingHashTraits<int> >::iterator it = set.begin(); it != set.end(); ++it) {
+        EXPECT_EQ(42, *it);
+        ++count;
+    }
+    EXPECT_EQ(1u, count);
+}
+
 struct Dummy {
     Dummy(bool& deleted) : deleted(deleted) { }
 
@@ -22,10 +22,16 @@
 
 #include "wtf/Alignment.h"
 #include "wtf/Assertions.h"
+#include "wtf/BitwiseOperations.h"
 #include "wtf/DefaultAllocator.h"
 #include "wtf/HashTraits.h"
+#include "wtf/VectorTraits.h"
 #include "wtf/WTF.h"
 
+#if CPU(X86) || CPU(X86_64)
+#include <emmintrin.h>
+#endif
+
 #define DUMP_HASHTABLE_STATS 0
 #define DUMP_HASHTABLE_STATS_PER_TABLE 0
 
@@ -102,6 +108,20 @@ namespace WTF {
 
     typedef enum { HashItemKnownGood } HashItemKnownGoodTag;
 
+    // Whether heap compaction may move a backing store holding buckets of
+    // type Value with memcpy. The buckets of hash maps are KeyValuePairs,
+    // which have no VectorTraits of their own, so they are movable when
+    // both their key and their value are.
+    template<typename Value>
+    struct IsHashTableBucketMovable {
+        static const bool value = VectorTraits<Value>::canMoveWithMemcpy;
+    };
+
+    template<typename Key, typename Value>
+    struct IsHashTableBucketMovable<KeyValuePair<Key, Value> > {
+        static const bool value = VectorTraits<Key>::canMoveWithMemcpy && VectorTraits<Value>::canMoveWithMemcpy;
+    };
+
     template<typename Key, typename Value, typename Extractor, typename HashFunctions, typename Traits, typename KeyTraits, typename Allocator>
     class HashTableConstIterator {
     private:
@@ -327,6 +347,59 @@ namespace WTF {
         static bool isEmptyOrDeletedBucket(const Value& value) { return isEmptyBucket(value) || isDeletedBucket(value); }
     };
 
+    // Tables with key traits that set useGroupedProbing keep a control byte
+    // per bucket, stored in the backing after the buckets. A control byte
+    // marks its bucket empty or deleted, or holds 7 bits of the hash of the
+    // key in the bucket. Lookups compare a group of 16 control bytes against
+    // the hash at once and only compare the keys of the buckets that match,
+    // probing group by group until a group has an empty bucket. The first
+    // group of control bytes is repeated after the last one so that a group
+    // can be loaded from any bucket without wrapping around.
+    struct HashTableControlBytes {
+        static const unsigned groupWidth = 16;
+        static const int8_t empty = -128;
+        static const int8_t deleted = -2;
+
+        static size_t size(unsigned tableSize) { return tableSize + groupWidth; }
+
+        static int8_t tag(unsigned hash)
+        {
+            // Take the top bits of a multiplicative hash, since the low bits
+            // of the hash select the bucket.
+            return static_cast<int8_t>((hash * 0x9E3779B1u) >> 25);
+        }
+
+        // Returns a mask with bit i set if control byte i of the group is
+        // equal to value.
+        static unsigned match(const int8_t* group, int8_t value)
+        {
+#if CPU(X86) || CPU(X86_64)
+            __m128i controlBytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+            return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(value), controlBytes));
+#else
+            unsigned mask = 0;
+            for (unsigned i = 0; i < groupWidth; ++i)
+                mask |= static_cast<unsigned>(group[i] == value) << i;
+            return mask;
+#endif
+        }
+
+        static unsigned matchEmpty(const int8_t* group) { return match(group, empty); }
+
+        // Empty and deleted are the only negative control bytes.
+        static unsigned matchEmptyOrDeleted(const int8_t* group)
+        {
+#if CPU(X86) || CPU(X86_64)
+            return _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(group)));
+#else
+            unsigned mask = 0;
+            for (unsigned i = 0; i < groupWidth; ++i)
+                mask |= static_cast<unsigned>(group[i] < 0) << i;
+            return mask;
+#endif
+        }
+    };
+
     template<typename HashTranslator, typename KeyTraits, bool safeToCompareToEmptyOrDeleted>
     struct HashTableKeyChecker {
         // There's no simple generic way to make this check if safeToCompareToEmptyOrDeleted is false,
@@ -496,6 +569,10 @@ namespace WTF {
 #endif
 
     private:
+        // Grouped probing is not supported for garbage collected backings,
+        // whose contents are traced bucket by bucket.
+        static const bool hasControlBytes = KeyTraits::useGroupedProbing && !Allocator::isGarbageCollected;
+
         static ValueType* allocateTable(unsigned size);
         static void deleteAllBucketsAndDeallocate(ValueType* table, unsigned size);
 
@@ -505,6 +582,25 @@ namespace WTF {
         LookupType lookupForWriting(const Key& key) { return lookupForWriting<IdentityTranslatorType>(key); };
         template<typename HashTranslator, typename T> FullLookupType fullLookupForWriting(const T&);
         template<typename HashTranslator, typename T> LookupType lookupForWriting(const T&);
+        template<typename HashTranslator, typename T> const ValueType* lookupInGroups(const T&) const;
+        template<typename HashTranslator, typename T> FullLookupType fullLookupInGroupsForWriting(const T&);
+
+        static unsigned minimumTableSize()
+        {
+            if (hasControlBytes && KeyTraits::minimumTableSize < HashTableControlBytes::groupWidth)
+                return HashTableControlBytes::groupWidth;
+            return KeyTraits::minimumTableSize;
+        }
+        static int8_t* controlBytesForTable(ValueType* table, unsigned size) { return reinterpret_cast<int8_t*>(table + size); }
+        const int8_t* controlBytes() const { return reinterpret_cast<const int8_t*>(m_table + m_tableSize); }
+        void setControlByte(ValueType* entry, int8_t value)
+        {
+            int8_t* controlBytes = controlBytesForTable(m_table, m_tableSize);
+            size_t index = entry - m_table;
+            controlBytes[index] = value;
+            if (index < HashTableControlBytes::groupWidth)
+                controlBytes[m_tableSize + index] = value;
+        }
 
         void remove(ValueType*);
 
@@ -515,7 +611,7 @@ namespace WTF {
             // isAllocationAllowed check should be at the last because it's
             // expensive.
             return m_keyCount * m_minLoad < m_tableSize
-                && m_tableSize > KeyTraits::minimumTableSize
+                && m_tableSize > minimumTableSize()
                 && Allocator::isAllocationAllowed();
         }
         ValueType* expand(ValueType* entry = 0);
@@ -647,6 +743,9 @@ namespace WTF {
         if (!table)
             return 0;
 
+        if (hasControlBytes)
+            return lookupInGroups<HashTranslator>(key);
+
         size_t k = 0;
         size_t sizeMask = tableSizeMask();
         unsigned h = HashTranslator::hash(key);
@@ -684,6 +783,9 @@ namespace WTF {
         ASSERT(m_table);
         registerModification();
 
+        if (hasControlBytes)
+            return fullLookupInGroupsForWriting<HashTranslator>(key).first;
+
         ValueType* table = m_table;
         size_t k = 0;
         size_t sizeMask = tableSizeMask();
@@ -726,6 +828,9 @@ namespace WTF {
         ASSERT(m_table);
         registerModification();
 
+        if (hasControlBytes)
+            return fullLookupInGroupsForWriting<HashTranslator>(key);
+
         ValueType* table = m_table;
         size_t k = 0;
         size_t sizeMask = tableSizeMask();
@@ -761,6 +866,69 @@ namespace WTF {
         }
     }
 
+template<typename Key, typename Value, typename Extractor, typename HashFunctions, typename Traits, typename KeyTraits, typename Allocator>
+    template<typename HashTranslator, typename T>
+    inline const Value* HashTable<Key, Value, Extractor, HashFunctions, Traits, KeyTraits, Allocator>::lookupInGroups(const T& key) const
+    {
+        const int8_t* controlBytes = this->controlBytes();
+        size_t sizeMask = tableSizeMask();
+        unsigned h = HashTranslator::hash(key);
+        int8_t tag = HashTableControlBytes::tag(h);
+        size_t i = h & sizeMask;
+        size_t stride = 0;
+
+        UPDATE_ACCESS_COUNTS();
+
+        while (1) {
+            const int8_t* group = controlBytes + i;
+            for (unsigned matches = HashTableControlBytes::match(group, tag); matches; matches &= matches - 1) {
+                const ValueType* entry = m_table + ((i + countTrailingZeros32(matches)) & sizeMask);
+                if (HashTranslator::equal(Extractor::extract(*entry), key))
+                    return entry;
+            }
+            if (HashTableControlBytes::matchEmpty(group))
+                return 0;
+            UPDATE_PROBE_COUNTS();
+            // Triangular probing visits every group of a power of two sized
+            // table.
+            stride += HashTableControlBytes::groupWidth;
+            i = (i + stride) & sizeMask;
+        }
+    }
+
+    template<typename Key, typename Value, typename Extractor, typename HashFunctions, typename Traits, typename KeyTraits, typename Allocator>
+    template<typename HashTranslator, typename T>
+    inline typename HashTable<Key, Value, Extractor, HashFunctions, Traits, KeyTraits, Allocator>::FullLookupType HashTable<Key, Value, Extractor, HashFunctions, Traits, KeyTraits, Allocator>::fullLookupInGroupsForWriting(const T& key)
+    {
+        const int8_t* controlBytes = this->controlBytes();
+        size_t sizeMask = tableSizeMask();
+        unsigned h = HashTranslator::hash(key);
+        int8_t tag = HashTableControlBytes::tag(h);
+        size_t i = h & sizeMask;
+        size_t stride = 0;
+
+        UPDATE_ACCESS_COUNTS();
+
+        ValueType* availableEntry = 0;
+        while (1) {
+            const int8_t* group = controlBytes + i;
+            for (unsigned matches = HashTableControlBytes::match(group, tag); matches; matches &= matches - 1) {
+                ValueType* entry = m_table + ((i + countTrailingZeros32(matches)) & sizeMask);
+                if (HashTranslator::equal(Extractor::extract(*entry), key))
+                    return makeLookupResult(entry, true, h);
+            }
+            if (!availableEntry) {
+                if (unsigned available = HashTableControlBytes::matchEmptyOrDeleted(group))
+                    availableEntry = m_table + ((i + countTrailingZeros32(available)) & sizeMask);
+            }
+            if (HashTableControlBytes::matchEmpty(group))
+                return makeLookupResult(availableEntry, false, h);
+            UPDATE_PROBE_COUNTS();
+            stride += HashTableControlBytes::groupWidth;
+            i = (i + stride) & sizeMask;
+        }
+    }
+
     template<bool emptyValueIsZero> struct HashTableBucketInitializer;
 
     template<> struct HashTableBucketInitializer<false> {
@@ -803,6 +971,28 @@ namespace WTF {
 
         ASSERT(m_table);
 
+        if (hasControlBytes) {
+            FullLookupType lookupResult = fullLookupForWriting<HashTranslator>(key);
+            ValueType* entry = lookupResult.first.first;
+            if (lookupResult.first.second)
+                return AddResult(this, entry, false);
+
+            if (isDeletedBucket(*entry)) {
+                initializeBucket(*entry);
+                --m_deletedCount;
+            }
+
+            HashTranslator::translate(*entry, key, extra);
+            ASSERT(!isEmptyOrDeletedBucket(*entry));
+            setControlByte(entry, HashTableControlBytes::tag(lookupResult.second));
+
+            ++m_keyCount;
+            if (shouldExpand())
+                entry = expand(entry);
+
+            return AddResult(this, entry, true);
+        }
+
         ValueType* table = m_table;
         size_t k = 0;
         size_t sizeMask = tableSizeMask();
@@ -884,6 +1074,8 @@ namespace WTF {
 
         HashTranslator::translate(*entry, key, extra, h);
         ASSERT(!isEmptyOrDeletedBucket(*entry));
+        if (hasControlBytes)
+            setControlByte(entry, HashTableControlBytes::tag(h));
 
         ++m_keyCount;
         if (shouldExpand())
@@ -905,7 +1097,10 @@ namespace WTF {
 #if DUMP_HASHTABLE_STATS_PER_TABLE
         ++m_stats->numReinserts;
 #endif
-        Value* newEntry = lookupForWriting(Extractor::extract(entry)).first;
+        FullLookupType lookupResult = fullLookupForWriting<IdentityTranslatorType>(Extractor::extract(entry));
+        Value* newEntry = lookupResult.first.first;
+        if (hasControlBytes)
+            setControlByte(newEntry, HashTableControlBytes::tag(lookupResult.second));
         Mover<ValueType, Allocator, Traits::needsDestruction>::move(entry, *newEntry);
 
         return newEntry;
@@ -951,6 +1146,8 @@ namespace WTF {
         ++m_stats->numRemoves;
 #endif
 
+        if (hasControlBytes)
+            setControlByte(pos, HashTableControlBytes::deleted);
         deleteBucket(*pos);
         ++m_deletedCount;
         --m_keyCount;
@@ -989,6 +1186,8 @@ namespace WTF {
         typedef typename Allocator::template HashTableBackingHelper<HashTable>::Type HashTableBacking;
 
         size_t allocSize = size * sizeof(ValueType);
+        if (hasControlBytes)
+            allocSize += HashTableControlBytes::size(size);
         ValueType* result;
         // Assert that we will not use memset on things with a vtable entry.
         // The compiler will also check this on some platforms. We would
@@ -1003,6 +1202,8 @@ namespace WTF {
             for (unsigned i = 0; i < size; i++)
                 initializeBucket(result[i]);
         }
+        if (hasControlBytes)
+            memset(controlBytesForTable(result, size), HashTableControlBytes::empty, HashTableControlBytes::size(size));
         return result;
     }
 
@@ -1036,7 +1237,7 @@ namespace WTF {
     {
         unsigned newSize;
         if (!m_tableSize) {
-            newSize = KeyTraits::minimumTableSize;
+            newSize = minimumTableSize();
         } else if (mustRehashInPlace()) {
             newSize = m_tableSize;
         } else {
@@ -1125,6 +1326,8 @@ namespace WTF {
     void HashTable<Key, Value, Extractor, HashFunctions, Traits, KeyTraits, Allocator>::swap(HashTable& other)
     {
         std::swap(m_table, other.m_table);
+        Allocator::backingWriteBarrier(m_table);
+        Allocator::backingWriteBarrier(other.m_table);
         std::swap(m_tableSize, other.m_tableSize);
         std::swap(m_keyCount, other.m_keyCount);
         // std::swap does not work for bit fields.
@@ -1248,6 +1451,11 @@ namespace WTF {
         // weakProcessing callback which will perform weak processing if needed.
         if (Traits::weakHandlingFlag == NoWeakHandlingInCollections) {
             Allocator::markNoTracing(visitor, m_table);
+            // Heap compaction can move the backing if the buckets can be
+            // moved. Weak backings stay in place since weak processing
+            // refers to them after marking.
+            if (IsHashTableBucketMovable<ValueType>::value)
+                Allocator::registerBackingStoreReference(visitor, &m_table);
         } else {
             Allocator::registerDelayedMarkNoTracing(visitor, m_table);
             Allocator::registerWeakMembers(visitor, this, m_table, WeakProcessingHashTableHelper<Traits::weakHandlingFlag, Key, Value, Extractor, HashFunctions, Traits, KeyTraits, Allocator>::process);
@@ -65,6 +65,12 @@ namespace WTF {
         static const unsigned minimumTableSize = 8;
 #endif
 
+        // The useGroupedProbing flag of the key traits selects a table layout
+        // with a control byte per bucket that is probed a group of buckets at
+        // a time, see HashTableControlBytes. It is ignored for garbage
+        // collected tables.
+        static const bool useGroupedProbing = false;
+
         template<typename U = void>
         struct NeedsTracingLazily {
             static const bool value = NeedsTracing<T>::value;
@@ -308,6 +314,13 @@ namespace WTF {
         static T emptyValue() { return reinterpret_cast<T>(1); }
     };
 
+    // Key traits for hot tables with many lookups, such as the ones keyed on
+    // AtomicString.
+    template<typename T>
+    struct GroupedProbingHashTraits : public HashTraits<T> {
+        static const bool useGroupedProbing = true;
+    };
+
     // This is for tracing inside collections that have special support for weak
     // pointers. The trait has a trace method which returns true if there are weak
     // pointers to things that have not (yet) been marked live. Returning true
@@ -320,6 +333,7 @@ namespace WTF {
 
 } // namespace WTF
 
+using WTF::GroupedProbingHashTraits;
 using WTF::HashTraits;
 using WTF::PairHashTraits;
 using WTF::NullableHashTraits;
@@ -31,6 +31,8 @@
 #include "config.h"
 #include "wtf/PartitionAlloc.h"
 
+#include "wtf/ThreadSpecific.h"
+#include <algorithm>
 #include <string.h>
 
 #ifndef NDEBUG
@@ -135,6 +137,26 @@ static void partitionBucketInitBase(PartitionBucket* bucket, PartitionRootBase*
     bucket->numSystemPagesPerSlotSpan = partitionBucketNumSystemPages(bucket->slotSize);
 }
 
+#if PARTITION_LAST_THREAD_CACHE_IN_TLS
+#if COMPILER(MSVC)
+__declspec(thread) PartitionLastThreadCache gPartitionLastThreadCache;
+#else
+__thread PartitionLastThreadCache gPartitionLastThreadCache;
+#endif
+#endif
+
+// Ids of the partitions with thread caches start at 1, so that the initial
+// gPartitionLastThreadCache of a thread matches no partition.
+static int gLastThreadCacheId = 0;
+
+static void partitionThreadCacheDestroyLocked(PartitionThreadCache*);
+
+static ThreadSpecificKey* partitionThreadCacheKey(PartitionRootGeneric* root)
+{
+    COMPILE_ASSERT(sizeof(ThreadSpecificKey) <= sizeof(root->threadCacheKey), ThreadSpecificKey_fits_in_root);
+    return reinterpret_cast<ThreadSpecificKey*>(&root->threadCacheKey);
+}
+
 void partitionAllocInit(PartitionRoot* root, size_t numBuckets, size_t maxAllocation)
 {
     parititonAllocBaseInit(root);
@@ -157,6 +179,9 @@ void partitionAllocGenericInit(PartitionRootGeneric* root)
     parititonAllocBaseInit(root);
 
     root->lock = 0;
+    root->threadCacheEnabled = false;
+    root->threadCacheId = 0;
+    root->threadCaches = 0;
 
     // Precalculate some shift and mask constants used in the hot path.
     // Example: malloc(41) == 101001 binary.
@@ -288,6 +313,18 @@ bool partitionAllocShutdown(PartitionRoot* root)
 
 bool partitionAllocGenericShutdown(PartitionRootGeneric* root)
 {
+    // The caches of threads that are still running are flushed as well. The
+    // partition must not be used by any thread after shutdown.
+    if (root->threadCacheEnabled) {
+        partitionThreadCacheFlush(root);
+        spinLockLock(&root->lock);
+        while (root->threadCaches)
+            partitionThreadCacheDestroyLocked(root->threadCaches);
+        spinLockUnlock(&root->lock);
+        threadSpecificKeyDelete(*partitionThreadCacheKey(root));
+        root->threadCacheEnabled = false;
+    }
+
     bool noLeaks = true;
     size_t i;
     for (i = 0; i < kGenericNumBucketedOrders * kGenericNumBucketsPerOrder; ++i) {
@@ -921,62 +958,279 @@ void* partitionReallocGeneric(PartitionRootGeneric* root, void* ptr, size_t newS
 #endif
 }
 
-#ifndef NDEBUG
+// Must be called with the partition lock held.
+static void partitionThreadCacheFlushSlots(PartitionThreadCacheBucket* cacheBucket, size_t numSlots)
+{
+    ASSERT(numSlots <= cacheBucket->numSlots);
+    for (size_t i = 0; i < numSlots; ++i) {
+        PartitionFreelistEntry* entry = cacheBucket->freelistHead;
+        cacheBucket->freelistHead = partitionFreelistMask(entry->next);
+        --cacheBucket->numSlots;
+        PartitionPage* page = partitionPointerToPage(entry);
+#if ENABLE(ASSERT)
+        // Restore the cookies that are checked when the slot is freed.
+        partitionCookieWriteValue(entry);
+        partitionCookieWriteValue(reinterpret_cast<char*>(entry) + page->bucket->slotSize - kCookieSize);
+#endif
+        partitionFreeWithPage(entry, page);
+    }
+}
 
-void partitionDumpStats(const PartitionRoot& root)
+// Must be called with the partition lock held.
+static void partitionThreadCacheDestroyLocked(PartitionThreadCache* cache)
 {
-    size_t i;
-    size_t totalLive = 0;
-    size_t totalResident = 0;
-    size_t totalFreeable = 0;
-    for (i = 0; i < root.numBuckets; ++i) {
-        const PartitionBucket& bucket = root.buckets()[i];
-        if (bucket.activePagesHead == &PartitionRootGeneric::gSeedPage && !bucket.freePagesHead && !bucket.numFullPages) {
-            // Empty bucket with no freelist or full pages. Skip reporting it.
+    PartitionRootGeneric* root = cache->root;
+    for (size_t i = 0; i < kGenericNumThreadCachedBuckets; ++i)
+        partitionThreadCacheFlushSlots(&cache->buckets[i], cache->buckets[i].numSlots);
+    if (cache->prev)
+        cache->prev->next = cache->next;
+    else
+        root->threadCaches = cache->next;
+    if (cache->next)
+        cache->next->prev = cache->prev;
+    void* ptr = partitionCookieFreePointerAdjust(cache);
+    partitionFreeWithPage(ptr, partitionPointerToPage(ptr));
+}
+
+static void partitionThreadCacheDestroy(void* data)
+{
+    PartitionThreadCache* cache = static_cast<PartitionThreadCache*>(data);
+    PartitionRootGeneric* root = cache->root;
+#if PARTITION_LAST_THREAD_CACHE_IN_TLS
+    if (gPartitionLastThreadCache.cache == cache)
+        gPartitionLastThreadCache.cache = 0;
+#endif
+    spinLockLock(&root->lock);
+    partitionThreadCacheDestroyLocked(cache);
+    spinLockUnlock(&root->lock);
+}
+
+static void partitionThreadCacheSetLast(PartitionRootGeneric* root, PartitionThreadCache* cache)
+{
+#if PARTITION_LAST_THREAD_CACHE_IN_TLS
+    gPartitionLastThreadCache.threadCacheId = root->threadCacheId;
+    gPartitionLastThreadCache.cache = cache;
+#endif
+}
+
+static PartitionThreadCache* partitionThreadCacheCreate(PartitionRootGeneric* root)
+{
+    // The cache is allocated from the partition itself, bypassing the
+    // thread caches.
+    size_t size = partitionCookieSizeAdjustAdd(sizeof(PartitionThreadCache));
+    PartitionBucket* bucket = partitionGenericSizeToBucket(root, size);
+    spinLockLock(&root->lock);
+    PartitionThreadCache* cache = static_cast<PartitionThreadCache*>(partitionBucketAlloc(root, 0, size, bucket));
+    cache->root = root;
+    cache->prev = 0;
+    cache->next = root->threadCaches;
+    if (cache->next)
+        cache->next->prev = cache;
+    root->threadCaches = cache;
+    spinLockUnlock(&root->lock);
+
+    for (size_t i = 0; i < kGenericNumThreadCachedBuckets; ++i) {
+        PartitionThreadCacheBucket* cacheBucket = &cache->buckets[i];
+        size_t slotSize = root->buckets[i].slotSize;
+        cacheBucket->freelistHead = 0;
+        cacheBucket->numSlots = 0;
+        // Invalid buckets are never used.
+        if (slotSize % kGenericSmallestBucket)
+            cacheBucket->maxSlots = 0;
+        else
+            cacheBucket->maxSlots = std::max<size_t>(1, std::min(kGenericThreadCacheMaxSlotsPerBucket, kGenericThreadCacheMaxBytesPerBucket / slotSize));
+    }
+    threadSpecificSet(*partitionThreadCacheKey(root), cache);
+    partitionThreadCacheSetLast(root, cache);
+    return cache;
+}
+
+void partitionAllocGenericEnableThreadCache(PartitionRootGeneric* root)
+{
+    ASSERT(root->initialized);
+    ASSERT(!root->threadCacheEnabled);
+    ASSERT(root->buckets[kGenericNumThreadCachedBuckets - 1].slotSize == kGenericMaxThreadCachedSize);
+    threadSpecificKeyCreate(partitionThreadCacheKey(root), partitionThreadCacheDestroy);
+    root->threadCacheId = atomicIncrement(&gLastThreadCacheId);
+    root->threadCacheEnabled = true;
+}
+
+PartitionThreadCache* partitionThreadCacheLookup(PartitionRootGeneric* root)
+{
+    PartitionThreadCache* cache = static_cast<PartitionThreadCache*>(threadSpecificGet(*partitionThreadCacheKey(root)));
+    partitionThreadCacheSetLast(root, cache);
+    return cache;
+}
+
+void* partitionThreadCacheAllocSlowPath(PartitionRootGeneric* root, int flags, size_t size, PartitionBucket* bucket)
+{
+    PartitionThreadCache* cache = partitionThreadCacheGet(root);
+    if (!cache)
+        cache = partitionThreadCacheCreate(root);
+    PartitionThreadCacheBucket* cacheBucket = &cache->buckets[bucket - root->buckets];
+
+    // Refill half of the cache while the lock is held, but only with slots
+    // that are available without provisioning more of the partition.
+    spinLockLock(&root->lock);
+    void* ret = partitionBucketAlloc(root, flags, size, bucket);
+    for (size_t i = 0; ret && i < cacheBucket->maxSlots / 2 && bucket->activePagesHead->freelistHead; ++i) {
+        void* slot = partitionCookieFreePointerAdjust(partitionBucketAlloc(root, 0, size, bucket));
+        partitionThreadCacheBucketPush(cacheBucket, slot, partitionPointerToPage(slot));
+    }
+    spinLockUnlock(&root->lock);
+    return ret;
+}
+
+void partitionThreadCacheFreeSlowPath(PartitionThreadCache* cache, PartitionThreadCacheBucket* cacheBucket, void* ptr, PartitionPage* page)
+{
+    // The cache is full, return half of it to the partition.
+    ASSERT(cacheBucket->numSlots == cacheBucket->maxSlots);
+    PartitionRootGeneric* root = cache->root;
+    spinLockLock(&root->lock);
+    partitionThreadCacheFlushSlots(cacheBucket, cacheBucket->numSlots - cacheBucket->maxSlots / 2);
+    spinLockUnlock(&root->lock);
+
+    partitionThreadCacheBucketPush(cacheBucket, ptr, page);
+}
+
+void partitionThreadCacheFlush(PartitionRootGeneric* root)
+{
+    ASSERT(root->threadCacheEnabled);
+    PartitionThreadCache* cache = partitionThreadCacheGet(root);
+    if (!cache)
+        return;
+    threadSpecificSet(*partitionThreadCacheKey(root), 0);
+    partitionThreadCacheSetLast(root, 0);
+    partitionThreadCacheDestroy(cache);
+}
+
+// Returns false if the bucket has never had any pages.
+static bool partitionBucketGetStats(PartitionBucketMemoryStats* stats, const PartitionBucket* bucket)
+{
+    if (!bucket->activePagesHead) {
+        // Invalid generic bucket.
+        return false;
+    }
+    if (bucket->activePagesHead == &PartitionRootGeneric::gSeedPage && !bucket->freePagesHead && !bucket->numFullPages)
+        return false;
+
+    memset(stats, '\0', sizeof(PartitionBucketMemoryStats));
+    size_t bucketNumSlots = partitionBucketSlots(bucket);
+    size_t bucketUsefulStorage = bucket->slotSize * bucketNumSlots;
+    stats->bucketSlotSize = bucket->slotSize;
+    stats->allocatedPageSize = bucket->numSystemPagesPerSlotSpan * kSystemPageSize;
+    stats->numFullPages = bucket->numFullPages;
+    stats->activeBytes = bucket->numFullPages * bucketUsefulStorage;
+    stats->residentBytes = bucket->numFullPages * stats->allocatedPageSize;
+
+    for (const PartitionPage* page = bucket->freePagesHead; page; page = page->nextPage)
+        ++stats->numDecommittedPages;
+
+    for (const PartitionPage* page = bucket->activePagesHead; page; page = page->nextPage) {
+        if (page == &PartitionRootGeneric::gSeedPage)
+            continue;
+        // A page may be on the active list but freed and not yet swept.
+        if (!page->freelistHead && !page->numUnprovisionedSlots && !page->numAllocatedSlots) {
+            ++stats->numDecommittedPages;
             continue;
         }
-        size_t numFreePages = 0;
-        PartitionPage* freePages = bucket.freePagesHead;
-        while (freePages) {
-            ++numFreePages;
-            freePages = freePages->nextPage;
-        }
-        size_t bucketSlotSize = bucket.slotSize;
-        size_t bucketNumSlots = partitionBucketSlots(&bucket);
-        size_t bucketUsefulStorage = bucketSlotSize * bucketNumSlots;
-        size_t bucketPageSize = bucket.numSystemPagesPerSlotSpan * kSystemPageSize;
-        size_t bucketWaste = bucketPageSize - bucketUsefulStorage;
-        size_t numActiveBytes = bucket.numFullPages * bucketUsefulStorage;
-        size_t numResidentBytes = bucket.numFullPages * bucketPageSize;
-        size_t numFreeableBytes = 0;
-        size_t numActivePages = 0;
-        const PartitionPage* page = bucket.activePagesHead;
-        while (page) {
-            ASSERT(page != &PartitionRootGeneric::gSeedPage);
-            // A page may be on the active list but freed and not yet swept.
-            if (!page->freelistHead && !page->numUnprovisionedSlots && !page->numAllocatedSlots) {
-                ++numFreePages;
-            } else {
-                ++numActivePages;
-                numActiveBytes += (page->numAllocatedSlots * bucketSlotSize);
-                size_t pageBytesResident = (bucketNumSlots - page->numUnprovisionedSlots) * bucketSlotSize;
-                // Round up to system page size.
-                pageBytesResident = (pageBytesResident + kSystemPageOffsetMask) & kSystemPageBaseMask;
-                numResidentBytes += pageBytesResident;
-                if (!page->numAllocatedSlots)
-                    numFreeableBytes += pageBytesResident;
-            }
-            page = page->nextPage;
+        // The active list may also briefly contain full pages.
+        size_t numAllocatedSlots = page->numAllocatedSlots < 0 ? -page->numAllocatedSlots : page->numAllocatedSlots;
+        size_t pageBytesResident = (bucketNumSlots - page->numUnprovisionedSlots) * bucket->slotSize;
+        // Round up to system page size.
+        pageBytesResident = (pageBytesResident + kSystemPageOffsetMask) & kSystemPageBaseMask;
+        stats->activeBytes += numAllocatedSlots * bucket->slotSize;
+        stats->residentBytes += pageBytesResident;
+        if (!numAllocatedSlots) {
+            ++stats->numEmptyPages;
+            stats->decommittableBytes += pageBytesResident;
+        } else if (numAllocatedSlots == bucketNumSlots) {
+            ++stats->numFullPages;
+        } else {
+            ++stats->numActivePages;
         }
-        totalLive += numActiveBytes;
-        totalResident += numResidentBytes;
-        totalFreeable += numFreeableBytes;
-        printf("bucket size %zu (pageSize %zu waste %zu): %zu alloc/%zu commit/%zu freeable bytes, %zu/%zu/%zu full/active/free pages\n", bucketSlotSize, bucketPageSize, bucketWaste, numActiveBytes, numResidentBytes, numFreeableBytes, static_cast<size_t>(bucket.numFullPages), numActivePages, numFreePages);
-    }
-    printf("total live: %zu bytes\n", totalLive);
-    printf("total resident: %zu bytes\n", totalResident);
-    printf("total freeable: %zu bytes\n", totalFreeable);
-    fflush(stdout);
+    }
+    return true;
+}
+
+static void partitionGetTotals(PartitionMemoryStats* totals, const PartitionRootBase* root)
+{
+    memset(totals, '\0', sizeof(PartitionMemoryStats));
+    totals->totalMmappedBytes = root->totalSizeOfSuperPages;
+    totals->totalCommittedBytes = root->totalSizeOfCommittedPages;
+    for (const PartitionSuperPageExtentEntry* extent = root->firstExtent; extent; extent = extent->next)
+        totals->numSuperPages += (extent->superPagesEnd - extent->superPageBase) >> kSuperPageShift;
+}
+
+static void partitionAddToTotals(PartitionMemoryStats* totals, const PartitionBucketMemoryStats& stats)
+{
+    totals->totalResidentBytes += stats.residentBytes;
+    totals->totalActiveBytes += stats.activeBytes;
+    totals->totalDecommittableBytes += stats.decommittableBytes;
+}
+
+void partitionDumpStats(PartitionRoot* root, const char* partitionName, PartitionStatsDumper* dumper)
+{
+    PartitionMemoryStats totals;
+    partitionGetTotals(&totals, root);
+    for (size_t i = 0; i < root->numBuckets; ++i) {
+        PartitionBucketMemoryStats stats;
+        if (!partitionBucketGetStats(&stats, &root->buckets()[i]))
+            continue;
+        partitionAddToTotals(&totals, stats);
+        dumper->partitionDumpBucketStats(partitionName, stats);
+    }
+    dumper->partitionDumpTotals(partitionName, totals);
+}
+
+void partitionDumpStatsGeneric(PartitionRootGeneric* root, const char* partitionName, PartitionStatsDumper* dumper)
+{
+    static const size_t kGenericNumBuckets = kGenericNumBucketedOrders * kGenericNumBucketsPerOrder;
+    PartitionBucketMemoryStats bucketStats[kGenericNumBuckets];
+    bool bucketHasStats[kGenericNumBuckets];
+    PartitionMemoryStats totals;
+
+    // The dumper is called without the lock held because it may well allocate
+    // from this partition.
+    spinLockLock(&root->lock);
+    partitionGetTotals(&totals, root);
+    for (size_t i = 0; i < kGenericNumBuckets; ++i) {
+        bucketHasStats[i] = partitionBucketGetStats(&bucketStats[i], &root->buckets[i]);
+        if (bucketHasStats[i])
+            partitionAddToTotals(&totals, bucketStats[i]);
+    }
+    spinLockUnlock(&root->lock);
+
+    for (size_t i = 0; i < kGenericNumBuckets; ++i) {
+        if (bucketHasStats[i])
+            dumper->partitionDumpBucketStats(partitionName, bucketStats[i]);
+    }
+    dumper->partitionDumpTotals(partitionName, totals);
+}
+
+#ifndef NDEBUG
+
+class PartitionStatsPrinter FINAL : public PartitionStatsDumper {
+public:
+    virtual void partitionDumpBucketStats(const char*, const PartitionBucketMemoryStats& stats) OVERRIDE
+    {
+        size_t bucketWaste = stats.allocatedPageSize - (stats.allocatedPageSize / stats.bucketSlotSize) * stats.bucketSlotSize;
+        printf("bucket size %zu (pageSize %zu waste %zu): %zu alloc/%zu commit/%zu freeable bytes, %zu/%zu/%zu/%zu full/active/empty/free pages\n", stats.bucketSlotSize, stats.allocatedPageSize, bucketWaste, stats.activeBytes, stats.residentBytes, stats.decommittableBytes, stats.numFullPages, stats.numActivePages, stats.numEmptyPages, stats.numDecommittedPages);
+    }
+
+    virtual void partitionDumpTotals(const char*, const PartitionMemoryStats& totals) OVERRIDE
+    {
+        printf("total live: %zu bytes\n", totals.totalActiveBytes);
+        printf("total resident: %zu bytes\n", totals.totalResidentBytes);
+        printf("total freeable: %zu bytes\n", totals.totalDecommittableBytes);
+        fflush(stdout);
+    }
+};
+
+void partitionDumpStats(const PartitionRoot& root)
+{
+    PartitionStatsPrinter printer;
+    partitionDumpStats(const_cast<PartitionRoot*>(&root), "", &printer);
 }
 
 #endif // !NDEBUG
@@ -57,6 +57,8 @@
 //
 // And for partitionAllocGeneric():
 // - Multi-threaded use against a single partition is ok; locking is handled.
+// - Partitions with a thread cache enabled serve small allocations and frees
+// from a per-thread cache of free slots without taking the lock.
 // - Allocations of any arbitrary size can be handled (subject to a limit of
 // INT_MAX bytes for security reasons).
 // - Bucketing is by approximate size, for example an allocation of 4000 bytes
@@ -185,6 +187,16 @@ static const size_t kGenericMaxBucketSpacing = 1 << ((kGenericMaxBucketedOrder -
 static const size_t kGenericMaxBucketed = (1 << (kGenericMaxBucketedOrder - 1)) + ((kGenericNumBucketsPerOrder - 1) * kGenericMaxBucketSpacing);
 static const size_t kGenericMinDirectMappedDownsize = kGenericMaxBucketed + 1; // Limit when downsizing a direct mapping using realloc().
 static const size_t kGenericMaxDirectMapped = INT_MAX - kSystemPageSize;
+
+// The following constants apply to the per-thread caches of generic
+// partitions. Slots of the buckets of the first seven orders, i.e., of up to
+// 960 bytes, are cached. Each thread caches at most
+// kGenericThreadCacheMaxSlotsPerBucket slots and at most
+// kGenericThreadCacheMaxBytesPerBucket bytes of each bucket.
+static const size_t kGenericNumThreadCachedBuckets = 7 * kGenericNumBucketsPerOrder;
+static const size_t kGenericMaxThreadCachedSize = 960;
+static const size_t kGenericThreadCacheMaxSlotsPerBucket = 32;
+static const size_t kGenericThreadCacheMaxBytesPerBucket = 4096;
 static const size_t kBitsPerSizet = sizeof(void*) * CHAR_BIT;
 
 // Constants for the memory reclaim logic.
@@ -200,6 +212,7 @@ static const size_t kCookieSize = 16; // Handles alignment up to XMM instruction
 
 struct PartitionBucket;
 struct PartitionRootBase;
+struct PartitionRootGeneric;
 
 struct PartitionFreelistEntry {
     PartitionFreelistEntry* next;
@@ -243,6 +256,30 @@ struct PartitionBucket {
     uint16_t numFullPages;
 };
 
+// A thread's cache of free slots of one bucket. The slots remain allocated
+// from the point of view of their partition page until they are flushed.
+struct PartitionThreadCacheBucket {
+    PartitionFreelistEntry* freelistHead;
+    uint32_t numSlots;
+    uint32_t maxSlots;
+};
+
+struct PartitionThreadCache {
+    PartitionRootGeneric* root;
+    // The caches of all threads of the root, for flushing them on shutdown.
+    PartitionThreadCache* next;
+    PartitionThreadCache* prev;
+    PartitionThreadCacheBucket buckets[kGenericNumThreadCachedBuckets];
+};
+
+// The last thread cache the calling thread used, and the threadCacheId of
+// its partition. Ids are never reused, so the cache of a partition that was
+// shut down is never handed out.
+struct PartitionLastThreadCache {
+    unsigned threadCacheId;
+    PartitionThreadCache* cache;
+};
+
 // An "extent" is a span of consecutive superpages. We link to the partition's
 // next extent (if there is one) at the very start of a superpage's metadata
 // area.
@@ -284,6 +321,12 @@ struct PartitionRoot : public PartitionRootBase {
 // Never instantiate a PartitionRootGeneric directly, instead use PartitionAllocatorGeneric.
 struct PartitionRootGeneric : public PartitionRootBase {
     int lock;
+    bool threadCacheEnabled;
+    unsigned threadCacheId;
+    // Storage for the ThreadSpecificKey of the per-thread caches.
+    intptr_t threadCacheKey;
+    // Guarded by lock.
+    PartitionThreadCache* threadCaches;
     // Some pre-computed constants.
     size_t orderIndexShifts[kBitsPerSizet + 1];
     size_t orderSubIndexMasks[kBitsPerSizet + 1];
@@ -300,14 +343,56 @@ enum PartitionAllocFlags {
     PartitionAllocReturnNull = 1 << 0,
 };
 
+// Memory statistics of a whole partition, reported by partitionDumpStats().
+// Direct mapped allocations are not included.
+struct PartitionMemoryStats {
+    size_t totalMmappedBytes; // Total bytes of reserved super pages.
+    size_t totalCommittedBytes; // Total bytes of committed system pages.
+    size_t totalResidentBytes; // Total bytes of provisioned slots.
+    size_t totalActiveBytes; // Total bytes of allocated slots.
+    size_t totalDecommittableBytes; // Total bytes of empty pages that may be decommitted.
+    size_t numSuperPages;
+};
+
+// Memory statistics of one bucket, reported by partitionDumpStats(). Slots
+// held in per-thread caches count as active.
+struct PartitionBucketMemoryStats {
+    size_t bucketSlotSize;
+    size_t allocatedPageSize; // Bytes of system pages per slot span.
+    size_t activeBytes; // Bytes of allocated slots.
+    size_t residentBytes; // Bytes of provisioned slots, rounded up to system pages.
+    size_t decommittableBytes; // Resident bytes of empty pages, e.g. the ones in the empty page ring.
+    size_t numFullPages;
+    size_t numActivePages;
+    size_t numEmptyPages; // Empty pages that are still committed.
+    size_t numDecommittedPages;
+};
+
+// Receives the statistics of a partition. Bucket statistics are reported for
+// every bucket that has pages, followed by the totals of the partition.
+class WTF_EXPORT PartitionStatsDumper {
+public:
+    virtual ~PartitionStatsDumper() { }
+    virtual void partitionDumpBucketStats(const char* partitionName, const PartitionBucketMemoryStats&) = 0;
+    virtual void partitionDumpTotals(const char* partitionName, const PartitionMemoryStats&) = 0;
+};
+
 WTF_EXPORT void partitionAllocInit(PartitionRoot*, size_t numBuckets, size_t maxAllocation);
 WTF_EXPORT bool partitionAllocShutdown(PartitionRoot*);
 WTF_EXPORT void partitionAllocGenericInit(PartitionRootGeneric*);
 WTF_EXPORT bool partitionAllocGenericShutdown(PartitionRootGeneric*);
+WTF_EXPORT void partitionAllocGenericEnableThreadCache(PartitionRootGeneric*);
 
 WTF_EXPORT NEVER_INLINE void* partitionAllocSlowPath(PartitionRootBase*, int, size_t, PartitionBucket*);
 WTF_EXPORT NEVER_INLINE void partitionFreeSlowPath(PartitionPage*);
 WTF_EXPORT NEVER_INLINE void* partitionReallocGeneric(PartitionRootGeneric*, void*, size_t);
+WTF_EXPORT NEVER_INLINE PartitionThreadCache* partitionThreadCacheLookup(PartitionRootGeneric*);
+WTF_EXPORT NEVER_INLINE void* partitionThreadCacheAllocSlowPath(PartitionRootGeneric*, int, size_t, PartitionBucket*);
+WTF_EXPORT NEVER_INLINE void partitionThreadCacheFreeSlowPath(PartitionThreadCache*, PartitionThreadCacheBucket*, void*, PartitionPage*);
+WTF_EXPORT void partitionThreadCacheFlush(PartitionRootGeneric*);
+
+WTF_EXPORT void partitionDumpStats(PartitionRoot*, const char* partitionName, PartitionStatsDumper*);
+WTF_EXPORT void partitionDumpStatsGeneric(PartitionRootGeneric*, const char* partitionName, PartitionStatsDumper*);
 
 #ifndef NDEBUG
 WTF_EXPORT void partitionDumpStats(const PartitionRoot&);
@@ -378,6 +463,28 @@ ALWAYS_INLINE void partitionCookieCheckValue(void* ptr)
 #endif
 }
 
+ALWAYS_INLINE void* partitionSlotPrepareForAlloc(void* slot, size_t slotSize)
+{
+#if ENABLE(ASSERT)
+    // Fill the uninitialized pattern. and write the cookies.
+    memset(slot, kUninitializedByte, slotSize);
+    partitionCookieWriteValue(slot);
+    partitionCookieWriteValue(reinterpret_cast<char*>(slot) + slotSize - kCookieSize);
+    // The value given to the application is actually just after the cookie.
+    slot = static_cast<char*>(slot) + kCookieSize;
+#endif
+    return slot;
+}
+
+ALWAYS_INLINE void partitionSlotPrepareForFree(void* slot, size_t slotSize)
+{
+#if ENABLE(ASSERT)
+    partitionCookieCheckValue(slot);
+    partitionCookieCheckValue(reinterpret_cast<char*>(slot) + slotSize - kCookieSize);
+    memset(slot, kFreedByte, slotSize);
+#endif
+}
+
 ALWAYS_INLINE char* partitionSuperPageToMetadataArea(char* ptr)
 {
     uintptr_t pointerAsUint = reinterpret_cast<uintptr_t>(ptr);
@@ -456,14 +563,8 @@ ALWAYS_INLINE void* partitionBucketAlloc(PartitionRootBase* root, int flags, siz
 #if ENABLE(ASSERT)
     if (!ret)
         return 0;
-    // Fill the uninitialized pattern. and write the cookies.
     page = partitionPointerToPage(ret);
-    size_t bucketSize = page->bucket->slotSize;
-    memset(ret, kUninitializedByte, bucketSize);
-    partitionCookieWriteValue(ret);
-    partitionCookieWriteValue(reinterpret_cast<char*>(ret) + bucketSize - kCookieSize);
-    // The value given to the application is actually just after the cookie.
-    ret = static_cast<char*>(ret) + kCookieSize;
+    ret = partitionSlotPrepareForAlloc(ret, page->bucket->slotSize);
 #endif
     return ret;
 }
@@ -488,12 +589,7 @@ ALWAYS_INLINE void* partitionAlloc(PartitionRoot* root, size_t size)
 ALWAYS_INLINE void partitionFreeWithPage(void* ptr, PartitionPage* page)
 {
     // If these asserts fire, you probably corrupted memory.
-#if ENABLE(ASSERT)
-    size_t bucketSize = page->bucket->slotSize;
-    partitionCookieCheckValue(ptr);
-    partitionCookieCheckValue(reinterpret_cast<char*>(ptr) + bucketSize - kCookieSize);
-    memset(ptr, kFreedByte, bucketSize);
-#endif
+    partitionSlotPrepareForFree(ptr, page->bucket->slotSize);
     ASSERT(page->numAllocatedSlots);
     PartitionFreelistEntry* freelistHead = page->freelistHead;
     ASSERT(!freelistHead || partitionPointerIsValid(freelistHead));
@@ -519,6 +615,45 @@ ALWAYS_INLINE void partitionFree(void* ptr)
 #endif
 }
 
+// The thread caches are looked up on every allocation and free of a cached
+// size, so the last one used is kept in a thread-local variable. Windows
+// can not export thread-local variables from a DLL, so component builds
+// there look the cache up through the ThreadSpecificKey of the partition.
+#if !OS(WIN) || !defined(COMPONENT_BUILD)
+#define PARTITION_LAST_THREAD_CACHE_IN_TLS 1
+#if COMPILER(MSVC)
+extern __declspec(thread) PartitionLastThreadCache gPartitionLastThreadCache;
+#else
+extern WTF_EXPORT __thread PartitionLastThreadCache gPartitionLastThreadCache;
+#endif
+#endif
+
+ALWAYS_INLINE PartitionThreadCache* partitionThreadCacheGet(PartitionRootGeneric* root)
+{
+#if PARTITION_LAST_THREAD_CACHE_IN_TLS
+    if (LIKELY(gPartitionLastThreadCache.threadCacheId == root->threadCacheId))
+        return gPartitionLastThreadCache.cache;
+#endif
+    return partitionThreadCacheLookup(root);
+}
+
+ALWAYS_INLINE void partitionThreadCacheBucketPush(PartitionThreadCacheBucket* cacheBucket, void* ptr, PartitionPage* page)
+{
+    // If these asserts fire, you probably corrupted memory. The slot stays
+    // allocated as far as its page is concerned, so only frees into the same
+    // cache bucket are caught here.
+    partitionSlotPrepareForFree(ptr, page->bucket->slotSize);
+    ASSERT(page->numAllocatedSlots);
+    PartitionFreelistEntry* freelistHead = cacheBucket->freelistHead;
+    ASSERT(!freelistHead || partitionPointerIsValid(freelistHead));
+    RELEASE_ASSERT(ptr != freelistHead); // Catches an immediate double free.
+    ASSERT(!freelistHead || ptr != partitionFreelistMask(freelistHead->next)); // Look for double free one level deeper in debug.
+    PartitionFreelistEntry* entry = static_cast<PartitionFreelistEntry*>(ptr);
+    entry->next = partitionFreelistMask(freelistHead);
+    cacheBucket->freelistHead = entry;
+    ++cacheBucket->numSlots;
+}
+
 ALWAYS_INLINE PartitionBucket* partitionGenericSizeToBucket(PartitionRootGeneric* root, size_t size)
 {
     size_t order = kBitsPerSizet - countLeadingZerosSizet(size);
@@ -542,6 +677,19 @@ ALWAYS_INLINE void* partitionAllocGenericFlags(PartitionRootGeneric* root, int f
     ASSERT(root->initialized);
     size = partitionCookieSizeAdjustAdd(size);
     PartitionBucket* bucket = partitionGenericSizeToBucket(root, size);
+    if (LIKELY(size <= kGenericMaxThreadCachedSize) && root->threadCacheEnabled) {
+        PartitionThreadCache* cache = partitionThreadCacheGet(root);
+        if (LIKELY(cache != 0)) {
+            PartitionThreadCacheBucket* cacheBucket = &cache->buckets[bucket - root->buckets];
+            void* ret = cacheBucket->freelistHead;
+            if (LIKELY(ret != 0)) {
+                cacheBucket->freelistHead = partitionFreelistMask(static_cast<PartitionFreelistEntry*>(ret)->next);
+                --cacheBucket->numSlots;
+                return partitionSlotPrepareForAlloc(ret, bucket->slotSize);
+            }
+        }
+        return partitionThreadCacheAllocSlowPath(root, flags, size, bucket);
+    }
     spinLockLock(&root->lock);
     void* ret = partitionBucketAlloc(root, flags, size, bucket);
     spinLockUnlock(&root->lock);
@@ -567,6 +715,19 @@ ALWAYS_INLINE void partitionFreeGeneric(PartitionRootGeneric* root, void* ptr)
     ptr = partitionCookieFreePointerAdjust(ptr);
     ASSERT(partitionPointerIsValid(ptr));
     PartitionPage* page = partitionPointerToPage(ptr);
+    if (LIKELY(page->bucket->slotSize <= kGenericMaxThreadCachedSize) && root->threadCacheEnabled) {
+        // Frees do not create a cache, so that frees during thread exit
+        // do not leak one.
+        PartitionThreadCache* cache = partitionThreadCacheGet(root);
+        if (LIKELY(cache != 0)) {
+            PartitionThreadCacheBucket* cacheBucket = &cache->buckets[page->bucket - root->buckets];
+            if (LIKELY(cacheBucket->numSlots < cacheBucket->maxSlots))
+                partitionThreadCacheBucketPush(cacheBucket, ptr, page);
+            else
+                partitionThreadCacheFreeSlowPath(cache, cacheBucket, ptr, page);
+            return;
+        }
+    }
     spinLockLock(&root->lock);
     partitionFreeWithPage(ptr, page);
     spinLockUnlock(&root->lock);
@@ -647,6 +808,7 @@ private:
 class PartitionAllocatorGeneric {
 public:
     void init() { partitionAllocGenericInit(&m_partitionRoot); }
+    void enableThreadCache() { partitionAllocGenericEnableThreadCache(&m_partitionRoot); }
     bool shutdown() { return partitionAllocGenericShutdown(&m_partitionRoot); }
     ALWAYS_INLINE PartitionRootGeneric* root() { return &m_partitionRoot; }
 private:
@@ -34,12 +34,17 @@
 #include "wtf/BitwiseOperations.h"
 #include "wtf/OwnPtr.h"
 #include "wtf/PassOwnPtr.h"
+#include "wtf/SpinLock.h"
+#include "wtf/StdLibExtras.h"
+#include "wtf/Vector.h"
 #include <gtest/gtest.h>
 #include <stdlib.h>
 #include <string.h>
 
 #if OS(POSIX)
+#include <sched.h>
 #include <sys/mman.h>
+#include <sys/time.h>
 
 #ifndef MAP_ANONYMOUS
 #define MAP_ANONYMOUS MAP_ANON
@@ -53,6 +58,7 @@ namespace {
 static const size_t kTestMaxAllocation = 4096;
 static SizeSpecificPartitionAllocator<kTestMaxAllocation> allocator;
 static PartitionAllocatorGeneric genericAllocator;
+static PartitionAllocatorGeneric threadCachedAllocator;
 
 static const size_t kTestAllocSize = 16;
 #if !ENABLE(ASSERT)
@@ -1097,6 +1103,337 @@ TEST(PartitionAllocTest, LostFreePagesBug)
     TestShutdown();
 }
 
+class MockPartitionStatsDumper : public WTF::PartitionStatsDumper {
+public:
+    MockPartitionStatsDumper()
+        : m_dumpedTotals(false)
+    {
+        memset(&m_totals, 0, sizeof(m_totals));
+    }
+
+    virtual void partitionDumpBucketStats(const char* partitionName, const WTF::PartitionBucketMemoryStats& stats) OVERRIDE
+    {
+        EXPECT_STREQ("mock", partitionName);
+        EXPECT_FALSE(m_dumpedTotals);
+        m_bucketStats.append(stats);
+    }
+
+    virtual void partitionDumpTotals(const char* partitionName, const WTF::PartitionMemoryStats& totals) OVERRIDE
+    {
+        EXPECT_STREQ("mock", partitionName);
+        EXPECT_FALSE(m_dumpedTotals);
+        m_dumpedTotals = true;
+        m_totals = totals;
+    }
+
+    bool dumpedTotals() const { return m_dumpedTotals; }
+    const WTF::PartitionMemoryStats& totals() const { return m_totals; }
+    size_t numBuckets() const { return m_bucketStats.size(); }
+
+    const WTF::PartitionBucketMemoryStats* bucketStats(size_t slotSize) const
+    {
+        for (size_t i = 0; i < m_bucketStats.size(); ++i) {
+            if (m_bucketStats[i].bucketSlotSize == slotSize)
+                return &m_bucketStats[i];
+        }
+        return 0;
+    }
+
+private:
+    bool m_dumpedTotals;
+    WTF::PartitionMemoryStats m_totals;
+    Vector<WTF::PartitionBucketMemoryStats> m_bucketStats;
+};
+
+// Tests the statistics reported for the pages of a bucket as they go through
+// the active, empty and decommitted states.
+TEST(PartitionAllocTest, DumpMemoryStats)
+{
+    TestSetup();
+
+    {
+        MockPartitionStatsDumper dumper;
+        partitionDumpStatsGeneric(genericAllocator.root(), "mock", &dumper);
+        EXPECT_TRUE(dumper.dumpedTotals());
+        EXPECT_EQ(0u, dumper.numBuckets());
+        EXPECT_EQ(0u, dumper.totals().totalMmappedBytes);
+        EXPECT_EQ(0u, dumper.totals().numSuperPages);
+    }
+
+    void* ptr = partitionAllocGeneric(genericAllocator.root(), kTestAllocSize);
+    WTF::PartitionPage* genericPage = WTF::partitionPointerToPage(WTF::partitionCookieFreePointerAdjust(ptr));
+    size_t slotSize = genericPage->bucket->slotSize;
+    size_t numSlots = (genericPage->bucket->numSystemPagesPerSlotSpan * WTF::kSystemPageSize) / slotSize;
+    // The first allocation provisions slots in whole system pages.
+    size_t residentBytes = (numSlots - genericPage->numUnprovisionedSlots) * slotSize;
+    residentBytes = (residentBytes + WTF::kSystemPageOffsetMask) & WTF::kSystemPageBaseMask;
+    {
+        MockPartitionStatsDumper dumper;
+        partitionDumpStatsGeneric(genericAllocator.root(), "mock", &dumper);
+        EXPECT_EQ(1u, dumper.numBuckets());
+        const WTF::PartitionBucketMemoryStats* stats = dumper.bucketStats(slotSize);
+        ASSERT_TRUE(stats);
+        EXPECT_EQ(slotSize, stats->activeBytes);
+        EXPECT_EQ(residentBytes, stats->residentBytes);
+        EXPECT_EQ(0u, stats->decommittableBytes);
+        EXPECT_EQ(0u, stats->numFullPages);
+        EXPECT_EQ(1u, stats->numActivePages);
+        EXPECT_EQ(0u, stats->numEmptyPages);
+        EXPECT_EQ(0u, stats->numDecommittedPages);
+        EXPECT_EQ(1u, dumper.totals().numSuperPages);
+        EXPECT_EQ(WTF::kSuperPageSize, dumper.totals().totalMmappedBytes);
+        EXPECT_EQ(genericAllocator.root()->totalSizeOfCommittedPages, dumper.totals().totalCommittedBytes);
+        EXPECT_EQ(slotSize, dumper.totals().totalActiveBytes);
+        EXPECT_EQ(residentBytes, dumper.totals().totalResidentBytes);
+    }
+
+    // An empty page sits in the empty page ring and can be decommitted.
+    partitionFreeGeneric(genericAllocator.root(), ptr);
+    {
+        MockPartitionStatsDumper dumper;
+        partitionDumpStatsGeneric(genericAllocator.root(), "mock", &dumper);
+        const WTF::PartitionBucketMemoryStats* stats = dumper.bucketStats(slotSize);
+        ASSERT_TRUE(stats);
+        EXPECT_EQ(0u, stats->activeBytes);
+        EXPECT_EQ(residentBytes, stats->residentBytes);
+        EXPECT_EQ(residentBytes, stats->decommittableBytes);
+        EXPECT_EQ(0u, stats->numActivePages);
+        EXPECT_EQ(1u, stats->numEmptyPages);
+        EXPECT_EQ(residentBytes, dumper.totals().totalDecommittableBytes);
+    }
+
+    // Pushing the page out of the ring decommits it.
+    CycleGenericFreeCache(kTestAllocSize * 64);
+    {
+        MockPartitionStatsDumper dumper;
+        partitionDumpStatsGeneric(genericAllocator.root(), "mock", &dumper);
+        EXPECT_EQ(2u, dumper.numBuckets());
+        const WTF::PartitionBucketMemoryStats* stats = dumper.bucketStats(slotSize);
+        ASSERT_TRUE(stats);
+        EXPECT_EQ(0u, stats->residentBytes);
+        EXPECT_EQ(0u, stats->decommittableBytes);
+        EXPECT_EQ(0u, stats->numEmptyPages);
+        EXPECT_EQ(1u, stats->numDecommittedPages);
+    }
+
+    // Full pages are reported by the size specific partitions too.
+    WTF::PartitionPage* page = GetFullPage(kTestAllocSize);
+    {
+        MockPartitionStatsDumper dumper;
+        partitionDumpStats(allocator.root(), "mock", &dumper);
+        EXPECT_EQ(1u, dumper.numBuckets());
+        const WTF::PartitionBucketMemoryStats* stats = dumper.bucketStats(kRealAllocSize);
+        ASSERT_TRUE(stats);
+        numSlots = stats->allocatedPageSize / kRealAllocSize;
+        EXPECT_EQ(numSlots * kRealAllocSize, stats->activeBytes);
+        EXPECT_EQ(stats->allocatedPageSize, stats->residentBytes);
+        EXPECT_EQ(1u, stats->numFullPages);
+        EXPECT_EQ(0u, stats->numActivePages);
+        EXPECT_EQ(numSlots * kRealAllocSize, dumper.totals().totalActiveBytes);
+    }
+    FreeFullPage(page);
+
+    TestShutdown();
+}
+
+// Test the basic operation of the per-thread caches of a generic partition.
+TEST(PartitionAllocTest, GenericThreadCache)
+{
+    threadCachedAllocator.init();
+    threadCachedAllocator.enableThreadCache();
+    WTF::PartitionRootGeneric* root = threadCachedAllocator.root();
+
+    void* ptr = partitionAllocGeneric(root, kTestAllocSize);
+    EXPECT_TRUE(ptr);
+    WTF::PartitionThreadCache* cache = WTF::partitionThreadCacheGet(root);
+    ASSERT_TRUE(cache);
+    WTF::PartitionPage* page = WTF::partitionPointerToPage(WTF::partitionCookieFreePointerAdjust(ptr));
+    WTF::PartitionThreadCacheBucket* cacheBucket = &cache->buckets[page->bucket - root->buckets];
+    EXPECT_LE(cacheBucket->maxSlots, WTF::kGenericThreadCacheMaxSlotsPerBucket);
+
+    // The allocation filled half of the cache. The cached slots remain
+    // allocated as far as the page is concerned.
+    EXPECT_EQ(cacheBucket->maxSlots / 2, cacheBucket->numSlots);
+    EXPECT_EQ(static_cast<int>(cacheBucket->numSlots + 1), page->numAllocatedSlots);
+
+    // A freed slot is cached and handed out again.
+    partitionFreeGeneric(root, ptr);
+    EXPECT_EQ(cacheBucket->maxSlots / 2 + 1, cacheBucket->numSlots);
+    EXPECT_EQ(ptr, partitionAllocGeneric(root, kTestAllocSize));
+    partitionFreeGeneric(root, ptr);
+
+    // Freeing into a full cache returns half of the cached slots.
+    void* ptrs[WTF::kGenericThreadCacheMaxSlotsPerBucket * 2];
+    for (size_t i = 0; i < WTF::kGenericThreadCacheMaxSlotsPerBucket * 2; ++i)
+        ptrs[i] = partitionAllocGeneric(root, kTestAllocSize);
+    for (size_t i = 0; i < WTF::kGenericThreadCacheMaxSlotsPerBucket * 2; ++i) {
+        partitionFreeGeneric(root, ptrs[i]);
+        EXPECT_LE(cacheBucket->numSlots, cacheBucket->maxSlots);
+    }
+    EXPECT_EQ(static_cast<int>(cacheBucket->numSlots), page->numAllocatedSlots);
+
+    // Allocations that are too large for the cache bypass it.
+    size_t size = WTF::kGenericMaxThreadCachedSize + 1 - kExtraAllocSize;
+    ptr = partitionAllocGeneric(root, size);
+    WTF::PartitionPage* largePage = WTF::partitionPointerToPage(WTF::partitionCookieFreePointerAdjust(ptr));
+    EXPECT_EQ(1, largePage->numAllocatedSlots);
+    partitionFreeGeneric(root, ptr);
+    EXPECT_EQ(0, largePage->numAllocatedSlots);
+
+    // Flushing returns all cached slots to the partition.
+    WTF::partitionThreadCacheFlush(root);
+    EXPECT_FALSE(WTF::partitionThreadCacheGet(root));
+    EXPECT_EQ(0, page->numAllocatedSlots);
+
+    // Frees do not create a cache.
+    ptr = partitionAllocGeneric(root, kTestAllocSize);
+    WTF::partitionThreadCacheFlush(root);
+    partitionFreeGeneric(root, ptr);
+    EXPECT_FALSE(WTF::partitionThreadCacheGet(root));
+
+    EXPECT_TRUE(threadCachedAllocator.shutdown());
+}
+
+#if USE(PTHREADS)
+
+struct ThreadCacheTestState {
+    WTF::PartitionRootGeneric* root;
+    size_t iterations;
+    int handoffLock;
+    void* handoff;
+};
+
+struct ThreadCacheTestThread {
+    ThreadCacheTestState* state;
+    unsigned char id;
+    pthread_t handle;
+};
+
+static void* threadCacheTestThreadMain(void* data)
+{
+    ThreadCacheTestThread* thread = static_cast<ThreadCacheTestThread*>(data);
+    ThreadCacheTestState* state = thread->state;
+    static const size_t kNumLiveAllocations = 64;
+    void* allocations[kNumLiveAllocations] = { 0 };
+    size_t sizes[kNumLiveAllocations] = { 0 };
+    for (size_t i = 0; i < state->iterations; ++i) {
+        size_t index = i % kNumLiveAllocations;
+        if (allocations[index]) {
+            // The allocation must not have been handed to another thread.
+            unsigned char* bytes = static_cast<unsigned char*>(allocations[index]);
+            EXPECT_EQ(thread->id, bytes[0]);
+            EXPECT_EQ(thread->id, bytes[sizes[index] - 1]);
+            partitionFreeGeneric(state->root, allocations[index]);
+        }
+        // Mostly sizes that are cached, with the occasional larger one.
+        size_t size = (i * 37) % (WTF::kGenericMaxThreadCachedSize + 128) + 1;
+        allocations[index] = partitionAllocGeneric(state->root, size);
+        sizes[index] = size;
+        memset(allocations[index], thread->id, size);
+
+        // Regularly free an allocation made by another thread.
+        if (!(i % 16)) {
+            spinLockLock(&state->handoffLock);
+            void* other = state->handoff;
+            state->handoff = allocations[index];
+            spinLockUnlock(&state->handoffLock);
+            allocations[index] = 0;
+            partitionFreeGeneric(state->root, other);
+        }
+    }
+    for (size_t i = 0; i < kNumLiveAllocations; ++i)
+        partitionFreeGeneric(state->root, allocations[i]);
+    return 0;
+}
+
+static void runThreadCacheTestThreads(ThreadCacheTestState* state, size_t numThreads)
+{
+    ThreadCacheTestThread threads[8];
+    ASSERT(numThreads <= WTF_ARRAY_LENGTH(threads));
+    for (size_t i = 0; i < numThreads; ++i) {
+        threads[i].state = state;
+        threads[i].id = 'a' + i;
+        EXPECT_EQ(0, pthread_create(&threads[i].handle, 0, threadCacheTestThreadMain, &threads[i]));
+    }
+    for (size_t i = 0; i < numThreads; ++i)
+        EXPECT_EQ(0, pthread_join(threads[i].handle, 0));
+    partitionFreeGeneric(state->root, state->handoff);
+    state->handoff = 0;
+}
+
+// Test that concurrent allocations and frees, including frees of
+// allocations made by other threads, do not corrupt the partition, and that
+// the caches are flushed when their threads exit.
+TEST(PartitionAllocTest, GenericThreadCacheContention)
+{
+    threadCachedAllocator.init();
+    threadCachedAllocator.enableThreadCache();
+    ThreadCacheTestState state = { threadCachedAllocator.root(), 20000, 0, 0 };
+    runThreadCacheTestThreads(&state, 4);
+    EXPECT_FALSE(WTF::partitionThreadCacheGet(threadCachedAllocator.root()));
+    EXPECT_TRUE(threadCachedAllocator.shutdown());
+}
+
+struct ThreadCacheShutdownTestState {
+    WTF::PartitionRootGeneric* root;
+    int cacheFilled;
+    int partitionShutDown;
+};
+
+static void* threadCacheShutdownTestThreadMain(void* data)
+{
+    ThreadCacheShutdownTestState* state = static_cast<ThreadCacheShutdownTestState*>(data);
+    partitionFreeGeneric(state->root, partitionAllocGeneric(state->root, kTestAllocSize));
+    releaseStore(&state->cacheFilled, 1);
+    // Keep the thread, and so its cache, alive until the partition is gone.
+    while (!acquireLoad(&state->partitionShutDown))
+        sched_yield();
+    return 0;
+}
+
+// Test that shutdown flushes the caches of threads that are still running.
+TEST(PartitionAllocTest, GenericThreadCacheShutdown)
+{
+    threadCachedAllocator.init();
+    threadCachedAllocator.enableThreadCache();
+    ThreadCacheShutdownTestState state = { threadCachedAllocator.root(), 0, 0 };
+    pthread_t thread;
+    ASSERT_EQ(0, pthread_create(&thread, 0, threadCacheShutdownTestThreadMain, &state));
+    while (!acquireLoad(&state.cacheFilled))
+        sched_yield();
+    EXPECT_TRUE(threadCachedAllocator.root()->threadCaches);
+    EXPECT_TRUE(threadCachedAllocator.shutdown());
+    releaseStore(&state.partitionShutDown, 1);
+    EXPECT_EQ(0, pthread_join(thread, 0));
+}
+
+static double threadCacheTestTimeMs()
+{
+    struct timeval now;
+    gettimeofday(&now, 0);
+    return now.tv_sec * 1000.0 + now.tv_usec / 1000.0;
+}
+
+// Compares the throughput of a generic partition that is used concurrently
+// by several threads with and without the thread caches. Run with
+// --gtest_also_run_disabled_tests.
+TEST(PartitionAllocTest, DISABLED_GenericThreadCacheThroughput)
+{
+    for (int enableThreadCache = 0; enableThreadCache < 2; ++enableThreadCache) {
+        threadCachedAllocator.init();
+        if (enableThreadCache)
+            threadCachedAllocator.enableThreadCache();
+        ThreadCacheTestState state = { threadCachedAllocator.root(), 2000000, 0, 0 };
+        double startTime = threadCacheTestTimeMs();
+        runThreadCacheTestThreads(&state, 4);
+        int elapsedMs = static_cast<int>(threadCacheTestTimeMs() - startTime);
+        RecordProperty(enableThreadCache ? "threadCacheMs" : "lockedMs", elapsedMs);
+        EXPECT_TRUE(threadCachedAllocator.shutdown());
+    }
+}
+
+#endif // USE(PTHREADS)
+
 #if !OS(ANDROID)
 
 // Make sure that malloc(-1) dies.
@@ -1127,6 +1464,21 @@ TEST(PartitionAllocDeathTest, ImmediateDoubleFree)
     TestShutdown();
 }
 
+// Check that immediate double-frees are also detected by the thread caches.
+TEST(PartitionAllocDeathTest, ThreadCacheImmediateDoubleFree)
+{
+    threadCachedAllocator.init();
+    threadCachedAllocator.enableThreadCache();
+
+    void* ptr = partitionAllocGeneric(threadCachedAllocator.root(), kTestAllocSize);
+    EXPECT_TRUE(ptr);
+    partitionFreeGeneric(threadCachedAllocator.root(), ptr);
+
+    EXPECT_DEATH(partitionFreeGeneric(threadCachedAllocator.root(), ptr), "");
+
+    EXPECT_TRUE(threadCachedAllocator.shutdown());
+}
+
 // Check that our refcount-based double-free detection works.
 TEST(PartitionAllocDeathTest, RefcountDoubleFree)
 {
@@ -1193,6 +1545,15 @@ TEST(PartitionAllocTest, CLZWorks)
 #endif
 }
 
+TEST(PartitionAllocTest, CTZWorks)
+{
+    EXPECT_EQ(32u, WTF::countTrailingZeros32(0u));
+    EXPECT_EQ(0u, WTF::countTrailingZeros32(1u));
+    EXPECT_EQ(0u, WTF::countTrailingZeros32(0xffffffffu));
+    EXPECT_EQ(4u, WTF::countTrailingZeros32(0x30u));
+    EXPECT_EQ(31u, WTF::countTrailingZeros32(1u << 31));
+}
+
 } // namespace
 
 #endif // !defined(MEMORY_TOOL_REPLACES_ALLOCATOR)
@@ -303,6 +303,7 @@ static const size_t kInitialVectorSize = WTF_VECTOR_INITIAL_SIZE;
 
         T* buffer() { return m_buffer; }
         const T* buffer() const { return m_buffer; }
+        T** bufferSlot() { return &m_buffer; }
         size_t capacity() const { return m_capacity; }
 
         void clearUnusedSlots(T* from, T* to)
@@ -369,6 +370,8 @@ static const size_t kInitialVectorSize = WTF_VECTOR_INITIAL_SIZE;
         {
             std::swap(m_buffer, other.m_buffer);
             std::swap(m_capacity, other.m_capacity);
+            Allocator::backingWriteBarrier(m_buffer);
+            Allocator::backingWriteBarrier(other.m_buffer);
         }
 
         using Base::allocateBuffer;
@@ -477,6 +480,12 @@ static const size_t kInitialVectorSize = WTF_VECTOR_INITIAL_SIZE;
                 std::swap(m_buffer, other.m_buffer);
                 std::swap(m_capacity, other.m_capacity);
             }
+            if (buffer() == inlineBuffer() || other.buffer() == other.inlineBuffer()) {
+                Allocator::inlineBufferWriteBarrier(inlineBuffer(), inlineCapacity * sizeof(T));
+                Allocator::inlineBufferWriteBarrier(other.inlineBuffer(), inlineCapacity * sizeof(T));
+            }
+            Allocator::backingWriteBarrier(m_buffer);
+            Allocator::backingWriteBarrier(other.m_buffer);
         }
 
         using Base::buffer;
@@ -1186,8 +1195,13 @@ static const size_t kInitialVectorSize = WTF_VECTOR_INITIAL_SIZE;
             for (const T* bufferEntry = bufferBegin; bufferEntry != bufferEnd; bufferEntry++)
                 Allocator::template trace<T, VectorTraits<T> >(visitor, *const_cast<T*>(bufferEntry));
         }
-        if (this->hasOutOfLineBuffer())
+        if (this->hasOutOfLineBuffer()) {
             Allocator::markNoTracing(visitor, buffer());
+            // The backing is only referenced from this vector, so heap
+            // compaction can move it if the elements can be moved.
+            if (VectorTraits<T>::canMoveWithMemcpy)
+                Allocator::registerBackingStoreReference(visitor, this->bufferSlot());
+        }
     }
 
 #if !ENABLE(OILPAN)
@@ -76,6 +76,8 @@ void Partitions::initialize()
     spinLockLock(&lock);
     if (!s_initialized) {
         m_bufferAllocator.init();
+        // Strings and collection buffers are allocated from many threads.
+        m_bufferAllocator.enableThreadCache();
         s_initialized = true;
     }
     spinLockUnlock(&lock);
@@ -87,4 +89,11 @@ void Partitions::shutdown()
     m_bufferAllocator.shutdown();
 }
 
+void Partitions::dumpMemoryStats(PartitionStatsDumper* dumper)
+{
+    if (s_initialized)
+        partitionDumpStatsGeneric(m_bufferAllocator.root(), "buffer", dumper);
+    fastMallocDumpPartitionStats(dumper);
+}
+
 } // namespace WTF
@@ -47,6 +47,8 @@ class WTF_EXPORT Partitions {
 public:
     static void initialize();
     static void shutdown();
+    // Reports the statistics of the buffer and fastMalloc partitions.
+    static void dumpMemoryStats(PartitionStatsDumper*);
     static ALWAYS_INLINE PartitionRootGeneric* getBufferPartition()
     {
         if (UNLIKELY(!s_initialized))
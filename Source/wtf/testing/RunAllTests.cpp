@@ -33,6 +33,7 @@
 #include "wtf/CryptographicallyRandomNumber.h"
 #include "wtf/MainThread.h"
 #include "wtf/WTF.h"
+#include "wtf/text/AtomicString.h"
 #include <base/test/test_suite.h>
 #include <string.h>
 
@@ -51,5 +52,6 @@ int main(int argc, char** argv)
     WTF::setRandomSource(AlwaysZeroNumberSource);
     WTF::initialize(CurrentTime, 0);
     WTF::initializeMainThread(0);
+    WTF::AtomicString::enableSharedTable();
     return base::RunUnitTestsUsingBaseTestSuite(argc, argv);
 }
@@ -24,7 +24,10 @@
 #include "AtomicString.h"
 
 #include "StringHash.h"
+#include "wtf/Atomics.h"
 #include "wtf/HashSet.h"
+#include "wtf/MainThread.h"
+#include "wtf/SpinLock.h"
 #include "wtf/WTFThreadData.h"
 #include "wtf/dtoa.h"
 #include "wtf/text/IntegerToStringConversion.h"
@@ -36,6 +39,106 @@ using namespace Unicode;
 
 COMPILE_ASSERT(sizeof(AtomicString) == sizeof(String), atomic_string_and_string_must_be_same_size);
 
+// Nearly every AtomicString creation looks up the table, so it uses the
+// grouped probing layout.
+typedef HashSet<StringImpl*, DefaultHash<StringImpl*>::Hash, GroupedProbingHashTraits<StringImpl*> > AtomicStringSet;
+
+// The process-wide table behind AtomicString::enableSharedTable(). Strings are
+// only ever added, never removed or moved, so lookups don't need a lock: a slot
+// is published with a release store once the string it refers to is complete.
+// Additions take the lock of one of several shards, picked by hash.
+static const unsigned numberOfSharedStringShards = 16;
+static const unsigned sharedStringSlotsPerShard = 4096;
+// Keeping each shard at most half full bounds the length of every probe.
+static const unsigned maximumSharedStringsPerShard = sharedStringSlotsPerShard / 2;
+// Shared strings live forever, so only identifier-sized ones are eligible.
+static const unsigned maximumSharedStringLength = 32;
+
+struct SharedStringShard {
+    int lock;
+    unsigned size;
+    // Zero for empty slots, otherwise one plus an index into |strings|.
+    volatile unsigned slots[sharedStringSlotsPerShard];
+    StringImpl* strings[maximumSharedStringsPerShard];
+};
+
+static bool s_sharedTableEnabled = false;
+static SharedStringShard s_sharedStringShards[numberOfSharedStringShards];
+
+static inline SharedStringShard& sharedStringShard(unsigned hash)
+{
+    return s_sharedStringShards[hash & (numberOfSharedStringShards - 1)];
+}
+
+// Returns the matching string, or 0 with |slot| set to the empty slot that
+// ends the probe sequence.
+template<typename CharacterType>
+static inline StringImpl* findSharedString(const SharedStringShard& shard, const CharacterType* characters, unsigned length, unsigned hash, unsigned& slot)
+{
+    for (slot = (hash / numberOfSharedStringShards) & (sharedStringSlotsPerShard - 1); ; slot = (slot + 1) & (sharedStringSlotsPerShard - 1)) {
+        unsigned entry = acquireLoad(&shard.slots[slot]);
+        if (!entry)
+            return 0;
+        StringImpl* string = shard.strings[entry - 1];
+        if (string->existingHash() == hash && equal(string, characters, length))
+            return string;
+    }
+}
+
+static inline PassRefPtr<StringImpl> createSharedString(const LChar* characters, unsigned length)
+{
+    return StringImpl::create(characters, length);
+}
+
+static inline PassRefPtr<StringImpl> createSharedString(const UChar* characters, unsigned length)
+{
+    return StringImpl::create8BitIfPossible(characters, length);
+}
+
+// Returns the shared string equal to the given characters, adding one if there
+// is room. |newString| is an AtomicString no other thread can see yet, which
+// becomes the shared string rather than a copy if given.
+template<typename CharacterType>
+static StringImpl* findOrAddSharedString(const CharacterType* characters, unsigned length, unsigned hash, StringImpl* newString)
+{
+    if (!s_sharedTableEnabled || length > maximumSharedStringLength)
+        return 0;
+
+    SharedStringShard& shard = sharedStringShard(hash);
+    unsigned slot;
+    if (StringImpl* string = findSharedString(shard, characters, length, hash, slot))
+        return string;
+
+    spinLockLock(&shard.lock);
+    // Another thread may have added the string, or others that share its
+    // probe sequence, since we looked.
+    StringImpl* string = findSharedString(shard, characters, length, hash, slot);
+    if (!string && shard.size < maximumSharedStringsPerShard) {
+        if (newString) {
+            string = newString;
+        } else {
+            string = createSharedString(characters, length).leakRef();
+            string->hash();
+            string->setIsAtomic(true);
+        }
+        string->setIsShared();
+        shard.strings[shard.size++] = string;
+        releaseStore(&shard.slots[slot], shard.size);
+    }
+    spinLockUnlock(&shard.lock);
+    return string;
+}
+
+enum SharedStringCreation { AdoptSharedString, CopySharedString };
+
+static inline StringImpl* findOrAddSharedString(StringImpl* string, SharedStringCreation creation)
+{
+    StringImpl* newString = creation == AdoptSharedString ? string : 0;
+    if (string->is8Bit())
+        return findOrAddSharedString(string->characters8(), string->length(), string->existingHash(), newString);
+    return findOrAddSharedString(string->characters16(), string->length(), string->existingHash(), newString);
+}
+
 class AtomicStringTable {
     WTF_MAKE_NONCOPYABLE(AtomicStringTable);
 public:
@@ -52,7 +155,15 @@ public:
         if (!string->length())
             return StringImpl::empty();
 
-        StringImpl* result = *m_table.add(string).storedValue;
+        AtomicStringSet::AddResult addResult = m_table.add(string);
+        StringImpl* result = *addResult.storedValue;
+
+        // |string| may be shared with other Strings, so the shared table gets
+        // a copy of it.
+        if (addResult.isNewEntry && !string->isStatic()) {
+            if (StringImpl* shared = findOrAddSharedString(string, CopySharedString))
+                result = *addResult.storedValue = shared;
+        }
 
         if (!result->isAtomic())
             result->setIsAtomic(true);
@@ -61,7 +172,7 @@ public:
         return result;
     }
 
-    HashSet<StringImpl*>& table()
+    AtomicStringSet& table()
     {
         return m_table;
     }
@@ -81,8 +192,8 @@ private:
 
     static void destroy(AtomicStringTable* table)
     {
-        HashSet<StringImpl*>::iterator end = table->m_table.end();
-        for (HashSet<StringImpl*>::iterator iter = table->m_table.begin(); iter != end; ++iter) {
+        AtomicStringSet::iterator end = table->m_table.end();
+        for (AtomicStringSet::iterator iter = table->m_table.begin(); iter != end; ++iter) {
             StringImpl* string = *iter;
             if (!string->isStatic()) {
                 ASSERT(string->isAtomic());
@@ -92,7 +203,7 @@ private:
         delete table;
     }
 
-    HashSet<StringImpl*> m_table;
+    AtomicStringSet m_table;
 };
 
 static inline AtomicStringTable& atomicStringTable()
@@ -105,7 +216,7 @@ static inline AtomicStringTable& atomicStringTable()
     return *table;
 }
 
-static inline HashSet<StringImpl*>& atomicStrings()
+static inline AtomicStringSet& atomicStrings()
 {
     return atomicStringTable().table();
 }
@@ -113,11 +224,22 @@ static inline HashSet<StringImpl*>& atomicStrings()
 template<typename T, typename HashTranslator>
 static inline PassRefPtr<StringImpl> addToStringTable(const T& value)
 {
-    HashSet<StringImpl*>::AddResult addResult = atomicStrings().add<HashTranslator>(value);
-
-    // If the string is newly-translated, then we need to adopt it.
-    // The boolean in the pair tells us if that is so.
-    return addResult.isNewEntry ? adoptRef(*addResult.storedValue) : *addResult.storedValue;
+    AtomicStringSet::AddResult addResult = atomicStrings().add<HashTranslator>(value);
+    if (!addResult.isNewEntry)
+        return *addResult.storedValue;
+
+    // The string is newly-translated, so we need to adopt it. It becomes the
+    // shared string too, unless an equal one has been shared already.
+    RefPtr<StringImpl> string = adoptRef(*addResult.storedValue);
+    StringImpl* shared = findOrAddSharedString(string.get(), AdoptSharedString);
+    if (shared && shared != string) {
+        // Keep the thread-local copy from removing the shared string from the
+        // table when it is destroyed.
+        string->setIsAtomic(false);
+        *addResult.storedValue = shared;
+        return shared;
+    }
+    return string.release();
 }
 
 PassRefPtr<StringImpl> AtomicString::add(const LChar* c)
@@ -409,7 +531,7 @@ PassRefPtr<StringImpl> AtomicString::addSlowCase(StringImpl* string)
 }
 
 template<typename CharacterType>
-static inline HashSet<StringImpl*>::iterator findString(const StringImpl* stringImpl)
+static inline AtomicStringSet::iterator findString(const StringImpl* stringImpl)
 {
     HashAndCharacters<CharacterType> buffer = { stringImpl->existingHash(), stringImpl->getCharacters<CharacterType>(), stringImpl->length() };
     return atomicStrings().find<HashAndCharactersTranslator<CharacterType> >(buffer);
@@ -423,19 +545,62 @@ StringImpl* AtomicString::find(const StringImpl* stringImpl)
     if (!stringImpl->length())
         return StringImpl::empty();
 
-    HashSet<StringImpl*>::iterator iterator;
+    AtomicStringSet::iterator iterator;
     if (stringImpl->is8Bit())
         iterator = findString<LChar>(stringImpl);
     else
         iterator = findString<UChar>(stringImpl);
-    if (iterator == atomicStrings().end())
+    if (iterator != atomicStrings().end())
+        return *iterator;
+
+    // Another thread may have shared the string without it ever being added
+    // to this thread's table.
+    if (!s_sharedTableEnabled || stringImpl->length() > maximumSharedStringLength)
         return 0;
-    return *iterator;
+    const SharedStringShard& shard = sharedStringShard(stringImpl->existingHash());
+    unsigned slot;
+    if (stringImpl->is8Bit())
+        return findSharedString(shard, stringImpl->characters8(), stringImpl->length(), stringImpl->existingHash(), slot);
+    return findSharedString(shard, stringImpl->characters16(), stringImpl->length(), stringImpl->existingHash(), slot);
+}
+
+void AtomicString::enableSharedTable()
+{
+    ASSERT(isMainThread());
+    // Otherwise a string atomized earlier and its shared equivalent would be
+    // two different AtomicStrings.
+    ASSERT(!wtfThreadData().atomicStringTable() || atomicStrings().size() == StringImpl::allStaticStrings().size());
+    s_sharedTableEnabled = true;
+}
+
+bool AtomicString::sharedTableEnabled()
+{
+    return s_sharedTableEnabled;
+}
+
+template<typename CharacterType>
+static inline AtomicString findOrAddShared(const CharacterType* characters, unsigned length)
+{
+    ASSERT(characters);
+    if (!length)
+        return emptyAtom;
+    unsigned hash = StringHasher::computeHashAndMaskTop8Bits(characters, length);
+    return AtomicString(findOrAddSharedString(characters, length, hash, 0));
+}
+
+AtomicString AtomicString::findOrAddShared(const LChar* characters, unsigned length)
+{
+    return WTF::findOrAddShared(characters, length);
+}
+
+AtomicString AtomicString::findOrAddShared(const UChar* characters, unsigned length)
+{
+    return WTF::findOrAddShared(characters, length);
 }
 
 void AtomicString::remove(StringImpl* r)
 {
-    HashSet<StringImpl*>::iterator iterator;
+    AtomicStringSet::iterator iterator;
     if (r->is8Bit())
         iterator = findString<LChar>(r);
     else
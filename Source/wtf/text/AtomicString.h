@@ -75,6 +75,22 @@ public:
 
     static StringImpl* find(const StringImpl*);
 
+    // Each thread normally has its own AtomicString table, so an AtomicString
+    // created on one thread can't be used on another. Once the shared table is
+    // enabled, short strings are instead atomized in a process-wide table and
+    // never destroyed, which makes them safe to hand between threads (e.g. from
+    // the HTML parser thread). The table has a fixed capacity; strings that
+    // don't fit fall back to the thread's own table. Must be called on the
+    // main thread before anything but static strings has been atomized.
+    static void enableSharedTable();
+    static bool sharedTableEnabled();
+
+    // Returns the process-wide AtomicString for the given characters, or a null
+    // AtomicString if they can't be shared. Never touches the current thread's
+    // table, so it's cheap to call for strings that are only sent elsewhere.
+    static AtomicString findOrAddShared(const LChar*, unsigned length);
+    static AtomicString findOrAddShared(const UChar*, unsigned length);
+
     operator const String&() const { return m_string; }
     const String& string() const { return m_string; };
 
@@ -31,7 +31,12 @@
 #include "config.h"
 #include "AtomicString.h"
 
+#include "wtf/text/StringBuilder.h"
 #include <gtest/gtest.h>
+#include <time.h>
+#if USE(PTHREADS)
+#include <pthread.h>
+#endif
 
 namespace {
 
@@ -77,4 +82,155 @@ TEST(AtomicStringTest, ImplEquality)
     ASSERT_NE(bar.impl(), baz.impl());
 }
 
+TEST(AtomicStringTest, SharedTable)
+{
+    ASSERT_TRUE(AtomicString::sharedTableEnabled());
+
+    AtomicString shared = AtomicString::findOrAddShared(reinterpret_cast<const LChar*>("sharedName"), 10);
+    ASSERT_FALSE(shared.isNull());
+    EXPECT_TRUE(shared.impl()->isStatic());
+    EXPECT_TRUE(shared.impl()->isAtomic());
+    EXPECT_TRUE(shared.string().isSafeToSendToAnotherThread());
+
+    // Atomizing the same characters on this thread finds the shared string.
+    AtomicString local("sharedName");
+    EXPECT_EQ(shared.impl(), local.impl());
+    const UChar characters16[] = { 's', 'h', 'a', 'r', 'e', 'd', 'N', 'a', 'm', 'e' };
+    EXPECT_EQ(shared.impl(), AtomicString::findOrAddShared(characters16, 10).impl());
+    EXPECT_EQ(shared.impl(), AtomicString(String("sharedName")).impl());
+
+    // Strings that were atomized first on this thread are shared too.
+    AtomicString first("sharedAfterLocal");
+    EXPECT_TRUE(first.impl()->isStatic());
+    EXPECT_EQ(first.impl(), AtomicString::findOrAddShared(reinterpret_cast<const LChar*>("sharedAfterLocal"), 16).impl());
+
+    EXPECT_EQ(emptyAtom.impl(), AtomicString::findOrAddShared(characters16, 0).impl());
+}
+
+TEST(AtomicStringTest, SharedTableSkipsLongStrings)
+{
+    String longString("aVeryLongNameThatShouldNotBeSharedBetweenThreads");
+    EXPECT_TRUE(AtomicString::findOrAddShared(longString.characters8(), longString.length()).isNull());
+
+    AtomicString local(longString);
+    EXPECT_FALSE(local.impl()->isStatic());
+    EXPECT_FALSE(local.string().isSafeToSendToAnotherThread());
+    EXPECT_EQ(local.impl(), AtomicString("aVeryLongNameThatShouldNotBeSharedBetweenThreads").impl());
+}
+
+#if USE(PTHREADS)
+
+static const unsigned kSharedNames = 300;
+
+static String sharedNameFor(unsigned i, const char* prefix = "name")
+{
+    StringBuilder builder;
+    builder.append(prefix);
+    builder.appendNumber(i);
+    return builder.toString();
+}
+
+struct SharedTableTestThread {
+    StringImpl* names[kSharedNames];
+    pthread_t handle;
+};
+
+static void* sharedTableTestThreadMain(void* data)
+{
+    SharedTableTestThread* thread = static_cast<SharedTableTestThread*>(data);
+    for (unsigned i = 0; i < kSharedNames; ++i) {
+        // Alternate between the thread's own table and the shared one.
+        AtomicString name = i % 2 ? AtomicString(sharedNameFor(i)) : AtomicString::findOrAddShared(sharedNameFor(i).characters8(), sharedNameFor(i).length());
+        thread->names[i] = name.impl();
+    }
+    return 0;
+}
+
+// Test that threads racing to atomize the same strings all end up with the
+// same StringImpls, which are then usable on the main thread.
+TEST(AtomicStringTest, SharedTableAcrossThreads)
+{
+    SharedTableTestThread threads[4];
+    for (size_t i = 0; i < WTF_ARRAY_LENGTH(threads); ++i)
+        EXPECT_EQ(0, pthread_create(&threads[i].handle, 0, sharedTableTestThreadMain, &threads[i]));
+    for (size_t i = 0; i < WTF_ARRAY_LENGTH(threads); ++i)
+        EXPECT_EQ(0, pthread_join(threads[i].handle, 0));
+
+    for (unsigned i = 0; i < kSharedNames; ++i) {
+        StringImpl* name = threads[0].names[i];
+        String expected = sharedNameFor(i);
+        expected.impl()->hash();
+        EXPECT_TRUE(name->isStatic());
+        EXPECT_TRUE(equal(name, expected.impl()));
+        for (size_t j = 1; j < WTF_ARRAY_LENGTH(threads); ++j)
+            EXPECT_EQ(name, threads[j].names[i]);
+        // This thread never atomized the string, but can still find it.
+        EXPECT_EQ(name, AtomicString::find(expected.impl()));
+        EXPECT_EQ(name, AtomicString(expected).impl());
+    }
+}
+
+enum HandOffMode { HandOffStrings, HandOffSharedAtomicStrings };
+
+struct HandOffBenchmarkThread {
+    HandOffMode mode;
+    const Vector<String>* names;
+    Vector<String> tokens;
+    pthread_t handle;
+};
+
+static void* handOffBenchmarkThreadMain(void* data)
+{
+    HandOffBenchmarkThread* thread = static_cast<HandOffBenchmarkThread*>(data);
+    const Vector<String>& names = *thread->names;
+    for (size_t i = 0; i < names.size(); ++i) {
+        const String& name = names[i];
+        if (thread->mode == HandOffSharedAtomicStrings)
+            thread->tokens.append(AtomicString::findOrAddShared(name.characters8(), name.length()));
+        else
+            thread->tokens.append(String(name.characters8(), name.length()));
+    }
+    return 0;
+}
+
+static double handOffBenchmarkMs(HandOffMode mode, const Vector<String>& names)
+{
+    // Like the HTML parser, a background thread turns the names into Strings
+    // that are safe to send, which the main thread then atomizes.
+    HandOffBenchmarkThread thread;
+    thread.mode = mode;
+    thread.names = &names;
+    EXPECT_EQ(0, pthread_create(&thread.handle, 0, handOffBenchmarkThreadMain, &thread));
+    EXPECT_EQ(0, pthread_join(thread.handle, 0));
+
+    clock_t start = clock();
+    unsigned matches = 0;
+    for (size_t i = 0; i < thread.tokens.size(); ++i) {
+        ASSERT(thread.tokens[i].isSafeToSendToAnotherThread());
+        AtomicString name(thread.tokens[i]);
+        matches += name.impl() == names[i % 200].impl();
+    }
+    EXPECT_EQ(thread.tokens.size(), matches);
+    return 1000.0 * (clock() - start) / CLOCKS_PER_SEC;
+}
+
+// Measures the main thread's cost of atomizing names handed over by a parser
+// thread as plain Strings and as shared AtomicStrings. Run with
+// --gtest_also_run_disabled_tests.
+TEST(AtomicStringTest, DISABLED_SharedTableHandOffThroughput)
+{
+    Vector<String> names;
+    for (unsigned i = 0; i < 200; ++i)
+        names.append(AtomicString(sharedNameFor(i, "handOffName")));
+    for (unsigned i = 0; i < 2000000; ++i)
+        names.append(names[i % 200]);
+
+    double stringsMs = handOffBenchmarkMs(HandOffStrings, names);
+    double sharedMs = handOffBenchmarkMs(HandOffSharedAtomicStrings, names);
+    ::testing::Test::RecordProperty("StringsMs", static_cast<int>(stringsMs));
+    ::testing::Test::RecordProperty("SharedAtomicStringsMs", static_cast<int>(sharedMs));
+}
+
+#endif // USE(PTHREADS)
+
 } // namespace
@@ -244,6 +244,16 @@ public:
 
     bool isStatic() const { return m_isStatic; }
 
+    // AtomicStrings in the process-wide table are never destroyed, just like
+    // static strings, so that they can be ref-counted from any thread.
+    // See AtomicString::enableSharedTable().
+    void setIsShared()
+    {
+        ASSERT(isAtomic());
+        ASSERT(hasHash());
+        m_isStatic = true;
+    }
+
 private:
     // The high bits of 'hash' are always empty, but we prefer to store our flags
     // in the low bits because it makes them slightly more efficient to access.
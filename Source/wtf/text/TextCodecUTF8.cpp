@@ -26,11 +26,18 @@
 #include "config.h"
 #include "wtf/text/TextCodecUTF8.h"
 
+#include "wtf/BitwiseOperations.h"
 #include "wtf/text/TextCodecASCIIFastPath.h"
 #include "wtf/text/CString.h"
 #include "wtf/text/StringBuffer.h"
 #include "wtf/unicode/CharacterNames.h"
 
+#if CPU(X86) || CPU(X86_64)
+#include <emmintrin.h>
+#elif HAVE(ARM_NEON_INTRINSICS)
+#include <arm_neon.h>
+#endif
+
 using namespace WTF;
 using namespace WTF::Unicode;
 using namespace std;
@@ -155,10 +162,208 @@ static inline UChar* appendCharacter(UChar* destination, int character)
     return destination;
 }
 
-void TextCodecUTF8::consumePartialSequenceByte()
+// Text in most non-Latin scripts is made of runs of two- and three-byte
+// sequences, so instead of looking up and validating one sequence at a time,
+// the decoder classifies a whole block of bytes with SIMD compares and, if the
+// block is well-formed, decodes it without further checks.
+static const int utf8BlockSize = 16;
+
+// Bit i of each mask describes byte i of the block.
+struct UTF8BlockMasks {
+    unsigned nonASCII; // 0x80-0xFF
+    unsigned continuations; // 0x80-0xBF
+    unsigned unsupportedLeads; // 0xC0 and 0xC1, which are always overlong, and four-byte leads 0xF0-0xFF
+    unsigned threeByteLeads; // 0xE0-0xEF
+    unsigned restrictedThreeByteLeads; // 0xE0 and 0xED, which restrict the following byte
+    unsigned nonLatin1Leads; // 0xC4-0xFF
+};
+
+#if CPU(X86) || CPU(X86_64) || (HAVE(ARM_NEON_INTRINSICS) && !(CPU(BIG_ENDIAN) || CPU(MIDDLE_ENDIAN)))
+#define HAVE_UTF8_BLOCK_DECODING 1
+#endif
+
+#if CPU(X86) || CPU(X86_64)
+
+// The compares are signed, so 0x80-0xFF are -128 to -1.
+static inline void classifyUTF8Block(const uint8_t* source, UTF8BlockMasks& masks)
+{
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+    masks.nonASCII = _mm_movemask_epi8(bytes);
+    masks.continuations = _mm_movemask_epi8(_mm_cmplt_epi8(bytes, _mm_set1_epi8(-64)));
+    unsigned belowC2 = _mm_movemask_epi8(_mm_cmplt_epi8(bytes, _mm_set1_epi8(-62)));
+    unsigned aboveDF = _mm_movemask_epi8(_mm_cmpgt_epi8(bytes, _mm_set1_epi8(-33))) & masks.nonASCII;
+    unsigned aboveEF = _mm_movemask_epi8(_mm_cmpgt_epi8(bytes, _mm_set1_epi8(-17))) & masks.nonASCII;
+    masks.unsupportedLeads = (belowC2 & ~masks.continuations) | aboveEF;
+    masks.threeByteLeads = aboveDF & ~aboveEF;
+    masks.restrictedThreeByteLeads = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(-32)), _mm_cmpeq_epi8(bytes, _mm_set1_epi8(-19))));
+    masks.nonLatin1Leads = _mm_movemask_epi8(_mm_cmpgt_epi8(bytes, _mm_set1_epi8(-61))) & masks.nonASCII;
+}
+
+// Decodes a block of eight two-byte sequences, as 16-bit lanes holding a lead
+// byte in the low half and a continuation byte in the high half.
+static inline __m128i decodeTwoByteSequences(const uint8_t* source)
+{
+    __m128i sequences = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+    __m128i high = _mm_slli_epi16(_mm_and_si128(sequences, _mm_set1_epi16(0x1F)), 6);
+    __m128i low = _mm_and_si128(_mm_srli_epi16(sequences, 8), _mm_set1_epi16(0x3F));
+    return _mm_or_si128(high, low);
+}
+
+static inline void decodeTwoByteBlock(const uint8_t* source, LChar* destination)
+{
+    __m128i characters = decodeTwoByteSequences(source);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(destination), _mm_packus_epi16(characters, characters));
+}
+
+static inline void decodeTwoByteBlock(const uint8_t* source, UChar* destination)
+{
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(destination), decodeTwoByteSequences(source));
+}
+
+#elif HAVE(UTF8_BLOCK_DECODING)
+
+// NEON has no movemask, so weigh each lane by its bit and add the lanes up.
+static inline unsigned laneMask(uint8x16_t lanes)
+{
+    static const uint8_t bits[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+    uint8x16_t weighted = vandq_u8(lanes, vld1q_u8(bits));
+    uint8x8_t sums = vpadd_u8(vget_low_u8(weighted), vget_high_u8(weighted));
+    sums = vpadd_u8(sums, sums);
+    sums = vpadd_u8(sums, sums);
+    return vget_lane_u8(sums, 0) | (vget_lane_u8(sums, 1) << 8);
+}
+
+static inline void classifyUTF8Block(const uint8_t* source, UTF8BlockMasks& masks)
+{
+    int8x16_t bytes = vreinterpretq_s8_u8(vld1q_u8(source));
+    masks.nonASCII = laneMask(vcltq_s8(bytes, vdupq_n_s8(0)));
+    masks.continuations = laneMask(vcltq_s8(bytes, vdupq_n_s8(-64)));
+    unsigned belowC2 = laneMask(vcltq_s8(bytes, vdupq_n_s8(-62)));
+    unsigned aboveDF = laneMask(vcgtq_s8(bytes, vdupq_n_s8(-33))) & masks.nonASCII;
+    unsigned aboveEF = laneMask(vcgtq_s8(bytes, vdupq_n_s8(-17))) & masks.nonASCII;
+    masks.unsupportedLeads = (belowC2 & ~masks.continuations) | aboveEF;
+    masks.threeByteLeads = aboveDF & ~aboveEF;
+    masks.restrictedThreeByteLeads = laneMask(vorrq_u8(vceqq_s8(bytes, vdupq_n_s8(-32)), vceqq_s8(bytes, vdupq_n_s8(-19))));
+    masks.nonLatin1Leads = laneMask(vcgtq_s8(bytes, vdupq_n_s8(-61))) & masks.nonASCII;
+}
+
+static inline uint16x8_t decodeTwoByteSequences(const uint8_t* source)
+{
+    uint16x8_t sequences = vreinterpretq_u16_u8(vld1q_u8(source));
+    uint16x8_t high = vshlq_n_u16(vandq_u16(sequences, vdupq_n_u16(0x1F)), 6);
+    uint16x8_t low = vandq_u16(vshrq_n_u16(sequences, 8), vdupq_n_u16(0x3F));
+    return vorrq_u16(high, low);
+}
+
+static inline void decodeTwoByteBlock(const uint8_t* source, LChar* destination)
+{
+    vst1_u8(destination, vmovn_u16(decodeTwoByteSequences(source)));
+}
+
+static inline void decodeTwoByteBlock(const uint8_t* source, UChar* destination)
+{
+    vst1q_u16(destination, decodeTwoByteSequences(source));
+}
+
+#endif
+
+#if HAVE(UTF8_BLOCK_DECODING)
+
+static inline bool blockFitsIn(const UTF8BlockMasks& masks, LChar*)
 {
-    --m_partialSequenceSize;
-    memmove(m_partialSequence, m_partialSequence + 1, m_partialSequenceSize);
+    return !masks.nonLatin1Leads;
+}
+
+static inline bool blockFitsIn(const UTF8BlockMasks&, UChar*)
+{
+    return true;
+}
+
+static inline bool isContinuationByte(uint8_t byte)
+{
+    return (byte & 0xC0) == 0x80;
+}
+
+// Decodes the block at |source|, along with the end of a sequence that crosses
+// the end of the block, if it only holds ASCII and well-formed two- and
+// three-byte sequences, and they all fit in CharType. Otherwise returns false
+// without consuming anything, leaving the block to the per-sequence decoder.
+template<typename CharType>
+static inline bool decodeNonASCIIBlock(const uint8_t*& source, const uint8_t* end, CharType*& destination)
+{
+    if (end - source < utf8BlockSize + 2)
+        return false;
+
+    UTF8BlockMasks masks;
+    classifyUTF8Block(source, masks);
+    if (masks.unsupportedLeads || !blockFitsIn(masks, destination))
+        return false;
+
+    // Every lead must be followed by exactly as many continuation bytes as its
+    // sequence needs, and there must be no other continuation bytes.
+    unsigned leads = masks.nonASCII & ~masks.continuations;
+    unsigned expectedContinuations = (leads << 1) | (masks.threeByteLeads << 2);
+    if ((expectedContinuations & 0xFFFF) != masks.continuations)
+        return false;
+    int length = utf8BlockSize;
+    if (expectedContinuations & (1 << 16)) {
+        if (!isContinuationByte(source[length]))
+            return false;
+        ++length;
+        if (expectedContinuations & (1 << 17)) {
+            if (!isContinuationByte(source[length]))
+                return false;
+            ++length;
+        }
+    }
+
+    // Reject overlong three-byte sequences and encoded surrogates.
+    for (unsigned restricted = masks.restrictedThreeByteLeads; restricted; restricted &= restricted - 1) {
+        const uint8_t* sequence = source + countTrailingZeros32(restricted);
+        if (sequence[0] == 0xE0 ? sequence[1] < 0xA0 : sequence[1] > 0x9F)
+            return false;
+    }
+
+    if (leads == 0x5555) {
+        decodeTwoByteBlock(source, destination);
+        source += utf8BlockSize;
+        destination += utf8BlockSize / 2;
+        return true;
+    }
+
+    const uint8_t* blockEnd = source + length;
+    while (source < blockEnd) {
+        uint8_t byte = *source;
+        if (isASCII(byte)) {
+            *destination++ = byte;
+            ++source;
+        } else if (byte < 0xE0) {
+            *destination++ = ((byte & 0x1F) << 6) | (source[1] & 0x3F);
+            source += 2;
+        } else {
+            ASSERT(sizeof(CharType) == sizeof(UChar));
+            *destination++ = ((byte & 0x0F) << 12) | ((source[1] & 0x3F) << 6) | (source[2] & 0x3F);
+            source += 3;
+        }
+    }
+    return true;
+}
+
+#else
+
+template<typename CharType>
+static inline bool decodeNonASCIIBlock(const uint8_t*&, const uint8_t*, CharType*&)
+{
+    return false;
+}
+
+#endif
+
+void TextCodecUTF8::consumePartialSequenceBytes(int numBytes)
+{
+    ASSERT(m_partialSequenceSize >= numBytes);
+    m_partialSequenceSize -= numBytes;
+    memmove(m_partialSequence, m_partialSequence + numBytes, m_partialSequenceSize);
 }
 
 void TextCodecUTF8::handleError(UChar*& destination, bool stopOnError, bool& sawError)
@@ -168,7 +373,7 @@ void TextCodecUTF8::handleError(UChar*& destination, bool stopOnError, bool& saw
         return;
     // Each error generates a replacement character and consumes one byte.
     *destination++ = replacementCharacter;
-    consumePartialSequenceByte();
+    consumePartialSequenceBytes(1);
 }
 
 template <>
@@ -178,7 +383,7 @@ bool TextCodecUTF8::handlePartialSequence<LChar>(LChar*& destination, const uint
     do {
         if (isASCII(m_partialSequence[0])) {
             *destination++ = m_partialSequence[0];
-            consumePartialSequenceByte();
+            consumePartialSequenceBytes(1);
             continue;
         }
         int count = nonASCIISequenceLength(m_partialSequence[0]);
@@ -207,7 +412,7 @@ bool TextCodecUTF8::handlePartialSequence<LChar>(LChar*& destination, const uint
         if ((character == nonCharacter) || (character > 0xff))
             return true;
 
-        m_partialSequenceSize -= count;
+        consumePartialSequenceBytes(count);
         *destination++ = character;
     } while (m_partialSequenceSize);
 
@@ -221,7 +426,7 @@ bool TextCodecUTF8::handlePartialSequence<UChar>(UChar*& destination, const uint
     do {
         if (isASCII(m_partialSequence[0])) {
             *destination++ = m_partialSequence[0];
-            consumePartialSequenceByte();
+            consumePartialSequenceBytes(1);
             continue;
         }
         int count = nonASCIISequenceLength(m_partialSequence[0]);
@@ -258,7 +463,7 @@ bool TextCodecUTF8::handlePartialSequence<UChar>(UChar*& destination, const uint
             continue;
         }
 
-        m_partialSequenceSize -= count;
+        consumePartialSequenceBytes(count);
         destination = appendCharacter(destination, character);
     } while (m_partialSequenceSize);
 
@@ -275,6 +480,8 @@ String TextCodecUTF8::decode(const char* bytes, size_t length, FlushBehavior flu
     const uint8_t* source = reinterpret_cast<const uint8_t*>(bytes);
     const uint8_t* end = source + length;
     const uint8_t* alignedEnd = alignToMachineWord(end);
+    // Where to next try decoding a whole block of non-ASCII text.
+    const uint8_t* nextBlock = source;
     LChar* destination = buffer.characters();
 
     do {
@@ -314,6 +521,12 @@ String TextCodecUTF8::decode(const char* bytes, size_t length, FlushBehavior flu
                 *destination++ = *source++;
                 continue;
             }
+            if (source >= nextBlock) {
+                if (decodeNonASCIIBlock(source, end, destination))
+                    continue;
+                // Don't try again until past this block.
+                nextBlock = source + utf8BlockSize;
+            }
             int count = nonASCIISequenceLength(*source);
             int character;
             if (!count)
@@ -391,6 +604,11 @@ upConvertTo16Bit:
                 *destination16++ = *source++;
                 continue;
             }
+            if (source >= nextBlock) {
+                if (decodeNonASCIIBlock(source, end, destination16))
+                    continue;
+                nextBlock = source + utf8BlockSize;
+            }
             int count = nonASCIISequenceLength(*source);
             int character;
             if (!count)
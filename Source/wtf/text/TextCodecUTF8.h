@@ -51,7 +51,7 @@ private:
     template <typename CharType>
     bool handlePartialSequence(CharType*& destination, const uint8_t*& source, const uint8_t* end, bool flush, bool stopOnError, bool& sawError);
     void handleError(UChar*& destination, bool stopOnError, bool& sawError);
-    void consumePartialSequenceByte();
+    void consumePartialSequenceBytes(int numBytes);
 
     int m_partialSequenceSize;
     uint8_t m_partialSequence[U8_MAX_LENGTH];
@@ -36,8 +36,10 @@
 #include "wtf/text/TextCodec.h"
 #include "wtf/text/TextEncoding.h"
 #include "wtf/text/TextEncodingRegistry.h"
+#include "wtf/text/StringBuilder.h"
 #include "wtf/text/WTFString.h"
 #include <gtest/gtest.h>
+#include <time.h>
 
 namespace WTF {
 
@@ -89,6 +91,198 @@ TEST(TextCodecUTF8, Decode0xFF)
     EXPECT_EQ(0xFFFDU, result[0]);
 }
 
+static String decodeUTF8(const char* bytes, size_t length, bool& sawError)
+{
+    TextEncoding encoding("UTF-8");
+    OwnPtr<TextCodec> codec(newTextCodec(encoding));
+    sawError = false;
+    return codec->decode(bytes, length, DataEOF, false, sawError);
+}
+
+// Decodes one byte per call, which takes the partial sequence path for every
+// multibyte sequence and so never the block decoder.
+static String decodeUTF8ByteByByte(const char* bytes, size_t length, bool& sawError)
+{
+    TextEncoding encoding("UTF-8");
+    OwnPtr<TextCodec> codec(newTextCodec(encoding));
+    sawError = false;
+    StringBuilder builder;
+    for (size_t i = 0; i < length; ++i)
+        builder.append(codec->decode(bytes + i, 1, i + 1 == length ? DataEOF : DoNotFlush, false, sawError));
+    if (!length)
+        builder.append(codec->decode(bytes, 0, DataEOF, false, sawError));
+    return builder.toString();
+}
+
+static String decodeUTF8InTwoParts(const char* bytes, size_t length, size_t split, bool& sawError)
+{
+    TextEncoding encoding("UTF-8");
+    OwnPtr<TextCodec> codec(newTextCodec(encoding));
+    sawError = false;
+    String first = codec->decode(bytes, split, DoNotFlush, false, sawError);
+    return first + codec->decode(bytes + split, length - split, DataEOF, false, sawError);
+}
+
+static void appendUTF8(Vector<char>& bytes, UChar32 character)
+{
+    char buffer[U8_MAX_LENGTH];
+    size_t length = 0;
+    U8_APPEND_UNSAFE(buffer, length, character);
+    bytes.append(buffer, length);
+}
+
+TEST(TextCodecUTF8, DecodeBlocks)
+{
+    // Long enough runs of each script for the block decoder to kick in.
+    Vector<char> latin1;
+    Vector<char> cyrillic;
+    Vector<char> cjk;
+    for (int i = 0; i < 100; ++i) {
+        appendUTF8(latin1, i % 7 ? 0xE9 : ' ');
+        appendUTF8(cyrillic, 0x0410 + i % 64);
+        appendUTF8(cjk, i % 5 ? 0x4E00 + i : 'a');
+    }
+
+    bool sawError;
+    String result = decodeUTF8(latin1.data(), latin1.size(), sawError);
+    EXPECT_FALSE(sawError);
+    EXPECT_TRUE(result.is8Bit());
+    ASSERT_EQ(100u, result.length());
+    for (unsigned i = 0; i < 100; ++i)
+        EXPECT_EQ(i % 7 ? 0xE9 : ' ', result[i]);
+
+    result = decodeUTF8(cyrillic.data(), cyrillic.size(), sawError);
+    EXPECT_FALSE(sawError);
+    ASSERT_EQ(100u, result.length());
+    for (unsigned i = 0; i < 100; ++i)
+        EXPECT_EQ(0x0410 + i % 64, result[i]);
+
+    result = decodeUTF8(cjk.data(), cjk.size(), sawError);
+    EXPECT_FALSE(sawError);
+    ASSERT_EQ(100u, result.length());
+    for (unsigned i = 0; i < 100; ++i)
+        EXPECT_EQ(i % 5 ? 0x4E00 + i : 'a', result[i]);
+}
+
+TEST(TextCodecUTF8, DecodeInvalidSequencesInBlocks)
+{
+    // Overlong forms and encoded surrogates are errors, even in the middle of
+    // otherwise valid text.
+    const char* invalidSequences[] = { "\xC0\x80", "\xC1\xBF", "\xE0\x80\x80", "\xE0\x9F\xBF", "\xED\xA0\x80", "\xED\xBF\xBF", "\xF0\x80\x80\x80", "\xF4\x90\x80\x80", "\x80", "\xBF\xBF", "\xD0", "\xE4\xB8" };
+    for (size_t i = 0; i < WTF_ARRAY_LENGTH(invalidSequences); ++i) {
+        for (size_t position = 0; position < 24; ++position) {
+            Vector<char> bytes;
+            for (int j = 0; j < 20; ++j)
+                appendUTF8(bytes, 0x0430 + j);
+            bytes.insert(position, invalidSequences[i], strlen(invalidSequences[i]));
+
+            bool sawError;
+            String result = decodeUTF8(bytes.data(), bytes.size(), sawError);
+            EXPECT_TRUE(sawError);
+            EXPECT_NE(kNotFound, result.find(static_cast<UChar>(0xFFFD)));
+            bool sawErrorByteByByte;
+            EXPECT_EQ(decodeUTF8ByteByByte(bytes.data(), bytes.size(), sawErrorByteByByte), result);
+            EXPECT_TRUE(sawErrorByteByByte);
+        }
+    }
+}
+
+// Generates a mix of ASCII, valid sequences of every length and, if
+// |invalidBytes| is set, bytes that may not form valid sequences.
+static void appendRandomUTF8(Vector<char>& bytes, unsigned& seed, size_t count, bool invalidBytes)
+{
+    for (size_t i = 0; i < count; ++i) {
+        seed = seed * 1103515245 + 12345;
+        unsigned random = seed >> 8;
+        switch (random % (invalidBytes ? 7 : 6)) {
+        case 0:
+            bytes.append(static_cast<char>(random % 0x80));
+            break;
+        case 1:
+            appendUTF8(bytes, 0x80 + random % 0x80);
+            break;
+        case 2:
+            appendUTF8(bytes, 0x100 + random % 0x700);
+            break;
+        case 3:
+        case 4: {
+            UChar32 character = 0x800 + random % 0xF800;
+            if (U_IS_SURROGATE(character))
+                character = 0xAC00;
+            appendUTF8(bytes, character);
+            break;
+        }
+        case 5:
+            appendUTF8(bytes, 0x10000 + random % 0x100000);
+            break;
+        default:
+            bytes.append(static_cast<char>(0x80 + random % 0x80));
+        }
+    }
+}
+
+TEST(TextCodecUTF8, DecodeFuzzedInputs)
+{
+    unsigned seed = 1;
+    for (int iteration = 0; iteration < 200; ++iteration) {
+        bool invalidBytes = iteration % 2;
+        Vector<char> bytes;
+        appendRandomUTF8(bytes, seed, 1 + iteration % 60, invalidBytes);
+
+        bool sawError;
+        String result = decodeUTF8(bytes.data(), bytes.size(), sawError);
+        bool sawErrorByteByByte;
+        EXPECT_EQ(decodeUTF8ByteByByte(bytes.data(), bytes.size(), sawErrorByteByByte), result);
+        EXPECT_EQ(sawErrorByteByByte, sawError);
+        if (!invalidBytes)
+            EXPECT_FALSE(sawError);
+
+        // Splitting the input anywhere, including inside a sequence or a
+        // block, doesn't change the result.
+        for (size_t split = 0; split <= bytes.size(); ++split) {
+            bool sawErrorInTwoParts;
+            EXPECT_EQ(decodeUTF8InTwoParts(bytes.data(), bytes.size(), split, sawErrorInTwoParts), result);
+            EXPECT_EQ(sawError, sawErrorInTwoParts);
+        }
+    }
+}
+
+static void runDecodeBenchmark(const char* name, UChar32 firstCharacter, UChar32 lastCharacter, int charactersPerSpace)
+{
+    // Text in one script, broken up by ASCII spaces like words.
+    Vector<char> bytes;
+    for (int i = 0; bytes.size() < 1024 * 1024; ++i) {
+        if (charactersPerSpace && !(i % charactersPerSpace))
+            bytes.append(' ');
+        appendUTF8(bytes, firstCharacter + i % (lastCharacter - firstCharacter + 1));
+    }
+
+    clock_t start = clock();
+    size_t decodedLength = 0;
+    for (int i = 0; i < 50; ++i) {
+        bool sawError;
+        decodedLength += decodeUTF8(bytes.data(), bytes.size(), sawError).length();
+        EXPECT_FALSE(sawError);
+    }
+    double ms = 1000.0 * (clock() - start) / CLOCKS_PER_SEC;
+    EXPECT_TRUE(decodedLength);
+    ::testing::Test::RecordProperty(name, static_cast<int>(ms));
+}
+
+// Decodes 50 MB of text in each script. Run with
+// --gtest_also_run_disabled_tests.
+TEST(TextCodecUTF8, DISABLED_DecodeThroughput)
+{
+    runDecodeBenchmark("AsciiMs", 'a', 'z', 6);
+    runDecodeBenchmark("Latin1Ms", 0xE0, 0xFF, 6);
+    runDecodeBenchmark("CyrillicMs", 0x0430, 0x044F, 7);
+    runDecodeBenchmark("GreekMs", 0x03B1, 0x03C9, 7);
+    runDecodeBenchmark("ChineseMs", 0x4E00, 0x9FA5, 0);
+    runDecodeBenchmark("JapaneseMs", 0x3041, 0x30FF, 0);
+    runDecodeBenchmark("KoreanMs", 0xAC00, 0xD7A3, 4);
+    runDecodeBenchmark("EmojiMs", 0x1F600, 0x1F64F, 0);
+}
+
 } // namespace
 
 } // namespace WTF